@@ -0,0 +1,118 @@
+#include "batchrunner.h"
+
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QMutexLocker>
+#include <QTextStream>
+#include <QThread>
+#include <cstdio>
+#include <memory>
+#include <utility>
+
+class BatchRunner::Worker : public QThread {
+public:
+    explicit Worker(BatchRunner *runner) : runner(runner) {}
+
+protected:
+    void run() override { runner->work(); }
+
+private:
+    BatchRunner *const runner;
+};
+
+BatchRunner::BatchRunner(JobFunction job_function, QStringList default_arguments)
+    : job_function(std::move(job_function))
+    , default_arguments(std::move(default_arguments)) {}
+
+bool BatchRunner::load_manifest(const QString &path, const JobValidator &validate) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        fprintf(stderr, "Batch manifest %s cannot be open for read.\n", qPrintable(path));
+        return false;
+    }
+    QTextStream in(&file);
+    for (int line_number = 1; !in.atEnd(); line_number++) {
+        const QString line = in.readLine().trimmed();
+        if (line.isEmpty() || line.startsWith('#')) { continue; }
+        Job job { default_arguments + split_arguments(line), line_number };
+        QString error = validate(job.arguments);
+        if (!error.isEmpty()) {
+            fprintf(
+                stderr, "%s:%d: invalid job: %s\n", qPrintable(path), line_number,
+                qPrintable(error));
+            return false;
+        }
+        jobs.push_back(std::move(job));
+    }
+    return true;
+}
+
+int BatchRunner::run(unsigned thread_count) {
+    if (thread_count > jobs.size()) { thread_count = jobs.size(); }
+    next_job = 0;
+    all_succeeded = true;
+    std::vector<std::unique_ptr<Worker>> workers;
+    for (unsigned i = 0; i < thread_count; i++) {
+        workers.emplace_back(new Worker(this));
+        workers.back()->start();
+    }
+    for (auto &worker : workers) {
+        worker->wait();
+    }
+    return all_succeeded ? 0 : 1;
+}
+
+QStringList BatchRunner::split_arguments(const QString &line) {
+    QStringList arguments;
+    QString current;
+    bool quoted = false;
+    bool pending = false;
+    for (QChar ch : line) {
+        if (ch == '"') {
+            quoted = !quoted;
+            pending = true;
+        } else if (ch.isSpace() && !quoted) {
+            if (pending) { arguments.append(current); }
+            current.clear();
+            pending = false;
+        } else {
+            current.append(ch);
+            pending = true;
+        }
+    }
+    if (pending) { arguments.append(current); }
+    return arguments;
+}
+
+void BatchRunner::work() {
+    while (true) {
+        const size_t index = next_job.fetch_add(1, std::memory_order_relaxed);
+        if (index >= jobs.size()) { return; }
+        execute(jobs[index]);
+    }
+}
+
+void BatchRunner::execute(const Job &job) {
+    QJsonObject report;
+    int exit_code;
+    try {
+        exit_code = job_function(job.arguments, report);
+    } catch (std::exception &e) {
+        report["error"] = QString(e.what());
+        exit_code = 1;
+    }
+    if (exit_code != 0) { all_succeeded = false; }
+
+    QJsonObject result;
+    result["line"] = job.line;
+    result["arguments"] = QJsonArray::fromStringList(job.arguments);
+    result["exit_code"] = exit_code;
+    result["report"] = report;
+    const QByteArray bytes = QJsonDocument(result).toJson(QJsonDocument::Compact);
+
+    QMutexLocker locker(&output_mutex);
+    fwrite(bytes.constData(), 1, bytes.size(), stdout);
+    fputc('\n', stdout);
+    fflush(stdout);
+}
@@ -0,0 +1,73 @@
+#ifndef BATCHRUNNER_H
+#define BATCHRUNNER_H
+
+#include <QJsonObject>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+#include <atomic>
+#include <functional>
+#include <vector>
+
+/**
+ * Runs many independent simulations (jobs) in parallel threads.
+ *
+ * Jobs are read from a manifest, one job per line. A line contains the input file followed by
+ * options of the job in the command line syntax, e.g. `prog.elf --cycle-limit 1000`. Arguments
+ * containing spaces can be quoted by `"`. Empty lines and lines starting with `#` are ignored.
+ * Options given to the batch itself are used as defaults of all jobs.
+ *
+ * Each worker thread takes the next waiting job as soon as it finishes the previous one, so long
+ * and short jobs are balanced between the threads. Report of each job is written to the standard
+ * output as a single line JSON object when the job finishes (JSON lines).
+ */
+class BatchRunner {
+public:
+    /**
+     * Simulation of a single job, it is called from worker threads.
+     *
+     * @param arguments  command line of the job (without the program name)
+     * @param report     report of the job
+     * @return           exit code of the job
+     */
+    using JobFunction = std::function<int(const QStringList &arguments, QJsonObject &report)>;
+    /** Checks arguments of a job before the run, returns error description or empty string. */
+    using JobValidator = std::function<QString(const QStringList &arguments)>;
+
+    BatchRunner(JobFunction job_function, QStringList default_arguments);
+
+    /** Loads and validates jobs, prints error and returns false on failure. */
+    bool load_manifest(const QString &path, const JobValidator &validate);
+
+    /**
+     * Runs all jobs and waits for them.
+     *
+     * @param thread_count  number of worker threads
+     * @return              0 when all jobs ended with exit code 0, 1 otherwise
+     */
+    int run(unsigned thread_count);
+
+    /** Splits manifest line into arguments. */
+    static QStringList split_arguments(const QString &line);
+
+private:
+    class Worker;
+
+    struct Job {
+        QStringList arguments;
+        /** Line of the job in the manifest (for reference in the report). */
+        int line;
+    };
+
+    const JobFunction job_function;
+    const QStringList default_arguments;
+    std::vector<Job> jobs;
+    std::atomic<size_t> next_job { 0 };
+    std::atomic<bool> all_succeeded { true };
+    QMutex output_mutex;
+
+    void work();
+    void execute(const Job &job);
+};
+
+#endif // BATCHRUNNER_H
@@ -40,6 +40,11 @@ void CharIOHandler::writeByte(int fd, unsigned int data) {
         writeByte(data);
 }
 
+void CharIOHandler::writeBytes(int fd, const QByteArray &data) {
+    if (!fd_specific || fd_list.contains(fd))
+        write(data);
+}
+
 void CharIOHandler::readBytePoll(int fd, unsigned int &data, bool &available) {
     char ch;
     qint64 res;
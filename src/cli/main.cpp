@@ -1,8 +1,10 @@
 #include "assembler/simpleasm.h"
+#include "batchrunner.h"
 #include "chariohandler.h"
 #include "common/logging.h"
 #include "common/logging_format_colors.h"
 #include "machine/machineconfig.h"
+#include "machine/programloader.h"
 #include "os_emulation/ossyscall.h"
 #include "msgreport.h"
 #include "reporter.h"
@@ -11,9 +13,14 @@
 #include <QCommandLineParser>
 #include <QCoreApplication>
 #include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QThread>
 #include <cctype>
 #include <fstream>
 #include <iostream>
+#include <memory>
+#include <stdexcept>
 
 using namespace machine;
 using namespace std;
@@ -30,10 +37,35 @@ void create_parser(QCommandLineParser &p) {
 
     // p.addOptions({}); available only from Qt 5.4+
     p.addOption({ "asm", "Treat provided file argument as assembler source." });
+    p.addOption({ "replay",
+                  "Treat provided file argument as access trace (see --record-trace) and replay "
+                  "it to the caches and branch predictor without running the core." });
+    p.addOption({ "record-trace",
+                  "Record memory accesses and branch outcomes to binary access trace file.",
+                  "FNAME" });
+    p.addOption({ "save-checkpoint-at",
+                  "Save machine state to checkpoint file when the cycle count reaches CYCLE and "
+                  "continue the run.",
+                  "CYCLE,FNAME" });
+    p.addOption({ "load-checkpoint",
+                  "Start the run from machine state saved by --save-checkpoint-at. Machine has to "
+                  "be configured the same way.",
+                  "FNAME" });
     p.addOption({ "pipelined", "Configure CPU to use five stage pipeline." });
     p.addOption({ "no-delay-slot", "Disable jump delay slot." });
     p.addOption(
         { "hazard-unit", "Specify hazard unit implementation [none|stall|forward].", "HUKIND" });
+    p.addOption({ "memory-backend",
+                  "Specify main memory storage organization [paged|tree], paged is the default.",
+                  "MBKIND" });
+    p.addOption({ "branch-predictor",
+                  "Enable branch predictor [ntaken|taken|btfnt|smith1|smith2|smith2h|gshare|"
+                  "tournament|tage|perceptron] with optional numbers of BTB, BHR and BHT "
+                  "address bits (e.g. smith2,4,2,3 or gshare,8,16,16).",
+                  "KIND,BTB,BHR,BHT" });
+    p.addOption({ "timing-model",
+                  "Load cycle costs of instruction classes and mnemonics from JSON file.",
+                  "FNAME" });
     p.addOption({ { "trace-fetch", "tr-fetch" },
                   "Trace fetched instruction (for both pipelined and not core)." });
     p.addOption({ { "trace-decode", "tr-decode" },
@@ -54,7 +86,15 @@ void create_parser(QCommandLineParser &p) {
     p.addOption({ "dump-to-json", "Configure reportor dump to json file.", "FNAME" });
     p.addOption({ { "dump-registers", "d-regs" }, "Dump registers state at program exit." });
     p.addOption({ "dump-cache-stats", "Dump cache statistics at program exit." });
+    p.addOption({ "dump-predictor-stats", "Dump branch predictor statistics at program exit." });
     p.addOption({ "dump-cycles", "Dump number of CPU cycles till program end." });
+    p.addOption({ "dump-cycle-breakdown", "Dump CPU cycles split by instruction class." });
+    p.addOption({ "dump-ips",
+                  "Dump number of retired instructions and simulation speed (instructions "
+                  "per second)." });
+    p.addOption({ "dump-core-counters",
+                  "Dump diagnostic counters of the core (vector ALU operations, unknown "
+                  "instruction encodings)." });
     p.addOption({ "dump-range", "Dump memory range.", "START,LENGTH,FNAME" });
     p.addOption({ "load-range", "Load memory range.", "START,FNAME" });
     p.addOption({ "expect-fail", "Expect that program causes CPU trap and fail if it doesn't." });
@@ -85,10 +125,52 @@ void create_parser(QCommandLineParser &p) {
     p.addOption({ { "os-emulation", "osemu" }, "Operating system emulation." });
     p.addOption({ { "std-out", "stdout" }, "File connected to the syscall standard output.", "FNAME" });
     p.addOption({ { "os-fs-root", "osfsroot" }, "Emulated system root/prefix for opened files", "DIR" });
+    p.addOption({ { "trace-syscalls", "tr-syscalls" },
+                  "Print emulated system calls with their arguments and results." });
     p.addOption({ { "isa-variant", "isavariant" }, "Instruction set to emulate (default RV32IMA)", "STR" });
+    p.addOption({ "sample",
+                  "Sampled simulation, each PERIOD instructions are fast-forwarded except for "
+                  "WARMUP instructions warming the pipeline and WINDOW measured instructions. "
+                  "Extrapolated cycles are reported.",
+                  "PERIOD,WARMUP,WINDOW" });
     p.addOption({ "cycle-limit", "Limit execution to specified maximum clock cycles", "NUMBER" });
+    p.addOption(
+        { "headless", "Run without observer signals (fastest). Tracing is not available." });
+    p.addOption({ "batch",
+                  "Run jobs listed in manifest file in parallel, one job per line given as input "
+                  "file and its options. Other options apply to all jobs. Reports are printed "
+                  "as JSON lines.",
+                  "MANIFEST" });
+    p.addOption({ "sweep",
+                  "Run the input file once for each configuration (options of the cache, branch "
+                  "predictor, core, ...) listed in file, one configuration per line. The program "
+                  "is loaded only once and the configurations run in parallel. Reports are "
+                  "printed as JSON lines.",
+                  "CONFIGS" });
+    p.addOption({ "jobs", "Number of threads running batch or sweep jobs (default: CPU count).",
+                  "NUMBER" });
+}
+
+/**
+ * Error of simulation options or of files named by them. Batch jobs run in worker threads and
+ * must not end the process, the error is recorded in the job report (see `run_batch_job`).
+ * Single simulation prints it and fails (see `main`).
+ */
+class OptionError : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+[[noreturn]] static void option_error(const QString &message) {
+    throw OptionError(message.toStdString());
 }
 
+// Options which are not available in batch mode (the jobs run headless).
+static const char *const TRACE_OPTIONS[]
+    = { "trace-fetch", "trace-decode", "trace-execute", "trace-memory",
+        "trace-writeback", "trace-pc", "trace-wrmem", "trace-rdmem", "trace-gp",
+        "trace-syscalls" };
+
 void configure_cache(CacheConfig &cacheconf, const QStringList &cachearg, const QString &which) {
     if (cachearg.empty()) { return; }
     cacheconf.set_enabled(true);
@@ -146,6 +228,52 @@ void configure_cache(CacheConfig &cacheconf, const QStringList &cachearg, const
     }
 }
 
+void configure_branch_predictor(MachineConfig &config, const QStringList &bparg) {
+    if (bparg.empty()) { return; }
+    static const struct {
+        const char *name;
+        PredictorType type;
+        PredictorState initial_state;
+    } kinds[] = {
+        { "ntaken", PredictorType::ALWAYS_NOT_TAKEN, PredictorState::NOT_TAKEN },
+        { "taken", PredictorType::ALWAYS_TAKEN, PredictorState::NOT_TAKEN },
+        { "btfnt", PredictorType::BTFNT, PredictorState::NOT_TAKEN },
+        { "smith1", PredictorType::SMITH_1_BIT, PredictorState::NOT_TAKEN },
+        { "smith2", PredictorType::SMITH_2_BIT, PredictorState::WEAKLY_NOT_TAKEN },
+        { "smith2h", PredictorType::SMITH_2_BIT_HYSTERESIS, PredictorState::WEAKLY_NOT_TAKEN },
+        { "gshare", PredictorType::GSHARE, PredictorState::WEAKLY_NOT_TAKEN },
+        { "tournament", PredictorType::TOURNAMENT, PredictorState::WEAKLY_NOT_TAKEN },
+        { "tage", PredictorType::TAGE_LITE, PredictorState::WEAKLY_NOT_TAKEN },
+        { "perceptron", PredictorType::PERCEPTRON, PredictorState::NOT_TAKEN },
+    };
+    QStringList pieces = bparg.last().split(",");
+    bool known = false;
+    for (const auto &kind : kinds) {
+        if (pieces.at(0).toLower() == kind.name) {
+            config.set_bp_type(kind.type);
+            config.set_bp_init_state(kind.initial_state);
+            known = true;
+        }
+    }
+    if (!known || pieces.size() > 4) {
+        fprintf(stderr, "Parameters of branch predictor incorrect (correct smith2,4,2,3).\n");
+        exit(EXIT_FAILURE);
+    }
+    void (MachineConfig::*const setters[])(uint8_t) = { &MachineConfig::set_bp_btb_bits,
+                                                        &MachineConfig::set_bp_bhr_bits,
+                                                        &MachineConfig::set_bp_bht_addr_bits };
+    for (int i = 1; i < pieces.size(); i++) {
+        bool ok;
+        unsigned bits = pieces.at(i).toUInt(&ok);
+        if (!ok || bits > UINT8_MAX) {
+            fprintf(stderr, "Number of branch predictor bits parse error.\n");
+            exit(EXIT_FAILURE);
+        }
+        (config.*setters[i - 1])(bits);
+    }
+    config.set_bp_enabled(true);
+}
+
 void parse_u32_option(
     QCommandLineParser &parser,
     const QString &option_name,
@@ -187,6 +315,14 @@ void configure_machine(QCommandLineParser &parser, MachineConfig &config) {
         }
     }
 
+    auto memory_backend_values = parser.values("memory-backend");
+    if (!memory_backend_values.empty()) {
+        if (!config.set_memory_backend(memory_backend_values.last().toLower())) {
+            fprintf(stderr, "Unknown kind of memory backend specified\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
     parse_u32_option(parser, "read-time", config, &MachineConfig::set_memory_access_time_read);
     parse_u32_option(parser, "write-time", config, &MachineConfig::set_memory_access_time_write);
     parse_u32_option(parser, "burst-time", config, &MachineConfig::set_memory_access_time_burst);
@@ -195,9 +331,22 @@ void configure_machine(QCommandLineParser &parser, MachineConfig &config) {
     configure_cache(*config.access_cache_data(), parser.values("d-cache"), "data");
     configure_cache(*config.access_cache_program(), parser.values("i-cache"), "instruction");
     configure_cache(*config.access_cache_level2(), parser.values("l2-cache"), "level2");
+    configure_branch_predictor(config, parser.values("branch-predictor"));
+    if (parser.isSet("timing-model")) {
+        try {
+            config.set_timing_model(TimingModel::load(parser.value("timing-model")));
+        } catch (SimulatorException &e) {
+            fprintf(stderr, "%s\n", qPrintable(e.msg(false)));
+            exit(EXIT_FAILURE);
+        }
+    }
 
     config.set_osemu_enable(parser.isSet("os-emulation"));
     config.set_osemu_known_syscall_stop(false);
+    if (config.osemu_enable() && config.memory_backend() != MachineConfig::MB_PAGED) {
+        fprintf(stderr, "Operating system emulation requires the paged memory backend\n");
+        exit(EXIT_FAILURE);
+    }
 
     int siz = parser.values("os-fs-root").size();
     if (siz >= 1) {
@@ -262,9 +411,7 @@ void configure_tracer(QCommandLineParser &p, Tracer &tr) {
             if (res && num <= machine::REGISTER_COUNT) {
                 tr.regs_to_trace.at(num) = true;
             } else {
-                fprintf(
-                    stderr, "Unknown register number given for trace-gp: %s\n", qPrintable(gp));
-                exit(EXIT_FAILURE);
+                option_error("Unknown register number given for trace-gp: " + gp);
             }
         }
     }
@@ -272,18 +419,52 @@ void configure_tracer(QCommandLineParser &p, Tracer &tr) {
     if (p.isSet("trace-rdmem")) { tr.trace_rdmem = true; }
     if (p.isSet("trace-wrmem")) { tr.trace_wrmem = true; }
 
+    // TODO
+}
+
+void configure_cycle_limit(QCommandLineParser &p, Machine &machine) {
     QStringList clim = p.values("cycle-limit");
     if (!clim.empty()) {
         bool ok;
-        tr.cycle_limit = clim.at(clim.size() - 1).toLong(&ok);
-        if (!ok) {
-            fprintf(
-                stderr, "Cycle limit parse error\n");
-            exit(EXIT_FAILURE);
-        }
+        machine.set_cycle_limit(clim.at(clim.size() - 1).toULongLong(&ok));
+        if (!ok) { option_error("Cycle limit parse error"); }
     }
+}
 
-    // TODO
+/** Parses `--sample` argument, returns false on error. */
+static bool parse_sampling(const QString &arg, SamplingConfig &sampling) {
+    const QStringList pieces = arg.split(",");
+    if (pieces.size() != 3) { return false; }
+    bool ok[3];
+    sampling.period = pieces[0].toULongLong(&ok[0], 0);
+    sampling.warmup = pieces[1].toULongLong(&ok[1], 0);
+    sampling.window = pieces[2].toULongLong(&ok[2], 0);
+    return ok[0] && ok[1] && ok[2] && sampling.enabled() && sampling.valid();
+}
+
+void configure_sampling(QCommandLineParser &p, Machine &machine) {
+    if (!p.isSet("sample")) { return; }
+    SamplingConfig sampling;
+    if (!parse_sampling(p.value("sample"), sampling)) {
+        option_error(
+            "Sampling specification error (PERIOD,WARMUP,WINDOW expected, WARMUP + WINDOW must "
+            "not exceed PERIOD).");
+    }
+    machine.set_sampling(sampling);
+}
+
+/**
+ * Parses `--fail-match` argument into `Reporter::FailReason` bits, returns false and the
+ * `unknown` condition on error.
+ */
+static bool parse_fail_match(const QString &arg, int &reasons, QChar &unknown) {
+    for (const QChar condition : arg) {
+        switch (condition.toLower().toLatin1()) {
+        case 'i': reasons |= Reporter::FR_UNSUPPORTED_INSTR; break;
+        default: unknown = condition; return false;
+        }
+    }
+    return true;
 }
 
 void configure_reporter(QCommandLineParser &p, Reporter &r, const SymbolTable *symtab) {
@@ -293,20 +474,19 @@ void configure_reporter(QCommandLineParser &p, Reporter &r, const SymbolTable *s
     }
     if (p.isSet("dump-registers")) { r.enable_regs_reporting(); }
     if (p.isSet("dump-cache-stats")) { r.enable_cache_stats(); }
+    if (p.isSet("dump-predictor-stats")) { r.enable_predictor_stats(); }
     if (p.isSet("dump-cycles")) { r.enable_cycles_reporting(); }
-
-    QStringList fail = p.values("fail-match");
-    for (const auto & i : fail) {
-        for (int y = 0; y < i.length(); y++) {
-            enum Reporter::FailReason reason;
-            switch (tolower(i.toStdString()[y])) {
-            case 'i': reason = Reporter::FR_UNSUPPORTED_INSTR; break;
-            default:
-                fprintf(stderr, "Unknown fail condition: %c\n", qPrintable(i)[y]);
-                exit(EXIT_FAILURE);
-            }
-            r.expect_fail(reason);
+    if (p.isSet("dump-cycle-breakdown")) { r.enable_cycle_breakdown_reporting(); }
+    if (p.isSet("dump-ips")) { r.enable_ips_reporting(); }
+    if (p.isSet("dump-core-counters")) { r.enable_core_counters_reporting(); }
+
+    for (const QString &fail : p.values("fail-match")) {
+        int reasons = Reporter::FR_NONE;
+        QChar condition;
+        if (!parse_fail_match(fail, reasons, condition)) {
+            option_error(QString("Unknown fail condition: ") + condition);
         }
+        r.expect_fail((Reporter::FailReason)reasons);
     }
     if (p.isSet("expect-fail") && !p.isSet("fail-match")) { r.expect_fail(Reporter::FailAny); }
 
@@ -316,15 +496,9 @@ void configure_reporter(QCommandLineParser &p, Reporter &r, const SymbolTable *s
         bool ok2 = true;
         QString str;
         int comma1 = range_arg.indexOf(",");
-        if (comma1 < 0) {
-            fprintf(stderr, "Range start missing\n");
-            exit(EXIT_FAILURE);
-        }
+        if (comma1 < 0) { option_error("Range start missing"); }
         int comma2 = range_arg.indexOf(",", comma1 + 1);
-        if (comma2 < 0) {
-            fprintf(stderr, "Range length/name missing\n");
-            exit(EXIT_FAILURE);
-        }
+        if (comma2 < 0) { option_error("Range length/name missing"); }
         str = range_arg.mid(0, comma1);
         Address start;
         if (str.size() >= 1 && !str.at(0).isDigit() && symtab != nullptr) {
@@ -340,10 +514,7 @@ void configure_reporter(QCommandLineParser &p, Reporter &r, const SymbolTable *s
         } else {
             len = str.toULong(&ok2, 0);
         }
-        if (!ok1 || !ok2) {
-            fprintf(stderr, "Range start/length specification error.\n");
-            exit(EXIT_FAILURE);
-        }
+        if (!ok1 || !ok2) { option_error("Range start/length specification error."); }
         r.add_dump_range(start, len, range_arg.mid(comma2 + 1));
     }
 
@@ -370,8 +541,7 @@ void configure_serial_port(QCommandLineParser &p, SerialPort *ser_port) {
             }
         }
         if (!ser_in->open(mode)) {
-            fprintf(stderr, "Serial port input file cannot be open for read.\n");
-            exit(EXIT_FAILURE);
+            option_error("Serial port input file cannot be open for read.");
         }
     }
 
@@ -381,8 +551,7 @@ void configure_serial_port(QCommandLineParser &p, SerialPort *ser_port) {
             auto *qf = new QFile(p.values("serial-out").at(siz - 1));
             ser_out = new CharIOHandler(qf, ser_port);
             if (!ser_out->open(QFile::WriteOnly)) {
-                fprintf(stderr, "Serial port output file cannot be open for write.\n");
-                exit(EXIT_FAILURE);
+                option_error("Serial port output file cannot be open for write.");
             }
         }
     }
@@ -409,8 +578,7 @@ void configure_osemu(QCommandLineParser &p, MachineConfig &config, Machine *mach
         auto *qf = new QFile(p.values("std-out").at(siz - 1));
         std_out = new CharIOHandler(qf, machine);
         if (!std_out->open(QFile::WriteOnly)) {
-            fprintf(stderr, "Emulated system standard output file cannot be open for write.\n");
-            exit(EXIT_FAILURE);
+            option_error("Emulated system standard output file cannot be open for write.");
         }
     }
     const static machine::ExceptionCause ecall_variats[] = {machine::EXCAUSE_ECALL_ANY,
@@ -419,11 +587,15 @@ void configure_osemu(QCommandLineParser &p, MachineConfig &config, Machine *mach
     if (config.osemu_enable()) {
         auto *osemu_handler = new osemu::OsSyscallExceptionHandler(
             config.osemu_known_syscall_stop(), config.osemu_unknown_syscall_stop(),
-            config.osemu_fs_root());
+            config.osemu_fs_root(), machine->config().get_simulated_xlen());
+        osemu_handler->setParent(machine);
+        if (p.isSet("trace-syscalls")) {
+            osemu_handler->set_trace_sink(std::make_shared<osemu::SyscallTextTrace>());
+        }
         if (std_out) {
             machine::Machine::connect(
-                osemu_handler, &osemu::OsSyscallExceptionHandler::char_written,
-                std_out, QOverload<int, unsigned>::of(&CharIOHandler::writeByte));
+                osemu_handler, &osemu::OsSyscallExceptionHandler::data_written,
+                std_out, &CharIOHandler::writeBytes);
         }
         /*connect(
             osemu_handler, &osemu::OsSyscallExceptionHandler::rx_byte_pool, terminal,
@@ -446,10 +618,7 @@ void load_ranges(Machine &machine, const QStringList &ranges) {
         bool ok = true;
         QString str;
         int comma1 = range_arg.indexOf(",");
-        if (comma1 < 0) {
-            fprintf(stderr, "Range start missing\n");
-            exit(EXIT_FAILURE);
-        }
+        if (comma1 < 0) { option_error("Range start missing"); }
         str = range_arg.mid(0, comma1);
         Address start;
         if (str.size() >= 1 && !str.at(0).isDigit() && machine.symbol_table() != nullptr) {
@@ -459,12 +628,10 @@ void load_ranges(Machine &machine, const QStringList &ranges) {
         } else {
             start = Address(str.toULong(&ok, 0));
         }
-        if (!ok) {
-            fprintf(stderr, "Range start/length specification error.\n");
-            exit(EXIT_FAILURE);
-        }
+        if (!ok) { option_error("Range start/length specification error."); }
         ifstream in;
         in.open(range_arg.mid(comma1 + 1).toLocal8Bit().data(), ios::in);
+        if (!in.is_open()) { option_error("Load range file cannot be open for read."); }
         Address addr = start;
         for (std::string line; getline(in, line);) {
             size_t end_pos = line.find_last_not_of(" \t\n");
@@ -476,12 +643,12 @@ void load_ranges(Machine &machine, const QStringList &ranges) {
             line = line.substr(0, end_pos + 1);
             line = line.substr(start_pos);
 
-            size_t idx;
-            uint32_t val = stoul(line, &idx, 0);
-            if (idx != line.size()) {
-                fprintf(stderr, "cannot parse load range data.\n");
-                exit(EXIT_FAILURE);
-            }
+            size_t idx = 0;
+            uint32_t val = 0;
+            try {
+                val = stoul(line, &idx, 0);
+            } catch (std::logic_error &) { idx = 0; }
+            if (idx == 0 || idx != line.size()) { option_error("cannot parse load range data."); }
             machine.memory_data_bus_rw()->write_u32(addr, val, ae::INTERNAL);
             addr += 4;
         }
@@ -507,41 +674,300 @@ bool assemble(Machine &machine, MsgReport &msgrep, const QString &filename) {
     return assembler.finish();
 }
 
-int main(int argc, char *argv[]) {
-    QCoreApplication app(argc, argv);
-    QCoreApplication::setApplicationName(APP_NAME);
-    QCoreApplication::setApplicationVersion(APP_VERSION);
-    set_default_log_pattern();
+/** Parses `--save-checkpoint-at` argument, returns false on error. */
+static bool parse_checkpoint_at(const QString &arg, uint64_t &cycle, QString &path) {
+    const int comma = arg.indexOf(',');
+    if (comma <= 0 || comma + 1 >= arg.size()) { return false; }
+    bool ok;
+    cycle = arg.left(comma).toULongLong(&ok, 0);
+    path = arg.mid(comma + 1);
+    return ok && cycle != 0;
+}
 
-    QCommandLineParser p;
-    create_parser(p);
-    p.process(app);
+/**
+ * Runs the machine. With `--save-checkpoint-at` the run stops at the cycle (at the end of
+ * the block reaching it in headless mode), the checkpoint is saved and the run continues.
+ */
+static Machine::StopReason run_machine(QCommandLineParser &p, Machine &machine) {
+    uint64_t checkpoint_cycle = 0;
+    QString checkpoint_path;
+    if (!p.isSet("save-checkpoint-at")) { return machine.run(); }
+    if (!parse_checkpoint_at(p.value("save-checkpoint-at"), checkpoint_cycle, checkpoint_path)) {
+        option_error("Checkpoint specification error (CYCLE,FNAME expected).");
+    }
+    const uint64_t cycle_limit = machine.get_cycle_limit();
+    if (cycle_limit != 0 && cycle_limit <= checkpoint_cycle) { return machine.run(); }
+    machine.set_cycle_limit(checkpoint_cycle);
+    const Machine::StopReason reason = machine.run();
+    machine.set_cycle_limit(cycle_limit);
+    if (reason != Machine::SR_CYCLE_LIMIT) { return reason; }
+    machine.save_checkpoint(checkpoint_path);
+    return machine.run();
+}
 
+/**
+ * Runs the simulation configured by the parsed command line.
+ *
+ * @param report   when set (batch job), the report is collected in it instead of printing
+ * @param program  when set (sweep job), the program is used instead of loading the input file
+ * @return         exit code of the simulation
+ */
+int simulate(
+    QCommandLineParser &p,
+    QJsonObject *report = nullptr,
+    const LoadedProgram *program = nullptr) {
     MachineConfig config;
     configure_machine(p, config);
 
     bool asm_source = p.isSet("asm");
-    Machine machine(config, !asm_source, !asm_source);
+    bool replay = p.isSet("replay");
+    if (asm_source && replay) { option_error("Assembler source cannot be replayed."); }
+    if (replay && p.isSet("save-checkpoint-at")) {
+        option_error("Checkpoint cannot be saved during replay.");
+    }
+    if (replay && p.isSet("sample")) { option_error("Access trace replay cannot be sampled."); }
+    std::unique_ptr<Machine> machine_ptr
+        = program != nullptr
+              ? std::make_unique<Machine>(config, *program)
+              : std::make_unique<Machine>(config, !asm_source && !replay, !asm_source && !replay);
+    Machine &machine = *machine_ptr;
+
+    std::unique_ptr<AccessTraceWriter> access_trace;
+    if (p.isSet("record-trace")) {
+        access_trace = std::make_unique<AccessTraceWriter>(p.value("record-trace"));
+        machine.set_access_trace(access_trace.get());
+    }
 
     Tracer tr(&machine);
     configure_tracer(p, tr);
 
+    configure_cycle_limit(p, machine);
+    configure_sampling(p, machine);
+
+    if (p.isSet("headless") || report != nullptr) {
+        if (tr.is_enabled()) { option_error("Tracing cannot be used in headless mode."); }
+        machine.set_headless(true);
+    }
+
     configure_serial_port(p, machine.serial_port());
 
     configure_osemu(p, config, &machine);
 
     if (asm_source) {
-        MsgReport msg_report(&app);
-        if (!assemble(machine, msg_report, p.positionalArguments()[0])) { exit(EXIT_FAILURE); }
+        QJsonArray messages;
+        MsgReport msg_report(
+            report != nullptr ? nullptr : QCoreApplication::instance(),
+            report != nullptr ? &messages : nullptr);
+        bool assembled = assemble(machine, msg_report, p.positionalArguments()[0]);
+        if (report != nullptr && !messages.isEmpty()) { (*report)["messages"] = messages; }
+        if (!assembled) {
+            if (report == nullptr) { exit(EXIT_FAILURE); }
+            return EXIT_FAILURE;
+        }
     }
 
-    Reporter r(&app, &machine);
+    // Batch jobs run in worker threads, their objects cannot be children of the application.
+    Reporter r(report != nullptr ? nullptr : QCoreApplication::instance(), &machine);
+    if (report != nullptr) { r.dump_format = DumpFormat::JSON; }
     configure_reporter(p, r, machine.symbol_table());
 
-    QObject::connect(&tr, &Tracer::cycle_limit_reached, &r, &Reporter::cycle_limit_reached);
-
+    if (p.isSet("load-checkpoint")) { machine.load_checkpoint(p.value("load-checkpoint")); }
     load_ranges(machine, p.values("load-range"));
 
-    machine.play();
-    return QCoreApplication::exec();
+    r.run_started();
+    if (replay) {
+        AccessTraceReader trace(p.positionalArguments()[0]);
+        r.trace_replayed(machine.replay_access_trace(trace));
+    } else if (run_machine(p, machine) == Machine::SR_CYCLE_LIMIT) {
+        // Exit, trap and exception stop are reported by the signals of the machine.
+        r.cycle_limit_reached();
+    }
+    if (access_trace != nullptr) { access_trace->close(); }
+    if (report != nullptr) {
+        for (const QString &key : r.dump_data_json.keys()) {
+            report->insert(key, r.dump_data_json.value(key));
+        }
+    }
+    return r.get_exit_code();
+}
+
+/** Parses command line of a batch job, program name is prepended. */
+static bool parse_batch_job(QCommandLineParser &p, const QStringList &arguments) {
+    create_parser(p);
+    return p.parse(QStringList(QCoreApplication::applicationFilePath()) + arguments);
+}
+
+static QString validate_batch_job(const QStringList &arguments, bool sweep) {
+    QCommandLineParser p;
+    if (!parse_batch_job(p, arguments)) { return p.errorText(); }
+    if (p.positionalArguments().size() != 1) { return "Single ELF file has to be specified"; }
+    if (p.isSet("batch") || p.isSet("sweep")) { return "Batch cannot be nested"; }
+    if (sweep && p.isSet("asm")) { return "Sweep requires ELF file or access trace"; }
+    if (p.isSet("save-checkpoint-at")) {
+        uint64_t cycle;
+        QString path;
+        if (!parse_checkpoint_at(p.value("save-checkpoint-at"), cycle, path)) {
+            return "Checkpoint specification error (CYCLE,FNAME expected)";
+        }
+        if (p.isSet("replay")) { return "Checkpoint cannot be saved during replay"; }
+    }
+    if (p.isSet("sample")) {
+        SamplingConfig sampling;
+        if (!parse_sampling(p.value("sample"), sampling)) {
+            return "Sampling specification error (PERIOD,WARMUP,WINDOW expected)";
+        }
+        if (p.isSet("replay")) { return "Access trace replay cannot be sampled"; }
+    }
+    for (const char *option : TRACE_OPTIONS) {
+        if (p.isSet(option)) { return "Tracing cannot be used in batch mode"; }
+    }
+    if (p.isSet("asm") && p.isSet("replay")) { return "Assembler source cannot be replayed"; }
+    if (p.isSet("cycle-limit")) {
+        bool ok;
+        p.value("cycle-limit").toULongLong(&ok);
+        if (!ok) { return "Cycle limit parse error"; }
+    }
+    for (const QString &fail : p.values("fail-match")) {
+        int reasons = Reporter::FR_NONE;
+        QChar condition;
+        if (!parse_fail_match(fail, reasons, condition)) {
+            return QString("Unknown fail condition: ") + condition;
+        }
+    }
+    for (const QString &range : p.values("dump-range")) {
+        if (range.count(',') < 2) { return "Dump range specification error (START,LENGTH,FNAME)"; }
+    }
+    // Files read by the job have to exist, output files are created by the job.
+    for (const QString &range : p.values("load-range")) {
+        const int comma = range.indexOf(',');
+        if (comma < 0) { return "Load range specification error (START,FNAME expected)"; }
+        if (!QFileInfo(range.mid(comma + 1)).isReadable()) {
+            return "Load range file cannot be open for read";
+        }
+    }
+    if (p.isSet("serial-in") && !QFileInfo(p.value("serial-in")).isReadable()) {
+        return "Serial port input file cannot be open for read";
+    }
+    if (p.isSet("load-checkpoint") && !QFileInfo(p.value("load-checkpoint")).isReadable()) {
+        return "Checkpoint file cannot be open for read";
+    }
+    // Machine configuration errors end the program before any job starts.
+    MachineConfig config;
+    configure_machine(p, config);
+    return {};
+}
+
+static int run_batch_job(
+    const QStringList &arguments,
+    QJsonObject &report,
+    const LoadedProgram *program = nullptr) {
+    QCommandLineParser p;
+    parse_batch_job(p, arguments);
+    try {
+        return simulate(p, &report, program);
+    } catch (SimulatorException &e) {
+        report["error"] = e.msg(false);
+        return EXIT_FAILURE;
+    } catch (OptionError &e) {
+        report["error"] = QString(e.what());
+        return EXIT_FAILURE;
+    }
+}
+
+/** Command line of the batch without the program name and batch specific options. */
+static QStringList batch_default_arguments(QStringList arguments) {
+    static const QStringList batch_options = { "--batch", "--sweep", "--jobs" };
+    QStringList result;
+    arguments.removeFirst();
+    for (int i = 0; i < arguments.size(); i++) {
+        const QString &arg = arguments.at(i);
+        if (batch_options.contains(arg)) {
+            i++; // Skip the value.
+        } else if (!batch_options.contains(arg.section('=', 0, 0))) {
+            result.append(arg);
+        }
+    }
+    return result;
+}
+
+static unsigned batch_thread_count(QCommandLineParser &p) {
+    if (!p.isSet("jobs")) {
+        return QThread::idealThreadCount() > 0 ? QThread::idealThreadCount() : 1;
+    }
+    bool ok;
+    unsigned thread_count = p.value("jobs").toUInt(&ok);
+    if (!ok || thread_count == 0) {
+        fprintf(stderr, "Number of batch jobs parse error\n");
+        exit(EXIT_FAILURE);
+    }
+    return thread_count;
+}
+
+int run_batch(QCommandLineParser &p) {
+    if (!p.positionalArguments().isEmpty()) {
+        fprintf(stderr, "Input files of batch are given by the manifest\n");
+        exit(EXIT_FAILURE);
+    }
+    BatchRunner runner(
+        [](const QStringList &arguments, QJsonObject &report) {
+            return run_batch_job(arguments, report);
+        },
+        batch_default_arguments(QCoreApplication::arguments()));
+    auto validate = [](const QStringList &arguments) {
+        return validate_batch_job(arguments, false);
+    };
+    if (!runner.load_manifest(p.value("batch"), validate)) { exit(EXIT_FAILURE); }
+    return runner.run(batch_thread_count(p));
+}
+
+/**
+ * Runs single program with all configurations of the sweep. The ELF file is loaded once and
+ * each job starts from a copy of it, or each job replays the same access trace (`--replay`).
+ * Jobs report cycles, cache and predictor statistics.
+ */
+int run_sweep(QCommandLineParser &p) {
+    if (p.positionalArguments().size() != 1 || p.isSet("asm")) {
+        fprintf(stderr, "Sweep requires single ELF file or access trace\n");
+        exit(EXIT_FAILURE);
+    }
+    // Access trace is mapped by each job, there is no program to load.
+    std::unique_ptr<const LoadedProgram> program;
+    if (!p.isSet("replay")) {
+        MachineConfig config;
+        configure_machine(p, config);
+        program = std::make_unique<const LoadedProgram>(Machine::load_program(config));
+    }
+
+    QStringList default_arguments = batch_default_arguments(QCoreApplication::arguments());
+    default_arguments << "--dump-cycles" << "--dump-cache-stats" << "--dump-predictor-stats";
+    BatchRunner runner(
+        [&program](const QStringList &arguments, QJsonObject &report) {
+            return run_batch_job(arguments, report, program.get());
+        },
+        default_arguments);
+    auto validate = [](const QStringList &arguments) {
+        return validate_batch_job(arguments, true);
+    };
+    if (!runner.load_manifest(p.value("sweep"), validate)) { exit(EXIT_FAILURE); }
+    return runner.run(batch_thread_count(p));
+}
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName(APP_NAME);
+    QCoreApplication::setApplicationVersion(APP_VERSION);
+    set_default_log_pattern();
+
+    QCommandLineParser p;
+    create_parser(p);
+    p.process(app);
+
+    if (p.isSet("batch")) { return run_batch(p); }
+    if (p.isSet("sweep")) { return run_sweep(p); }
+    try {
+        return simulate(p);
+    } catch (OptionError &e) {
+        fprintf(stderr, "%s\n", e.what());
+        return EXIT_FAILURE;
+    }
 }
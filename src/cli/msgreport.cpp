@@ -4,7 +4,9 @@
 
 using namespace std;
 
-MsgReport::MsgReport(QCoreApplication *app) : Super(app) {}
+MsgReport::MsgReport(QCoreApplication *app, QJsonArray *collected)
+    : Super(app)
+    , collected(collected) {}
 
 void MsgReport::report_message(
     messagetype::Type type,
@@ -23,8 +25,13 @@ void MsgReport::report_message(
     default: return;
     }
 
-    printf("%s:", qPrintable(file));
-    if (line != 0) { printf("%d:", line); }
-    if (column != 0) { printf("%d:", column); }
-    printf("%s:%s\n", qPrintable(typestr), qPrintable(text));
+    QString message = file + ":";
+    if (line != 0) { message += QString::number(line) + ":"; }
+    if (column != 0) { message += QString::number(column) + ":"; }
+    message += typestr + ":" + text;
+    if (collected != nullptr) {
+        collected->append(message);
+    } else {
+        printf("%s\n", qPrintable(message));
+    }
 }
@@ -4,6 +4,7 @@
 #include "assembler/messagetype.h"
 
 #include <QCoreApplication>
+#include <QJsonArray>
 #include <QObject>
 #include <QString>
 #include <QVector>
@@ -14,16 +15,22 @@ class MsgReport : public QObject {
     using Super = QObject;
 
 public:
-    explicit MsgReport(QCoreApplication *app);
+    /**
+     * @param collected  messages are appended here instead of printing when set (batch jobs)
+     */
+    explicit MsgReport(QCoreApplication *app, QJsonArray *collected = nullptr);
 
 public slots:
-    static void report_message(
+    void report_message(
         messagetype::Type type,
         const QString &file,
         int line,
         int column,
         const QString &text,
         const QString &hint);
+
+private:
+    QJsonArray *const collected;
 };
 
 #endif // MSGREPORT_H
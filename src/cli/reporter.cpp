@@ -1,5 +1,7 @@
 #include "reporter.h"
 
+#include <QList>
+#include <QPair>
 #include <cinttypes>
 
 using namespace machine;
@@ -16,6 +18,11 @@ Reporter::Reporter(QCoreApplication *app, Machine *machine)
         &Reporter::machine_exception_reached);
 }
 
+void Reporter::run_started() {
+    run_start_instructions = machine->control_state()->read_internal(CSR::Id::MINSTRET).as_u64();
+    run_timer.start();
+}
+
 void Reporter::add_dump_range(Address start, size_t len, const QString &path_to_write) {
     dump_ranges.append({ start, len, path_to_write });
 }
@@ -23,10 +30,10 @@ void Reporter::add_dump_range(Address start, size_t len, const QString &path_to_
 void Reporter::machine_exit() {
     report();
     if (e_fail != 0) {
-        printf("Machine was expected to fail but it didn't.\n");
-        QCoreApplication::exit(1);
+        report_status("Machine was expected to fail but it didn't.");
+        finish(1);
     } else {
-        QCoreApplication::exit();
+        finish(0);
     }
 }
 
@@ -60,15 +67,21 @@ constexpr const char *get_exception_name(ExceptionCause exception_cause) {
 
 void Reporter::machine_exception_reached() {
     ExceptionCause excause = machine->get_exception_cause();
-    printf("Machine stopped on %s exception.\n", get_exception_name(excause));
+    report_status(QString("Machine stopped on %1 exception.").arg(get_exception_name(excause)));
     report();
-    QCoreApplication::exit();
+    finish(0);
 }
 
 void Reporter::cycle_limit_reached() {
-    printf("Specified cycle limit reached\n");
+    report_status("Specified cycle limit reached");
     report();
-    QCoreApplication::exit();
+    finish(0);
+}
+
+void Reporter::trace_replayed(uint64_t records) {
+    report_status(QString("Access trace of %1 records replayed").arg(records));
+    report();
+    finish(0);
 }
 
 void Reporter::machine_trap(SimulatorException &e) {
@@ -79,18 +92,31 @@ void Reporter::machine_trap(SimulatorException &e) {
         expected = e_fail & FR_UNSUPPORTED_INSTR;
     }
 
-    printf("Machine trapped: %s\n", qPrintable(e.msg(false)));
-    QCoreApplication::exit(expected ? 0 : 1);
+    report_status("Machine trapped: " + e.msg(false));
+    finish(expected ? 0 : 1);
+}
+
+void Reporter::finish(int code) {
+    exit_code = code;
+}
+
+void Reporter::report_status(const QString &message) {
+    if (dump_format & DumpFormat::JSON) { dump_data_json["status"] = message; }
+    if (dump_format & DumpFormat::CONSOLE) { printf("%s\n", qPrintable(message)); }
 }
 
 void Reporter::report() {
-    if (e_regs | e_cycles | e_cycles | e_fail) { printf("Machine state report:\n"); }
+    if ((e_regs | e_cycles | e_cycle_breakdown | e_core_counters | e_fail)
+        && (dump_format & DumpFormat::CONSOLE)) {
+        printf("Machine state report:\n");
+    }
 
     if (e_regs) { report_regs(); }
     if (e_cache_stats) { report_caches(); }
+    if (e_predictor_stats) { report_predictor(); }
     if (e_cycles) {
-        QString cycle_count = QString::asprintf("%" PRIu32, machine->core()->get_cycle_count());
-        QString stall_count = QString::asprintf("%" PRIu32, machine->core()->get_stall_count());
+        QString cycle_count = QString::asprintf("%" PRIu64, machine->core()->get_cycle_count());
+        QString stall_count = QString::asprintf("%" PRIu64, machine->core()->get_stall_count());
         if (dump_format & DumpFormat::JSON) {
             QJsonObject temp = {};
             temp["cycles"] = cycle_count;
@@ -102,11 +128,15 @@ void Reporter::report() {
             printf("stalls: %s\n", qPrintable(stall_count));
         }
     }
+    if (e_cycle_breakdown) { report_cycle_breakdown(); }
+    if (e_ips) { report_ips(); }
+    if (e_core_counters) { report_core_counters(); }
+    if (machine->get_sampling().enabled()) { report_sampling(); }
     for (const DumpRange &range : dump_ranges) {
         report_range(range);
     }
 
-    if (dump_format & DumpFormat::JSON) {
+    if ((dump_format & DumpFormat::JSON) && !dump_file_json.isEmpty()) {
         QFile file(dump_file_json);
         QByteArray bytes = QJsonDocument(dump_data_json).toJson(QJsonDocument::Indented);
         if (file.open(QIODevice::WriteOnly)) {
@@ -119,6 +149,74 @@ void Reporter::report() {
     }
 }
 
+void Reporter::report_ips() {
+    const uint64_t instructions
+        = machine->control_state()->read_internal(CSR::Id::MINSTRET).as_u64();
+    const double seconds = run_timer.isValid() ? (double)run_timer.nsecsElapsed() / 1e9 : 0.0;
+    const uint64_t executed = instructions - run_start_instructions;
+    QString instr_count = QString::asprintf("%" PRIu64, instructions);
+    QString ips = QString::asprintf("%.0f", seconds > 0 ? (double)executed / seconds : 0.0);
+    if (dump_format & DumpFormat::JSON) {
+        QJsonObject temp = {};
+        temp["instructions"] = instr_count;
+        temp["ips"] = ips;
+        dump_data_json["performance"] = temp;
+    }
+    if (dump_format & DumpFormat::CONSOLE) {
+        printf("instructions: %s\n", qPrintable(instr_count));
+        printf("ips: %s\n", qPrintable(ips));
+    }
+}
+
+void Reporter::report_cycle_breakdown() {
+    const CoreState &state = machine->core()->get_state();
+    QJsonObject breakdown = {};
+    for (size_t i = 0; i < IC_COUNT; i++) {
+        const char *class_name = INSTRUCTION_CLASS_NAMES[i];
+        QString cycles = QString::asprintf("%" PRIu64, state.class_cycles[i]);
+        QString instructions = QString::asprintf("%" PRIu64, state.class_instructions[i]);
+        if (dump_format & DumpFormat::JSON) {
+            QJsonObject temp = {};
+            temp["cycles"] = cycles;
+            temp["instructions"] = instructions;
+            breakdown[class_name] = temp;
+        }
+        if (dump_format & DumpFormat::CONSOLE) {
+            printf("cycles:%s: %s\n", class_name, qPrintable(cycles));
+            printf("instructions:%s: %s\n", class_name, qPrintable(instructions));
+        }
+    }
+    if (dump_format & DumpFormat::JSON) { dump_data_json["cycle_breakdown"] = breakdown; }
+}
+
+void Reporter::report_core_counters() {
+    const CoreState &state = machine->core()->get_state();
+    const QList<QPair<const char *, uint64_t>> counters = {
+        { "vector_add_vv", state.vector_alu.add_vv },
+        { "vector_add_vi", state.vector_alu.add_vi },
+        { "vector_mul_vv", state.vector_alu.mul_vv },
+        { "vector_reduce_sum", state.vector_alu.reduce_sum },
+        { "vector_elements", state.vector_alu.elements },
+        { "unknown_instructions", state.decode.unknown_instructions },
+    };
+    QJsonObject temp = {};
+    for (const auto &counter : counters) {
+        QString value = QString::asprintf("%" PRIu64, counter.second);
+        if (dump_format & DumpFormat::JSON) { temp[counter.first] = value; }
+        if (dump_format & DumpFormat::CONSOLE) {
+            printf("%s: %s\n", counter.first, qPrintable(value));
+        }
+    }
+    if (state.decode.unknown_instructions > 0) {
+        QString code = QString::asprintf("0x%08" PRIx32, state.decode.last_unknown_code);
+        if (dump_format & DumpFormat::JSON) { temp["last_unknown_code"] = code; }
+        if (dump_format & DumpFormat::CONSOLE) {
+            printf("last_unknown_code: %s\n", qPrintable(code));
+        }
+    }
+    if (dump_format & DumpFormat::JSON) { dump_data_json["core_counters"] = temp; }
+}
+
 void Reporter::report_regs() {
     if (dump_format & DumpFormat::JSON) { dump_data_json["regs"] = {}; }
     report_pc();
@@ -169,7 +267,7 @@ void Reporter::report_csr_reg(size_t internal_id, bool last) {
 
 void Reporter::report_caches() {
     if (dump_format & DumpFormat::JSON) { dump_data_json["caches"] = {}; }
-    printf("Cache statistics report:\n");
+    if (dump_format & DumpFormat::CONSOLE) { printf("Cache statistics report:\n"); }
     report_cache("i-cache", *machine->cache_program());
     report_cache("d-cache", *machine->cache_data());
     if (machine->config().cache_level2().enabled()) {
@@ -200,6 +298,64 @@ void Reporter::report_cache(const char *cache_name, const Cache &cache) {
     }
 }
 
+void Reporter::report_predictor() {
+    const machine::BranchPredictor *predictor = machine->core()->get_predictor();
+    if (!predictor->get_enabled()) { return; }
+    const machine::PredictionStatistics &stats = predictor->get_total_stats();
+    if (dump_format & DumpFormat::JSON) {
+        QJsonObject temp = {};
+        temp["type"] = predictor->get_predictor_name().toString();
+        temp["total"] = QString::asprintf("%" PRIu64, stats.total);
+        temp["correct"] = QString::asprintf("%" PRIu64, stats.correct);
+        temp["wrong"] = QString::asprintf("%" PRIu64, stats.wrong);
+        temp["accuracy"] = QString::asprintf("%.3lf", stats.get_accuracy());
+        dump_data_json["predictor"] = temp;
+    }
+    if (dump_format & DumpFormat::CONSOLE) {
+        printf("predictor:type: %s\n", qPrintable(predictor->get_predictor_name().toString()));
+        printf("predictor:total: %" PRIu64 "\n", stats.total);
+        printf("predictor:correct: %" PRIu64 "\n", stats.correct);
+        printf("predictor:wrong: %" PRIu64 "\n", stats.wrong);
+        printf("predictor:accuracy: %.3lf\n", stats.get_accuracy());
+    }
+}
+
+void Reporter::report_sampling() {
+    const SamplingStatistics &stats = machine->sampling_statistics();
+    const uint64_t instructions
+        = machine->control_state()->read_internal(CSR::Id::MINSTRET).as_u64();
+    const SampleEstimate cpi = stats.cycles_per_instruction();
+    const SampleEstimate cycles = stats.extrapolate_cycles(instructions);
+    const SampleEstimate data_miss_rate = stats.data_miss_rate();
+    const SampleEstimate program_miss_rate = stats.program_miss_rate();
+    // Confidence intervals are given as half widths of the 95% interval.
+    const QList<QPair<QString, QString>> values = {
+        { "windows", QString::number(stats.window_count()) },
+        { "measured-instructions", QString::number(stats.measured().instructions) },
+        { "instructions", QString::number(instructions) },
+        { "cpi", QString::asprintf("%.4f", cpi.mean) },
+        { "cpi-ci95", QString::asprintf("%.4f", cpi.confidence) },
+        { "cycles", QString::asprintf("%.0f", cycles.mean) },
+        { "cycles-ci95", QString::asprintf("%.0f", cycles.confidence) },
+        { "d-cache-miss-rate", QString::asprintf("%.4f", data_miss_rate.mean) },
+        { "d-cache-miss-rate-ci95", QString::asprintf("%.4f", data_miss_rate.confidence) },
+        { "i-cache-miss-rate", QString::asprintf("%.4f", program_miss_rate.mean) },
+        { "i-cache-miss-rate-ci95", QString::asprintf("%.4f", program_miss_rate.confidence) },
+    };
+    if (dump_format & DumpFormat::JSON) {
+        QJsonObject temp = {};
+        for (const auto &value : values) {
+            temp[value.first] = value.second;
+        }
+        dump_data_json["sampling"] = temp;
+    }
+    if (dump_format & DumpFormat::CONSOLE) {
+        for (const auto &value : values) {
+            printf("sampling:%s: %s\n", qPrintable(value.first), qPrintable(value.second));
+        }
+    }
+}
+
 void Reporter::report_range(const Reporter::DumpRange &range) {
     FILE *out = fopen(range.path_to_write.toLocal8Bit().data(), "w");
     if (out == nullptr) {
@@ -5,6 +5,7 @@
 #include "machine/machine.h"
 
 #include <QCoreApplication>
+#include <QElapsedTimer>
 #include <QFile>
 #include <QJsonDocument>
 #include <QJsonObject>
@@ -30,7 +31,11 @@ public:
 
     void enable_regs_reporting() { e_regs = true; };
     void enable_cache_stats() { e_cache_stats = true; };
+    void enable_predictor_stats() { e_predictor_stats = true; };
     void enable_cycles_reporting() { e_cycles = true; };
+    void enable_cycle_breakdown_reporting() { e_cycle_breakdown = true; };
+    void enable_ips_reporting() { e_ips = true; };
+    void enable_core_counters_reporting() { e_core_counters = true; };
 
     enum FailReason {
         FR_NONE = 0,
@@ -47,6 +52,18 @@ public:
     };
     void add_dump_range(Address start, size_t len, const QString &path_to_write);
 
+    /**
+     * Starts the measurement of the instructions per second report. Called once the machine is
+     * set up (program assembled, checkpoint and ranges loaded), just before it runs.
+     */
+    void run_started();
+
+    /** Process exit code determined by the last reported event. */
+    int get_exit_code() const { return exit_code; }
+
+    /** Reports the end of access trace replay (see `Machine::replay_access_trace`). */
+    void trace_replayed(uint64_t records);
+
 public slots:
     void cycle_limit_reached();
 
@@ -59,23 +76,45 @@ private:
     BORROWED QCoreApplication *const app;
     BORROWED machine::Machine *const machine;
     QVector<DumpRange> dump_ranges;
+    /** Measures host time of the simulation for instructions per second report. */
+    QElapsedTimer run_timer;
+    /** Retired instructions (`MINSTRET`) when the run started, e.g. restored from checkpoint. */
+    uint64_t run_start_instructions = 0;
 
     bool e_regs = false;
     bool e_cache_stats = false;
+    bool e_predictor_stats = false;
     bool e_cycles = false;
+    bool e_cycle_breakdown = false;
+    bool e_ips = false;
+    bool e_core_counters = false;
     FailReason e_fail = FR_NONE;
+    int exit_code = 0;
+
+    void finish(int code);
+    /** Reports the reason of the end of the simulation. */
+    void report_status(const QString &message);
 
     void report();
     void report_pc();
     void report_regs();
     void report_caches();
+    void report_ips();
+    /** Cycles and decoded instructions of each instruction class (see `CoreState`). */
+    void report_cycle_breakdown();
+    /** Diagnostic counters of the vector ALU and of decoding (see `CoreState`). */
+    void report_core_counters();
     void report_range(const DumpRange &range);
     void report_csr_reg(size_t internal_id, bool last);
     void report_gp_reg(unsigned int i, bool last);
     void report_cache(const char *cache_name, const machine::Cache &cache);
+    void report_predictor();
+    /** Extrapolated results of sampled simulation (see `Machine::set_sampling`). */
+    void report_sampling();
 
 public:
     DumpFormat dump_format = DumpFormat::CONSOLE;
+    /** File the JSON report is written to, report is only kept in `dump_data_json` if empty. */
     QString dump_file_json;
     QJsonObject dump_data_json = {};
 };
@@ -5,11 +5,14 @@
 using namespace machine;
 
 Tracer::Tracer(Machine *machine) : core_state(machine->core()->get_state()) {
-    cycle_limit = 0;
-
     connect(machine->core(), &Core::step_done, this, &Tracer::step_output);
 }
 
+bool Tracer::is_enabled() const {
+    return trace_fetch || trace_decode || trace_execute || trace_memory || trace_writeback
+           || trace_pc || trace_wrmem || trace_rdmem || trace_regs_gp;
+}
+
 template<typename StageStruct>
 void trace_instruction_in_stage(
     const char *stage_name,
@@ -47,7 +50,4 @@ void Tracer::step_output() {
         printf("MEM[%" PRIx64 "]:  WR %" PRIx64 "\n", mem_wb.mem_addr.get_raw(),
                mem.mem_write_val.i.as_u64());
     }
-    if ((cycle_limit != 0) && (core_state.cycle_count >= cycle_limit)) {
-        emit cycle_limit_reached();
-    }
 }
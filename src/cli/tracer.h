@@ -16,8 +16,8 @@ class Tracer final : public QObject {
 public:
     explicit Tracer(machine::Machine *machine);
 
-signals:
-    void cycle_limit_reached();
+    /** Tracer needs per step signals of the core when any trace is requested. */
+    bool is_enabled() const;
 
 private slots:
     void step_output();
@@ -30,7 +30,6 @@ public:
     bool trace_fetch = false, trace_decode = false, trace_execute = false, trace_memory = false,
          trace_writeback = false, trace_pc = false, trace_wrmem = false,  trace_rdmem = false,
          trace_regs_gp = false;
-    quint64 cycle_limit;
 };
 
 #endif // TRACER_H
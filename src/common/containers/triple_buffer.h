@@ -0,0 +1,51 @@
+#ifndef TRIPLE_BUFFER_H
+#define TRIPLE_BUFFER_H
+
+#include <array>
+#include <atomic>
+
+/**
+ * Lock-free exchange of the latest value between a single producer and a single consumer thread.
+ *
+ * Producer fills its private back buffer and publishes it by an atomic exchange with the middle
+ * buffer. Consumer takes the middle buffer when a fresh value has been published since its last
+ * `update`. Neither side ever waits for the other one, values published faster than consumed are
+ * skipped and the consumer never observes a partially written value.
+ */
+template<typename T>
+class TripleBuffer {
+public:
+    /** Producer side: buffer to be filled (it contains an older value). */
+    T &back() { return buffers[back_index]; }
+    /** Producer side: makes the back buffer the latest value. */
+    void publish() {
+        const unsigned previous
+            = middle.exchange(back_index | FRESH_FLAG, std::memory_order_acq_rel);
+        back_index = previous & INDEX_MASK;
+    }
+
+    /**
+     * Consumer side: takes the latest published value.
+     *
+     * @return  false when nothing was published since the last call (`front` is unchanged)
+     */
+    bool update() {
+        if ((middle.load(std::memory_order_relaxed) & FRESH_FLAG) == 0) { return false; }
+        const unsigned previous = middle.exchange(front_index, std::memory_order_acq_rel);
+        front_index = previous & INDEX_MASK;
+        return true;
+    }
+    /** Consumer side: value taken by the last `update`. */
+    const T &front() const { return buffers[front_index]; }
+
+private:
+    static constexpr unsigned INDEX_MASK = 0x3;
+    static constexpr unsigned FRESH_FLAG = 0x4;
+
+    std::array<T, 3> buffers {};
+    unsigned back_index = 0;
+    std::atomic<unsigned> middle { 1 };
+    unsigned front_index = 2;
+};
+
+#endif // TRIPLE_BUFFER_H
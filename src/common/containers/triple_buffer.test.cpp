@@ -0,0 +1,75 @@
+#include "triple_buffer.h"
+
+#include "triple_buffer.test.h"
+
+#include <QThread>
+
+void TestTripleBuffer::test_triple_buffer_latest_value() {
+    TripleBuffer<int> buffer;
+    QVERIFY(!buffer.update());
+
+    buffer.back() = 1;
+    buffer.publish();
+    buffer.back() = 2;
+    buffer.publish();
+    QVERIFY(buffer.update());
+    QCOMPARE(buffer.front(), 2);
+    QVERIFY(!buffer.update());
+    QCOMPARE(buffer.front(), 2);
+
+    buffer.back() = 3;
+    buffer.publish();
+    QVERIFY(buffer.update());
+    QCOMPARE(buffer.front(), 3);
+}
+
+namespace {
+/** Value consistent only when all items are equal, torn reads are detected. */
+struct Sample {
+    std::array<uint64_t, 64> items {};
+};
+
+class Producer : public QThread {
+public:
+    explicit Producer(TripleBuffer<Sample> &buffer) : buffer(buffer) {}
+
+protected:
+    void run() override {
+        for (uint64_t value = 1; value <= COUNT; value++) {
+            buffer.back().items.fill(value);
+            buffer.publish();
+        }
+    }
+
+public:
+    static constexpr uint64_t COUNT = 200000;
+
+private:
+    TripleBuffer<Sample> &buffer;
+};
+} // namespace
+
+void TestTripleBuffer::test_triple_buffer_concurrent() {
+    TripleBuffer<Sample> buffer;
+    Producer producer(buffer);
+    producer.start();
+
+    uint64_t last = 0;
+    bool finished = false;
+    while (!finished) {
+        finished = producer.isFinished();
+        if (!buffer.update()) { continue; }
+        const Sample &sample = buffer.front();
+        for (uint64_t item : sample.items) {
+            QCOMPARE(item, sample.items[0]);
+        }
+        // Values are never observed out of order.
+        QVERIFY(sample.items[0] > last);
+        last = sample.items[0];
+    }
+    producer.wait();
+    if (buffer.update()) { last = buffer.front().items[0]; }
+    QCOMPARE(last, Producer::COUNT);
+}
+
+QTEST_APPLESS_MAIN(TestTripleBuffer)
@@ -0,0 +1,13 @@
+#ifndef TRIPLE_BUFFER_TEST_H
+#define TRIPLE_BUFFER_TEST_H
+
+#include <QtTest/QTest>
+
+class TestTripleBuffer : public QObject {
+    Q_OBJECT
+private slots:
+    static void test_triple_buffer_latest_value();
+    static void test_triple_buffer_concurrent();
+};
+
+#endif // TRIPLE_BUFFER_TEST_H
@@ -33,4 +33,23 @@
 #define WARN(...) qCWarning(_loging_category_, __VA_ARGS__)
 #define ERROR(...) qCCritical(_loging_category_, __VA_ARGS__)
 
+/**
+ * Tracing of hot paths (instruction decode, ALU).
+ *
+ * Trace category is separate from the file category and its debug level is disabled by default,
+ * so it has to be enabled by logging rules, e.g.
+ * `QT_LOGGING_RULES="machine.execute.alu.trace.debug=true"`. Tracing is compiled out together
+ * with other debug output (`QT_NO_DEBUG_OUTPUT`, i.e. release builds). Use `TRACE_ENABLED()` to
+ * guard expensive formatting of the message.
+ */
+#define TRACE_CATEGORY(NAME) static QLoggingCategory _trace_category_(NAME, QtInfoMsg)
+
+#if defined(QT_NO_DEBUG_OUTPUT)
+    #define TRACE QT_NO_QDEBUG_MACRO
+    #define TRACE_ENABLED() false
+#else
+    #define TRACE(...) qCDebug(_trace_category_, __VA_ARGS__)
+    #define TRACE_ENABLED() _trace_category_.isDebugEnabled()
+#endif
+
 #endif
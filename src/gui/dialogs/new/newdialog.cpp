@@ -421,9 +421,11 @@ void NewDialog::bp_toggle_widgets() {
     const bool is_predictor_dynamic { machine::is_predictor_type_dynamic(predictor_type) };
     const bool is_predictor_enabled { config->get_bp_enabled() };
 
+    const bool has_initial_state { machine::predictor_type_has_initial_state(predictor_type) };
+
     ui->group_bp_bht->setEnabled(is_predictor_enabled && is_predictor_dynamic);
-    ui->text_bp_init_state->setEnabled(is_predictor_enabled && is_predictor_dynamic);
-    ui->select_bp_init_state->setEnabled(is_predictor_enabled && is_predictor_dynamic);
+    ui->text_bp_init_state->setEnabled(is_predictor_enabled && has_initial_state);
+    ui->select_bp_init_state->setEnabled(is_predictor_enabled && has_initial_state);
 }
 
 void NewDialog::bp_type_change() {
@@ -463,7 +465,10 @@ void NewDialog::bp_type_change() {
     } break;
 
     case machine::PredictorType::SMITH_2_BIT:
-    case machine::PredictorType::SMITH_2_BIT_HYSTERESIS: {
+    case machine::PredictorType::SMITH_2_BIT_HYSTERESIS:
+    case machine::PredictorType::GSHARE:
+    case machine::PredictorType::TOURNAMENT:
+    case machine::PredictorType::TAGE_LITE: {
         // Add items to the combo box
         ui->select_bp_init_state->addItem(
             predictor_state_to_string(machine::PredictorState::STRONGLY_NOT_TAKEN, false).toString(),
@@ -493,6 +498,8 @@ void NewDialog::bp_type_change() {
     default:
         break;
     }
+    // Table size depends on the predictor type
+    bp_bht_bits_texts_update();
     bp_toggle_widgets();
 
     if (need_switch2custom)
@@ -584,6 +591,18 @@ void NewDialog::config_gui() {
     ui->select_bp_type->addItem(
         predictor_type_to_string(machine::PredictorType::SMITH_2_BIT_HYSTERESIS).toString(),
         QVariant::fromValue(machine::PredictorType::SMITH_2_BIT_HYSTERESIS));
+    ui->select_bp_type->addItem(
+        predictor_type_to_string(machine::PredictorType::GSHARE).toString(),
+        QVariant::fromValue(machine::PredictorType::GSHARE));
+    ui->select_bp_type->addItem(
+        predictor_type_to_string(machine::PredictorType::TOURNAMENT).toString(),
+        QVariant::fromValue(machine::PredictorType::TOURNAMENT));
+    ui->select_bp_type->addItem(
+        predictor_type_to_string(machine::PredictorType::TAGE_LITE).toString(),
+        QVariant::fromValue(machine::PredictorType::TAGE_LITE));
+    ui->select_bp_type->addItem(
+        predictor_type_to_string(machine::PredictorType::PERCEPTRON).toString(),
+        QVariant::fromValue(machine::PredictorType::PERCEPTRON));
     const int index { ui->select_bp_type->findData(QVariant::fromValue(config->get_bp_type())) };
     if (index >= 0) {
         ui->select_bp_type->setCurrentIndex(index);
@@ -25,6 +25,9 @@
 
 LOG_CATEGORY("gui.mainwindow");
 
+// Period of refreshing views from state published by a background run (in msec).
+constexpr int STATE_POLL_PERIOD = 16;
+
 #ifdef __EMSCRIPTEN__
     #include "qhtml5file.h"
 
@@ -142,8 +145,16 @@ MainWindow::MainWindow(QSettings *settings, QWidget *parent)
     speed_group->addAction(ui->ipsMax);
     ui->ips1->setChecked(true);
 
+    // Background runs are not available in browser, it may lack threads support.
+    ui->actionRunInBackground->setVisible(!WEB_ASSEMBLY);
+    state_poll_timer = new QTimer(this);
+    state_poll_timer->setInterval(STATE_POLL_PERIOD);
+    connect(state_poll_timer, &QTimer::timeout, this, &MainWindow::poll_machine_state);
+
     // Connect signals from menu
     connect(ui->actionExit, &QAction::triggered, this, &QWidget::close);
+    connect(ui->actionRun, &QAction::triggered, this, &MainWindow::machine_run);
+    connect(ui->actionRestart, &QAction::triggered, this, &MainWindow::machine_restart);
     connect(ui->actionNewMachine, &QAction::triggered, this, &MainWindow::new_machine);
     connect(ui->actionReload, &QAction::triggered, this, [this] { machine_reload(false, false); });
     connect(ui->actionPrint, &QAction::triggered, this, &MainWindow::print_action);
@@ -188,6 +199,8 @@ MainWindow::MainWindow(QSettings *settings, QWidget *parent)
     connect(ui->ips25, &QAction::toggled, this, &MainWindow::set_speed);
     connect(ui->ipsUnlimited, &QAction::toggled, this, &MainWindow::set_speed);
     connect(ui->ipsMax, &QAction::toggled, this, &MainWindow::set_speed);
+    connect(
+        ui->actionRunInBackground, &QAction::toggled, this, &MainWindow::set_run_in_background);
 
     connect(this, &MainWindow::report_message, messages, &MessagesDock::insert_line);
     connect(this, &MainWindow::clear_messages, messages, &MessagesDock::clear_messages);
@@ -199,6 +212,9 @@ MainWindow::MainWindow(QSettings *settings, QWidget *parent)
     if (settings->value("viewMnemonicRegisters").toBool()) {
         ui->actionMnemonicRegisters->trigger();
     }
+    if (!WEB_ASSEMBLY && settings->value("runInBackgroundThread").toBool()) {
+        ui->actionRunInBackground->setChecked(true);
+    }
 
     for (const QString &file_name : settings->value("openSrcFiles").toStringList()) {
         editor_tabs->open_file(file_name);
@@ -213,6 +229,8 @@ MainWindow::MainWindow(QSettings *settings, QWidget *parent)
 }
 
 MainWindow::~MainWindow() {
+    // The run has to end while the views are still alive.
+    machine_worker.reset();
     settings->sync();
 }
 
@@ -268,6 +286,9 @@ void MainWindow::create_core(
     const machine::MachineConfig &config,
     bool load_executable,
     bool keep_memory) {
+    // Old machine cannot be accessed before its background run ends.
+    if (machine_worker != nullptr) { machine_worker->stop(); }
+
     // Create machine
     auto *new_machine = new machine::Machine(config, true, load_executable);
 
@@ -276,7 +297,13 @@ void MainWindow::create_core(
     }
 
     // Remove old machine
+    machine_worker.reset();
     machine.reset(new_machine);
+    machine_worker.reset(new machine::MachineWorker(new_machine));
+    machine_worker->set_publish_period(STATE_POLL_PERIOD);
+    connect(
+        machine_worker.data(), &machine::MachineWorker::finished, this,
+        &MainWindow::machine_worker_finished);
 
     // Create machine view
     auto focused_index = central_widget_tabs->currentIndex();
@@ -292,11 +319,14 @@ void MainWindow::create_core(
     if (config.osemu_enable()) {
         auto *osemu_handler = new osemu::OsSyscallExceptionHandler(
             config.osemu_known_syscall_stop(), config.osemu_unknown_syscall_stop(),
-            config.osemu_fs_root());
+            config.osemu_fs_root(), new_machine->config().get_simulated_xlen());
         osemu_handler->setParent(new_machine);
+        // Interactive runs do not freeze on blocking host I/O, background runs are headless and
+        // complete it synchronously.
+        osemu_handler->set_async_host_io(true);
         connect(
-            osemu_handler, &osemu::OsSyscallExceptionHandler::char_written, terminal.data(),
-            QOverload<int, unsigned int>::of(&TerminalDock::tx_byte));
+            osemu_handler, &osemu::OsSyscallExceptionHandler::data_written, terminal.data(),
+            &TerminalDock::tx_data);
         connect(
             osemu_handler, &osemu::OsSyscallExceptionHandler::rx_byte_pool, terminal.data(),
             &TerminalDock::rx_byte_pool);
@@ -313,10 +343,10 @@ void MainWindow::create_core(
     }
 
     // Connect machine signals and slots
-    connect(ui->actionRun, &QAction::triggered, machine.data(), &machine::Machine::play);
+    // Pause also ends a background run, run and restart are handled by `machine_run` and
+    // `machine_restart`.
     connect(ui->actionPause, &QAction::triggered, machine.data(), &machine::Machine::pause);
     connect(ui->actionStep, &QAction::triggered, machine.data(), &machine::Machine::step);
-    connect(ui->actionRestart, &QAction::triggered, machine.data(), &machine::Machine::restart);
     connect(machine.data(), &machine::Machine::status_change, this, &MainWindow::machine_status);
     connect(machine.data(), &machine::Machine::program_exit, this, &MainWindow::machine_exit);
     connect(machine.data(), &machine::Machine::program_trap, this, &MainWindow::machine_trap);
@@ -522,6 +552,49 @@ void MainWindow::set_speed() {
     }
 }
 
+void MainWindow::set_run_in_background(bool enable) {
+    settings->setValue("runInBackgroundThread", enable);
+}
+
+void MainWindow::machine_run() {
+    if (machine == nullptr) { return; }
+    if (ui->actionRunInBackground->isChecked() && machine_worker->start()) {
+        // Machine stays busy until the worker finishes, the controls show it running.
+        machine_status(machine::Machine::ST_RUNNING);
+        state_poll_timer->start();
+        return;
+    }
+    machine->play();
+}
+
+void MainWindow::machine_restart() {
+    if (machine == nullptr) { return; }
+    machine_worker->stop();
+    machine->restart();
+}
+
+void MainWindow::machine_worker_finished() {
+    state_poll_timer->stop();
+    // Final state is always published by the worker.
+    poll_machine_state();
+}
+
+void MainWindow::poll_machine_state() {
+    if (machine_worker == nullptr || !machine_worker->poll()) { return; }
+    show_published_state(machine_worker->state());
+}
+
+void MainWindow::show_published_state(const machine::PublishedState &state) {
+    registers->show_state(state.registers);
+    csrdock->show_state(state.control_state);
+    program->update_pipeline_addrs(state.core_state);
+    if (corescene != nullptr) { corescene->show_state(state.core_state); }
+    cache_program->show_statistics(state.cache_program);
+    cache_data->show_statistics(state.cache_data);
+    cache_level2->show_statistics(state.cache_level2);
+    bp_info->update_stats(state.predictor_stats);
+}
+
 void MainWindow::view_mnemonics_registers(bool enable) {
     machine::Instruction::set_symbolic_registers(enable);
     settings->setValue("viewMnemonicRegisters", enable);
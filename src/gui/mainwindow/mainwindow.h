@@ -9,6 +9,7 @@
 #include "dialogs/new/newdialog.h"
 #include "extprocess.h"
 #include "machine/machine.h"
+#include "machine/machine_worker.h"
 #include "machine/machineconfig.h"
 #include "scene.h"
 #include "ui_MainWindow.h"
@@ -33,6 +34,7 @@
 #include <QPointer>
 #include <QSettings>
 #include <QTabWidget>
+#include <QTimer>
 
 class MainWindow : public QMainWindow {
     Q_OBJECT
@@ -109,8 +111,14 @@ public slots:
     void about_qt();
     // Actions - execution speed
     void set_speed();
+    void set_run_in_background(bool enable);
+    // Machine control
+    void machine_run();
+    void machine_restart();
     // Machine signals
     void machine_status(enum machine::Machine::Status st);
+    void machine_worker_finished();
+    void poll_machine_state();
     void machine_exit();
     void machine_trap(machine::SimulatorException &e);
     void view_mnemonics_registers(bool enable);
@@ -157,12 +165,15 @@ private:
     QSharedPointer<QSettings> settings;
 
     Box<machine::Machine> machine; // Current simulated machine
+    Box<machine::MachineWorker> machine_worker; // Background runs of the current machine
+    QTimer *state_poll_timer {};
 
     void show_dockwidget(
         QDockWidget *w,
         Qt::DockWidgetArea area = Qt::RightDockWidgetArea,
         bool defaultVisible = false,
         bool resetState = false);
+    void show_published_state(const machine::PublishedState &state);
     QPointer<ExtProcess> build_process;
     bool ignore_unsaved = false;
 
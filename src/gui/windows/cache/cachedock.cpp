@@ -71,6 +71,14 @@ void CacheDock::setup(const machine::Cache *cache, bool cache_after_cache) {
     graphicsview->setVisible(cache != nullptr && cache->get_config().enabled());
 }
 
+void CacheDock::show_statistics(const machine::PublishedCacheState &state) {
+    hit_update(state.stats.hit_read + state.stats.hit_write);
+    miss_update(state.stats.miss_read + state.stats.miss_write);
+    memory_reads_update(state.stats.mem_reads);
+    memory_writes_update(state.stats.mem_writes);
+    statistics_update(state.stall_count, state.speed_improvement, state.hit_rate);
+}
+
 void CacheDock::hit_update(unsigned val) {
     l_hit->setText(QString::number(val));
 }
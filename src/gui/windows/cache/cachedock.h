@@ -4,6 +4,7 @@
 #include "cacheview.h"
 #include "graphicsview.h"
 #include "machine/machine.h"
+#include "machine/machine_worker.h"
 
 #include <QDockWidget>
 #include <QFormLayout>
@@ -15,6 +16,8 @@ public:
     CacheDock(QWidget *parent, const QString &type);
 
     void setup(const machine::Cache *cache, bool cache_after_cache = false);
+    /** Shows statistics published by a worker thread, the cache lines are not updated. */
+    void show_statistics(const machine::PublishedCacheState &state);
 
 private slots:
     void hit_update(unsigned);
@@ -147,9 +147,7 @@ CacheViewBlock::CacheViewBlock(const machine::Cache *cache, unsigned block, bool
     rows = cache->get_config().set_count();
     columns = cache->get_config().block_size();
     curr_row = 0;
-    last_set = 0;
-    last_col = 0;
-    last_highlighted = false;
+    batch_published = false;
 
     QFont font;
     font.setPixelSize(FontSize::SIZE7);
@@ -215,6 +213,9 @@ CacheViewBlock::CacheViewBlock(const machine::Cache *cache, unsigned block, bool
     l_data->setPos(wd + (columns * DATA_WIDTH - box.width()) / 2, -1 - box.height());
 
     connect(cache, &machine::Cache::cache_update, this, &CacheViewBlock::cache_update);
+    connect(
+        cache, &machine::Cache::cache_updates_published, this,
+        &CacheViewBlock::cache_updates_published);
 }
 
 CacheViewBlock::~CacheViewBlock() {
@@ -344,10 +345,15 @@ void CacheViewBlock::cache_update(
     uint32_t tag,
     const uint32_t *data,
     bool write) {
-    (void)col;
+    if (batch_published) {
+        // Updates of a batch are accumulated, highlights of the previous one are cleared.
+        for (const auto &cell : highlighted) {
+            this->data[cell.first][cell.second]->setBrush(QBrush(QColor(0, 0, 0)));
+        }
+        highlighted.clear();
+        batch_published = false;
+    }
     if (associat != block) {
-        if (last_highlighted) { this->data[last_set][last_col]->setBrush(QBrush(QColor(0, 0, 0))); }
-        last_highlighted = false;
         return; // Ignore blocks that are not used
     }
     validity[set]->setText(valid ? "1" : "0");
@@ -364,20 +370,20 @@ void CacheViewBlock::cache_update(
         //  TODO Use cache API
     }
 
-    if (last_highlighted) { this->data[last_set][last_col]->setBrush(QBrush(QColor(0, 0, 0))); }
-    if (write) {
-        this->data[set][col]->setBrush(QBrush(QColor(240, 0, 0)));
-    } else {
-        this->data[set][col]->setBrush(QBrush(QColor(0, 0, 240)));
+    if (valid) { // Invalidated line has no data to highlight
+        this->data[set][col]->setBrush(
+            write ? QBrush(QColor(240, 0, 0)) : QBrush(QColor(0, 0, 240)));
+        highlighted.append({ set, col });
     }
-    last_highlighted = true;
 
     curr_row = set;
-    last_set = set;
-    last_col = col;
     update();
 }
 
+void CacheViewBlock::cache_updates_published() {
+    batch_published = true;
+}
+
 CacheViewScene::CacheViewScene(const machine::Cache *cache) {
     associativity = cache->get_config().associativity();
     block = new CacheViewBlock *[associativity];
@@ -8,6 +8,8 @@
 #include <QGraphicsObject>
 #include <QGraphicsScene>
 #include <QGraphicsView>
+#include <QPair>
+#include <QVector>
 
 class CacheAddressBlock : public QGraphicsObject {
     Q_OBJECT
@@ -62,6 +64,7 @@ private slots:
         uint32_t tag,
         const uint32_t *data,
         bool write);
+    void cache_updates_published();
 
 private:
     const Endian simulated_machine_endian;
@@ -70,9 +73,12 @@ private:
     unsigned rows, columns;
     QGraphicsSimpleTextItem **validity, **dirty, **tag, ***data;
     unsigned curr_row;
-    bool last_highlighted;
-    unsigned last_set;
-    unsigned last_col;
+    /**
+     * Cells (set, column) accessed in the last published batch of updates, they stay
+     * highlighted until the next batch starts.
+     */
+    QVector<QPair<unsigned, unsigned>> highlighted;
+    bool batch_published;
 };
 
 class CacheViewScene : public QGraphicsScene {
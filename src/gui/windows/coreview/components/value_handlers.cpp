@@ -9,6 +9,7 @@ const QString PCValue::COMPONENT_NAME = QStringLiteral("pc-value");
 const QString RegValue::COMPONENT_NAME = QStringLiteral("reg-value");
 const QString RegIdValue::COMPONENT_NAME = QStringLiteral("reg-id-value");
 const QString DebugValue::COMPONENT_NAME = QStringLiteral("debug-value");
+const QString &CounterValue::COMPONENT_NAME = DebugValue::COMPONENT_NAME;
 const QString MultiTextValue::COMPONENT_NAME = QStringLiteral("multi-text-value");
 const QString InstructionValue::COMPONENT_NAME = QStringLiteral("instruction-value");
 
@@ -43,7 +44,10 @@ RegValue::RegValue(SimpleTextItem *element, const machine::RegisterValueUnion &d
     , data(data) {}
 
 void RegValue::update() {
-    element->setText(QString("%1").arg(data.i.as_u32(), 8, 16, QChar('0')));
+    // Vector values show their first element.
+    const uint32_t value
+        = (data.type == machine::REGISTER_VALUE_TYPE_V) ? data.v[0] : data.i.as_u32();
+    element->setText(QString("%1").arg(value, 8, 16, QChar('0')));
 }
 
 RegIdValue::RegIdValue(svgscene::SimpleTextItem *element, const machine::RegisterId &data)
@@ -61,6 +65,15 @@ DebugValue::DebugValue(SimpleTextItem *element, const unsigned int &data)
 void DebugValue::update() {
     element->setText(QString("%1").arg(data, 0, 10, QChar(' ')));
 }
+
+CounterValue::CounterValue(SimpleTextItem *element, const uint64_t &data)
+    : element(element)
+    , data(data) {}
+
+void CounterValue::update() {
+    element->setText(QString::number(data));
+}
+
 MultiTextValue::MultiTextValue(SimpleTextItem *const element, Data data)
     : element(element)
     , current_text_index(data.first)
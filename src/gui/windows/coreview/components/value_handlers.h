@@ -85,6 +85,18 @@ private:
     const unsigned &data;
 };
 
+/** Debug value of a 64-bit counter (e.g. cycle count), shares the component with `DebugValue`. */
+class CounterValue {
+public:
+    CounterValue(svgscene::SimpleTextItem *element, const uint64_t &data);
+    void update();
+    static const QString &COMPONENT_NAME;
+
+private:
+    BORROWED svgscene::SimpleTextItem *const element;
+    const uint64_t &data;
+};
+
 class MultiTextValue {
     using Source = const std::unordered_map<unsigned, QString> &;
     using Data = std::pair<const unsigned int &, Source>;
@@ -159,9 +159,11 @@ const struct {
         { QStringLiteral("rs1"), LENS(CoreState, pipeline.decode.result.num_rs) },
         { QStringLiteral("rs2"), LENS(CoreState, pipeline.decode.result.num_rt) },
     };
-    const unordered_map<QStringView, Lens<CoreState, unsigned>> DEBUG_VAL {
+    const unordered_map<QStringView, Lens<CoreState, uint64_t>> COUNTER {
         { QStringLiteral("CycleCount"), LENS(CoreState, cycle_count) },
         { QStringLiteral("StallCount"), LENS(CoreState, stall_count) },
+    };
+    const unordered_map<QStringView, Lens<CoreState, unsigned>> DEBUG_VAL {
         { QStringLiteral("decode-AluControl"),
           LENS(CoreState, pipeline.decode.internal.alu_op_num) },
         { QStringLiteral("exec-AluControl"),
@@ -21,8 +21,9 @@ LOG_CATEGORY("gui.coreview");
 
 CoreViewScene::CoreViewScene(machine::Machine *machine, const QString &core_svg_scheme_name)
     : SvgGraphicsScene()
-    , program_counter_value((VALUE_SOURCE_NAME_MAPS.PC.at(QStringLiteral("fetch-pc")))(
-          machine->core()->get_state())) {
+    , shown_state(machine->core()->get_state())
+    , program_counter_value(
+          (VALUE_SOURCE_NAME_MAPS.PC.at(QStringLiteral("fetch-pc")))(shown_state)) {
     SvgDocument document
         = svgscene::parseFromFileName(this, QString(":/core/%1.svg").arg(core_svg_scheme_name));
 
@@ -36,7 +37,7 @@ CoreViewScene::CoreViewScene(machine::Machine *machine, const QString &core_svg_
      *      - colored frames on special values
      */
 
-    const machine::CoreState &core_state = machine->core()->get_state();
+    const machine::CoreState &core_state = shown_state;
 
     // Find all components in the DOM tree and install controllers for them.
     for (auto component : document.getRoot().findAll("data-component")) {
@@ -56,8 +57,16 @@ CoreViewScene::CoreViewScene(machine::Machine *machine, const QString &core_svg_
         }
         case 'd': {
             if (component_name == DebugValue::COMPONENT_NAME) {
-                install_value(
-                    values.debug_values, VALUE_SOURCE_NAME_MAPS.DEBUG_VAL, component, core_state);
+                // Counters are 64-bit wide, other debug values are narrow indexes.
+                if (VALUE_SOURCE_NAME_MAPS.COUNTER.count(component.getAttrValueOr("data-source"))) {
+                    install_value(
+                        values.counter_values, VALUE_SOURCE_NAME_MAPS.COUNTER, component,
+                        core_state);
+                } else {
+                    install_value(
+                        values.debug_values, VALUE_SOURCE_NAME_MAPS.DEBUG_VAL, component,
+                        core_state);
+                }
             } else if (component_name == QStringLiteral("data-cache")) {
                 if (machine->config().cache_data().enabled()) {
                     auto texts = component.findAll<SimpleTextItem>();
@@ -174,7 +183,7 @@ CoreViewScene::CoreViewScene(machine::Machine *machine, const QString &core_svg_
     update_values(); // Set to initial value - most often zero.
 
     // Update coreview with each core step.
-    connect(machine->core(), &machine::Core::step_done, this, &CoreViewScene::update_values);
+    connect(machine->core(), &machine::Core::step_done, this, &CoreViewScene::show_state);
 }
 
 CoreViewScene::~CoreViewScene() = default;
@@ -227,6 +236,7 @@ void CoreViewScene::update_value_list(std::vector<T> &value_list) {
 void CoreViewScene::update_values() {
     update_value_list(values.bool_values);
     update_value_list(values.debug_values);
+    update_value_list(values.counter_values);
     update_value_list(values.reg_values);
     update_value_list(values.reg_id_values);
     update_value_list(values.pc_values);
@@ -236,6 +246,11 @@ void CoreViewScene::update_values() {
     update_value_list(values.mux3_values);
 }
 
+void CoreViewScene::show_state(const machine::CoreState &state) {
+    shown_state = state;
+    update_values();
+}
+
 void CoreViewScene::request_jump_to_program_counter_wrapper() {
     emit request_jump_to_program_counter(program_counter_value);
 }
@@ -43,6 +43,11 @@ public slots:
      * @see install_value
      */
     void update_values();
+    /**
+     * Copy `state` into the shown state and update all values. Used for steps of the core and for
+     * states published by a machine running in the background thread.
+     */
+    void show_state(const machine::CoreState &state);
 
 protected:
     /**
@@ -91,6 +96,7 @@ protected:
         std::vector<RegValue> reg_values;
         std::vector<RegIdValue> reg_id_values;
         std::vector<DebugValue> debug_values;
+        std::vector<CounterValue> counter_values;
         std::vector<PCValue> pc_values;
         std::vector<MultiTextValue> multi_text_values;
         std::vector<InstructionValue> instruction_values;
@@ -101,6 +107,11 @@ protected:
     Box<Cache> program_cache;
     Box<Cache> data_cache;
 
+    /**
+     * Copy of the core state shown by the installed values. The values never refer to the state
+     * of the core itself, which may be running in another thread.
+     */
+    machine::CoreState shown_state;
     /** Reference to current PC value to be used to focus PC in program memory on lick */
     const machine::Address& program_counter_value;
 };
@@ -74,6 +74,12 @@ void CsrDock::setup(machine::Machine *machine) {
     connect(machine, &machine::Machine::tick, this, &CsrDock::clear_highlights);
 }
 
+void CsrDock::show_state(const machine::CSR::ControlState::Snapshot &state) {
+    for (size_t i = 0; i < machine::CSR::REGISTERS.size(); i++) {
+        labelVal(csr_view[i], state.register_data[i].as_xlen(xlen));
+    }
+}
+
 void CsrDock::csr_changed(size_t internal_reg_id, machine::RegisterValue val) {
     // FIXME assert takes literal
     SANITY_ASSERT(
@@ -18,6 +18,8 @@ public:
     explicit CsrDock(QWidget *parent);
 
     void setup(machine::Machine *machine);
+    /** Shows values copied from the machine (e.g. published by a worker thread). */
+    void show_state(const machine::CSR::ControlState::Snapshot &state);
 
 private slots:
     void csr_changed(std::size_t internal_reg_id, machine::RegisterValue val);
@@ -16,7 +16,8 @@ MemoryModel::MemoryModel(QObject *parent) : Super(parent), data_font("Monospace"
 }
 
 const machine::FrontendMemory *MemoryModel::mem_access() const {
-    if (machine == nullptr) { return nullptr; }
+    // Machine stepped by a worker thread (`MachineWorker`) must not be accessed.
+    if (machine == nullptr || machine->is_run_active()) { return nullptr; }
     if (machine->memory_data_bus() != nullptr) { return machine->memory_data_bus(); }
     // Direct access to memory is not allowed, data bus must be used. At least a
     // trivial one. If this occurred, there is a misconfigured machine.
@@ -24,7 +25,7 @@ const machine::FrontendMemory *MemoryModel::mem_access() const {
 }
 
 machine::FrontendMemory *MemoryModel::mem_access_rw() const {
-    if (machine == nullptr) { return nullptr; }
+    if (machine == nullptr || machine->is_run_active()) { return nullptr; }
     if (machine->memory_data_bus_rw() != nullptr) { return machine->memory_data_bus_rw(); }
     // Direct access to memory is not allowed, data bus must be used. At least a
     // trivial one. If this occurred, there is a misconfigured machine.
@@ -54,7 +54,7 @@ DockPredictorBHT::DockPredictorBHT(QWidget *parent) : Super(parent) {
 }
 
 // Get BHT cell item, or create new one if needed
-QTableWidgetItem* DockPredictorBHT::get_bht_cell_item(uint8_t row_index, uint8_t col_index) {
+QTableWidgetItem* DockPredictorBHT::get_bht_cell_item(int row_index, int col_index) {
     QTableWidgetItem *item { bht->item(row_index, col_index) };
     if (item == nullptr) {
         item = new QTableWidgetItem();
@@ -66,21 +66,28 @@ QTableWidgetItem* DockPredictorBHT::get_bht_cell_item(uint8_t row_index, uint8_t
 }
 
 void DockPredictorBHT::set_table_color(QColor color) {
-    for (uint16_t row_index = 0; row_index < bht->rowCount(); row_index++) {
-        for (uint16_t column_index = 0; column_index < bht->columnCount(); column_index++) {
+    for (int row_index = 0; row_index < bht->rowCount(); row_index++) {
+        for (int column_index = 0; column_index < bht->columnCount(); column_index++) {
             get_bht_cell_item(row_index, column_index)->setBackground(
                 QBrush(color));
         }
     }
 }
 
-void DockPredictorBHT::set_row_color(uint16_t row_index, QColor color) {
-    for (uint16_t column_index = 0; column_index < bht->columnCount(); column_index++) {
+void DockPredictorBHT::set_row_color(int row_index, QColor color) {
+    for (int column_index = 0; column_index < bht->columnCount(); column_index++) {
         get_bht_cell_item(row_index, column_index)->setBackground(
             QBrush(color));
     }
 }
 
+// Entries of sampled tables without their own row are not highlighted
+void DockPredictorBHT::set_entry_color(uint32_t bht_index, QColor color) {
+    if ((bht_index & ((1u << bht_view_stride_bits) - 1)) != 0) { return; }
+    const uint32_t row_index { bht_index >> bht_view_stride_bits };
+    if (row_index < (uint32_t)bht->rowCount()) { set_row_color(row_index, color); }
+}
+
 void DockPredictorBHT::setup(
     const machine::BranchPredictor *branch_predictor,
     const machine::Core *core) {
@@ -89,6 +96,7 @@ void DockPredictorBHT::setup(
 
     number_of_bhr_bits = branch_predictor->get_number_of_bhr_bits();
     number_of_bht_bits = branch_predictor->get_number_of_bht_bits();
+    bht_view_stride_bits = branch_predictor->get_bht_view_stride_bits();
     initial_state = branch_predictor->get_initial_state();
     const machine::PredictorType predictor_type { branch_predictor->get_predictor_type() };
     const bool is_predictor_dynamic { machine::is_predictor_type_dynamic(predictor_type) };
@@ -110,7 +118,7 @@ void DockPredictorBHT::setup(
 
         if (is_predictor_dynamic) {
             bht->setDisabled(false);
-            bht->setRowCount(qPow(2, number_of_bht_bits));
+            bht->setRowCount(branch_predictor->get_bht_view_size());
             clear_bht(initial_state);
 
             connect(
@@ -131,7 +139,7 @@ void DockPredictorBHT::setup(
 
 void DockPredictorBHT::show_new_prediction(
     uint16_t btb_index,
-    uint16_t bht_index,
+    uint32_t bht_index,
     machine::PredictionInput input,
     machine::BranchResult result,
     machine::BranchType branch_type) {
@@ -139,38 +147,40 @@ void DockPredictorBHT::show_new_prediction(
     UNUSED(input);
     UNUSED(result);
     if (branch_type == machine::BranchType::BRANCH) {
-        set_row_color(bht_index, Q_COLOR_PREDICT);
+        set_entry_color(bht_index, Q_COLOR_PREDICT);
     }
 }
 
 void DockPredictorBHT::show_new_update(
     uint16_t btb_index,
-    uint16_t bht_index,
+    uint32_t bht_index,
     machine::PredictionFeedback feedback) {
     UNUSED(btb_index);
     if (feedback.branch_type == machine::BranchType::BRANCH) {
-        set_row_color(bht_index, Q_COLOR_UPDATE);
+        set_entry_color(bht_index, Q_COLOR_UPDATE);
     }
 }
 
 void DockPredictorBHT::update_predictor_stats(machine::PredictionStatistics stats) {
     label_stats_correct_value->setText(QString::number(stats.correct));
     label_stats_wrong_value->setText(QString::number(stats.wrong));
-    label_stats_accuracy_value->setText(QString::number(stats.accuracy) + " %");
     if (stats.total > 0) {
-        label_stats_accuracy_value->setText(QString::number(stats.accuracy) + " %");
+        label_stats_accuracy_value->setText(
+            QString::number(stats.get_accuracy(), 'f', 2) + " %");
     } else {
         label_stats_accuracy_value->setText("N/A");
     }
 }
 
-void DockPredictorBHT::update_bht_row(uint16_t row_index, machine::BranchHistoryTableEntry bht_entry) {
-    if (row_index >= bht->rowCount()) {
+void DockPredictorBHT::update_bht_row(
+    uint32_t row_index,
+    machine::BranchHistoryTableEntry bht_entry) {
+    if (row_index >= (uint32_t)bht->rowCount()) {
         WARN("BHT dock update received invalid row index: %u", row_index);
         return;
     }
 
-    for (uint16_t column_index = 0; column_index < bht->columnCount(); column_index++) {
+    for (int column_index = 0; column_index < bht->columnCount(); column_index++) {
         get_bht_cell_item(row_index, DOCK_BHT_COL_STATE)->setData(
             Qt::DisplayRole, machine::predictor_state_to_string(bht_entry.state, true).toString());
 
@@ -182,7 +192,8 @@ void DockPredictorBHT::update_bht_row(uint16_t row_index, machine::BranchHistory
 
         if (bht_entry.stats.total > 0) {
             get_bht_cell_item(row_index, DOCK_BHT_COL_ACCURACY)->setData(
-                Qt::DisplayRole, QString::number(bht_entry.stats.accuracy) + " %");
+                Qt::DisplayRole,
+                QString::number(bht_entry.stats.get_accuracy(), 'f', 2) + " %");
         } else {
             get_bht_cell_item(row_index, DOCK_BHT_COL_ACCURACY)->setData(
                 Qt::DisplayRole, "N/A");
@@ -206,9 +217,9 @@ void DockPredictorBHT::clear_name() {
 }
 
 void DockPredictorBHT::clear_bht(machine::PredictorState initial_state) {
-    for (uint16_t row_index = 0; row_index < bht->rowCount(); row_index++) {
+    for (int row_index = 0; row_index < bht->rowCount(); row_index++) {
         get_bht_cell_item(row_index, DOCK_BHT_COL_INDEX)->setData(
-            Qt::DisplayRole, QString::number(row_index));
+            Qt::DisplayRole, QString::number((uint32_t)row_index << bht_view_stride_bits));
 
         get_bht_cell_item(row_index, DOCK_BHT_COL_STATE)->setData(
             Qt::DisplayRole, machine::predictor_state_to_string(initial_state, true).toString());
@@ -47,9 +47,10 @@ public: // Constructors & Destructor
     DockPredictorBHT(QWidget *parent);
 
 private: // Internal functions
-    QTableWidgetItem* get_bht_cell_item(uint8_t row_index, uint8_t col_index);
+    QTableWidgetItem* get_bht_cell_item(int row_index, int col_index);
     void set_table_color(QColor color);
-    void set_row_color(uint16_t row_index, QColor color);
+    void set_row_color(int row_index, QColor color);
+    void set_entry_color(uint32_t bht_index, QColor color);
 
 public: // General functions
     void setup(const machine::BranchPredictor *branch_predictor, const machine::Core *core);
@@ -57,16 +58,16 @@ public: // General functions
 public slots:
     void show_new_prediction(
         uint16_t btb_index,
-        uint16_t bht_index,
+        uint32_t bht_index,
         machine::PredictionInput input,
         machine::BranchResult result,
         machine::BranchType branch_type);
     void show_new_update(
         uint16_t btb_index,
-        uint16_t bht_index,
+        uint32_t bht_index,
         machine::PredictionFeedback feedback);
     void update_predictor_stats(machine::PredictionStatistics stats);
-    void update_bht_row(uint16_t row_index, machine::BranchHistoryTableEntry bht_entry);
+    void update_bht_row(uint32_t row_index, machine::BranchHistoryTableEntry bht_entry);
     void reset_colors();
     void clear_name();
     void clear_stats();
@@ -76,6 +77,7 @@ public slots:
 private: // Internal variables
     uint8_t number_of_bhr_bits{ 0 };
     uint8_t number_of_bht_bits{ 0 };
+    uint8_t bht_view_stride_bits{ 0 }; // Row shows every 2^stride-th entry of larger tables
     machine::PredictorState initial_state{ machine::PredictorState::UNDEFINED };
 
     QT_OWNED QGroupBox *content{ new QGroupBox() };
@@ -230,7 +230,7 @@ void DockPredictorInfo::setup(
     clear_bhr();
 }
 
-void DockPredictorInfo::update_bhr(uint8_t number_of_bhr_bits, uint16_t register_value) {
+void DockPredictorInfo::update_bhr(uint8_t number_of_bhr_bits, uint64_t register_value) {
     if (number_of_bhr_bits > 0) {
         QString binary_value, zero_padding;
         binary_value = QString::number(register_value, 2);
@@ -243,7 +243,7 @@ void DockPredictorInfo::update_bhr(uint8_t number_of_bhr_bits, uint16_t register
 
 void DockPredictorInfo::show_new_prediction(
     uint16_t btb_index,
-    uint16_t bht_index,
+    uint32_t bht_index,
     machine::PredictionInput input,
     machine::BranchResult result,
     machine::BranchType branch_type) {
@@ -263,7 +263,7 @@ void DockPredictorInfo::show_new_prediction(
 
 void DockPredictorInfo::show_new_update(
     uint16_t btb_index,
-    uint16_t bht_index,
+    uint32_t bht_index,
     machine::PredictionFeedback feedback) {
     value_event_update_instruction->setText(feedback.instruction.to_str());
     value_event_update_address->setText(addr_to_hex_str(feedback.instruction_address));
@@ -283,7 +283,12 @@ void DockPredictorInfo::show_new_update(
 void DockPredictorInfo::update_stats(machine::PredictionStatistics stats) {
     label_stats_total_value->setText(QString::number(stats.correct));
     label_stats_miss_value->setText(QString::number(stats.wrong));
-    label_stats_accuracy_value->setText(QString::number(stats.accuracy) + " %");
+    if (stats.total > 0) {
+        label_stats_accuracy_value->setText(
+            QString::number(stats.get_accuracy(), 'f', 2) + " %");
+    } else {
+        label_stats_accuracy_value->setText("N/A");
+    }
 }
 
 void DockPredictorInfo::reset_colors() {
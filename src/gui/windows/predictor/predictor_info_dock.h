@@ -48,16 +48,16 @@ public: // General functions
     void setup(const machine::BranchPredictor *branch_predictor, const machine::Core *core);
 
 public slots:
-    void update_bhr(uint8_t number_of_bhr_bits, uint16_t register_value);
+    void update_bhr(uint8_t number_of_bhr_bits, uint64_t register_value);
     void show_new_prediction(
         uint16_t btb_index,
-        uint16_t bht_index,
+        uint32_t bht_index,
         machine::PredictionInput input,
         machine::BranchResult result,
         machine::BranchType branch_type);
     void show_new_update(
         uint16_t btb_index,
-        uint16_t bht_index,
+        uint32_t bht_index,
         machine::PredictionFeedback feedback);
     void update_stats(machine::PredictionStatistics stats);
     void reset_colors();
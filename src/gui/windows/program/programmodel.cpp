@@ -17,14 +17,15 @@ ProgramModel::ProgramModel(QObject *parent) : Super(parent), data_font("Monospac
 }
 
 const machine::FrontendMemory *ProgramModel::mem_access() const {
-    if (machine == nullptr) { return nullptr; }
+    // Machine stepped by a worker thread (`MachineWorker`) must not be accessed.
+    if (machine == nullptr || machine->is_run_active()) { return nullptr; }
     if (machine->memory_data_bus() != nullptr) { return machine->memory_data_bus(); }
     throw std::logic_error("Use of backend memory in frontend."); // TODO
     //    return machine->memory();
 }
 
 machine::FrontendMemory *ProgramModel::mem_access_rw() const {
-    if (machine == nullptr) { return nullptr; }
+    if (machine == nullptr || machine->is_run_active()) { return nullptr; }
     if (machine->memory_data_bus_rw() != nullptr) { return machine->memory_data_bus_rw(); }
     throw std::logic_error("Use of backend memory in frontend."); // TODO
     //    return machine->memory_rw();
@@ -192,7 +193,7 @@ bool ProgramModel::adjustRowAndOffset(int &row, machine::Address address) {
 
 void ProgramModel::toggle_hw_break(const QModelIndex &index) {
     machine::Address address;
-    if (index.column() != 0 || machine == nullptr) { return; }
+    if (index.column() != 0 || mem_access() == nullptr) { return; }
 
     if (!get_row_address(address, index.row())) { return; }
 
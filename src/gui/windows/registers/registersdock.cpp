@@ -83,6 +83,13 @@ void RegistersDock::connectToMachine(machine::Machine *machine) {
     connect(machine, &machine::Machine::tick, this, &RegistersDock::clear_highlights);
 }
 
+void RegistersDock::show_state(const machine::Registers::Snapshot &state) {
+    setRegisterValueToLabel(pc, state.pc.get_raw());
+    for (size_t i = 0; i < gp.size(); i++) {
+        setRegisterValueToLabel(gp[i], state.gp[i]);
+    }
+}
+
 void RegistersDock::pc_changed(machine::Address val) {
     setRegisterValueToLabel(pc, val.get_raw());
 }
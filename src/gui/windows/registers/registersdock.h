@@ -22,6 +22,8 @@ public:
     explicit RegistersDock(QWidget *parent, machine::Xlen xlen);
 
     void connectToMachine(machine::Machine *machine);
+    /** Shows values copied from the machine (e.g. published by a worker thread). */
+    void show_state(const machine::Registers::Snapshot &state);
 
 private slots:
     void pc_changed(machine::Address val);
@@ -32,9 +32,7 @@ TerminalDock::TerminalDock(QWidget *parent, QSettings *settings) : QDockWidget(p
 
 void TerminalDock::setup(machine::SerialPort *ser_port) {
     if (ser_port == nullptr) { return; }
-    connect(
-        ser_port, &machine::SerialPort::tx_byte, this,
-        QOverload<unsigned int>::of(&TerminalDock::tx_byte));
+    connect(ser_port, &machine::SerialPort::tx_byte, this, &TerminalDock::tx_byte);
     connect(ser_port, &machine::SerialPort::rx_byte_pool, this, &TerminalDock::rx_byte_pool);
     connect(input_edit, &QLineEdit::textChanged, ser_port, &machine::SerialPort::rx_queue_check);
 }
@@ -53,9 +51,16 @@ void TerminalDock::tx_byte(unsigned int data) {
     }
 }
 
-void TerminalDock::tx_byte(int fd, unsigned int data) {
+void TerminalDock::tx_data(int fd, const QByteArray &data) {
     (void)fd;
-    tx_byte(data);
+    bool at_end = terminal_text->textCursor().atEnd();
+    // Line feeds are converted to new blocks by the cursor.
+    append_cursor->insertText(QString::fromLatin1(data));
+    if (at_end) {
+        QTextCursor cursor = QTextCursor(terminal_text->document());
+        cursor.movePosition(QTextCursor::End);
+        terminal_text->setTextCursor(cursor);
+    }
 }
 
 void TerminalDock::rx_byte_pool(int fd, unsigned int &data, bool &available) {
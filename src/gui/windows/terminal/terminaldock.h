@@ -19,7 +19,7 @@ public:
 
 public slots:
     void tx_byte(unsigned int data);
-    void tx_byte(int fd, unsigned int data);
+    void tx_data(int fd, const QByteArray &data);
     void rx_byte_pool(int fd, unsigned int &data, bool &available);
 
 private:
@@ -0,0 +1,182 @@
+#include "access_trace.h"
+
+#include "simulator_exception.h"
+
+#include <cstring>
+
+using namespace machine;
+
+static constexpr char TRACE_MAGIC[8] = { 'Q', 'T', 'R', 'V', 'A', 'C', 'T', 'R' };
+static constexpr uint32_t TRACE_VERSION = 1;
+static constexpr size_t TRACE_HEADER_SIZE = 16;
+/** Buffered records are written to the file when the buffer exceeds this size. */
+static constexpr size_t TRACE_BUFFER_SIZE = 1 << 16;
+
+static constexpr unsigned TAG_KIND_MASK = 0x3;
+static constexpr unsigned TAG_SIZE_SHIFT = 2;
+static constexpr unsigned TAG_SIZE_EXTENDED = 63;
+static constexpr uint8_t TAG_BRANCH_TAKEN = 1U << 2;
+static constexpr uint8_t TAG_BRANCH_JUMP = 1U << 3;
+
+/** Index of the address stream (see `stream_end`) the access kind belongs to. */
+static inline size_t stream_of(AccessTraceKind kind) {
+    return kind == ATK_FETCH ? 0 : 1;
+}
+
+AccessTraceWriter::AccessTraceWriter(const QString &path) : file(path) {
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        throw SIMULATOR_EXCEPTION(
+            Input, QString("Can't open access trace file for writing (") + path + ")",
+            file.errorString());
+    }
+    buffer.reserve(TRACE_BUFFER_SIZE + 32);
+    buffer.insert(buffer.end(), std::begin(TRACE_MAGIC), std::end(TRACE_MAGIC));
+    for (uint32_t word : { TRACE_VERSION, 0U }) {
+        for (unsigned i = 0; i < 4; i++) {
+            buffer.push_back(static_cast<uint8_t>(word >> (8 * i)));
+        }
+    }
+}
+
+AccessTraceWriter::~AccessTraceWriter() {
+    if (file.isOpen()) { flush(); }
+}
+
+void AccessTraceWriter::record_access(AccessTraceKind kind, Address address, size_t size) {
+    const size_t stream = stream_of(kind);
+    if (size < TAG_SIZE_EXTENDED) {
+        buffer.push_back(static_cast<uint8_t>(kind | (size << TAG_SIZE_SHIFT)));
+    } else {
+        buffer.push_back(static_cast<uint8_t>(kind | (TAG_SIZE_EXTENDED << TAG_SIZE_SHIFT)));
+        put_varint(size);
+    }
+    put_signed(static_cast<int64_t>(address.get_raw() - stream_end[stream]));
+    stream_end[stream] = address.get_raw() + size;
+    record_count++;
+    if (buffer.size() >= TRACE_BUFFER_SIZE) { flush(); }
+}
+
+void AccessTraceWriter::record_branch(
+    Address address,
+    Address target,
+    BranchType branch_type,
+    BranchResult result) {
+    uint8_t tag = ATK_BRANCH;
+    if (result == BranchResult::TAKEN) { tag |= TAG_BRANCH_TAKEN; }
+    if (branch_type == BranchType::JUMP) { tag |= TAG_BRANCH_JUMP; }
+    buffer.push_back(tag);
+    put_signed(static_cast<int64_t>(address.get_raw() - last_branch));
+    put_signed(static_cast<int64_t>(target.get_raw() - address.get_raw()));
+    last_branch = address.get_raw();
+    record_count++;
+    if (buffer.size() >= TRACE_BUFFER_SIZE) { flush(); }
+}
+
+void AccessTraceWriter::close() {
+    if (!file.isOpen()) { return; }
+    const bool written = flush();
+    file.close();
+    if (!written) {
+        throw SIMULATOR_EXCEPTION(
+            Input, QString("Writing of access trace failed (") + file.fileName() + ")",
+            file.errorString());
+    }
+}
+
+void AccessTraceWriter::put_varint(uint64_t value) {
+    while (value >= 0x80) {
+        buffer.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    buffer.push_back(static_cast<uint8_t>(value));
+}
+
+void AccessTraceWriter::put_signed(int64_t value) {
+    // Zigzag encoding keeps small negative differences short.
+    put_varint((static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+}
+
+bool AccessTraceWriter::flush() {
+    const auto size = static_cast<qint64>(buffer.size());
+    const bool written
+        = file.write(reinterpret_cast<const char *>(buffer.data()), size) == size;
+    buffer.clear();
+    return written;
+}
+
+AccessTraceReader::AccessTraceReader(const QString &path) : file(path) {
+    if (!file.open(QIODevice::ReadOnly)) {
+        throw SIMULATOR_EXCEPTION(
+            Input, QString("Can't open access trace file for reading (") + path + ")",
+            file.errorString());
+    }
+    const qint64 size = file.size();
+    begin = size > 0 ? file.map(0, size) : nullptr;
+    if (begin == nullptr) {
+        content = file.readAll();
+        begin = reinterpret_cast<const uint8_t *>(content.constData());
+    }
+    end = begin + size;
+
+    if (size < static_cast<qint64>(TRACE_HEADER_SIZE)
+        || memcmp(begin, TRACE_MAGIC, sizeof(TRACE_MAGIC)) != 0) {
+        throw SIMULATOR_EXCEPTION(Input, QString("Not an access trace file (") + path + ")", "");
+    }
+    uint32_t version = 0;
+    for (unsigned i = 0; i < 4; i++) {
+        version |= static_cast<uint32_t>(begin[sizeof(TRACE_MAGIC) + i]) << (8 * i);
+    }
+    if (version != TRACE_VERSION) {
+        throw SIMULATOR_EXCEPTION(
+            Input, QString("Unsupported access trace version (") + path + ")",
+            QString::number(version));
+    }
+    rewind();
+}
+
+void AccessTraceReader::rewind() {
+    position = begin + TRACE_HEADER_SIZE;
+    stream_end[0] = stream_end[1] = 0;
+    last_branch = 0;
+}
+
+bool AccessTraceReader::next(AccessTraceRecord &record) {
+    if (position == end) { return false; }
+    const uint8_t tag = *position++;
+    record.kind = static_cast<AccessTraceKind>(tag & TAG_KIND_MASK);
+    if (record.kind == ATK_BRANCH) {
+        const uint64_t address = last_branch + get_signed();
+        record.address = Address(address);
+        record.target = Address(address + get_signed());
+        record.size = 0;
+        record.branch_type = (tag & TAG_BRANCH_JUMP) ? BranchType::JUMP : BranchType::BRANCH;
+        record.result = (tag & TAG_BRANCH_TAKEN) ? BranchResult::TAKEN : BranchResult::NOT_TAKEN;
+        last_branch = address;
+    } else {
+        const size_t stream = stream_of(record.kind);
+        const unsigned size = tag >> TAG_SIZE_SHIFT;
+        record.size = size == TAG_SIZE_EXTENDED ? static_cast<uint32_t>(get_varint()) : size;
+        const uint64_t address = stream_end[stream] + get_signed();
+        record.address = Address(address);
+        stream_end[stream] = address + record.size;
+    }
+    return true;
+}
+
+uint64_t AccessTraceReader::get_varint() {
+    uint64_t value = 0;
+    for (unsigned shift = 0; shift < 64; shift += 7) {
+        if (position == end) {
+            throw SIMULATOR_EXCEPTION(Input, "Access trace is truncated", file.fileName());
+        }
+        const uint8_t byte = *position++;
+        value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) { return value; }
+    }
+    throw SIMULATOR_EXCEPTION(Input, "Access trace is corrupted", file.fileName());
+}
+
+int64_t AccessTraceReader::get_signed() {
+    const uint64_t value = get_varint();
+    return static_cast<int64_t>((value >> 1) ^ (~(value & 1) + 1));
+}
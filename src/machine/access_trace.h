@@ -0,0 +1,117 @@
+#ifndef ACCESS_TRACE_H
+#define ACCESS_TRACE_H
+
+#include "memory/address.h"
+#include "predictor_types.h"
+
+#include <QFile>
+#include <QString>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace machine {
+
+/**
+ * Binary trace of memory accesses and branch outcomes of a simulated program.
+ *
+ * The trace is recorded at the interface of the first level caches and the branch predictor
+ * (see `Machine::set_access_trace`) and it can be replayed into caches and a predictor of
+ * another configuration without running the core (see `Machine::replay_access_trace`).
+ *
+ * File format: 16 byte header (magic `QTRVACTR`, little endian 32-bit version and 32-bit
+ * reserved word) followed by records until the end of the file. Each record starts with a tag
+ * byte, its lowest two bits are the `AccessTraceKind`.
+ *
+ * - Memory access: upper six bits of the tag hold the size, value 63 means that the size follows
+ *   as a varint. Then follows zigzag varint of the difference between the address and the end of
+ *   the previous access of the same stream (instruction fetches form one stream, data reads and
+ *   writes the other one), so sequential accesses take a single byte.
+ * - Branch: bit 2 of the tag is set when the branch was taken, bit 3 for unconditional jumps.
+ *   Then follows zigzag varint of the difference from the address of the previous branch and
+ *   zigzag varint of the difference between the target and the branch address.
+ *
+ * Varints are little endian groups of 7 bits with the highest bit set on all but the last byte.
+ */
+enum AccessTraceKind : uint8_t {
+    ATK_FETCH = 0,
+    ATK_READ = 1,
+    ATK_WRITE = 2,
+    ATK_BRANCH = 3,
+};
+
+struct AccessTraceRecord {
+    AccessTraceKind kind;
+    Address address;
+    /** Size of memory access in bytes. */
+    uint32_t size;
+    /** Branch target (valid for taken and not taken branches). */
+    Address target;
+    BranchType branch_type;
+    BranchResult result;
+};
+
+class AccessTraceWriter {
+public:
+    /** Creates (truncates) the file, throws `SimulatorExceptionInput` on failure. */
+    explicit AccessTraceWriter(const QString &path);
+    /** Writes the rest of the buffered records, errors are ignored (see `close`). */
+    ~AccessTraceWriter();
+
+    void record_access(AccessTraceKind kind, Address address, size_t size);
+    void record_branch(
+        Address address,
+        Address target,
+        BranchType branch_type,
+        BranchResult result);
+    /** Writes the buffered records and closes the file, throws on write error. */
+    void close();
+
+    uint64_t get_record_count() const { return record_count; }
+
+private:
+    QFile file;
+    std::vector<uint8_t> buffer;
+    uint64_t record_count = 0;
+    /** End of the previous access of the instruction and the data stream. */
+    uint64_t stream_end[2] = { 0, 0 };
+    uint64_t last_branch = 0;
+
+    void put_varint(uint64_t value);
+    void put_signed(int64_t value);
+    bool flush();
+};
+
+/**
+ * Reads the trace file mapped to memory (the file is read whole when mapping is not available).
+ */
+class AccessTraceReader {
+public:
+    /** Opens the file and checks the header, throws `SimulatorExceptionInput` on failure. */
+    explicit AccessTraceReader(const QString &path);
+
+    /**
+     * Decodes the next record.
+     *
+     * @return  false at the end of the trace, truncated record throws `SimulatorExceptionInput`
+     */
+    bool next(AccessTraceRecord &record);
+    /** Restarts reading from the first record. */
+    void rewind();
+
+private:
+    QFile file;
+    QByteArray content;
+    const uint8_t *begin = nullptr;
+    const uint8_t *end = nullptr;
+    const uint8_t *position = nullptr;
+    uint64_t stream_end[2] = { 0, 0 };
+    uint64_t last_branch = 0;
+
+    uint64_t get_varint();
+    int64_t get_signed();
+};
+
+} // namespace machine
+
+#endif // ACCESS_TRACE_H
@@ -0,0 +1,104 @@
+#include "access_trace.test.h"
+
+#include "machine/access_trace.h"
+#include "machine/simulator_exception.h"
+
+#include <QTemporaryDir>
+
+using namespace machine;
+
+static void write_sample_trace(AccessTraceWriter &writer) {
+    writer.record_access(ATK_FETCH, 0x200_addr, 4);
+    writer.record_access(ATK_FETCH, 0x204_addr, 4);
+    writer.record_access(ATK_READ, 0xfffffff0_addr, 8);
+    writer.record_access(ATK_WRITE, 0x1000_addr, 256);
+    writer.record_branch(0x208_addr, 0x200_addr, BranchType::BRANCH, BranchResult::TAKEN);
+    writer.record_access(ATK_FETCH, 0x200_addr, 2);
+    writer.record_branch(0x20c_addr, 0x400_addr, BranchType::JUMP, BranchResult::TAKEN);
+    writer.record_branch(0x20c_addr, 0x100_addr, BranchType::BRANCH, BranchResult::NOT_TAKEN);
+}
+
+void TestAccessTrace::access_trace_round_trip() {
+    QTemporaryDir dir;
+    const QString path = dir.filePath("trace.bin");
+    {
+        AccessTraceWriter writer(path);
+        write_sample_trace(writer);
+        QCOMPARE(writer.get_record_count(), uint64_t(8));
+        writer.close();
+    }
+
+    AccessTraceReader reader(path);
+    for (int pass = 0; pass < 2; pass++) {
+        AccessTraceRecord r {};
+        QVERIFY(reader.next(r));
+        QCOMPARE(r.kind, ATK_FETCH);
+        QCOMPARE(r.address, 0x200_addr);
+        QCOMPARE(r.size, 4U);
+        QVERIFY(reader.next(r));
+        QCOMPARE(r.address, 0x204_addr);
+        QVERIFY(reader.next(r));
+        QCOMPARE(r.kind, ATK_READ);
+        QCOMPARE(r.address, 0xfffffff0_addr);
+        QCOMPARE(r.size, 8U);
+        QVERIFY(reader.next(r));
+        QCOMPARE(r.kind, ATK_WRITE);
+        QCOMPARE(r.address, 0x1000_addr);
+        QCOMPARE(r.size, 256U);
+        QVERIFY(reader.next(r));
+        QCOMPARE(r.kind, ATK_BRANCH);
+        QCOMPARE(r.address, 0x208_addr);
+        QCOMPARE(r.target, 0x200_addr);
+        QCOMPARE(r.branch_type, BranchType::BRANCH);
+        QCOMPARE(r.result, BranchResult::TAKEN);
+        QVERIFY(reader.next(r));
+        QCOMPARE(r.kind, ATK_FETCH);
+        QCOMPARE(r.address, 0x200_addr);
+        QCOMPARE(r.size, 2U);
+        QVERIFY(reader.next(r));
+        QCOMPARE(r.address, 0x20c_addr);
+        QCOMPARE(r.target, 0x400_addr);
+        QCOMPARE(r.branch_type, BranchType::JUMP);
+        QVERIFY(reader.next(r));
+        QCOMPARE(r.target, 0x100_addr);
+        QCOMPARE(r.result, BranchResult::NOT_TAKEN);
+        QVERIFY(!reader.next(r));
+        reader.rewind();
+    }
+}
+
+void TestAccessTrace::access_trace_compact() {
+    QTemporaryDir dir;
+    const QString path = dir.filePath("trace.bin");
+    {
+        AccessTraceWriter writer(path);
+        for (uint64_t i = 0; i < 1000; i++) {
+            writer.record_access(ATK_FETCH, Address(4 * i), 4);
+        }
+    }
+    // Header and two bytes per sequential fetch.
+    QCOMPARE(QFileInfo(path).size(), qint64(16 + 2 * 1000));
+}
+
+void TestAccessTrace::access_trace_truncated() {
+    QTemporaryDir dir;
+    const QString path = dir.filePath("trace.bin");
+    {
+        AccessTraceWriter writer(path);
+        writer.record_branch(0x12345678_addr, 0x200_addr, BranchType::JUMP, BranchResult::TAKEN);
+    }
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::ReadWrite));
+    QVERIFY(file.resize(file.size() - 1));
+    file.close();
+
+    AccessTraceReader reader(path);
+    AccessTraceRecord r {};
+    bool thrown = false;
+    try {
+        reader.next(r);
+    } catch (SimulatorExceptionInput &) { thrown = true; }
+    QVERIFY(thrown);
+}
+
+QTEST_APPLESS_MAIN(TestAccessTrace)
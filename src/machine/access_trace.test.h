@@ -0,0 +1,14 @@
+#ifndef ACCESS_TRACE_TEST_H
+#define ACCESS_TRACE_TEST_H
+
+#include <QtTest>
+
+class TestAccessTrace : public QObject {
+    Q_OBJECT
+private slots:
+    static void access_trace_round_trip();
+    static void access_trace_compact();
+    static void access_trace_truncated();
+};
+
+#endif // ACCESS_TRACE_TEST_H
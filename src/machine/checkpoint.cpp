@@ -0,0 +1,309 @@
+#include "checkpoint.h"
+
+#include "machine.h"
+
+#include <QBuffer>
+#include <QFile>
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+using namespace machine;
+
+static constexpr char CHECKPOINT_MAGIC[8] = { 'Q', 'T', 'R', 'V', 'C', 'K', 'P', 'T' };
+static constexpr quint32 CHECKPOINT_VERSION = 10;
+
+/** Sizes of structures stored raw, checkpoint of a different build is rejected. */
+static std::vector<quint32> build_layout() {
+    return {
+        static_cast<quint32>(NATIVE_ENDIAN),
+        sizeof(RegisterValue),
+        sizeof(VectorRegisterValue),
+        sizeof(Address),
+        sizeof(CoreState),
+        sizeof(InstructionClass),
+        sizeof(BranchTargetBufferEntry),
+        sizeof(PredictionStatistics),
+        sizeof(CacheStatistics),
+        sizeof(aclint::AclintMtimer::Snapshot),
+        sizeof(aclint::AclintMswi::Snapshot),
+    };
+}
+
+/** Configuration the state depends on, checkpoint of a different machine is rejected. */
+static std::vector<quint32> configuration_layout(const MachineConfig &config) {
+    std::vector<quint32> layout {
+        static_cast<quint32>(config.get_simulated_xlen()),
+        config.pipelined(),
+        config.delay_slot(),
+        static_cast<quint32>(config.hazard_unit()),
+        config.get_bp_enabled(),
+        static_cast<quint32>(config.get_bp_type()),
+        config.get_bp_btb_bits(),
+        config.get_bp_bhr_bits(),
+        config.get_bp_bht_addr_bits(),
+    };
+    for (const CacheConfig *cache :
+         { &config.cache_program(), &config.cache_data(), &config.cache_level2() }) {
+        layout.insert(
+            layout.end(),
+            { cache->enabled(), cache->set_count(), cache->block_size(), cache->associativity(),
+              static_cast<quint32>(cache->replacement_policy()) });
+    }
+    return layout;
+}
+
+static void write_cache(QDataStream &out, const Cache::Snapshot &cache) {
+    cache.lines.save(out);
+    cache.replacement_policy->save(out);
+    checkpoint::write_value(out, cache.stats);
+}
+
+static void read_cache(QDataStream &in, Cache::Snapshot &cache) {
+    cache.lines.load(in);
+    cache.replacement_policy->load(in);
+    checkpoint::read_value(in, cache.stats);
+}
+
+/** Byte ranges (offset and size) of references to vector payloads in `state`, ordered. */
+static std::vector<std::pair<size_t, size_t>> vector_reference_ranges(const CoreState &state) {
+    std::vector<std::pair<size_t, size_t>> ranges;
+    const auto *base = reinterpret_cast<const char *>(&state);
+    for_each_pipeline_value(state.pipeline, [&ranges, base](const RegisterValueUnion &value) {
+        const auto *reference = reinterpret_cast<const char *>(&value.v);
+        ranges.emplace_back(reference - base, sizeof(value.v));
+    });
+    std::sort(ranges.begin(), ranges.end());
+    return ranges;
+}
+
+/**
+ * Core state is plain data except for the references to vector payloads (see `VectorValueRef`).
+ * It is stored raw with the references zeroed, followed by the payloads of vector values in order
+ * of `for_each_pipeline_value`.
+ */
+static void write_core_state(QDataStream &out, const CoreState &state) {
+    std::vector<char> image(sizeof(CoreState));
+    memcpy(image.data(), reinterpret_cast<const char *>(&state), image.size());
+    for (const auto &range : vector_reference_ranges(state)) {
+        std::fill_n(image.begin() + range.first, range.second, 0);
+    }
+    std::vector<vector_register_storage_t> vectors;
+    for_each_pipeline_value(state.pipeline, [&vectors](const RegisterValueUnion &value) {
+        if (value.type == REGISTER_VALUE_TYPE_V) { vectors.push_back(value.v.storage()); }
+    });
+    checkpoint::write_vector(out, image);
+    checkpoint::write_vector(out, vectors);
+}
+
+/** Reads state written by `write_core_state`, only the plain members of `state` are copied. */
+static void read_core_state(QDataStream &in, CoreState &state) {
+    std::vector<char> image(sizeof(CoreState));
+    std::vector<vector_register_storage_t> vectors;
+    checkpoint::read_array(in, image.data(), image.size());
+    checkpoint::read_vector(in, vectors);
+    for_each_pipeline_value(state.pipeline, [](RegisterValueUnion &value) { value.v = {}; });
+    auto *base = reinterpret_cast<char *>(&state);
+    size_t copied = 0;
+    for (const auto &range : vector_reference_ranges(state)) {
+        memcpy(base + copied, image.data() + copied, range.first - copied);
+        copied = range.first + range.second;
+    }
+    memcpy(base + copied, image.data() + copied, image.size() - copied);
+    size_t next_vector = 0;
+    for_each_pipeline_value(state.pipeline, [&](RegisterValueUnion &value) {
+        if (value.type != REGISTER_VALUE_TYPE_V) { return; }
+        if (next_vector == vectors.size()) { checkpoint::throw_truncated(); }
+        value.v = VectorValueRef(vectors[next_vector++]);
+    });
+    if (next_vector != vectors.size()) { checkpoint::throw_truncated(); }
+}
+
+/** Memory is stored as blocks (offset and content) preceded by a non zero byte. */
+static void write_memory(QDataStream &out, const Memory &memory) {
+    memory.for_each_block([&out](Offset offset, const byte *data, size_t length) {
+        // Blocks of zeros are equal to never written memory.
+        if (std::all_of(data, data + length, [](byte value) { return value == 0; })) { return; }
+        out << static_cast<quint8>(1) << static_cast<quint64>(offset);
+        checkpoint::write_array(out, data, length);
+    });
+    out << static_cast<quint8>(0);
+}
+
+static void read_memory(QDataStream &in, Memory &memory) {
+    std::vector<byte> block;
+    while (true) {
+        quint8 marker = 0;
+        quint64 offset = 0;
+        in >> marker;
+        if (in.status() != QDataStream::Ok) { checkpoint::throw_truncated(); }
+        if (marker == 0) { return; }
+        in >> offset;
+        checkpoint::read_vector(in, block);
+        memory.write(offset, block.data(), block.size(), { .type = AccessEffects::INTERNAL });
+    }
+}
+
+void Machine::save_checkpoint(const QString &path) const {
+    const Snapshot state = snapshot();
+    // Handlers may refuse to store their state, which is found out before the file is replaced.
+    std::vector<QByteArray> handler_states;
+    for (const ExceptionHandler *handler : cr->get_exception_handlers()) {
+        QByteArray data;
+        QBuffer buffer(&data);
+        buffer.open(QIODevice::WriteOnly);
+        QDataStream handler_out(&buffer);
+        handler->save_checkpoint(handler_out);
+        handler_states.push_back(data);
+    }
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        throw SIMULATOR_EXCEPTION(
+            Input, QString("Can't open checkpoint file for writing (") + path + ")",
+            file.errorString());
+    }
+    QDataStream out(&file);
+    out.writeRawData(CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC));
+    out << CHECKPOINT_VERSION;
+    checkpoint::write_vector(out, build_layout());
+    checkpoint::write_vector(out, configuration_layout(machine_config));
+
+    checkpoint::write_array(out, state.registers.gp.data(), state.registers.gp.size());
+    checkpoint::write_array(out, state.registers.vr.data(), state.registers.vr.size());
+    checkpoint::write_value(out, state.registers.pc);
+    checkpoint::write_value(out, state.registers.vl);
+    checkpoint::write_array(
+        out, state.control_state.register_data.data(), state.control_state.register_data.size());
+    write_memory(out, *state.memory);
+    write_cache(out, state.cache_program);
+    write_cache(out, state.cache_data);
+    write_cache(out, state.cache_level2);
+    checkpoint::write_value(out, state.predictor.total_stats);
+    checkpoint::write_value(out, state.predictor.predictor_stats);
+    checkpoint::write_vector(out, state.predictor.bht_stats);
+    checkpoint::write_vector(out, state.predictor.tables);
+    checkpoint::write_value(out, state.predictor.bhr_value);
+    checkpoint::write_vector(out, state.predictor.btb);
+    write_core_state(out, state.core.state);
+    checkpoint::write_value(out, state.core.prev_inst_class);
+    checkpoint::write_value(out, state.core.prev_inst_addr);
+    checkpoint::write_value(out, state.mtimer);
+    checkpoint::write_value(out, state.mswi);
+    out << static_cast<quint32>(state.status);
+    // Each handler state is a separate block, a handler cannot read data of another one.
+    out << static_cast<quint32>(handler_states.size());
+    for (const QByteArray &data : handler_states) {
+        out << data;
+    }
+
+    if (out.status() != QDataStream::Ok || !file.flush()) {
+        throw SIMULATOR_EXCEPTION(
+            Input, QString("Writing of checkpoint failed (") + path + ")", file.errorString());
+    }
+}
+
+void Machine::load_checkpoint(const QString &path) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        throw SIMULATOR_EXCEPTION(
+            Input, QString("Can't open checkpoint file for reading (") + path + ")",
+            file.errorString());
+    }
+    // When the file can be mapped, the stream reads from a buffer wrapping the mapping (no copy
+    // of the whole file is made). Values are still copied out of the mapping into the snapshot,
+    // the mapping only saves the read calls and the buffering of QFile.
+    const qint64 size = file.size();
+    const uchar *mapped = (size > 0 && size <= INT_MAX) ? file.map(0, size) : nullptr;
+    QByteArray content;
+    QBuffer buffer(&content);
+    QDataStream in(&file);
+    if (mapped != nullptr) {
+        content = QByteArray::fromRawData(
+            reinterpret_cast<const char *>(mapped), static_cast<int>(size));
+        buffer.open(QIODevice::ReadOnly);
+        in.setDevice(&buffer);
+    }
+
+    char magic[sizeof(CHECKPOINT_MAGIC)] {};
+    quint32 version = 0;
+    in.readRawData(magic, sizeof(magic));
+    in >> version;
+    if (in.status() != QDataStream::Ok || memcmp(magic, CHECKPOINT_MAGIC, sizeof(magic)) != 0) {
+        throw SIMULATOR_EXCEPTION(Input, QString("Not a checkpoint file (") + path + ")", "");
+    }
+    if (version != CHECKPOINT_VERSION) {
+        throw SIMULATOR_EXCEPTION(
+            Input, QString("Unsupported checkpoint version (") + path + ")",
+            QString::number(version));
+    }
+    std::vector<quint32> layout;
+    checkpoint::read_vector(in, layout);
+    if (layout != build_layout()) {
+        throw SIMULATOR_EXCEPTION(
+            Input, QString("Checkpoint was saved by an incompatible build (") + path + ")", "");
+    }
+    checkpoint::read_vector(in, layout);
+    if (layout != configuration_layout(machine_config)) {
+        throw SIMULATOR_EXCEPTION(
+            Input, QString("Checkpoint was saved with a different configuration (") + path + ")",
+            "");
+    }
+
+    // Components of configuration dependent size are read into snapshots of this machine.
+    Snapshot state;
+    state.memory = std::make_unique<Memory>(machine_config.get_simulated_endian(), mem->layout());
+    state.cache_program = cch_program->snapshot();
+    state.cache_data = cch_data->snapshot();
+    state.cache_level2 = cch_level2->snapshot();
+    state.predictor = predictor->snapshot();
+
+    checkpoint::read_array(in, state.registers.gp.data(), state.registers.gp.size());
+    checkpoint::read_array(in, state.registers.vr.data(), state.registers.vr.size());
+    checkpoint::read_value(in, state.registers.pc);
+    checkpoint::read_value(in, state.registers.vl);
+    checkpoint::read_array(
+        in, state.control_state.register_data.data(), state.control_state.register_data.size());
+    read_memory(in, *state.memory);
+    read_cache(in, state.cache_program);
+    read_cache(in, state.cache_data);
+    read_cache(in, state.cache_level2);
+    checkpoint::read_value(in, state.predictor.total_stats);
+    checkpoint::read_value(in, state.predictor.predictor_stats);
+    checkpoint::read_array(
+        in, state.predictor.bht_stats.data(), state.predictor.bht_stats.size());
+    checkpoint::read_array(in, state.predictor.tables.data(), state.predictor.tables.size());
+    checkpoint::read_value(in, state.predictor.bhr_value);
+    checkpoint::read_array(in, state.predictor.btb.data(), state.predictor.btb.size());
+    read_core_state(in, state.core.state);
+    checkpoint::read_value(in, state.core.prev_inst_class);
+    checkpoint::read_value(in, state.core.prev_inst_addr);
+    checkpoint::read_value(in, state.mtimer);
+    checkpoint::read_value(in, state.mswi);
+    quint32 status = 0;
+    in >> status;
+    if (in.status() != QDataStream::Ok || status > ST_TRAPPED) { checkpoint::throw_truncated(); }
+    state.status = static_cast<enum Status>(status);
+    const QList<ExceptionHandler *> handlers = cr->get_exception_handlers();
+    quint32 handler_count = 0;
+    in >> handler_count;
+    if (in.status() != QDataStream::Ok) { checkpoint::throw_truncated(); }
+    if (handler_count != static_cast<quint32>(handlers.size())) {
+        checkpoint::throw_mismatch(QString("%1 exception handlers stored, %2 registered")
+                                       .arg(handler_count)
+                                       .arg(handlers.size()));
+    }
+    std::vector<QByteArray> handler_states(handlers.size());
+    for (QByteArray &data : handler_states) {
+        in >> data;
+        if (in.status() != QDataStream::Ok) { checkpoint::throw_truncated(); }
+    }
+
+    // Handlers keep their state when their data are invalid, the machine is restored after them.
+    for (int i = 0; i < handlers.size(); i++) {
+        QDataStream handler_in(handler_states[i]);
+        handlers[i]->load_checkpoint(handler_in);
+    }
+    restore(state);
+}
@@ -0,0 +1,109 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include "simulator_exception.h"
+
+#include <QDataStream>
+#include <QIODevice>
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+/**
+ * Serialization helpers of machine checkpoints (see `Machine::save_checkpoint`).
+ *
+ * Plain data (registers, pipeline state, predictor tables, cache lines) are stored as a 64-bit
+ * element count followed by raw bytes of the elements. Such checkpoint can be loaded only by a
+ * build with the same data layout and byte order, which is verified by the checkpoint header.
+ */
+namespace machine { namespace checkpoint {
+
+/** Throws `SimulatorExceptionInput` describing a checkpoint that ended prematurely. */
+[[noreturn]] inline void throw_truncated() {
+    throw SIMULATOR_EXCEPTION(Input, "Checkpoint is truncated or corrupted", "");
+}
+
+/** Throws `SimulatorExceptionInput` about a checkpoint of a different machine. */
+[[noreturn]] inline void throw_mismatch(const QString &what) {
+    throw SIMULATOR_EXCEPTION(Input, "Checkpoint does not match the machine", what);
+}
+
+template<typename T>
+void write_array(QDataStream &out, const T *data, size_t count) {
+    static_assert(std::is_trivially_copyable<T>::value, "Only plain data are stored raw.");
+    out << static_cast<quint64>(count);
+    out.writeRawData(reinterpret_cast<const char *>(data), static_cast<int>(sizeof(T) * count));
+}
+
+/** Reads array written by `write_array`, the stored element count has to match. */
+template<typename T>
+void read_array(QDataStream &in, T *data, size_t count) {
+    static_assert(std::is_trivially_copyable<T>::value, "Only plain data are stored raw.");
+    quint64 stored_count = 0;
+    in >> stored_count;
+    if (in.status() != QDataStream::Ok) { throw_truncated(); }
+    if (stored_count != count) {
+        throw_mismatch(QString("%1 items stored, %2 expected").arg(stored_count).arg(count));
+    }
+    const auto size = static_cast<int>(sizeof(T) * count);
+    if (in.readRawData(reinterpret_cast<char *>(data), size) != size) { throw_truncated(); }
+}
+
+template<typename T>
+void write_value(QDataStream &out, const T &value) {
+    write_array(out, &value, 1);
+}
+
+template<typename T>
+void read_value(QDataStream &in, T &value) {
+    read_array(in, &value, 1);
+}
+
+template<typename T>
+void write_vector(QDataStream &out, const std::vector<T> &values) {
+    write_array(out, values.data(), values.size());
+}
+
+/** Reads vector of any length written by `write_vector`. */
+template<typename T>
+void read_vector(QDataStream &in, std::vector<T> &values) {
+    quint64 stored_count = 0;
+    in >> stored_count;
+    // Count is checked before the allocation, each element takes at least one byte.
+    if (in.status() != QDataStream::Ok || in.device() == nullptr
+        || stored_count * sizeof(T) > static_cast<quint64>(in.device()->bytesAvailable())) {
+        throw_truncated();
+    }
+    values.resize(stored_count);
+    const auto size = static_cast<int>(sizeof(T) * values.size());
+    if (in.readRawData(reinterpret_cast<char *>(values.data()), size) != size) {
+        throw_truncated();
+    }
+}
+
+/** Writes table with rows of equal length (e.g. replacement state of cache sets). */
+template<typename T>
+void write_rows(QDataStream &out, const std::vector<std::vector<T>> &rows) {
+    out << static_cast<quint64>(rows.size());
+    for (const auto &row : rows) {
+        write_vector(out, row);
+    }
+}
+
+/** Reads table written by `write_rows` into a table of the same shape. */
+template<typename T>
+void read_rows(QDataStream &in, std::vector<std::vector<T>> &rows) {
+    quint64 stored_count = 0;
+    in >> stored_count;
+    if (in.status() != QDataStream::Ok) { throw_truncated(); }
+    if (stored_count != rows.size()) {
+        throw_mismatch(QString("%1 rows stored, %2 expected").arg(stored_count).arg(rows.size()));
+    }
+    for (auto &row : rows) {
+        read_array(in, row.data(), row.size());
+    }
+}
+
+}} // namespace machine::checkpoint
+
+#endif // CHECKPOINT_H
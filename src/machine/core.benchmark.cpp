@@ -0,0 +1,79 @@
+#include "core.benchmark.h"
+
+#include "machine/core.h"
+#include "machine/memory/backend/memory.h"
+#include "machine/memory/memory_bus.h"
+#include "machine/predictor.h"
+
+using namespace machine;
+
+static void compile_program(FrontendMemory &memory, Address pc, const QStringList &program) {
+    uint32_t code[2];
+    for (const QString &instruction : program) {
+        const size_t size = Instruction::code_from_string(code, 8, instruction, pc);
+        for (size_t i = 0; i < size; i += 4, pc += 4) {
+            memory.write_u32(pc, code[i]);
+        }
+    }
+}
+
+void BenchmarkCore::pipecore_step() {
+    // Each stage result is returned by value and stored into the pipeline once per step.
+    qInfo(
+        "interstage bytes copied per step: %zu",
+        sizeof(FetchState) + sizeof(DecodeState) + sizeof(ExecuteState) + sizeof(MemoryState)
+            + sizeof(WritebackState));
+
+    Memory memory_backend(BIG);
+    TrivialBus memory(&memory_backend);
+    Registers registers {};
+    BranchPredictor predictor {};
+    CSR::ControlState controlst {};
+    CorePipelined core(
+        &registers, &predictor, &memory, &memory, &controlst, Xlen::_32, config_isa_word_default);
+    core.set_headless(true);
+    compile_program(memory, 0x200_addr, { "addi x1, x1, 1", "add x2, x2, x1", "jal x0, 0x200" });
+    registers.write_pc(0x200_addr);
+    QBENCHMARK {
+        core.step();
+    }
+}
+
+void BenchmarkCore::singlecore_step_data() {
+    QTest::addColumn<bool>("block");
+    QTest::addRow("step") << false;
+    QTest::addRow("block") << true;
+}
+
+void BenchmarkCore::singlecore_step() {
+    // Both variants execute the same number of instructions per iteration.
+    QFETCH(bool, block);
+    constexpr unsigned INSTRUCTIONS = 1000;
+
+    Memory memory_backend(BIG);
+    TrivialBus memory(&memory_backend);
+    Registers registers {};
+    BranchPredictor predictor {};
+    CSR::ControlState controlst {};
+    CoreSingle core(
+        &registers, &predictor, &memory, &memory, &controlst, Xlen::_32, config_isa_word_default);
+    core.set_headless(true);
+    compile_program(
+        memory, 0x200_addr,
+        { "addi x1, x1, 1", "add x2, x2, x1", "sw x2, 0x400(x0)", "lw x3, 0x400(x0)",
+          "xor x4, x3, x1", "slli x5, x4, 2", "bne x5, x0, 0x200", "jal x0, 0x200" });
+    registers.write_pc(0x200_addr);
+    QBENCHMARK {
+        unsigned executed = 0;
+        while (executed < INSTRUCTIONS) {
+            if (block) {
+                executed += core.step_block();
+            } else {
+                core.step();
+                executed++;
+            }
+        }
+    }
+}
+
+QTEST_APPLESS_MAIN(BenchmarkCore)
@@ -0,0 +1,14 @@
+#ifndef CORE_BENCHMARK_H
+#define CORE_BENCHMARK_H
+
+#include <QtTest>
+
+class BenchmarkCore : public QObject {
+    Q_OBJECT
+private slots:
+    static void pipecore_step();
+    static void singlecore_step_data();
+    static void singlecore_step();
+};
+
+#endif // CORE_BENCHMARK_H
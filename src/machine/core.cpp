@@ -5,6 +5,7 @@
 #include "utils.h"
 
 #include <cinttypes>
+#include <utility>
 
 LOG_CATEGORY("machine.core");
 
@@ -51,23 +52,61 @@ Core::Core(
 }
 
 void Core::step(bool skip_break) {
-    emit step_started();
+    if (check_stall()) { return; }
+    if (!headless) { emit step_started(); }
     // state.cycle_count++;
     do_step(skip_break);
-    emit step_done(state);
+    if (!headless) { emit step_done(state); }
+}
+
+unsigned Core::step_block(bool skip_break) {
+    if (check_stall()) { return 0; }
+    step(skip_break);
+    return 1;
+}
+
+void Core::set_block_stop(Address end_addr, uint64_t cycle_limit) {
+    block_end_addr = end_addr;
+    block_cycle_limit = cycle_limit;
+}
+
+bool Core::check_stall() {
+    if (!stall_resume) { return false; }
+    if (!stall_resume()) { return true; }
+    stall_resume = nullptr;
+    return false;
 }
 
 void Core::reset() {
     state.cycle_count = 0;
     state.stall_count = 0;
+    state.class_cycles.fill(0);
+    state.class_instructions.fill(0);
+    state.vector_alu = {};
+    state.decode = {};
+    stall_resume = nullptr;
+    decode_cache.invalidate();
     do_reset();
 }
 
-unsigned Core::get_cycle_count() const {
+Core::Snapshot Core::snapshot() const {
+    Snapshot snapshot { state, prev_inst_class };
+    do_snapshot(snapshot);
+    return snapshot;
+}
+
+void Core::restore(const Snapshot &snapshot) {
+    state = snapshot.state;
+    prev_inst_class = snapshot.prev_inst_class;
+    do_restore(snapshot);
+    if (!headless) { emit step_done(state); }
+}
+
+uint64_t Core::get_cycle_count() const {
     return state.cycle_count;
 }
 
-unsigned Core::get_stall_count() const {
+uint64_t Core::get_stall_count() const {
     return state.stall_count;
 }
 
@@ -91,6 +130,22 @@ BranchPredictor *Core::get_predictor() const {
     return predictor;
 }
 
+void Core::set_headless(bool headless) {
+    this->headless = headless;
+}
+
+bool Core::is_headless() const {
+    return headless;
+}
+
+void Core::stall_until(std::function<bool()> resume) {
+    stall_resume = std::move(resume);
+}
+
+bool Core::is_stalled() const {
+    return static_cast<bool>(stall_resume);
+}
+
 const CoreState &Core::get_state() const {
     return state;
 }
@@ -128,6 +183,10 @@ Xlen Core::get_xlen() const {
     return xlen;
 }
 
+const DecodeCache &Core::get_decode_cache() const {
+    return decode_cache;
+}
+
 void Core::register_exception_handler(ExceptionCause excause, ExceptionHandler *exhandler) {
     if (excause == EXCAUSE_NONE) {
         ex_default_handler.reset(exhandler);
@@ -138,6 +197,33 @@ void Core::register_exception_handler(ExceptionCause excause, ExceptionHandler *
     }
 }
 
+QList<ExceptionHandler *> Core::get_exception_handlers() const {
+    // One handler is usually registered for several causes (e.g. all ECALL variants).
+    QList<ExceptionHandler *> handlers;
+    for (ExceptionHandler *handler : ex_handlers) {
+        if (!handlers.contains(handler)) { handlers.append(handler); }
+    }
+    if (!handlers.contains(ex_default_handler.data())) {
+        handlers.append(ex_default_handler.data());
+    }
+    return handlers;
+}
+
+void Core::copy_exception_setup(const Core &other) {
+    stop_on_exception = other.stop_on_exception;
+    step_over_exception = other.step_over_exception;
+    for (auto it = other.ex_handlers.cbegin(); it != other.ex_handlers.cend(); ++it) {
+        register_exception_handler(it.key(), it.value());
+    }
+}
+
+void Core::set_timing_model(const TimingModel &model) {
+    timing = TimingTable(model);
+    // Decoded instructions hold cost slots of the previous table.
+    decode_cache.invalidate();
+    do_invalidate_decoded();
+}
+
 bool Core::handle_exception(
     ExceptionCause excause,
     const Instruction& inst,
@@ -313,6 +399,10 @@ FetchState Core::fetch(PCInterstage pc, bool skip_break) {
     const Address inst_addr = Address(regs->read_pc());
     const Instruction inst(mem_program->read_u32(inst_addr));
     // printf("Read %08x from %08x.\n", inst.data(), inst_addr.get_raw());
+    return fetch_instruction(inst_addr, inst, skip_break);
+}
+
+FetchState Core::fetch_instruction(Address inst_addr, const Instruction &inst, bool skip_break) {
     ExceptionCause excause = EXCAUSE_NONE;
 
     if (!skip_break && hw_breaks.contains(inst_addr)) { excause = EXCAUSE_HWBREAK; }
@@ -344,48 +434,26 @@ DecodeState Core::decode(const FetchInterstage &dt) {
     AccessControl mem_ctl;
     ExceptionCause excause = dt.excause;
 
-    dt.inst.flags_alu_op_mem_ctl(flags, alu_op, mem_ctl);
+    const DecodedInstruction &decoded = decode_cache.lookup(dt.inst_addr, dt.inst);
+    flags = decoded.flags;
+    alu_op = decoded.alu_op;
+    mem_ctl = decoded.mem_ctl;
 
     if ((flags ^ check_inst_flags_val) & check_inst_flags_mask) {
         excause = EXCAUSE_INSN_ILLEGAL;
     }
-
-    uint8_t cycle_add = 0;
-    if (flags & IMF_MEM) {
-        if (flags & IMF_VEC)
-            cycle_add = regs->read_vl() + 36;
-        else
-            cycle_add = 36;
-    }
-    else if (flags & IMF_MUL) {
-        cycle_add = 8;
-    }
-    else if (flags & IMF_VEC) {
-        if (flags & IMF_VEC_MUL) {
-            cycle_add = regs->read_vl() * 4 + 4; // assume it is chained
-        }
-        else if (flags & IMF_VEC_REDSUM) {
-            cycle_add = (regs->read_vl() + 4) * 2; // 1 + 2 + 4 + ... +vl <= vl * 2
-        }
-        else if (flags & IMF_VEC_VL) {
-            cycle_add = 5;
-        }
-        else {
-            cycle_add = regs->read_vl() + 4;
-        }
-    }
-    else {
-        cycle_add = 5;
-    }
-    if ((flags & IMF_VEC_REDSUM) && (prev_inst_flags & IMF_VEC_MUL)) {
-        cycle_add -= regs->read_vl() + 4;
+    if (!(flags & IMF_SUPPORTED)) {
+        state.decode.unknown_instructions++;
+        state.decode.last_unknown_code = dt.inst.data();
     }
-    state.cycle_count += cycle_add;
-    prev_inst_flags = flags;
 
-    RegisterId num_rs = (flags & (IMF_ALU_REQ_RS | IMF_ALU_RS_ID)) ? dt.inst.rs() : 0;
-    RegisterId num_rt = (flags & IMF_ALU_REQ_RT) ? dt.inst.rt() : 0;
-    RegisterId num_rd = (flags & IMF_REGWRITE) ? dt.inst.rd() : 0;
+    account_cycles(
+        decoded.inst_class, timing.cycles(prev_inst_class, decoded.timing_slot, regs->read_vl()));
+    prev_inst_class = decoded.inst_class;
+
+    RegisterId num_rs = decoded.num_rs;
+    RegisterId num_rt = decoded.num_rt;
+    RegisterId num_rd = decoded.num_rd;
     // When instruction does not specify register, it is set to x0 as operations on x0 have no
     // side effects (not even visualization).
     // RegisterValue val_rs
@@ -408,11 +476,11 @@ DecodeState Core::decode(const FetchInterstage &dt) {
     else {
         val_rt = regs->read_gp(num_rt);
     }
-    RegisterValueUnion immediate_val = RegisterValue(dt.inst.immediate());
+    RegisterValueUnion immediate_val = RegisterValue(decoded.immediate);
     // printf("[%s]: imm = %08x\n", dt.inst.to_str(dt.inst_addr).toStdString().c_str(), immediate_val.i.as_u32());
     const bool regwrite = flags & IMF_REGWRITE;
 
-    CSR::Address csr_address = (flags & IMF_CSR) ? dt.inst.csr_address() : CSR::Address(0);
+    CSR::Address csr_address = decoded.csr_address;
     RegisterValue csr_read_val
         = ((control_state != nullptr && (flags & IMF_CSR))) ? control_state->read(csr_address) : 0;
     bool csr_write = (flags & IMF_CSR) && (!(flags & IMF_CSR_TO_ALU) || (num_rs != 0));
@@ -465,6 +533,9 @@ DecodeState Core::decode(const FetchInterstage &dt) {
                                 .num_rs = num_rs,
                                 .num_rt = num_rt,
                                 .num_rd = num_rd,
+                                .rs_mask = decoded.rs_mask,
+                                .rt_mask = decoded.rt_mask,
+                                .rd_mask = decoded.rd_mask,
                                 .memread = bool(flags & IMF_MEMREAD),
                                 .memwrite = bool(flags & IMF_MEMWRITE),
                                 .alusrc = bool(flags & IMF_ALUSRC),
@@ -517,6 +588,9 @@ ExecuteState Core::execute(const DecodeInterstage &dt) {
         if (excause != EXCAUSE_NONE) return RegisterValueUnion(0);
         return alu_combined_operate(dt.aluop, dt.alu_component, dt.w_operation, dt.alu_mod, alu_fst, alu_sec, regs->read_vl());
     }();
+    if (excause == EXCAUSE_NONE && dt.alu_component == AluComponent::VEC) {
+        state.vector_alu.count(dt.aluop.vec_op, regs->read_vl());
+    }
     // const Address branch_jal_target = dt.inst_addr + dt.immediate_val.as_i64();
     const Address branch_jal_target = dt.inst_addr + (
         (dt.immediate_val.type == RegisterValueType::REGISTER_VALUE_TYPE_I) ?
@@ -561,6 +635,7 @@ ExecuteState Core::execute(const DecodeInterstage &dt) {
                  .excause = excause,
                  .memctl = dt.memctl,
                  .num_rd = dt.num_rd,
+                 .rd_mask = dt.rd_mask,
                  .memread = dt.memread,
                  .memwrite = dt.memwrite,
                  .regwrite = dt.regwrite,
@@ -687,6 +762,7 @@ MemoryState Core::memory(const ExecuteInterstage &dt) {
                  }(),
                  .excause = dt.excause,
                  .num_rd = dt.num_rd,
+                 .rd_mask = regwrite ? dt.rd_mask : 0,
                  .memtoreg = memread,
                  .regwrite = regwrite,
                  .is_valid = dt.is_valid,
@@ -742,9 +818,13 @@ CoreSingle::CoreSingle(
 
 void CoreSingle::do_step(bool skip_break) {
     // printf("=========================================\n");
+    execute_stages(fetch(pc_if, skip_break));
+}
+
+void CoreSingle::execute_stages(const FetchState &fetched) {
     Pipeline &p = state.pipeline;
 
-    p.fetch = fetch(pc_if, skip_break);
+    p.fetch = fetched;
     p.decode = decode(p.fetch.final);
     p.execute = execute(p.decode.final);
     p.memory = memory(p.execute.final);
@@ -766,6 +846,204 @@ void CoreSingle::do_step(bool skip_break) {
 void CoreSingle::do_reset() {
     state.pipeline = {};
     prev_inst_addr = Address::null();
+    block_cache.invalidate();
+}
+
+void CoreSingle::do_invalidate_decoded() {
+    block_cache.invalidate();
+}
+
+void CoreSingle::do_snapshot(Snapshot &snapshot) const {
+    snapshot.prev_inst_addr = prev_inst_addr;
+}
+
+void CoreSingle::do_restore(const Snapshot &snapshot) {
+    prev_inst_addr = snapshot.prev_inst_addr;
+}
+
+unsigned CoreSingle::step_block(bool skip_break) {
+    if (check_stall()) { return 0; }
+    Address inst_addr = regs->read_pc();
+    if (!headless || interrupt_pending() || (!skip_break && hw_breaks.contains(inst_addr))) {
+        step(skip_break);
+        return 1;
+    }
+
+    BasicBlock &block = block_cache.slot(inst_addr);
+    if (!block.valid || block.start != inst_addr) { build_block(block, inst_addr); }
+    if (block.ops.empty()) {
+        step(skip_break);
+        return 1;
+    }
+
+    unsigned executed = 0;
+    for (const BlockOp &op : block.ops) {
+        if (executed > 0 && (interrupt_pending() || block_stop_reached(inst_addr))) { break; }
+
+        // Fetch is performed regularly to keep memory statistics identical to the stage model.
+        const uint32_t inst_word = mem_program->read_u32(inst_addr);
+        if (inst_word != op.decoded.inst_word) {
+            // Code was modified after the block has been discovered.
+            block.valid = false;
+            execute_stages(fetch_instruction(inst_addr, Instruction(inst_word), skip_break));
+            return executed + 1;
+        }
+        if (control_state != nullptr) { control_state->increment_internal(CSR::Id::MCYCLE, 1); }
+        const Address predicted_next_inst_addr
+            = predictor->predict_next_pc_address(op.inst, inst_addr);
+
+        account_cycles(
+            op.decoded.inst_class,
+            timing.cycles(prev_inst_class, op.decoded.timing_slot, regs->read_vl()));
+        prev_inst_class = op.decoded.inst_class;
+
+        const Address next_inst_addr = op.handler(*this, op);
+
+        if (control_state != nullptr) { control_state->increment_internal(CSR::Id::MINSTRET, 1); }
+        if (next_inst_addr != predicted_next_inst_addr) { predictor->increment_mispredictions(); }
+        regs->write_pc(next_inst_addr);
+        prev_inst_addr = inst_addr;
+        inst_addr = next_inst_addr;
+        executed++;
+    }
+    return executed;
+}
+
+bool CoreSingle::interrupt_pending() const {
+    return control_state != nullptr && control_state->core_interrupt_request();
+}
+
+bool CoreSingle::block_stop_reached(Address inst_addr) const {
+    return inst_addr >= block_end_addr
+           || (block_cycle_limit != 0 && state.cycle_count >= block_cycle_limit)
+           || (!hw_breaks.isEmpty() && hw_breaks.contains(inst_addr));
+}
+
+void CoreSingle::build_block(BasicBlock &block, Address start) {
+    block.start = start;
+    block.valid = true;
+    block.ops.clear();
+
+    Address inst_addr = start;
+    while (block.ops.size() < BlockCache::MAX_BLOCK_LENGTH) {
+        BlockOp op;
+        op.inst = Instruction(mem_program->read_u32(inst_addr, ae::INTERNAL));
+        DecodeCache::decode(op.decoded, inst_addr, op.inst, timing);
+        op.handler = select_block_handler(op.decoded);
+        if (op.handler == nullptr) { break; }
+
+        const InstructionFlags flags = op.decoded.flags;
+        op.alu_component = (flags & IMF_MUL) ? AluComponent::MUL : AluComponent::ALU;
+        op.w_operation = (xlen != Xlen::_64) || (flags & IMF_FORCE_W_OP);
+        block.ops.push_back(op);
+
+        if (flags & (IMF_BRANCH | IMF_JUMP | IMF_BRANCH_JALR)) { break; }
+        inst_addr += op.inst.size();
+    }
+}
+
+BlockOpHandler CoreSingle::select_block_handler(const DecodedInstruction &decoded) const {
+    const InstructionFlags flags = decoded.flags;
+    if (!(flags & IMF_SUPPORTED)) { return nullptr; }
+    if ((flags ^ check_inst_flags_val) & check_inst_flags_mask) { return nullptr; }
+    constexpr unsigned STAGE_MODEL_ONLY
+        = IMF_EXCEPTION | IMF_XRET | IMF_CSR | IMF_CSR_TO_ALU | IMF_ALU_RS_ID | IMF_AMO | IMF_VEC
+          | IMF_VEC_RT | IMF_VEC_VL | IMF_VEC_MUL | IMF_VEC_REDSUM;
+    if (flags & STAGE_MODEL_ONLY) { return nullptr; }
+    if (decoded.mem_ctl != AC_NONE && !is_regular_access(decoded.mem_ctl)) { return nullptr; }
+
+    if (flags & IMF_BRANCH) { return &CoreSingle::block_exec_branch; }
+    if (flags & IMF_JUMP) { return &CoreSingle::block_exec_jal; }
+    if (flags & IMF_BRANCH_JALR) { return &CoreSingle::block_exec_jalr; }
+    if (flags & IMF_MEMREAD) { return &CoreSingle::block_exec_load; }
+    if (flags & IMF_MEMWRITE) { return &CoreSingle::block_exec_store; }
+    return &CoreSingle::block_exec_alu;
+}
+
+RegisterValue CoreSingle::block_alu_value(const BlockOp &op) const {
+    const DecodedInstruction &d = op.decoded;
+    const RegisterValue alu_fst = (d.flags & IMF_PC_TO_ALU)
+                                      ? RegisterValue(d.inst_addr.get_raw())
+                                      : regs->read_gp(d.num_rs);
+    const RegisterValue alu_sec
+        = (d.flags & IMF_ALUSRC) ? RegisterValue(d.immediate) : regs->read_gp(d.num_rt);
+    return alu_scalar_operate(
+        d.alu_op, op.alu_component, op.w_operation, d.flags & IMF_ALU_MOD, alu_fst, alu_sec);
+}
+
+Address CoreSingle::block_exec_alu(CoreSingle &core, const BlockOp &op) {
+    const RegisterValue alu_val = core.block_alu_value(op);
+    if (op.decoded.flags & IMF_REGWRITE) { core.regs->write_gp(op.decoded.num_rd, alu_val); }
+    return op.decoded.inst_addr + op.inst.size();
+}
+
+Address CoreSingle::block_exec_load(CoreSingle &core, const BlockOp &op) {
+    const Address mem_addr = Address(core.get_xlen_from_reg(core.block_alu_value(op)));
+    FrontendMemory *mem = core.mem_data;
+    RegisterValue value;
+    switch (op.decoded.mem_ctl) {
+    case AC_I8: value = RegisterValue((int8_t)mem->read_u8(mem_addr)); break;
+    case AC_U8: value = RegisterValue(mem->read_u8(mem_addr)); break;
+    case AC_I16: value = RegisterValue((int16_t)mem->read_u16(mem_addr)); break;
+    case AC_U16: value = RegisterValue(mem->read_u16(mem_addr)); break;
+    case AC_I32: value = RegisterValue((int32_t)mem->read_u32(mem_addr)); break;
+    case AC_U32: value = RegisterValue(mem->read_u32(mem_addr)); break;
+    case AC_I64: value = RegisterValue((int64_t)mem->read_u64(mem_addr)); break;
+    case AC_U64: value = RegisterValue(mem->read_u64(mem_addr)); break;
+    default: value = mem->read_ctl(op.decoded.mem_ctl, mem_addr).i; break;
+    }
+    if (op.decoded.flags & IMF_REGWRITE) { core.regs->write_gp(op.decoded.num_rd, value); }
+    return op.decoded.inst_addr + op.inst.size();
+}
+
+Address CoreSingle::block_exec_store(CoreSingle &core, const BlockOp &op) {
+    const Address mem_addr = Address(core.get_xlen_from_reg(core.block_alu_value(op)));
+    const RegisterValue value = core.regs->read_gp(op.decoded.num_rt);
+    FrontendMemory *mem = core.mem_data;
+    switch (op.decoded.mem_ctl) {
+    case AC_I8:
+    case AC_U8: mem->write_u8(mem_addr, value.as_u8()); break;
+    case AC_I16:
+    case AC_U16: mem->write_u16(mem_addr, value.as_u16()); break;
+    case AC_I32:
+    case AC_U32: mem->write_u32(mem_addr, value.as_u32()); break;
+    case AC_I64:
+    case AC_U64: mem->write_u64(mem_addr, value.as_u64()); break;
+    default: mem->write_ctl(op.decoded.mem_ctl, mem_addr, value); break;
+    }
+    return op.decoded.inst_addr + op.inst.size();
+}
+
+Address CoreSingle::block_exec_branch(CoreSingle &core, const BlockOp &op) {
+    const bool alu_zero = core.block_alu_value(op) == 0;
+    const bool taken = !(op.decoded.flags & IMF_BJ_NOT) ^ !alu_zero;
+    const Address target = op.decoded.inst_addr + RegisterValue(op.decoded.immediate).as_i64();
+    core.predictor->update(
+        op.inst, op.decoded.inst_addr, target, BranchType::BRANCH,
+        taken ? BranchResult::TAKEN : BranchResult::NOT_TAKEN);
+    return taken ? target : op.decoded.inst_addr + op.inst.size();
+}
+
+Address CoreSingle::block_exec_jal(CoreSingle &core, const BlockOp &op) {
+    const Address next_inst_addr = op.decoded.inst_addr + op.inst.size();
+    const Address target = op.decoded.inst_addr + RegisterValue(op.decoded.immediate).as_i64();
+    core.predictor->update(
+        op.inst, op.decoded.inst_addr, target, BranchType::JUMP, BranchResult::TAKEN);
+    if (op.decoded.flags & IMF_REGWRITE) {
+        core.regs->write_gp(op.decoded.num_rd, RegisterValue(next_inst_addr.get_raw()));
+    }
+    return target;
+}
+
+Address CoreSingle::block_exec_jalr(CoreSingle &core, const BlockOp &op) {
+    const Address next_inst_addr = op.decoded.inst_addr + op.inst.size();
+    const Address target = Address(core.get_xlen_from_reg(core.block_alu_value(op)));
+    core.predictor->update(
+        op.inst, op.decoded.inst_addr, target, BranchType::JUMP, BranchResult::TAKEN);
+    if (op.decoded.flags & IMF_REGWRITE) {
+        core.regs->write_gp(op.decoded.num_rd, RegisterValue(next_inst_addr.get_raw()));
+    }
+    return target;
 }
 
 CorePipelined::CorePipelined(
@@ -833,6 +1111,21 @@ void CorePipelined::do_step(bool skip_break) {
     }
 }
 
+void CorePipelined::drain() {
+    // Stages before memory have no side effects, their instructions are fetched again.
+    Address resume_addr = regs->read_pc();
+    if (ex_mem.is_valid) {
+        resume_addr = ex_mem.inst_addr;
+    } else if (id_ex.is_valid) {
+        resume_addr = id_ex.inst_addr;
+    } else if (if_id.is_valid) {
+        resume_addr = if_id.inst_addr;
+    }
+    writeback(mem_wb);
+    state.pipeline = {};
+    regs->write_pc(resume_addr);
+}
+
 void CorePipelined::flush_and_continue_from_address(Address next_pc) {
     regs->write_pc(next_pc);
     if_id.flush();
@@ -864,55 +1157,41 @@ bool CorePipelined::is_stall_requested() const {
     return id_ex.insert_stall_before && ex_mem.is_valid;
 }
 
-template<typename InterstageReg>
-bool is_hazard_in_stage(const InterstageReg &interstage, const DecodeInterstage &id_ex) {
-    return (
-        interstage.regwrite && interstage.num_rd != 0
-        && ((id_ex.alu_req_rs && interstage.num_rd == id_ex.num_rs)
-            || (id_ex.alu_req_rt && interstage.num_rd == id_ex.num_rt)));
-    // Note: We make exception with $0 as that has no effect and is used in nop instruction
-}
-
 bool CorePipelined::handle_data_hazards() {
-    // Note: We make exception with $0 as that has no effect when
-    // written and is used in nop instruction
-    bool stall = false;
-
-    if (is_hazard_in_stage(mem_wb, id_ex)) {
-        if (hazard_unit == MachineConfig::HU_STALL_FORWARD) {
-            // Forward result value
-            if (id_ex.alu_req_rs && mem_wb.num_rd == id_ex.num_rs) {
-                id_ex.val_rs = mem_wb.towrite_val;
-                id_ex.ff_rs = FORWARD_FROM_W;
-            }
-            if (id_ex.alu_req_rt && mem_wb.num_rd == id_ex.num_rt) {
-                id_ex.val_rt = mem_wb.towrite_val;
-                id_ex.ff_rt = FORWARD_FROM_W;
-            }
-        } else {
-            stall = true;
-        }
+    const Scoreboard scoreboard {
+        .memory = ex_mem.rd_mask,
+        .memory_load = ex_mem.memread ? ex_mem.rd_mask : 0,
+        .writeback = mem_wb.rd_mask,
+    };
+    const RegisterMask reads = id_ex.rs_mask | id_ex.rt_mask;
+    if (!(reads & scoreboard.pending())) { return false; }
+    if (hazard_unit != MachineConfig::HU_STALL_FORWARD || (reads & scoreboard.memory_load)) {
+        return true;
     }
-    if (is_hazard_in_stage(ex_mem, id_ex)) {
-        if (hazard_unit == MachineConfig::HU_STALL_FORWARD) {
-            if (ex_mem.memread) {
-                stall = true;
-            } else {
-                // Forward result value
-                if (id_ex.alu_req_rs && ex_mem.num_rd == id_ex.num_rs) {
-                    id_ex.val_rs = ex_mem.alu_val;
-                    id_ex.ff_rs = FORWARD_FROM_M;
-                }
-                if (id_ex.alu_req_rt && ex_mem.num_rd == id_ex.num_rt) {
-                    id_ex.val_rt = ex_mem.alu_val;
-                    id_ex.ff_rt = FORWARD_FROM_M;
-                }
-            }
-        } else {
-            stall = true;
-        }
+    forward_operand(scoreboard, id_ex.rs_mask, id_ex.val_rs, id_ex.ff_rs);
+    forward_operand(scoreboard, id_ex.rt_mask, id_ex.val_rt, id_ex.ff_rt);
+    return false;
+}
+
+void CorePipelined::forward_operand(
+    const Scoreboard &scoreboard,
+    RegisterMask operand,
+    RegisterValueUnion &value,
+    ForwardFrom &forward_from) const {
+    // Value in EX/MEM is newer than the one in MEM/WB.
+    if (operand & scoreboard.memory) {
+        value = ex_mem.alu_val;
+        forward_from = FORWARD_FROM_M;
+    } else if (operand & scoreboard.writeback) {
+        value = mem_wb.towrite_val;
+        forward_from = FORWARD_FROM_W;
+    } else {
+        return;
     }
-    return stall;
+    // Vector operands are forwarded whole, they must never receive a scalar and vice versa.
+    Q_ASSERT(
+        bool(operand & VEC_REGISTERS)
+        == (value.type == RegisterValueType::REGISTER_VALUE_TYPE_V));
 }
 
 void CorePipelined::do_reset() {
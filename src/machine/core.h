@@ -2,7 +2,9 @@
 #define CORE_H
 
 #include "common/memory_ownership.h"
+#include "core/block_cache.h"
 #include "core/core_state.h"
+#include "core/decode_cache.h"
 #include "csr/controlstate.h"
 #include "instruction.h"
 #include "machineconfig.h"
@@ -14,7 +16,11 @@
 #include "registers.h"
 #include "simulator_exception.h"
 
+#include <QList>
 #include <QObject>
+#include <functional>
+
+class QDataStream;
 
 namespace machine {
 
@@ -37,10 +43,23 @@ public:
         ConfigIsaWord isa_word);
 
     void step(bool skip_break = false);
+    /**
+     * Executes as many instructions as the core can run at once (at least one unless the core is
+     * stalled) and returns their count. Cores without a faster execution engine execute a single
+     * `step`.
+     */
+    virtual unsigned step_block(bool skip_break = false);
+    /**
+     * Stop conditions of the machine checked by `step_block` before each instruction, so that
+     * a block ends at the same instruction as single steps would. Block ends before an
+     * instruction at `end_addr` or above and once the cycle count reaches `cycle_limit` (zero
+     * for no limit).
+     */
+    void set_block_stop(Address end_addr, uint64_t cycle_limit);
     void reset(); // Reset core (only core, memory and registers has to be reset separately).
 
-    unsigned get_cycle_count() const;
-    unsigned get_stall_count() const;
+    uint64_t get_cycle_count() const;
+    uint64_t get_stall_count() const;
 
     Registers *get_regs() const;
     CSR::ControlState *get_control_state() const;
@@ -49,11 +68,30 @@ public:
     FrontendMemory *get_mem_program() const;
     const CoreState &get_state() const;
     Xlen get_xlen() const;
+    const DecodeCache &get_decode_cache() const;
+
+    /**
+     * Headless mode suppresses the per step observer signals (`step_started`, `step_done`).
+     * Signals required for control flow (`stop_on_exception_reached`) are still emitted.
+     */
+    void set_headless(bool headless);
+    bool is_headless() const;
+
+    /**
+     * Stalls the core until `resume` returns true. Each step calls it and does nothing else while
+     * it fails, stalled steps neither execute instructions nor count cycles. Used by exception
+     * handlers waiting for an external event (e.g. host I/O of a system call). Reset ends the
+     * stall.
+     */
+    void stall_until(std::function<bool()> resume);
+    bool is_stalled() const;
 
     void insert_hwbreak(Address address);
     void remove_hwbreak(Address address);
     bool is_hwbreak(Address address) const;
     void register_exception_handler(ExceptionCause excause, ExceptionHandler *exhandler);
+    /** Handlers registered for exception causes (each once, in cause order), then the default. */
+    QList<ExceptionHandler *> get_exception_handlers() const;
     void set_stop_on_exception(enum ExceptionCause excause, bool value);
     bool get_stop_on_exception(enum ExceptionCause excause) const;
     void set_step_over_exception(enum ExceptionCause excause, bool value);
@@ -65,6 +103,28 @@ public:
      */
     uint64_t get_xlen_from_reg(RegisterValue reg) const;
 
+    /** Pipeline state and counters, see `Machine::snapshot`. */
+    struct Snapshot {
+        CoreState state {};
+        InstructionClass prev_inst_class = IC_ALU;
+        Address prev_inst_addr = Address::null();
+    };
+    Snapshot snapshot() const;
+    /** Restores snapshot of the core of the same kind. Emits `step_done` when not headless. */
+    void restore(const Snapshot &snapshot);
+
+    /**
+     * Brings registers to the architectural state, so that another core sharing them can
+     * continue the execution (see `Machine::set_sampling`). Instructions which already accessed
+     * memory are completed, younger ones are discarded and PC points to the first of them.
+     */
+    virtual void drain() {}
+    /** Registers exception handlers of `other` (they are shared) and copies its stop settings. */
+    void copy_exception_setup(const Core &other);
+
+    /** Replaces the cycle cost model (built-in `TimingModel` by default). */
+    void set_timing_model(const TimingModel &model);
+
 protected:
     CoreState state {};
 
@@ -98,6 +158,10 @@ signals:
 protected:
     virtual void do_step(bool skip_break) = 0;
     virtual void do_reset() = 0;
+    virtual void do_snapshot(Snapshot &) const {}
+    virtual void do_restore(const Snapshot &) {}
+    /** Drops instructions decoded by the core besides `decode_cache`. */
+    virtual void do_invalidate_decoded() {}
 
     bool handle_exception(
         ExceptionCause excause,
@@ -120,9 +184,31 @@ protected:
     QMap<Address, OWNED hwBreak *> hw_breaks {};
     QMap<ExceptionCause, OWNED ExceptionHandler *> ex_handlers;
     Box<ExceptionHandler> ex_default_handler;
-    InstructionFlags prev_inst_flags {};
+    /** Class of the last decoded instruction, chaining rules of `TimingModel` depend on it. */
+    InstructionClass prev_inst_class = IC_ALU;
+    bool headless = false;
+    /** Condition ending the stall of the core, see `stall_until`. */
+    std::function<bool()> stall_resume;
+    /** Stop conditions of `step_block`, see `set_block_stop`. */
+    Address block_end_addr = Address(UINT64_MAX);
+    uint64_t block_cycle_limit = 0;
+    TimingTable timing {};
+    /** Decoded form of recently executed instructions, see `DecodeCache`. */
+    DecodeCache decode_cache { timing };
+
+    /** Checks the condition of `stall_until`, returns whether the core stays stalled. */
+    bool check_stall();
+
+    /** Adds cycles of one decoded instruction to the total and to its class. */
+    void account_cycles(InstructionClass inst_class, unsigned cycles) {
+        state.cycle_count += cycles;
+        state.class_cycles[inst_class] += cycles;
+        state.class_instructions[inst_class]++;
+    }
 
     FetchState fetch(PCInterstage pc, bool skip_break);
+    /** Fetch stage for instruction already read from program memory. */
+    FetchState fetch_instruction(Address inst_addr, const Instruction &inst, bool skip_break);
     DecodeState decode(const FetchInterstage &);
     ExecuteState execute(const DecodeInterstage &);
     MemoryState memory(const ExecuteInterstage &);
@@ -156,12 +242,42 @@ public:
         Xlen xlen,
         ConfigIsaWord isa_word);
 
+    /**
+     * In headless mode, runs the whole basic block starting at current PC using pre-bound
+     * handlers. Falls back to the stage model (`step`) for instructions which need it
+     * (exceptions, CSR, vector and AMO instructions), at a hardware breakpoint or when
+     * an interrupt is pending. Breakpoints, interrupts and the stop conditions of
+     * `set_block_stop` are checked before each instruction of the block, the block ends
+     * before the first instruction where any of them applies.
+     */
+    unsigned step_block(bool skip_break = false) override;
+
 protected:
     void do_step(bool skip_break) override;
     void do_reset() override;
+    void do_snapshot(Snapshot &snapshot) const override;
+    void do_restore(const Snapshot &snapshot) override;
+    void do_invalidate_decoded() override;
 
 private:
     Address prev_inst_addr {};
+    BlockCache block_cache {};
+
+    /** Runs decode, execute, memory and writeback stages for fetched instruction. */
+    void execute_stages(const FetchState &fetched);
+    bool interrupt_pending() const;
+    /** Whether a block has to end before the instruction at `inst_addr`. */
+    bool block_stop_reached(Address inst_addr) const;
+    void build_block(BasicBlock &block, Address start);
+    BlockOpHandler select_block_handler(const DecodedInstruction &decoded) const;
+
+    static Address block_exec_alu(CoreSingle &core, const BlockOp &op);
+    static Address block_exec_load(CoreSingle &core, const BlockOp &op);
+    static Address block_exec_store(CoreSingle &core, const BlockOp &op);
+    static Address block_exec_branch(CoreSingle &core, const BlockOp &op);
+    static Address block_exec_jal(CoreSingle &core, const BlockOp &op);
+    static Address block_exec_jalr(CoreSingle &core, const BlockOp &op);
+    RegisterValue block_alu_value(const BlockOp &op) const;
 };
 
 class CorePipelined : public Core {
@@ -178,6 +294,8 @@ public:
         // Forward was chosen as the most conservative variant (regarding correctness).
         MachineConfig::HazardUnit hazard_unit = MachineConfig::HazardUnit::HU_STALL_FORWARD);
 
+    void drain() override;
+
 protected:
     void do_step(bool skip_break) override;
     void do_reset() override;
@@ -185,7 +303,19 @@ protected:
 private:
     MachineConfig::HazardUnit hazard_unit;
 
+    /**
+     * Stalls or forwards operands of the instruction in ID/EX written by instructions further in
+     * the pipeline (see `Scoreboard`).
+     *
+     * @return true when the pipeline has to stall
+     */
     bool handle_data_hazards();
+    /** Forwards the value of `operand` register (if pending) into `value`. */
+    void forward_operand(
+        const Scoreboard &scoreboard,
+        RegisterMask operand,
+        RegisterValueUnion &value,
+        ForwardFrom &forward_from) const;
     bool detect_mispredicted_jump() const;
 
     /** Some special instruction require that all issued instructions are committed before this
@@ -216,6 +346,18 @@ public:
         Address jump_branch_pc,
         Address mem_ref_addr)
         = 0;
+
+    /**
+     * Stores state the handler keeps between exceptions (e.g. emulated operating system) into
+     * a machine checkpoint (see `Machine::save_checkpoint`). Stateless handlers store nothing.
+     * Throws `SimulatorExceptionInput` when the state cannot be stored.
+     */
+    virtual void save_checkpoint(QDataStream &out) const { (void)out; }
+    /**
+     * Restores state written by `save_checkpoint`. Throws `SimulatorExceptionInput` and keeps
+     * the current state when the data are invalid.
+     */
+    virtual void load_checkpoint(QDataStream &in) { (void)in; }
 };
 
 class StopExceptionHandler : public ExceptionHandler {
@@ -7,7 +7,10 @@
 #include "machine/memory/memory_bus.h"
 #include "machine/predictor.h"
 
+#include <QThread>
 #include <QVector>
+#include <functional>
+#include <memory>
 
 using std::vector;
 
@@ -1044,6 +1047,523 @@ void TestCore::pipecore_wb_memory_tests() {
     run_code_fragment(core, reg_init, reg_res, mem_init, mem_res, code);
 }
 
+void TestCore::singlecore_decode_cache_invalidation() {
+    Memory memory_backend(BIG);
+    TrivialBus memory(&memory_backend);
+    Registers registers {};
+    BranchPredictor predictor {};
+    CSR::ControlState controlst {};
+    CoreSingle core(&registers, &predictor, &memory, &memory, &controlst, Xlen::_32, config_isa_word_default);
+
+    compile_simple_program(memory, 0x200_addr, { "addi x10, x0, 1" });
+    registers.write_pc(0x200_addr);
+    core.step();
+    QCOMPARE(registers.read_gp(10).as_u32(), 1U);
+
+    registers.write_pc(0x200_addr);
+    core.step();
+    QCOMPARE(registers.read_gp(10).as_u32(), 1U);
+    QCOMPARE(core.get_decode_cache().get_hits(), uint64_t(1));
+
+    // Code rewritten in memory has to be decoded again.
+    compile_simple_program(memory, 0x200_addr, { "addi x10, x0, 2" });
+    registers.write_pc(0x200_addr);
+    core.step();
+    QCOMPARE(registers.read_gp(10).as_u32(), 2U);
+    QCOMPARE(core.get_decode_cache().get_misses(), uint64_t(2));
+}
+
+void TestCore::singlecore_block_dispatch() {
+    const std::vector<QString> program {
+        "addi x1, x0, 10",   "addi x10, x0, 0", "add x10, x10, x1", "addi x1, x1, -1",
+        "bne x1, x0, 0x208", "sw x10, 0x400(x0)", "lw x11, 0x400(x0)", "nop",
+    };
+    const size_t executed_count = 2 + 3 * 10 + 3;
+
+    Memory stage_backend(BIG);
+    TrivialBus stage_memory(&stage_backend);
+    Registers stage_regs {};
+    BranchPredictor stage_predictor {};
+    CSR::ControlState stage_controlst {};
+    CoreSingle stage_core(
+        &stage_regs, &stage_predictor, &stage_memory, &stage_memory, &stage_controlst, Xlen::_32,
+        config_isa_word_default);
+    compile_simple_program(stage_memory, 0x200_addr, program);
+    stage_regs.write_pc(0x200_addr);
+    for (size_t i = 0; i < executed_count; i++) {
+        stage_core.step();
+    }
+
+    Memory block_backend(BIG);
+    TrivialBus block_memory(&block_backend);
+    Registers block_regs {};
+    BranchPredictor block_predictor {};
+    CSR::ControlState block_controlst {};
+    CoreSingle block_core(
+        &block_regs, &block_predictor, &block_memory, &block_memory, &block_controlst, Xlen::_32,
+        config_isa_word_default);
+    block_core.set_headless(true);
+    compile_simple_program(block_memory, 0x200_addr, program);
+    block_regs.write_pc(0x200_addr);
+    size_t executed = 0;
+    while (executed < executed_count) {
+        executed += block_core.step_block();
+    }
+
+    QCOMPARE(executed, executed_count);
+    QCOMPARE(block_regs.read_gp(10).as_u32(), 55U);
+    QCOMPARE(block_regs.read_gp(11).as_u32(), 55U);
+    QCOMPARE(block_regs, stage_regs);
+    QCOMPARE(block_core.get_cycle_count(), stage_core.get_cycle_count());
+    QVERIFY(block_core.get_state().class_cycles == stage_core.get_state().class_cycles);
+    QVERIFY(
+        block_core.get_state().class_instructions == stage_core.get_state().class_instructions);
+    QCOMPARE(
+        block_controlst.read_internal(CSR::Id::MINSTRET).as_u64(),
+        stage_controlst.read_internal(CSR::Id::MINSTRET).as_u64());
+}
+
+void TestCore::singlecore_block_stop() {
+    const std::vector<QString> program {
+        "addi x1, x0, 1", "addi x2, x0, 2", "addi x3, x0, 3", "addi x4, x0, 4",
+        "addi x5, x0, 5", "addi x6, x0, 6", "addi x7, x0, 7", "jal x0, 0x200",
+    };
+
+    Memory backend(BIG);
+    TrivialBus memory(&backend);
+    Registers regs {};
+    BranchPredictor predictor {};
+    CSR::ControlState controlst {};
+    CoreSingle core(
+        &regs, &predictor, &memory, &memory, &controlst, Xlen::_32, config_isa_word_default);
+    core.set_headless(true);
+    compile_simple_program(memory, 0x200_addr, program);
+    regs.write_pc(0x200_addr);
+
+    // Block ends before a breakpoint, the breakpoint is skipped when the run resumes.
+    core.insert_hwbreak(0x208_addr);
+    QCOMPARE(core.step_block(), 2U);
+    QCOMPARE(regs.read_pc(), 0x208_addr);
+    QCOMPARE(regs.read_gp(3).as_u32(), 0U);
+    core.remove_hwbreak(0x208_addr);
+
+    // Block ends before the end address.
+    core.set_block_stop(0x210_addr, 0);
+    QCOMPARE(core.step_block(), 2U);
+    QCOMPARE(regs.read_pc(), 0x210_addr);
+    QCOMPARE(core.step_block(), 1U);
+
+    // Block ends once the cycle limit is reached.
+    core.set_block_stop(Address(UINT64_MAX), core.get_cycle_count() + 1);
+    QCOMPARE(core.step_block(), 1U);
+    QCOMPARE(regs.read_pc(), 0x218_addr);
+    core.set_block_stop(Address(UINT64_MAX), 0);
+    QCOMPARE(core.step_block(), 2U);
+    QCOMPARE(regs.read_pc(), 0x200_addr);
+    QCOMPARE(regs.read_gp(7).as_u32(), 7U);
+}
+
+void TestCore::pipecore_vector_hazards() {
+    // Vector and general purpose registers of the same number must not be treated as dependent.
+    // Register v0 is hardwired to zero like x0, the discarded result written to it must be
+    // neither forwarded nor waited for.
+    std::vector<QString> program {
+        "vsetvl x5, x1, x0",    "vadd.vv v1, v2, v3", "vadd.vv v4, v1, v1",
+        "addi x1, x1, 1",       "vadd.vv v0, v2, v2", "vadd.vv v5, v0, v3",
+        "vadd.vx v6, v5, x1",   "vsw.v v6, 0x400(x0)",
+    };
+    program.push_back(QString("jal x0, 0x%1").arg(0x200 + 4 * program.size(), 0, 16));
+
+    Registers regs_init {};
+    regs_init.write_gp(1, 4);
+    regs_init.write_vr(2, VectorRegisterValue({ 1, 2, 3, 4 }));
+    regs_init.write_vr(3, VectorRegisterValue({ 10, 20, 30, 40 }));
+    regs_init.write_pc(0x200_addr);
+
+    const auto run = [&](MachineConfig::HazardUnit hazard_unit, bool pipelined) {
+        Memory backend(LITTLE);
+        TrivialBus memory(&backend);
+        Registers regs(regs_init);
+        BranchPredictor predictor {};
+        CSR::ControlState controlst {};
+        compile_simple_program(memory, 0x200_addr, program);
+        std::unique_ptr<Core> core;
+        if (pipelined) {
+            core = std::make_unique<CorePipelined>(
+                &regs, &predictor, &memory, &memory, &controlst, Xlen::_32,
+                config_isa_word_default, hazard_unit);
+        } else {
+            core = std::make_unique<CoreSingle>(
+                &regs, &predictor, &memory, &memory, &controlst, Xlen::_32,
+                config_isa_word_default);
+        }
+        for (int i = 0; i < 40; i++) {
+            core->step();
+        }
+        regs.write_pc(0x200_addr);
+        return std::make_pair(regs.snapshot(), core->get_stall_count());
+    };
+
+    // Elements past vl are left undefined by vector operations.
+    using Snapshot = Registers::Snapshot;
+    const auto same_active_elements = [](const Snapshot &a, const Snapshot &b) {
+        for (size_t reg = 0; reg < REGISTER_COUNT; reg++) {
+            for (size_t i = 0; i < 4; i++) {
+                if (a.vr[reg][i] != b.vr[reg][i]) { return false; }
+            }
+        }
+        return true;
+    };
+
+    const auto expected = run(MachineConfig::HU_NONE, false);
+    QCOMPARE(expected.first.gp[1], RegisterValue(5));
+    QCOMPARE(expected.first.vr[4][3], uint32_t(88));
+    QCOMPARE(expected.first.vr[0][0], uint32_t(0));
+    QCOMPARE(expected.first.vr[5][0], uint32_t(10));
+    QCOMPARE(expected.first.vr[6][0], uint32_t(15));
+    const auto forwarded = run(MachineConfig::HU_STALL_FORWARD, true);
+    QVERIFY(forwarded.first.gp == expected.first.gp);
+    QVERIFY(same_active_elements(forwarded.first, expected.first));
+    QCOMPARE(forwarded.first.vr[5][3], uint32_t(40));
+    // Vector results are forwarded from the ALU, no stall is needed.
+    QCOMPARE(forwarded.second, uint64_t(0));
+    const auto stalled = run(MachineConfig::HU_STALL, true);
+    QVERIFY(stalled.first.gp == expected.first.gp);
+    QVERIFY(same_active_elements(stalled.first, expected.first));
+    QVERIFY(stalled.second > 0);
+}
+
+/** Runs a function in its own thread. */
+class FunctionThread : public QThread {
+public:
+    explicit FunctionThread(std::function<void()> function) : function(std::move(function)) {}
+
+protected:
+    void run() override { function(); }
+
+private:
+    std::function<void()> function;
+};
+
+void TestCore::pipecore_vector_threads() {
+    // Machines in the batch mode run vector code on many short lived threads, their values must
+    // not depend on how many threads simulated vector instructions before.
+    std::vector<QString> program {
+        "vsetvl x5, x1, x0",
+        "vadd.vv v1, v2, v3",
+        "vadd.vv v4, v1, v1",
+    };
+    program.push_back(QString("jal x0, 0x%1").arg(0x200 + 4 * program.size(), 0, 16));
+    const auto run = [&program]() {
+        Memory backend(LITTLE);
+        TrivialBus memory(&backend);
+        Registers regs {};
+        regs.write_gp(1, 4);
+        regs.write_vr(2, VectorRegisterValue({ 1, 2, 3, 4 }));
+        regs.write_vr(3, VectorRegisterValue({ 10, 20, 30, 40 }));
+        regs.write_pc(0x200_addr);
+        BranchPredictor predictor {};
+        CSR::ControlState controlst {};
+        compile_simple_program(memory, 0x200_addr, program);
+        CorePipelined core(
+            &regs, &predictor, &memory, &memory, &controlst, Xlen::_32,
+            config_isa_word_default);
+        for (int i = 0; i < 12; i++) {
+            core.step();
+        }
+        return regs.read_vr(4)[3];
+    };
+
+    constexpr size_t SEQUENTIAL_THREADS = 300;
+    constexpr size_t PARALLEL_THREADS = 8;
+    std::vector<uint32_t> results(SEQUENTIAL_THREADS + PARALLEL_THREADS, 0);
+    for (size_t i = 0; i < SEQUENTIAL_THREADS; i++) {
+        FunctionThread thread([&results, &run, i] { results[i] = run(); });
+        thread.start();
+        thread.wait();
+    }
+    std::vector<std::unique_ptr<FunctionThread>> threads;
+    for (size_t i = SEQUENTIAL_THREADS; i < results.size(); i++) {
+        threads.push_back(
+            std::make_unique<FunctionThread>([&results, &run, i] { results[i] = run(); }));
+        threads.back()->start();
+    }
+    for (auto &thread : threads) {
+        thread->wait();
+    }
+
+    for (uint32_t result : results) {
+        QCOMPARE(result, uint32_t(88));
+    }
+}
+
+void TestCore::singlecore_diagnostic_counters() {
+    const std::vector<QString> program {
+        "vsetvl x5, x1, x0",
+        "vadd.vv v1, v2, v3",
+        "vmul.vv v4, v1, v1",
+    };
+
+    Memory backend(LITTLE);
+    TrivialBus memory(&backend);
+    Registers regs {};
+    regs.write_gp(1, 4);
+    BranchPredictor predictor {};
+    CSR::ControlState controlst {};
+    CoreSingle core(
+        &regs, &predictor, &memory, &memory, &controlst, Xlen::_32, config_isa_word_default);
+    compile_simple_program(memory, 0x200_addr, program);
+    memory.write_u32(0x20c_addr, 0x0000000b); // Unknown encoding (custom-0 opcode).
+    regs.write_pc(0x200_addr);
+    for (size_t i = 0; i < program.size(); i++) {
+        core.step();
+    }
+    bool thrown = false;
+    try {
+        core.step();
+    } catch (SimulatorException &) { thrown = true; }
+    QVERIFY(thrown);
+
+    // Counters belong to the core, not to the thread stepping it.
+    const CoreState &state = core.get_state();
+    QCOMPARE(state.vector_alu.add_vv, uint64_t(1));
+    QCOMPARE(state.vector_alu.mul_vv, uint64_t(1));
+    QCOMPARE(state.vector_alu.elements, uint64_t(8));
+    QCOMPARE(state.decode.unknown_instructions, uint64_t(1));
+    QCOMPARE(state.decode.last_unknown_code, uint32_t(0x0000000b));
+
+    core.reset();
+    QCOMPARE(core.get_state().vector_alu.elements, uint64_t(0));
+    QCOMPARE(core.get_state().decode.unknown_instructions, uint64_t(0));
+}
+
+void TestCore::core_timing_model() {
+    const std::vector<QString> program {
+        "addi x1, x0, 3", "mul x2, x1, x1", "add x3, x2, x1", "nop",
+    };
+
+    TimingModel model;
+    model.set_class_cost(IC_ALU, { 1, 0 });
+    model.set_mnemonic_cost("mul", { 20, 0 });
+    model.set_chaining_rules({ { IC_MUL, IC_ALU, { 2, 0 } } });
+    QCOMPARE(TimingModel::from_json(model.to_json()), model);
+    bool thrown = false;
+    try {
+        TimingModel::from_json(QJsonObject { { "classes", QJsonObject { { "fpu", 1 } } } });
+    } catch (SimulatorExceptionInput &) { thrown = true; }
+    QVERIFY(thrown);
+
+    Memory backend(BIG);
+    TrivialBus memory(&backend);
+    Registers regs {};
+    BranchPredictor predictor {};
+    CSR::ControlState controlst {};
+    CoreSingle core(
+        &regs, &predictor, &memory, &memory, &controlst, Xlen::_32, config_isa_word_default);
+    compile_simple_program(memory, 0x200_addr, program);
+    regs.write_pc(0x200_addr);
+    for (int i = 0; i < 3; i++) {
+        core.step();
+    }
+    QCOMPARE(core.get_cycle_count(), uint64_t(5 + 8 + 5));
+
+    core.reset();
+    core.set_timing_model(model);
+    regs.write_pc(0x200_addr);
+    for (int i = 0; i < 3; i++) {
+        core.step();
+    }
+    // Add following the multiplication is adjusted by the chaining rule.
+    QCOMPARE(core.get_cycle_count(), uint64_t(1 + 20 + (1 + 2)));
+    QCOMPARE(core.get_state().class_cycles[IC_MUL], uint64_t(20));
+}
+
+void TestCore::core_counters_64bit() {
+    const std::vector<QString> program {
+        "addi x1, x0, 3", "mul x2, x1, x1", "sw x2, 0x400(x0)", "addi x1, x1, -1",
+        "bne x1, x0, 0x204",
+    };
+
+    Memory backend(BIG);
+    TrivialBus memory(&backend);
+    Registers regs {};
+    BranchPredictor predictor {};
+    CSR::ControlState controlst(Xlen::_32, config_isa_word_default);
+    CorePipelined core(
+        &regs, &predictor, &memory, &memory, &controlst, Xlen::_32, config_isa_word_default);
+    std::vector<QString> padded_program = program;
+    padded_program.resize(program.size() + 20, "nop");
+    compile_simple_program(memory, 0x200_addr, padded_program);
+    regs.write_pc(0x200_addr);
+    // Counters of RV32 continue past 32 bits, instructions read their low half.
+    controlst.increment_internal(CSR::Id::MINSTRET, 0xffffffffULL);
+    controlst.increment_internal(CSR::Id::MCYCLE, 0xffffffffULL);
+    for (int i = 0; i < 30; i++) {
+        core.step();
+    }
+    const uint64_t minstret = controlst.read_internal(CSR::Id::MINSTRET).as_u64();
+    QVERIFY(minstret > 0xffffffffULL);
+    QCOMPARE(controlst.read(CSR::Address(0xB02)).as_u64(), minstret & 0xffffffffULL);
+    QCOMPARE(
+        controlst.read_internal(CSR::Id::CYCLE).as_u64(),
+        controlst.read_internal(CSR::Id::MCYCLE).as_u64());
+    QCOMPARE(controlst.read(CSR::Address(0xB82)).as_u64(), minstret >> 32);
+    QCOMPARE(controlst.read(CSR::Address(0xC82)).as_u64(), minstret >> 32);
+    QCOMPARE(controlst.read(CSR::Address(0xC02)).as_u64(), minstret & 0xffffffffULL);
+    QCOMPARE(controlst.read(CSR::Address(0xC80)).as_u64(), uint64_t(1));
+    // Writes of RV32 counter halves keep the other half.
+    controlst.write(CSR::Address(0xB80), 0x12U);
+    controlst.write(CSR::Address(0xB00), 0x34U);
+    QCOMPARE(controlst.read_internal(CSR::Id::MCYCLE).as_u64(), 0x1200000034ULL);
+    QCOMPARE(controlst.read(CSR::Address(0xC80)).as_u64(), uint64_t(0x12));
+    QCOMPARE(controlst.read(CSR::Address(0xC00)).as_u64(), uint64_t(0x34));
+    // Upper halves do not exist on RV64.
+    CSR::ControlState controlst64(Xlen::_64, config_isa_word_default);
+    bool thrown = false;
+    try {
+        (void)controlst64.read(CSR::Address(0xB80));
+    } catch (SimulatorExceptionUnsupportedInstruction &) { thrown = true; }
+    QVERIFY(thrown);
+
+    // Breakdown accounts all cycles of the cost model.
+    const CoreState &state = core.get_state();
+    uint64_t class_cycles = 0;
+    for (uint64_t cycles : state.class_cycles) {
+        class_cycles += cycles;
+    }
+    QCOMPARE(class_cycles, core.get_cycle_count());
+    QVERIFY(state.class_instructions[IC_MUL] >= 3);
+    QVERIFY(state.class_instructions[IC_MEM] >= 3);
+    QCOMPARE(state.class_cycles[IC_MUL], state.class_instructions[IC_MUL] * 8);
+    QCOMPARE(state.class_cycles[IC_MEM], state.class_instructions[IC_MEM] * 36);
+}
+
+void TestCore::pipelinecore_snapshot_restore() {
+    const std::vector<QString> program {
+        "addi x1, x0, 10",   "addi x10, x0, 0", "add x10, x10, x1", "addi x1, x1, -1",
+        "bne x1, x0, 0x208", "sw x10, 0x400(x0)", "lw x11, 0x400(x0)", "beq x0, x0, 0x21c",
+        "nop",               "nop",             "nop",
+    };
+
+    Memory backend(BIG, MemoryLayout::PAGED);
+    TrivialBus memory(&backend);
+    Registers regs {};
+    BranchPredictor predictor(true, PredictorType::SMITH_2_BIT);
+    CSR::ControlState controlst {};
+    CorePipelined core(
+        &regs, &predictor, &memory, &memory, &controlst, Xlen::_32, config_isa_word_default);
+    compile_simple_program(memory, 0x200_addr, program);
+    regs.write_pc(0x200_addr);
+    for (int i = 0; i < 17; i++) {
+        core.step();
+    }
+
+    // Snapshot is taken with instructions in flight.
+    const Registers::Snapshot regs_snapshot = regs.snapshot();
+    const CSR::ControlState::Snapshot controlst_snapshot = controlst.snapshot();
+    const BranchPredictor::Snapshot predictor_snapshot = predictor.snapshot();
+    const Core::Snapshot core_snapshot = core.snapshot();
+    const Memory memory_snapshot(backend);
+    const uint64_t cycles_snapshot = core.get_cycle_count();
+
+    for (int i = 0; i < 60; i++) {
+        core.step();
+    }
+    QCOMPARE(regs.read_gp(11).as_u32(), 55U);
+    const Registers regs_done(regs);
+    const uint64_t cycles_done = core.get_cycle_count();
+    const uint64_t minstret_done = controlst.read_internal(CSR::Id::MINSTRET).as_u64();
+    QVERIFY(backend != memory_snapshot);
+
+    regs.restore(regs_snapshot);
+    controlst.restore(controlst_snapshot);
+    predictor.restore(predictor_snapshot);
+    core.restore(core_snapshot);
+    backend.reset(memory_snapshot);
+    QCOMPARE(backend, memory_snapshot);
+    QCOMPARE(core.get_cycle_count(), cycles_snapshot);
+
+    for (int i = 0; i < 60; i++) {
+        core.step();
+    }
+    QCOMPARE(regs, regs_done);
+    QCOMPARE(core.get_cycle_count(), cycles_done);
+    QCOMPARE(controlst.read_internal(CSR::Id::MINSTRET).as_u64(), minstret_done);
+    QCOMPARE(memory.read_u32(0x400_addr), 55U);
+}
+
+/** Vector payloads of pipeline values, in order of `for_each_pipeline_value`. */
+static std::vector<vector_register_storage_t> pipeline_vectors(const Pipeline &pipeline) {
+    std::vector<vector_register_storage_t> vectors;
+    for_each_pipeline_value(pipeline, [&vectors](const RegisterValueUnion &value) {
+        if (value.type == REGISTER_VALUE_TYPE_V) { vectors.push_back(value.v.storage()); }
+    });
+    return vectors;
+}
+
+void TestCore::pipecore_vector_snapshot() {
+    // Snapshot owns the vector values in flight, the running core producing further vector
+    // results must not change them.
+    std::vector<QString> program {
+        "vsetvl x5, x1, x0",  "vadd.vv v1, v2, v3", "vadd.vv v4, v1, v1",
+        "vadd.vv v2, v4, v3", "addi x1, x1, 1",     "jal x0, 0x204",
+    };
+    Memory backend(LITTLE);
+    TrivialBus memory(&backend);
+    Registers regs {};
+    regs.write_gp(1, 4);
+    regs.write_vr(2, VectorRegisterValue({ 1, 2, 3, 4 }));
+    regs.write_vr(3, VectorRegisterValue({ 10, 20, 30, 40 }));
+    regs.write_pc(0x200_addr);
+    BranchPredictor predictor {};
+    CSR::ControlState controlst {};
+    compile_simple_program(memory, 0x200_addr, program);
+    CorePipelined core(
+        &regs, &predictor, &memory, &memory, &controlst, Xlen::_32, config_isa_word_default);
+    for (int i = 0; i < 6; i++) {
+        core.step();
+    }
+
+    const Core::Snapshot snapshot = core.snapshot();
+    const auto vectors = pipeline_vectors(snapshot.state.pipeline);
+    QVERIFY(!vectors.empty());
+    for (int i = 0; i < 200; i++) {
+        core.step();
+    }
+    QVERIFY(pipeline_vectors(snapshot.state.pipeline) == vectors);
+    core.restore(snapshot);
+    QVERIFY(pipeline_vectors(core.snapshot().state.pipeline) == vectors);
+}
+
+/** Layout of the value union with the vector payload stored inline. */
+struct InlineVectorRegisterValueUnion {
+    RegisterValueType type;
+    union {
+        RegisterValue i;
+        VectorRegisterValue v;
+    };
+};
+
+void TestCore::interstage_bytes_copied() {
+    // Each stage result is returned by value and stored into the pipeline once per step.
+    constexpr size_t bytes_per_step = sizeof(FetchState) + sizeof(DecodeState)
+                                      + sizeof(ExecuteState) + sizeof(MemoryState)
+                                      + sizeof(WritebackState);
+    const Pipeline pipeline {};
+    size_t value_fields = 0;
+    for_each_pipeline_value(pipeline, [&value_fields](const RegisterValueUnion &) {
+        value_fields++;
+    });
+    const size_t inline_bytes_per_step
+        = bytes_per_step
+          + value_fields * (sizeof(InlineVectorRegisterValueUnion) - sizeof(RegisterValueUnion));
+    qInfo(
+        "interstage bytes copied per step: %zu (with inline vector payload: %zu)", bytes_per_step,
+        inline_bytes_per_step);
+    QVERIFY(sizeof(RegisterValueUnion) * 4 <= sizeof(InlineVectorRegisterValueUnion));
+    QVERIFY(bytes_per_step * 2 < inline_bytes_per_step);
+}
+
 void extension_m_data() {
     QTest::addColumn<vector<QString>>("instructions");
     QTest::addColumn<Registers>("registers");
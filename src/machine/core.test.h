@@ -36,6 +36,17 @@ private slots:
     void pipecore_wt_na_memory_tests();
     void pipecore_wt_a_memory_tests();
     void pipecore_wb_memory_tests();
+    void singlecore_decode_cache_invalidation();
+    void singlecore_block_dispatch();
+    void singlecore_block_stop();
+    void pipecore_vector_hazards();
+    void pipecore_vector_threads();
+    void pipelinecore_snapshot_restore();
+    void pipecore_vector_snapshot();
+    void interstage_bytes_copied();
+    void core_counters_64bit();
+    void singlecore_diagnostic_counters();
+    void core_timing_model();
 
     // Extensions:
     // =============================================================================================
@@ -0,0 +1,77 @@
+#ifndef QTRVSIM_BLOCK_CACHE_H
+#define QTRVSIM_BLOCK_CACHE_H
+
+#include "core/decode_cache.h"
+#include "execute/alu.h"
+#include "instruction.h"
+#include "memory/address.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace machine {
+
+class CoreSingle;
+struct BlockOp;
+
+/**
+ * Executes single pre-decoded instruction and returns address of the next instruction.
+ */
+using BlockOpHandler = Address (*)(CoreSingle &core, const BlockOp &op);
+
+/**
+ * Instruction of a basic block with its handler bound at block discovery time.
+ */
+struct BlockOp {
+    DecodedInstruction decoded {};
+    Instruction inst {};
+    BlockOpHandler handler = nullptr;
+    AluComponent alu_component = AluComponent::ALU;
+    bool w_operation = false;
+};
+
+/**
+ * Straight sequence of instructions, which ends with (and includes) the first control transfer
+ * instruction or ends before the first instruction, which requires the full stage model.
+ */
+struct BasicBlock {
+    Address start = Address::null();
+    bool valid = false;
+    std::vector<BlockOp> ops {};
+};
+
+/**
+ * Direct mapped cache of basic blocks indexed by the address of their first instruction.
+ *
+ * Blocks are discovered without side effects on the memory subsystem (internal reads). Every
+ * instruction word is still fetched regularly when the block is executed and it is compared
+ * against the recorded one, so modified code is detected at the first instruction affected.
+ */
+class BlockCache {
+public:
+    /** Upper limit of instructions in a single block. */
+    static constexpr size_t MAX_BLOCK_LENGTH = 64;
+
+    explicit BlockCache(size_t size_log2 = 10)
+        : blocks(size_t(1) << size_log2)
+        , index_mask((size_t(1) << size_log2) - 1) {}
+
+    /** Slot where the block starting at `start` is (or would be) stored. */
+    BasicBlock &slot(Address start) { return blocks[(start.get_raw() >> 2) & index_mask]; }
+
+    /** Drops all blocks. */
+    void invalidate() {
+        for (auto &block : blocks) {
+            block.valid = false;
+            block.ops.clear();
+        }
+    }
+
+private:
+    std::vector<BasicBlock> blocks;
+    const size_t index_mask;
+};
+
+} // namespace machine
+
+#endif // QTRVSIM_BLOCK_CACHE_H
@@ -4,20 +4,47 @@
 #include "machinedefs.h"
 #include "pipeline.h"
 #include "common/memory_ownership.h"
+#include "execute/alu.h"
 #include "memory/address_range.h"
+#include "timing_model.h"
 
 #include <QMap>
+#include <array>
 #include <cstdint>
 #include <machineconfig.h>
 using std::uint32_t;
+using std::uint64_t;
 
 namespace machine {
 
+/**
+ * Diagnostic counters of instruction decoding.
+ *
+ * Decoding of unknown encodings is counted instead of printed. Individual lookups can be traced
+ * by enabling `machine.instruction.decode.trace` logging category in debug builds.
+ */
+struct DecodeCounters {
+    /** Decoded instructions which did not match any known encoding (flushed ones included). */
+    uint64_t unknown_instructions = 0;
+    /** The most recent unknown encoding. */
+    uint32_t last_unknown_code = 0;
+};
+
 struct CoreState {
     Pipeline pipeline = {};
     AddressRange LoadReservedRange;
-    uint32_t stall_count = 0;
-    uint32_t cycle_count = 0;
+    uint64_t stall_count = 0;
+    uint64_t cycle_count = 0;
+    /**
+     * Cycles of `cycle_count` split by instruction class, their sum equals `cycle_count`.
+     * Decodes repeated after a stall or flushed by a misprediction are accounted as well.
+     */
+    std::array<uint64_t, IC_COUNT> class_cycles {};
+    /** Decoded instructions of each class, counted the same way as `class_cycles`. */
+    std::array<uint64_t, IC_COUNT> class_instructions {};
+    /** Operations executed by the vector ALU. */
+    VectorAluCounters vector_alu {};
+    DecodeCounters decode {};
 };
 
 } // namespace machine
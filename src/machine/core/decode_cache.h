@@ -0,0 +1,132 @@
+#ifndef QTRVSIM_DECODE_CACHE_H
+#define QTRVSIM_DECODE_CACHE_H
+
+#include "csr/address.h"
+#include "execute/alu.h"
+#include "instruction.h"
+#include "memory/address.h"
+#include "registers.h"
+#include "core/scoreboard.h"
+#include "timing_model.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace machine {
+
+/** Class of the timing model the instruction is accounted to. */
+inline InstructionClass instruction_class(InstructionFlags flags) {
+    if (flags & IMF_MEM) { return (flags & IMF_VEC) ? IC_VEC_MEM : IC_MEM; }
+    if (flags & IMF_MUL) { return IC_MUL; }
+    if (flags & IMF_VEC_VL) { return IC_VEC_CONFIG; }
+    if (!(flags & IMF_VEC)) { return IC_ALU; }
+    if (flags & IMF_VEC_MUL) { return IC_VEC_MUL; }
+    if (flags & IMF_VEC_REDSUM) { return IC_VEC_REDSUM; }
+    return IC_VEC_ALU;
+}
+
+/**
+ * Statically decoded part of an instruction.
+ *
+ * Everything stored here depends only on the instruction word, so it can be reused whenever the
+ * same word is fetched from the same address again.
+ */
+struct DecodedInstruction {
+    Address inst_addr = Address::null();
+    uint32_t inst_word = 0;
+    bool valid = false;
+    InstructionFlags flags {};
+    AluCombinedOp alu_op {};
+    AccessControl mem_ctl {};
+    RegisterId num_rs = 0;
+    RegisterId num_rt = 0;
+    RegisterId num_rd = 0;
+    /** Registers read and written, see `Scoreboard`. */
+    RegisterMask rs_mask = 0;
+    RegisterMask rt_mask = 0;
+    RegisterMask rd_mask = 0;
+    int32_t immediate = 0;
+    CSR::Address csr_address { 0 };
+    InstructionClass inst_class = IC_ALU;
+    /** Cost of the instruction in `TimingTable`. */
+    uint16_t timing_slot = 0;
+};
+
+/**
+ * Direct mapped cache of decoded instructions indexed by PC.
+ *
+ * Each entry is validated against the instruction word which was just fetched from memory. Fetch
+ * still has to go through the memory frontend (caches account every access), so the validation
+ * is free and any modification of code (self-modifying programs, program reload, memory peek/poke
+ * from GUI) is picked up exactly without any explicit invalidation.
+ */
+class DecodeCache {
+public:
+    explicit DecodeCache(const TimingTable &timing, size_t size_log2 = 10)
+        : timing(timing)
+        , entries(size_t(1) << size_log2)
+        , index_mask((size_t(1) << size_log2) - 1) {}
+
+    /**
+     * Returns decoded form of the instruction `inst` located at `inst_addr`. Decodes and stores
+     * it, when it is not present yet.
+     */
+    const DecodedInstruction &lookup(Address inst_addr, const Instruction &inst) {
+        DecodedInstruction &entry = entries[(inst_addr.get_raw() >> 2) & index_mask];
+        if (entry.valid && entry.inst_word == inst.data() && entry.inst_addr == inst_addr) {
+            hits++;
+            return entry;
+        }
+        misses++;
+        decode(entry, inst_addr, inst, timing);
+        return entry;
+    }
+
+    /** Drops all entries. */
+    void invalidate() {
+        for (auto &entry : entries) {
+            entry.valid = false;
+        }
+        hits = 0;
+        misses = 0;
+    }
+
+    uint64_t get_hits() const { return hits; }
+    uint64_t get_misses() const { return misses; }
+
+    /** Fills `entry` with decoded form of `inst` located at `inst_addr`. */
+    static void decode(
+        DecodedInstruction &entry,
+        Address inst_addr,
+        const Instruction &inst,
+        const TimingTable &timing) {
+        entry.inst_addr = inst_addr;
+        entry.inst_word = inst.data();
+        inst.flags_alu_op_mem_ctl(entry.flags, entry.alu_op, entry.mem_ctl);
+        const InstructionFlags flags = entry.flags;
+        entry.num_rs = (flags & (IMF_ALU_REQ_RS | IMF_ALU_RS_ID)) ? inst.rs() : 0;
+        entry.num_rt = (flags & IMF_ALU_REQ_RT) ? inst.rt() : 0;
+        entry.num_rd = (flags & IMF_REGWRITE) ? inst.rd() : 0;
+        entry.rs_mask = rs_register_mask(flags, entry.num_rs);
+        entry.rt_mask = rt_register_mask(flags, entry.num_rt);
+        entry.rd_mask = rd_register_mask(flags, entry.num_rd);
+        entry.immediate = inst.immediate();
+        entry.csr_address = (flags & IMF_CSR) ? inst.csr_address() : CSR::Address(0);
+        entry.inst_class = instruction_class(flags);
+        // Instruction map is searched for the mnemonic only when any mnemonic has its own cost.
+        entry.timing_slot = timing.slot(
+            timing.has_mnemonic_costs() ? inst.mnemonic() : nullptr, entry.inst_class);
+        entry.valid = true;
+    }
+
+private:
+    const TimingTable &timing;
+    std::vector<DecodedInstruction> entries;
+    const size_t index_mask;
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+};
+
+} // namespace machine
+
+#endif // QTRVSIM_DECODE_CACHE_H
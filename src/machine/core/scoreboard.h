@@ -0,0 +1,77 @@
+#ifndef QTRVSIM_SCOREBOARD_H
+#define QTRVSIM_SCOREBOARD_H
+
+#include "instruction.h"
+#include "registers.h"
+
+#include <cstdint>
+
+namespace machine {
+
+/**
+ * Set of architectural registers, one bit per register.
+ *
+ * General purpose registers occupy the low half and vector registers the high half. Hazards of
+ * both register files are detected by a single AND, while registers with the same number in
+ * different files never alias. Registers `x0` and `v0` are never included, both are hardwired
+ * to zero and writes to them have no effect (see `Registers::write_vr`).
+ */
+using RegisterMask = uint64_t;
+
+static_assert(2 * REGISTER_COUNT <= 64, "Both register files have to fit in the mask.");
+
+constexpr RegisterMask GP_REGISTERS = (RegisterMask(1) << REGISTER_COUNT) - 1;
+constexpr RegisterMask VEC_REGISTERS = GP_REGISTERS << REGISTER_COUNT;
+
+inline RegisterMask gp_register_mask(RegisterId reg) {
+    return (RegisterMask(1) << size_t(reg)) & ~RegisterMask(1);
+}
+
+inline RegisterMask vec_register_mask(RegisterId reg) {
+    return (RegisterMask(1) << (REGISTER_COUNT + size_t(reg)))
+           & ~(RegisterMask(1) << REGISTER_COUNT);
+}
+
+/**
+ * Register read as the first operand by an instruction with `flags` (see `Core::decode`).
+ * Vector memory accesses take their address from a general purpose register.
+ */
+inline RegisterMask rs_register_mask(InstructionFlags flags, RegisterId reg) {
+    if (!(flags & IMF_ALU_REQ_RS)) { return 0; }
+    return ((flags & IMF_VEC) && !(flags & IMF_MEM)) ? vec_register_mask(reg)
+                                                    : gp_register_mask(reg);
+}
+
+/** Register read as the second operand by an instruction with `flags`. */
+inline RegisterMask rt_register_mask(InstructionFlags flags, RegisterId reg) {
+    if (!(flags & IMF_ALU_REQ_RT)) { return 0; }
+    return (flags & IMF_VEC_RT) ? vec_register_mask(reg) : gp_register_mask(reg);
+}
+
+/** Register written by an instruction with `flags`, reductions produce a scalar. */
+inline RegisterMask rd_register_mask(InstructionFlags flags, RegisterId reg) {
+    if (!(flags & IMF_REGWRITE)) { return 0; }
+    return ((flags & IMF_VEC) && !(flags & IMF_VEC_REDSUM)) ? vec_register_mask(reg)
+                                                           : gp_register_mask(reg);
+}
+
+/**
+ * Registers with writes pending in the pipeline.
+ *
+ * Built once per cycle, after the stages advance, from the interstage registers of the stages
+ * following decode (see `CorePipelined::handle_data_hazards`).
+ */
+struct Scoreboard {
+    /** Written by the instruction in EX/MEM, its value is forwarded from the ALU result. */
+    RegisterMask memory = 0;
+    /** Part of `memory` loaded from memory, the value is not available before writeback. */
+    RegisterMask memory_load = 0;
+    /** Written by the instruction in MEM/WB. */
+    RegisterMask writeback = 0;
+
+    [[nodiscard]] RegisterMask pending() const { return memory | writeback; }
+};
+
+} // namespace machine
+
+#endif // QTRVSIM_SCOREBOARD_H
@@ -42,6 +42,23 @@ namespace machine { namespace CSR {
         }
     }
 
+    ControlState::Snapshot ControlState::snapshot() const {
+        return { register_data };
+    }
+
+    void ControlState::restore(const Snapshot &snapshot) {
+        register_data = snapshot.register_data;
+        for (size_t i = 0; i < register_data.size(); i++) {
+            emit write_signal(i, register_data[i]);
+        }
+    }
+
+    /** Upper halves of counters exist only on RV32, RV64 CSR instructions can't access them. */
+    static bool is_rv32_only(size_t internal_id) {
+        return internal_id == Id::CYCLEH || internal_id == Id::INSTRETH
+               || internal_id == Id::MCYCLEH || internal_id == Id::MINSTRETH;
+    }
+
     size_t ControlState::get_register_internal_id(Address address) {
         // if (address.get_privilege_level() != PrivilegeLevel::MACHINE)
 
@@ -57,7 +74,14 @@ namespace machine { namespace CSR {
     RegisterValue ControlState::read(Address address) const {
         // Only machine level privilege is supported so no checking is needed.
         size_t reg_id = get_register_internal_id(address);
+        if (xlen != Xlen::_32 && is_rv32_only(reg_id)) {
+            throw SIMULATOR_EXCEPTION(
+                UnsupportedInstruction,
+                QString("CSR register %1 exists only on RV32").arg(address.data), "");
+        }
         RegisterValue value = register_data[reg_id];
+        // Counters are kept 64-bit wide, RV32 reads their low half.
+        if (xlen == Xlen::_32) { value = value.as_u32(); }
         DEBUG("Read CSR[%u] == 0x%" PRIx64, address.data, value.as_u64());
         emit read_signal(reg_id, value);
         return value;
@@ -73,7 +97,13 @@ namespace machine { namespace CSR {
                 UnsupportedInstruction,
                 QString("CSR address %1 is not writable.").arg(address.data), "");
         }
-        write_internal(get_register_internal_id(address), value);
+        size_t reg_id = get_register_internal_id(address);
+        if (xlen != Xlen::_32 && is_rv32_only(reg_id)) {
+            throw SIMULATOR_EXCEPTION(
+                UnsupportedInstruction,
+                QString("CSR register %1 exists only on RV32").arg(address.data), "");
+        }
+        write_internal(reg_id, value);
     }
 
     void ControlState::default_wlrl_write_handler(
@@ -99,9 +129,66 @@ namespace machine { namespace CSR {
         RegisterValue &reg,
         RegisterValue val) {
         Q_UNUSED(desc)
-        reg = val;
-        register_data[Id::CYCLE] = val;
-        write_signal(Id::CYCLE, register_data[Id::CYCLE]);
+        Q_UNUSED(reg)
+        write_counter(Id::MCYCLE, val.as_u64(), false);
+    }
+
+    void ControlState::minstret_wlrl_write_handler(
+        const RegisterDesc &desc,
+        RegisterValue &reg,
+        RegisterValue val) {
+        Q_UNUSED(desc)
+        Q_UNUSED(reg)
+        write_counter(Id::MINSTRET, val.as_u64(), false);
+    }
+
+    void ControlState::mcycleh_wlrl_write_handler(
+        const RegisterDesc &desc,
+        RegisterValue &reg,
+        RegisterValue val) {
+        Q_UNUSED(desc)
+        Q_UNUSED(reg)
+        write_counter(Id::MCYCLE, val.as_u64(), true);
+    }
+
+    void ControlState::minstreth_wlrl_write_handler(
+        const RegisterDesc &desc,
+        RegisterValue &reg,
+        RegisterValue val) {
+        Q_UNUSED(desc)
+        Q_UNUSED(reg)
+        write_counter(Id::MINSTRET, val.as_u64(), true);
+    }
+
+    void ControlState::write_counter(size_t counter_id, uint64_t value, bool upper_half) {
+        uint64_t counter = register_data[counter_id].as_u64();
+        if (upper_half) {
+            counter = (value << 32) | (counter & 0xffffffff);
+        } else if (xlen == Xlen::_32) {
+            counter = (counter & ~(uint64_t)0xffffffff) | (value & 0xffffffff);
+        } else {
+            counter = value;
+        }
+        set_counter(counter_id, counter);
+    }
+
+    void ControlState::set_counter(size_t counter_id, uint64_t value) {
+        const bool is_cycle = counter_id == Id::MCYCLE;
+        const size_t alias_id = is_cycle ? Id::CYCLE : Id::INSTRET;
+        const size_t upper_id = is_cycle ? Id::MCYCLEH : Id::MINSTRETH;
+        const size_t alias_upper_id = is_cycle ? Id::CYCLEH : Id::INSTRETH;
+        register_data[counter_id] = value;
+        register_data[alias_id] = value;
+        write_signal(counter_id, register_data[counter_id]);
+        write_signal(alias_id, register_data[alias_id]);
+        // Upper halves change once per 2^32 increments, their signals are emitted only then.
+        const uint64_t upper = value >> 32;
+        if (register_data[upper_id].as_u64() != upper) {
+            register_data[upper_id] = upper;
+            register_data[alias_upper_id] = upper;
+            write_signal(upper_id, register_data[upper_id]);
+            write_signal(alias_upper_id, register_data[alias_upper_id]);
+        }
     }
 
     bool ControlState::operator==(const ControlState &other) const {
@@ -202,7 +289,13 @@ namespace machine { namespace CSR {
         write_signal(internal_id, reg);
     }
     void ControlState::increment_internal(size_t internal_id, uint64_t amount) {
-        auto value = register_data[internal_id];
-        write_internal(internal_id, value.as_u64() + amount);
+        // Write handlers would truncate counters to XLEN, they are 64-bit wide on RV32 as well.
+        if (internal_id == Id::MCYCLE || internal_id == Id::MINSTRET) {
+            set_counter(internal_id, register_data[internal_id].as_u64() + amount);
+            return;
+        }
+        RegisterValue &reg = register_data[internal_id];
+        reg = reg.as_u64() + amount;
+        write_signal(internal_id, reg);
     }
 }} // namespace machine::CSR
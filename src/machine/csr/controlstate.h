@@ -20,6 +20,9 @@ namespace machine { namespace CSR {
         enum IdxType{
             // Unprivileged Counter/Timers
             CYCLE,
+            INSTRET,
+            CYCLEH,
+            INSTRETH,
             // Machine Information Registers
             MVENDORID,
             MARCHID,
@@ -46,6 +49,8 @@ namespace machine { namespace CSR {
             // ...
             MCYCLE,
             MINSTRET,
+            MCYCLEH,
+            MINSTRETH,
             _COUNT,
         };
     };
@@ -104,12 +109,21 @@ namespace machine { namespace CSR {
         void write_internal(size_t internal_id, RegisterValue value);
 
         /** Shorthand for counter incrementing. Counters like time might have different increment
-         * amount. */
+         * amount. Counters are incremented in full 64 bits regardless of XLEN, MCYCLE and MINSTRET
+         * update their aliases through `set_counter`. */
         void increment_internal(size_t internal_id, uint64_t amount);
 
         /** Reset data to initial values */
         void reset();
 
+        /** Values of all CSR registers, see `Machine::snapshot`. */
+        struct Snapshot {
+            std::array<RegisterValue, Id::_COUNT> register_data {};
+        };
+        [[nodiscard]] Snapshot snapshot() const;
+        /** Restores all registers without write handlers, emits write signal for each. */
+        void restore(const Snapshot &snapshot);
+
         /** Read CSR register field */
         RegisterValue read_field(const RegisterFieldDesc &field_desc) const {
             return field_desc.decode(read_internal(field_desc.regId).as_u64());
@@ -142,6 +156,15 @@ namespace machine { namespace CSR {
     private:
         static size_t get_register_internal_id(Address address);
 
+        /**
+         * Set 64-bit machine counter (MCYCLE or MINSTRET) and its aliases: the unprivileged
+         * counter (CYCLE, INSTRET) and the RV32 upper halves of both. All counter updates
+         * (increments and CSR writes) go through here.
+         */
+        void set_counter(size_t counter_id, uint64_t value);
+        /** CSR write of a counter, RV32 writes only the selected half of the 64-bit value. */
+        void write_counter(size_t counter_id, uint64_t value, bool upper_half);
+
         /** Write CSR register field without write handler, read-only masking and signal */
         void write_field_raw(const RegisterFieldDesc &field_desc, uint64_t value) {
             uint64_t u = register_data[field_desc.regId].as_u64();
@@ -170,6 +193,18 @@ namespace machine { namespace CSR {
             const RegisterDesc &desc,
             RegisterValue &reg,
             RegisterValue val);
+        void minstret_wlrl_write_handler(
+            const RegisterDesc &desc,
+            RegisterValue &reg,
+            RegisterValue val);
+        void mcycleh_wlrl_write_handler(
+            const RegisterDesc &desc,
+            RegisterValue &reg,
+            RegisterValue val);
+        void minstreth_wlrl_write_handler(
+            const RegisterDesc &desc,
+            RegisterValue &reg,
+            RegisterValue val);
     };
 
     struct RegisterDesc {
@@ -207,6 +242,10 @@ namespace machine { namespace CSR {
     inline constexpr std::array<RegisterDesc, Id::_COUNT> REGISTERS { {
         // Unprivileged Counter/Timers
         [Id::CYCLE] = { "cycle", 0xC00_csr, "Cycle counter for RDCYCLE instruction.", 0, 0},
+        [Id::INSTRET] = { "instret", 0xC02_csr,
+                        "Instructions-retired counter for RDINSTRET instruction.", 0, 0},
+        [Id::CYCLEH] = { "cycleh", 0xC80_csr, "Upper 32 bits of cycle, RV32 only.", 0, 0},
+        [Id::INSTRETH] = { "instreth", 0xC82_csr, "Upper 32 bits of instret, RV32 only.", 0, 0},
         // Priviledged Machine Mode Registers
         [Id::MVENDORID] = { "mvendorid", 0xF11_csr, "Vendor ID.", 0, 0},
         [Id::MARCHID] = { "marchid", 0xF12_csr, "Architecture ID.", 0, 0},
@@ -230,7 +269,12 @@ namespace machine { namespace CSR {
         // Machine Counter/Timers
         [Id::MCYCLE] = { "mcycle", 0xB00_csr, "Machine cycle counter.",
                         0, (register_storage_t)0xffffffffffffffff, &ControlState::mcycle_wlrl_write_handler},
-        [Id::MINSTRET] = { "minstret", 0xB02_csr, "Machine instructions-retired counter."},
+        [Id::MINSTRET] = { "minstret", 0xB02_csr, "Machine instructions-retired counter.",
+                        0, (register_storage_t)0xffffffffffffffff, &ControlState::minstret_wlrl_write_handler},
+        [Id::MCYCLEH] = { "mcycleh", 0xB80_csr, "Upper 32 bits of mcycle, RV32 only.",
+                        0, 0xffffffff, &ControlState::mcycleh_wlrl_write_handler},
+        [Id::MINSTRETH] = { "minstreth", 0xB82_csr, "Upper 32 bits of minstret, RV32 only.",
+                        0, 0xffffffff, &ControlState::minstreth_wlrl_write_handler},
     } };
 
     /** Lookup from CSR address (value used in instruction) to internal id (index in continuous
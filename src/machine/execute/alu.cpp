@@ -1,9 +1,34 @@
 #include "alu.h"
 
+#include "common/logging.h"
 #include "common/polyfills/mulh64.h"
+#include "utils.h"
+
+#include <QStringList>
+
+TRACE_CATEGORY("machine.execute.alu.trace");
 
 namespace machine {
 
+void VectorAluCounters::count(VecOp op, uint8_t vl) {
+    elements += vl;
+    switch (op) {
+    case VecOp::VADDVV: add_vv++; break;
+    case VecOp::VADDVI: add_vi++; break;
+    case VecOp::VMULVV: mul_vv++; break;
+    case VecOp::VREDSUM: reduce_sum++; break;
+    }
+}
+
+/** Prints elements of a vector operand, only called when tracing is enabled. */
+static QString format_vector(const VectorRegisterValue &value, uint8_t vl) {
+    QStringList elements;
+    for (size_t i = 0; i < vl; i++) {
+        elements.append(QString::number(static_cast<int32_t>(value[i])));
+    }
+    return elements.join(' ');
+}
+
 // RegisterValue alu_combined_operate(
 RegisterValueUnion alu_combined_operate(
     AluCombinedOp op,
@@ -41,9 +66,7 @@ constexpr uint64_t SHIFT_MASK64 = 0b111111; // == 63
 // int64_t alu64_operate(AluOp op, bool modified, RegisterValue a, RegisterValue b) {
 //     uint64_t _a = a.as_u64();
 //     uint64_t _b = b.as_u64();
-int64_t alu64_operate(AluOp op, bool modified, RegisterValueUnion a_raw, RegisterValueUnion b_raw) {
-    RegisterValue a = a_raw.i;
-    RegisterValue b = b_raw.i;
+static int64_t alu64_operate_scalar(AluOp op, bool modified, RegisterValue a, RegisterValue b) {
     uint64_t _a = a.as_u64();
     uint64_t _b = b.as_u64();
 
@@ -68,9 +91,7 @@ int64_t alu64_operate(AluOp op, bool modified, RegisterValueUnion a_raw, Registe
 // int32_t alu32_operate(AluOp op, bool modified, RegisterValue a, RegisterValue b) {
 //     uint32_t _a = a.as_u32();
 //     uint32_t _b = b.as_u32();
-int32_t alu32_operate(AluOp op, bool modified, RegisterValueUnion a_raw, RegisterValueUnion b_raw) {
-    RegisterValue a = a_raw.i;
-    RegisterValue b = b_raw.i;
+static int32_t alu32_operate_scalar(AluOp op, bool modified, RegisterValue a, RegisterValue b) {
     uint32_t _a = a.as_u32();
     uint32_t _b = b.as_u32();
 
@@ -92,9 +113,7 @@ int32_t alu32_operate(AluOp op, bool modified, RegisterValueUnion a_raw, Registe
 }
 
 // int64_t mul64_operate(MulOp op, RegisterValue a, RegisterValue b) {
-int64_t mul64_operate(MulOp op, RegisterValueUnion a_raw, RegisterValueUnion b_raw) {
-    RegisterValue a = a_raw.i;
-    RegisterValue b = b_raw.i;
+static int64_t mul64_operate_scalar(MulOp op, RegisterValue a, RegisterValue b) {
 
     switch (op) {
     case MulOp::MUL: return a.as_u64() * b.as_u64();
@@ -129,9 +148,7 @@ int64_t mul64_operate(MulOp op, RegisterValueUnion a_raw, RegisterValueUnion b_r
 }
 
 // int32_t mul32_operate(MulOp op, RegisterValue a, RegisterValue b) {
-int32_t mul32_operate(MulOp op, RegisterValueUnion a_raw, RegisterValueUnion b_raw) {
-    RegisterValue a = a_raw.i;
-    RegisterValue b = b_raw.i;
+static int32_t mul32_operate_scalar(MulOp op, RegisterValue a, RegisterValue b) {
 
     switch (op) {
     case MulOp::MUL: return a.as_u32() * b.as_u32();
@@ -165,6 +182,42 @@ int32_t mul32_operate(MulOp op, RegisterValueUnion a_raw, RegisterValueUnion b_r
     }
 }
 
+int64_t alu64_operate(AluOp op, bool modified, RegisterValueUnion a, RegisterValueUnion b) {
+    return alu64_operate_scalar(op, modified, a.i, b.i);
+}
+
+int32_t alu32_operate(AluOp op, bool modified, RegisterValueUnion a, RegisterValueUnion b) {
+    return alu32_operate_scalar(op, modified, a.i, b.i);
+}
+
+int64_t mul64_operate(MulOp op, RegisterValueUnion a, RegisterValueUnion b) {
+    return mul64_operate_scalar(op, a.i, b.i);
+}
+
+int32_t mul32_operate(MulOp op, RegisterValueUnion a, RegisterValueUnion b) {
+    return mul32_operate_scalar(op, a.i, b.i);
+}
+
+RegisterValue alu_scalar_operate(
+    AluCombinedOp op,
+    AluComponent component,
+    bool w_operation,
+    bool modified,
+    RegisterValue a,
+    RegisterValue b) {
+    switch (component) {
+    case AluComponent::ALU:
+        return (w_operation) ? alu32_operate_scalar(op.alu_op, modified, a, b)
+                             : alu64_operate_scalar(op.alu_op, modified, a, b);
+    case AluComponent::MUL:
+        return (w_operation) ? mul32_operate_scalar(op.mul_op, a, b)
+                             : mul64_operate_scalar(op.mul_op, a, b);
+    case AluComponent::PASS: return a;
+    // Vector operations are executed by `alu_combined_operate` only.
+    default: UNREACHABLE
+    }
+}
+
 RegisterValueUnion vec32_operate(VecOp op, RegisterValueUnion a, RegisterValueUnion b, uint8_t vl) {
     switch (op) {
     case VecOp::VADDVV: {
@@ -172,56 +225,39 @@ RegisterValueUnion vec32_operate(VecOp op, RegisterValueUnion a, RegisterValueUn
         for (size_t i = 0; i < vl; i++) {
             result[i] = a.v[i] + b.v[i];
         }
-        printf("perform vector addition:\nInputs: [");
-        for (size_t i = 0; i < vl; i++) {
-            printf("%d ", a.v[i]);
+        RegisterValueUnion value = VectorRegisterValue(result);
+        if (TRACE_ENABLED()) {
+            TRACE(
+                "vadd.vv [%s] + [%s] = [%s]", qPrintable(format_vector(a.v, vl)),
+                qPrintable(format_vector(b.v, vl)), qPrintable(format_vector(value.v, vl)));
         }
-        printf("] + [");
-        for (size_t i = 0; i < vl; i++) {
-            printf("%d ", b.v[i]);
-        }
-        printf("] = [");
-        for (size_t i = 0; i < vl; i++) {
-            printf("%d ", result[i]);
-        }
-        printf("]\n");
-        return VectorRegisterValue(result);
+        return value;
     }
     case VecOp::VADDVI: {
         vector_register_storage_t result;
         for (size_t i = 0; i < vl; i++) {
             result[i] = a.v[i] + b.i.as_u32();
         }
-        // printf("perform vector addition:\nInputs: [");
-        // for (size_t i = 0; i < vl; i++) {
-        //     printf("%d ", a.v[i]);
-        // }
-        // printf("] + %d = [", b.i.as_u32());
-        // for (size_t i = 0; i < vl; i++) {
-        //     printf("%d ", result[i]);
-        // }
-        // printf("]\n");
-        return VectorRegisterValue(result);
+        RegisterValueUnion value = VectorRegisterValue(result);
+        if (TRACE_ENABLED()) {
+            TRACE(
+                "vadd.vi [%s] + %d = [%s]", qPrintable(format_vector(a.v, vl)),
+                static_cast<int32_t>(b.i.as_u32()), qPrintable(format_vector(value.v, vl)));
+        }
+        return value;
     }
     case VecOp::VMULVV: {
         vector_register_storage_t result;
         for (size_t i = 0; i < vl; i++) {
             result[i] = a.v[i] * b.v[i];
         }
-        printf("perform vector multiplication:\nInputs: [");
-        for (size_t i = 0; i < vl; i++) {
-            printf("%d ", a.v[i]);
-        }
-        printf("] + [");
-        for (size_t i = 0; i < vl; i++) {
-            printf("%d ", b.v[i]);
-        }
-        printf("] = [");
-        for (size_t i = 0; i < vl; i++) {
-            printf("%d ", result[i]);
+        RegisterValueUnion value = VectorRegisterValue(result);
+        if (TRACE_ENABLED()) {
+            TRACE(
+                "vmul.vv [%s] * [%s] = [%s]", qPrintable(format_vector(a.v, vl)),
+                qPrintable(format_vector(b.v, vl)), qPrintable(format_vector(value.v, vl)));
         }
-        printf("]\n");
-        return VectorRegisterValue(result);
+        return value;
     }
     case VecOp::VREDSUM: {
         uint32_t result = a.i.as_u32();
@@ -49,6 +49,20 @@ union AluCombinedOp {
     RegisterValueUnion b,
     uint8_t vl = 0);
 
+/**
+ * Dispatcher for scalar only components (ALU, MUL, PASS)
+ *
+ * Same as `alu_combined_operate`, but avoids construction of vector capable operands. Used by
+ * execution paths that are known to handle integer instructions only.
+ */
+[[gnu::const]] RegisterValue alu_scalar_operate(
+    AluCombinedOp op,
+    AluComponent component,
+    bool w_operation,
+    bool modified,
+    RegisterValue a,
+    RegisterValue b);
+
 /**
  * RV64I for OP and OP-IMM instructions
  *
@@ -124,7 +138,30 @@ union AluCombinedOp {
 // [[gnu::const]] int32_t mul32_operate(MulOp op, RegisterValue a, RegisterValue b);
 [[gnu::const]] int32_t mul32_operate(MulOp op, RegisterValueUnion a, RegisterValueUnion b);
 
-[[gnu::const]] RegisterValueUnion vec32_operate(VecOp op, RegisterValueUnion a, RegisterValueUnion b, uint8_t vl);
+/**
+ * RV32 "V" subset: element-wise operations on the first `vl` elements
+ */
+[[gnu::const]] RegisterValueUnion
+vec32_operate(VecOp op, RegisterValueUnion a, RegisterValueUnion b, uint8_t vl);
+
+/**
+ * Diagnostic counters of the vector ALU.
+ *
+ * Counting replaces printing of every vector operation, it is cheap enough to stay enabled in
+ * benchmarks. Counters are kept by each core in its `CoreState`. Operands and results can be
+ * still traced by enabling `machine.execute.alu.trace` logging category in debug builds.
+ */
+struct VectorAluCounters {
+    uint64_t add_vv = 0;
+    uint64_t add_vi = 0;
+    uint64_t mul_vv = 0;
+    uint64_t reduce_sum = 0;
+    /** Total number of processed elements (sum of `vl` over all operations). */
+    uint64_t elements = 0;
+
+    /** Counts one operation executed by `vec32_operate`. */
+    void count(VecOp op, uint8_t vl);
+};
 
 } // namespace machine
 
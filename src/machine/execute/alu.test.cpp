@@ -241,4 +241,31 @@ void TestAlu::test_mul32_operate() {
         RegisterValueUnion(RegisterValue(result)));
 }
 
+void TestAlu::test_vec32_operate_counters() {
+    vector_register_storage_t a {};
+    vector_register_storage_t b {};
+    for (uint32_t i = 0; i < 8; i++) {
+        a[i] = i;
+        b[i] = 2 * i;
+    }
+
+    RegisterValueUnion sum = vec32_operate(VecOp::VADDVV, a, b, 8);
+    RegisterValueUnion product = vec32_operate(VecOp::VMULVV, a, b, 4);
+    RegisterValueUnion reduced = vec32_operate(VecOp::VREDSUM, RegisterValue(1), sum, 8);
+
+    QCOMPARE(sum.v[7], 21U);
+    QCOMPARE(product.v[3], 18U);
+    QCOMPARE(reduced.i.as_u32(), 85U);
+
+    VectorAluCounters counters;
+    counters.count(VecOp::VADDVV, 8);
+    counters.count(VecOp::VMULVV, 4);
+    counters.count(VecOp::VREDSUM, 8);
+    QCOMPARE(counters.add_vv, (uint64_t)1);
+    QCOMPARE(counters.add_vi, (uint64_t)0);
+    QCOMPARE(counters.mul_vv, (uint64_t)1);
+    QCOMPARE(counters.reduce_sum, (uint64_t)1);
+    QCOMPARE(counters.elements, (uint64_t)20);
+}
+
 QTEST_APPLESS_MAIN(TestAlu)
\ No newline at end of file
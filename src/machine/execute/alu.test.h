@@ -14,6 +14,7 @@ private slots:
     static void test_mul64_operate();
     static void test_mul32_operate_data();
     static void test_mul32_operate();
+    static void test_vec32_operate_counters();
 };
 
 #endif // ALU_TEST_H
@@ -17,6 +17,7 @@
 #include <utility>
 
 LOG_CATEGORY("machine.instruction");
+TRACE_CATEGORY("machine.instruction.decode.trace");
 
 using namespace machine;
 using std::underlying_type;
@@ -653,7 +654,10 @@ static inline const struct InstructionMap &InstructionMapFind(uint32_t code) {
     while (im->subclass != nullptr) {
         im = &im->subclass[im->subfield.decode(code)];
     }
-    if ((code ^ im->code) & im->mask) {printf("try to find %08x, but not found (imcode=%08x, immask=%08x)\n", code, im->code, im->mask); return C_inst_unknown; }
+    if ((code ^ im->code) & im->mask) {
+        TRACE("unknown encoding %08x (imcode=%08x, immask=%08x)", code, im->code, im->mask);
+        return C_inst_unknown;
+    }
     return *im;
 }
 
@@ -661,7 +665,8 @@ const std::array<const QString, 36> RECOGNIZED_PSEUDOINSTRUCTIONS { "nop",    "l
                                                                     "sext.b", "sext.h", "zext.h",
                                                                     "zext.w", "call",   "tail" };
 
-bool Instruction::symbolic_registers_enabled = false;
+std::atomic<bool> Instruction::symbolic_registers_enabled { false };
+
 const Instruction Instruction::NOP = Instruction(0x00000013);
 const Instruction Instruction::UNKNOWN_INST = Instruction(0x0);
 
@@ -673,10 +678,6 @@ Instruction::Instruction(uint32_t inst) {
     this->dt = inst;
 }
 
-Instruction::Instruction(const Instruction &i) {
-    this->dt = i.data();
-}
-
 #define MASK(LEN, OFF) ((this->dt >> (OFF)) & ((1 << (LEN)) - 1))
 
 uint8_t Instruction::opcode() const {
@@ -760,6 +761,11 @@ enum AccessControl Instruction::mem_ctl() const {
     return im.mem_ctl;
 }
 
+const char *Instruction::mnemonic() const {
+    const struct InstructionMap &im = InstructionMapFind(dt);
+    return im.type == UNKNOWN ? nullptr : im.name;
+}
+
 void Instruction::flags_alu_op_mem_ctl(
     InstructionFlags &flags,
     AluCombinedOp &alu_op,
@@ -778,11 +784,6 @@ bool Instruction::operator!=(const Instruction &c) const {
     return !this->operator==(c);
 }
 
-Instruction &Instruction::operator=(const Instruction &c) {
-    if (this != &c) { this->dt = c.data(); }
-    return *this;
-}
-
 QString Instruction::to_str(Address inst_addr) const {
     const InstructionMap &im = InstructionMapFind(dt);
     // TODO there are exception where some fields are zero and such so we should
@@ -816,7 +817,7 @@ QString Instruction::to_str(Address inst_addr) const {
             }
             switch (arg_desc->kind) {
             case 'g': {
-                if (symbolic_registers_enabled) {
+                if (symbolic_registers_enabled.load(std::memory_order_relaxed)) {
                     res += QString(Rv_regnames[field]);
                 } else {
                     res += "x" + QString::number(field);
@@ -839,7 +840,7 @@ QString Instruction::to_str(Address inst_addr) const {
                 break;
             }
             case 'E': {
-                if (symbolic_registers_enabled) {
+                if (symbolic_registers_enabled.load(std::memory_order_relaxed)) {
                     try {
                         res += CSR::REGISTERS[CSR::REGISTER_MAP.at(CSR::Address(field))].name;
                     } catch (std::out_of_range &e) { res.append(str::asHex(field)); }
@@ -854,9 +855,10 @@ QString Instruction::to_str(Address inst_addr) const {
     return res;
 }
 
-QMultiMap<QString, uint32_t> str_to_instruction_code_map;
+using InstructionCodeMap = QMultiMap<QString, uint32_t>;
 
 static void instruction_from_string_build_base_aliases(
+    InstructionCodeMap &code_map,
     uint32_t base_code,
     uint32_t base_mask,
     const InstructionMap *ia) {
@@ -876,7 +878,7 @@ static void instruction_from_string_build_base_aliases(
             continue;
         }
         bool found = false;
-        auto iter_range = str_to_instruction_code_map.equal_range(ia->name);
+        auto iter_range = code_map.equal_range(ia->name);
         for (auto i = iter_range.first; i != iter_range.second; i += 1) {
             if (i.value() == base_code) {
                 found = true;
@@ -886,11 +888,12 @@ static void instruction_from_string_build_base_aliases(
         if (found) continue;
 
         // store base code, the iteration over alliases is required anyway
-        str_to_instruction_code_map.insert(ia->name, base_code);
+        code_map.insert(ia->name, base_code);
     }
 }
 
-void instruction_from_string_build_base(
+static void instruction_from_string_build_base(
+    InstructionCodeMap &code_map,
     const InstructionMap *im,
     BitField field,
     uint32_t base_code,
@@ -904,7 +907,8 @@ void instruction_from_string_build_base(
     for (unsigned int i = 0; i < 1U << bits; i++, im++) {
         code = base_code | (i << shift);
         if (im->subclass) {
-            instruction_from_string_build_base(im->subclass, im->subfield, code, base_mask);
+            instruction_from_string_build_base(
+                code_map, im->subclass, im->subfield, code, base_mask);
             continue;
         }
         if (!(im->flags & IMF_SUPPORTED)) { continue; }
@@ -922,20 +926,30 @@ void instruction_from_string_build_base(
                 im->name, code, base_mask, im->code, im->mask);
             continue;
         }
-        str_to_instruction_code_map.insert(im->name, im->code);
+        code_map.insert(im->name, im->code);
 
         if (im->aliases != nullptr)
-            instruction_from_string_build_base_aliases(im->code, im->mask, im->aliases);
+            instruction_from_string_build_base_aliases(code_map, im->code, im->mask, im->aliases);
     }
 #if 0
-    for (auto i = str_to_instruction_code_map.begin();
-         i != str_to_instruction_code_map.end(); i++)
+    for (auto i = code_map.begin(); i != code_map.end(); i++)
         std::cout << i.key().toStdString() << ' ';
 #endif
 }
 
-void instruction_from_string_build_base() {
-    return instruction_from_string_build_base(C_inst_map, instruction_map_opcode_field, 0, 0);
+/**
+ * Map of instruction names to their base codes, used by the instruction parser.
+ *
+ * The map is built on first use and it is never modified after. Initialization of the local
+ * static is thread safe, so machines and assemblers can be used from several threads.
+ */
+static const InstructionCodeMap &str_to_instruction_code_map() {
+    static const InstructionCodeMap map = [] {
+        InstructionCodeMap result;
+        instruction_from_string_build_base(result, C_inst_map, instruction_map_opcode_field, 0, 0);
+        return result;
+    }();
+    return map;
 }
 
 static int parse_reg_from_string(const QString &str, uint *chars_taken = nullptr) {
@@ -1033,8 +1047,6 @@ size_t Instruction::code_from_tokens(
     TokenizedInstruction &inst,
     RelocExpressionList *reloc,
     bool pseudoinst_enabled) {
-    if (str_to_instruction_code_map.isEmpty()) { instruction_from_string_build_base(); }
-
     Instruction result = base_from_tokens(inst, reloc);
     if (result.data() != 0) {
         if (result.size() > buffsize) {
@@ -1213,7 +1225,7 @@ Instruction Instruction::base_from_tokens(
     uint64_t initial_immediate_value) {
     int rethrow = false;
     ParseError parse_error = ParseError("no match for arguments combination found");
-    auto iter_range = str_to_instruction_code_map.equal_range(inst.base);
+    auto iter_range = str_to_instruction_code_map().equal_range(inst.base);
     if (iter_range.first == iter_range.second) {
         DEBUG("Base instruction of the name %s not found.", qPrintable(inst.base));
         return Instruction::UNKNOWN_INST;
@@ -1453,10 +1465,8 @@ constexpr uint64_t Instruction::modify_pseudoinst_imm(Instruction::Modifier mod,
 
 // highlighter
 void Instruction::append_recognized_instructions(QStringList &list) {
-    if (str_to_instruction_code_map.isEmpty()) { instruction_from_string_build_base(); }
-
-    for (auto iter = str_to_instruction_code_map.keyBegin();
-         iter != str_to_instruction_code_map.keyEnd(); iter++) {
+    const InstructionCodeMap &code_map = str_to_instruction_code_map();
+    for (auto iter = code_map.keyBegin(); iter != code_map.keyEnd(); iter++) {
         list.append(*iter);
     }
     for (const auto &str : RECOGNIZED_PSEUDOINSTRUCTIONS) {
@@ -1465,7 +1475,7 @@ void Instruction::append_recognized_instructions(QStringList &list) {
 }
 
 void Instruction::set_symbolic_registers(bool enable) {
-    symbolic_registers_enabled = enable;
+    symbolic_registers_enabled.store(enable, std::memory_order_relaxed);
 }
 
 inline int32_t Instruction::extend(uint32_t value, uint32_t used_bits) const {
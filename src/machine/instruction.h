@@ -12,6 +12,7 @@
 #include <QStringList>
 #include <QVector>
 #include <array>
+#include <atomic>
 #include <utility>
 
 namespace machine {
@@ -114,7 +115,7 @@ public:
     //     uint8_t rt,
     //     uint16_t immediate);                      // Type I
     // Instruction(uint8_t opcode, Address address); // Type J
-    Instruction(const Instruction &);
+    Instruction(const Instruction &) = default;
 
     static const Instruction NOP;
     static const Instruction UNKNOWN_INST;
@@ -160,6 +161,8 @@ public:
     enum InstructionFlags flags() const;
     AluCombinedOp alu_op() const;
     enum AccessControl mem_ctl() const;
+    /** Name of the instruction (without aliases), null for unknown instruction. */
+    const char *mnemonic() const;
 
     void flags_alu_op_mem_ctl(
         enum InstructionFlags &flags,
@@ -168,7 +171,7 @@ public:
 
     bool operator==(const Instruction &c) const;
     bool operator!=(const Instruction &c) const;
-    Instruction &operator=(const Instruction &c);
+    Instruction &operator=(const Instruction &c) = default;
 
     QString to_str(Address inst_addr = Address::null()) const;
 
@@ -208,7 +211,8 @@ public:
 
 private:
     uint32_t dt;
-    static bool symbolic_registers_enabled;
+    /** Shared by all threads, it is a display preference of the whole application. */
+    static std::atomic<bool> symbolic_registers_enabled;
 
     static Instruction base_from_tokens(
         const TokenizedInstruction &inst,
@@ -1,44 +1,97 @@
 #include "machine.h"
 
+#include "common/logging.h"
 #include "programloader.h"
 
-#include <QTime>
+#include <QElapsedTimer>
+#include <algorithm>
 #include <utility>
+#include <vector>
+
+LOG_CATEGORY("machine.Machine");
 
 using namespace machine;
 
+// Number of steps executed between checks of elapsed time in `Machine::step_internal`.
+constexpr unsigned TIME_CHECK_STEPS = 1024;
+
+static MemoryLayout memory_layout(const MachineConfig &config) {
+    // Emulated OS releases memory on munmap, only paged memory returns it to the host and holds
+    // the RAM of RV64 programs above 4 GiB.
+    if (config.osemu_enable()) { return MemoryLayout::PAGED; }
+    switch (config.memory_backend()) {
+    case MachineConfig::MB_PAGED: return MemoryLayout::PAGED;
+    case MachineConfig::MB_TREE:
+    default: return MemoryLayout::TREE;
+    }
+}
+
+/** Records the backend forced by OS emulation, so reports and checkpoints show the real one. */
+static void apply_forced_memory_backend(MachineConfig &config) {
+    if (memory_layout(config) == MemoryLayout::PAGED
+        && config.memory_backend() != MachineConfig::MB_PAGED) {
+        WARN("Operating system emulation requires paged memory, tree backend is not used.");
+        config.set_memory_backend(MachineConfig::MB_PAGED);
+    }
+}
+
 Machine::Machine(MachineConfig config, bool load_symtab, bool load_executable)
     : machine_config(std::move(config))
     , stat(ST_READY) {
+    apply_forced_memory_backend(machine_config);
     regs = new Registers();
 
     if (load_executable) {
         ProgramLoader program(machine_config.elf());
-        this->machine_config.set_simulated_endian(program.get_endian());
-        mem_program_only = new Memory(machine_config.get_simulated_endian());
-        program.to_memory(mem_program_only);
-
-        if (program.get_architecture_type() == ARCH64)
-            this->machine_config.set_simulated_xlen(Xlen::_64);
-        else
-            this->machine_config.set_simulated_xlen(Xlen::_32);
-
         if (load_symtab) {
             symtab = program.get_symbol_table();
         }
-
-        program_end = program.end();
-        if (program.get_executable_entry() != 0x0_addr) {
-            regs->write_pc(program.get_executable_entry());
-        }
-        mem = new Memory(*mem_program_only);
+        setup_program(LoadedProgram(program, memory_layout(machine_config)));
     } else {
-        mem = new Memory(machine_config.get_simulated_endian());
+        mem = new Memory(machine_config.get_simulated_endian(), memory_layout(machine_config));
+    }
+    setup_components();
+}
+
+Machine::Machine(MachineConfig config, const LoadedProgram &program)
+    : machine_config(std::move(config))
+    , stat(ST_READY) {
+    apply_forced_memory_backend(machine_config);
+    regs = new Registers();
+    setup_program(LoadedProgram(program));
+    setup_components();
+}
+
+LoadedProgram Machine::load_program(const MachineConfig &config) {
+    ProgramLoader program(config.elf());
+    return LoadedProgram(program, memory_layout(config));
+}
+
+void Machine::setup_program(LoadedProgram program) {
+    this->machine_config.set_simulated_endian(program.endian);
+    mem_program_only = program.memory.release();
+
+    if (program.architecture_type == ARCH64)
+        this->machine_config.set_simulated_xlen(Xlen::_64);
+    else
+        this->machine_config.set_simulated_xlen(Xlen::_32);
+
+    program_end = program.end;
+    if (program.executable_entry != 0x0_addr) {
+        regs->write_pc(program.executable_entry);
     }
+    mem = new Memory(*mem_program_only);
+}
 
+void Machine::setup_components() {
     data_bus = new MemoryDataBus(machine_config.get_simulated_endian());
     data_bus->insert_device_to_range(
-        mem, 0x00000000_addr, 0xefffffff_addr, false);
+        mem, 0x00000000_addr, RAM_LAST_ADDR, false);
+    if (machine_config.get_simulated_xlen() == Xlen::_64
+        && mem->layout() == MemoryLayout::PAGED) {
+        data_bus->insert_device_to_range(
+            mem, RAM_HIGH_START_ADDR, RAM_HIGH_LAST_ADDR, false, RAM_HIGH_START_ADDR.get_raw());
+    }
 
     setup_serial_port();
     setup_perip_spi_led();
@@ -77,6 +130,11 @@ Machine::Machine(MachineConfig config, bool load_symtab, bool load_executable)
         access_time_burst,
         access_enable_burst);
 
+    // Cache observers are updated once per tick, not on every access.
+    connect(this, &Machine::post_tick, cch_program, &Cache::publish_updates);
+    connect(this, &Machine::post_tick, cch_data, &Cache::publish_updates);
+    connect(this, &Machine::post_tick, cch_level2, &Cache::publish_updates);
+
     controlst = new CSR::ControlState(machine_config.get_simulated_xlen(), machine_config.get_isa_word());
     predictor = new BranchPredictor(
         machine_config.get_bp_enabled(), machine_config.get_bp_type(),
@@ -91,8 +149,15 @@ Machine::Machine(MachineConfig config, bool load_symtab, bool load_executable)
         cr = new CoreSingle(regs, predictor, cch_program, cch_data, controlst,
                             machine_config.get_simulated_xlen(), machine_config.get_isa_word());
     }
+    cr->set_timing_model(machine_config.timing_model());
+    connect(
+        this, &Machine::set_interrupt_signal, controlst, &CSR::ControlState::set_interrupt_signal,
+        Qt::DirectConnection);
+    // Internal connections are direct, the machine may be stepped by another thread (`run_steps`).
     connect(
-        this, &Machine::set_interrupt_signal, controlst, &CSR::ControlState::set_interrupt_signal);
+        cr, &Core::stop_on_exception_reached, this, &Machine::exception_stop_reached,
+        Qt::DirectConnection);
+    cr_active = cr;
 
     run_t = new QTimer(this);
     set_speed(0); // In default run as fast as possible
@@ -134,7 +199,7 @@ void Machine::setup_serial_port() {
         memory_bus_insert_range(ser_port, 0xffffffffffffc000_addr, 0xffffffffffffc03f_addr, false);
     connect(
         ser_port, &SerialPort::signal_interrupt, this,
-        &Machine::set_interrupt_signal);
+        &Machine::set_interrupt_signal, Qt::DirectConnection);
 }
 
 void Machine::setup_aclint_mtime() {
@@ -150,7 +215,7 @@ void Machine::setup_aclint_mtime() {
                                 false);
     connect(
         aclint_mtimer, &aclint::AclintMtimer::signal_interrupt, this,
-        &Machine::set_interrupt_signal);
+        &Machine::set_interrupt_signal, Qt::DirectConnection);
 }
 
 void Machine::setup_aclint_mswi() {
@@ -166,7 +231,7 @@ void Machine::setup_aclint_mswi() {
                                 false);
     connect(
         aclint_mswi, &aclint::AclintMswi::signal_interrupt, this,
-        &Machine::set_interrupt_signal);
+        &Machine::set_interrupt_signal, Qt::DirectConnection);
 }
 
 void Machine::setup_aclint_sswi() {
@@ -182,7 +247,7 @@ void Machine::setup_aclint_sswi() {
                                 false);
     connect(
         aclint_sswi, &aclint::AclintSswi::signal_interrupt, this,
-        &Machine::set_interrupt_signal);
+        &Machine::set_interrupt_signal, Qt::DirectConnection);
 }
 
 Machine::~Machine() {
@@ -190,6 +255,8 @@ Machine::~Machine() {
     run_t = nullptr;
     delete cr;
     cr = nullptr;
+    delete cr_functional;
+    cr_functional = nullptr;
     delete controlst;
     controlst = nullptr;
     delete regs;
@@ -221,6 +288,27 @@ void Machine::set_speed(unsigned int ips, unsigned int time_chunk) {
     run_t->setInterval(ips);
 }
 
+void Machine::set_headless(bool headless) {
+    this->headless = headless;
+    regs->blockSignals(headless);
+    controlst->blockSignals(headless);
+    cch_program->set_headless(headless);
+    cch_data->set_headless(headless);
+    cch_level2->set_headless(headless);
+    predictor->set_headless(headless);
+    cr->set_headless(headless);
+}
+
+bool Machine::is_headless() const {
+    return headless;
+}
+
+void Machine::set_access_trace(AccessTraceWriter *trace) {
+    cch_program->set_access_trace(trace, true);
+    cch_data->set_access_trace(trace, false);
+    predictor->set_access_trace(trace);
+}
+
 const Registers *Machine::registers() {
     return regs;
 }
@@ -249,6 +337,44 @@ const Cache *Machine::cache_level2() {
     return cch_level2;
 }
 
+uint64_t Machine::replay_access_trace(AccessTraceReader &trace) {
+    std::vector<uint8_t> scratch(64);
+    AccessTraceRecord record {};
+    uint64_t count = 0;
+    while (trace.next(record)) {
+        if (record.size > scratch.size()) { scratch.resize(record.size); }
+        switch (record.kind) {
+        case ATK_FETCH:
+            cch_program->read(scratch.data(), record.address, record.size, { AccessEffects::REGULAR });
+            break;
+        case ATK_READ:
+            cch_data->read(scratch.data(), record.address, record.size, { AccessEffects::REGULAR });
+            break;
+        case ATK_WRITE:
+            std::fill_n(scratch.begin(), record.size, 0);
+            cch_data->write(record.address, scratch.data(), record.size, { AccessEffects::REGULAR });
+            break;
+        case ATK_BRANCH: {
+            const Address next_inst_addr
+                = record.result == BranchResult::TAKEN ? record.target : record.address + 4;
+            if (predictor->predict_next_pc_address(Instruction(), record.address)
+                != next_inst_addr) {
+                predictor->increment_mispredictions();
+            }
+            predictor->update(
+                Instruction(), record.address, record.target, record.branch_type, record.result);
+            break;
+        }
+        }
+        count++;
+    }
+    return count;
+}
+
+Cache *Machine::cache_program_rw() {
+    return cch_program;
+}
+
 Cache *Machine::cache_data_rw() {
     return cch_data;
 }
@@ -348,9 +474,15 @@ void Machine::play() {
 }
 
 void Machine::pause() {
+    // Status of a `run` is owned by `end_run`, the steps may be executed by another thread.
+    if (run_active) {
+        request_pause();
+        return;
+    }
     if (stat != ST_BUSY) {
         CTL_GUARD;
     }
+    pause_requested = true;
     set_status(ST_READY);
     run_t->stop();
 }
@@ -361,11 +493,23 @@ void Machine::step_internal(bool skip_break) {
     set_status(ST_BUSY);
     emit tick();
     try {
-        QTime start_time = QTime::currentTime();
-        do {
-            cr->step(skip_break);
-        } while (time_chunk != 0 && stat == ST_BUSY && !skip_break
-                 && start_time.msecsTo(QTime::currentTime()) < (int)time_chunk);
+        QElapsedTimer chunk_timer;
+        chunk_timer.start();
+        unsigned steps_to_time_check = TIME_CHECK_STEPS;
+        while (true) {
+            if (headless && !skip_break) {
+                cr->set_block_stop(program_end, 0);
+                cr->step_block();
+            } else {
+                cr->step(skip_break);
+            }
+            if (time_chunk == 0 || stat != ST_BUSY || skip_break) { break; }
+            // Reading the clock costs more than a step, it is checked once in a while.
+            if (--steps_to_time_check == 0) {
+                steps_to_time_check = TIME_CHECK_STEPS;
+                if (chunk_timer.elapsed() >= (qint64)time_chunk) { break; }
+            }
+        }
     } catch (SimulatorException &e) {
         run_t->stop();
         set_status(ST_TRAPPED);
@@ -392,6 +536,181 @@ void Machine::step_timer() {
     step_internal();
 }
 
+void Machine::exception_stop_reached() {
+    exception_stop = true;
+}
+
+Machine::StopReason Machine::run(uint64_t max_steps, StopMask stop_mask) {
+    StopReason reason = begin_run();
+    if (reason != SR_NONE) { return reason; }
+    reason = run_steps(max_steps, stop_mask);
+    end_run(reason);
+    return reason;
+}
+
+Machine::StopReason Machine::begin_run() {
+    if (stat == ST_EXIT) { return SR_EXIT; }
+    if (stat == ST_TRAPPED) { return SR_TRAP; }
+    if (stat == ST_BUSY) { return SR_PAUSED; }
+    run_t->stop();
+    set_status(ST_BUSY);
+    exception_stop = false;
+    pause_requested = false;
+    run_resumed = true;
+    run_active = true;
+    emit tick();
+    return SR_NONE;
+}
+
+Machine::StopReason Machine::run_steps(uint64_t max_steps, StopMask stop_mask) {
+    StopReason reason = SR_NONE;
+    uint64_t steps = 0;
+    try {
+        while (reason == SR_NONE) {
+            // The first instruction of a run is executed even when the machine stopped at its
+            // breakpoint.
+            const bool skip_break = run_resumed;
+            run_resumed = false;
+            if (headless && !skip_break
+                && (max_steps == 0 || max_steps - steps >= BlockCache::MAX_BLOCK_LENGTH)) {
+                // Active core may change by sampling, the limits are passed for every block.
+                cr_active->set_block_stop(
+                    program_end, (stop_mask & SR_CYCLE_LIMIT) ? cycle_limit : 0);
+                steps += cr_active->step_block();
+            } else {
+                cr_active->step(skip_break);
+                steps++;
+            }
+            if (sampling.enabled()) { update_sampling(); }
+
+            if (regs->read_pc() >= program_end) {
+                reason = SR_EXIT;
+            } else if (pause_requested.load(std::memory_order_relaxed)) {
+                reason = SR_PAUSED;
+            } else if (exception_stop && (stop_mask & SR_EXCEPTION)) {
+                reason = SR_EXCEPTION;
+            } else if (
+                cycle_limit != 0 && (stop_mask & SR_CYCLE_LIMIT)
+                && cr->get_cycle_count() >= cycle_limit) {
+                reason = SR_CYCLE_LIMIT;
+            } else if (max_steps != 0 && steps >= max_steps) {
+                reason = SR_STEP_LIMIT;
+            }
+            exception_stop = false;
+        }
+    } catch (SimulatorException &) {
+        trap_exception = std::current_exception();
+        return SR_TRAP;
+    }
+    return reason;
+}
+
+void Machine::end_run(StopReason reason) {
+    run_active = false;
+    if (reason == SR_TRAP && trap_exception != nullptr) {
+        set_status(ST_TRAPPED);
+        try {
+            std::rethrow_exception(std::exchange(trap_exception, nullptr));
+        } catch (SimulatorException &e) { emit program_trap(e); }
+    } else if (reason == SR_EXIT) {
+        set_status(ST_EXIT);
+        emit program_exit();
+    } else {
+        set_status(ST_READY);
+    }
+    emit post_tick();
+}
+
+void Machine::request_pause() {
+    pause_requested = true;
+}
+
+bool Machine::is_run_active() const {
+    return run_active;
+}
+
+void Machine::set_cycle_limit(uint64_t limit) {
+    cycle_limit = limit;
+}
+
+uint64_t Machine::get_cycle_limit() const {
+    return cycle_limit;
+}
+
+void Machine::set_sampling(const SamplingConfig &config) {
+    Q_ASSERT(config.valid());
+    cr_active = cr;
+    sampling = config;
+    sampling_stats.reset();
+    if (!sampling.enabled()) { return; }
+    if (cr_functional == nullptr) {
+        cr_functional = new CoreSingle(
+            regs, predictor, cch_program, cch_data, controlst, machine_config.get_simulated_xlen(),
+            machine_config.get_isa_word());
+        cr_functional->copy_exception_setup(*cr);
+        cr_functional->set_headless(true);
+        // Observers of exception stops (e.g. the reporter) are connected to the detailed core.
+        connect(
+            cr_functional, &Core::stop_on_exception_reached, cr,
+            &Core::stop_on_exception_reached, Qt::DirectConnection);
+    }
+    start_sampling();
+}
+
+const SamplingConfig &Machine::get_sampling() const {
+    return sampling;
+}
+
+const SamplingStatistics &Machine::sampling_statistics() const {
+    return sampling_stats;
+}
+
+void Machine::start_sampling() {
+    cr->drain();
+    cr_active = cr_functional;
+    sampling_phase = SP_FAST_FORWARD;
+    sampling_phase_end = controlst->read_internal(CSR::Id::MINSTRET).as_u64() + sampling.period
+                         - sampling.warmup - sampling.window;
+}
+
+void Machine::update_sampling() {
+    const uint64_t instructions = controlst->read_internal(CSR::Id::MINSTRET).as_u64();
+    // Empty phases (no fast-forward or warm-up) are passed at once.
+    while (instructions >= sampling_phase_end) {
+        switch (sampling_phase) {
+        case SP_FAST_FORWARD:
+            cr_active = cr;
+            sampling_phase = SP_WARMUP;
+            sampling_phase_end = instructions + sampling.warmup;
+            break;
+        case SP_WARMUP:
+            sampling_window_start = sampling_counters();
+            sampling_phase = SP_MEASURE;
+            sampling_phase_end = instructions + sampling.window;
+            break;
+        case SP_MEASURE:
+            sampling_stats.add_window(sampling_counters().since(sampling_window_start));
+            cr->drain();
+            cr_active = cr_functional;
+            sampling_phase = SP_FAST_FORWARD;
+            sampling_phase_end = instructions + sampling.period - sampling.warmup - sampling.window;
+            break;
+        }
+    }
+}
+
+SampleCounters Machine::sampling_counters() const {
+    SampleCounters counters;
+    counters.instructions = controlst->read_internal(CSR::Id::MINSTRET).as_u64();
+    counters.cycles = cr->get_cycle_count();
+    counters.stalls = cr->get_stall_count();
+    counters.program_accesses = cch_program->get_hit_count() + cch_program->get_miss_count();
+    counters.program_misses = cch_program->get_miss_count();
+    counters.data_accesses = cch_data->get_hit_count() + cch_data->get_miss_count();
+    counters.data_misses = cch_data->get_miss_count();
+    return counters;
+}
+
 void Machine::restart() {
     pause();
     regs->reset();
@@ -402,9 +721,45 @@ void Machine::restart() {
     cch_data->reset();
     cch_level2->reset();
     cr->reset();
+    if (sampling.enabled()) {
+        cr_functional->reset();
+        sampling_stats.reset();
+        start_sampling();
+    }
     set_status(ST_READY);
 }
 
+Machine::Snapshot Machine::snapshot() const {
+    Snapshot snapshot;
+    snapshot.registers = regs->snapshot();
+    snapshot.control_state = controlst->snapshot();
+    snapshot.memory = std::make_unique<Memory>(*mem);
+    snapshot.cache_program = cch_program->snapshot();
+    snapshot.cache_data = cch_data->snapshot();
+    snapshot.cache_level2 = cch_level2->snapshot();
+    snapshot.predictor = predictor->snapshot();
+    snapshot.core = cr->snapshot();
+    snapshot.mtimer = aclint_mtimer->snapshot();
+    snapshot.mswi = aclint_mswi->snapshot();
+    snapshot.status = (stat == ST_RUNNING || stat == ST_BUSY) ? ST_READY : stat;
+    return snapshot;
+}
+
+void Machine::restore(const Snapshot &snapshot) {
+    pause();
+    regs->restore(snapshot.registers);
+    controlst->restore(snapshot.control_state);
+    mem->reset(*snapshot.memory);
+    cch_program->restore(snapshot.cache_program);
+    cch_data->restore(snapshot.cache_data);
+    cch_level2->restore(snapshot.cache_level2);
+    predictor->restore(snapshot.predictor);
+    cr->restore(snapshot.core);
+    aclint_mtimer->restore(snapshot.mtimer);
+    aclint_mswi->restore(snapshot.mswi);
+    set_status(snapshot.status);
+}
+
 void Machine::set_status(enum Status st) {
     bool change = st != stat;
     stat = st;
@@ -419,6 +774,7 @@ void Machine::register_exception_handler(
     if (cr != nullptr) {
         cr->register_exception_handler(excause, exhandler);
     }
+    if (cr_functional != nullptr) { cr_functional->register_exception_handler(excause, exhandler); }
 }
 
 bool Machine::memory_bus_insert_range(
@@ -456,6 +812,7 @@ void Machine::set_stop_on_exception(enum ExceptionCause excause, bool value) {
     if (cr != nullptr) {
         cr->set_stop_on_exception(excause, value);
     }
+    if (cr_functional != nullptr) { cr_functional->set_stop_on_exception(excause, value); }
 }
 
 bool Machine::get_stop_on_exception(enum ExceptionCause excause) const {
@@ -469,6 +826,7 @@ void Machine::set_step_over_exception(enum ExceptionCause excause, bool value) {
     if (cr != nullptr) {
         cr->set_step_over_exception(excause, value);
     }
+    if (cr_functional != nullptr) { cr_functional->set_step_over_exception(excause, value); }
 }
 
 bool Machine::get_step_over_exception(enum ExceptionCause excause) const {
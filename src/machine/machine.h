@@ -10,27 +10,65 @@
 #include "memory/backend/aclintmtimer.h"
 #include "memory/backend/aclintmswi.h"
 #include "memory/backend/aclintsswi.h"
+#include "memory/backend/memory.h"
 #include "memory/cache/cache.h"
 #include "memory/memory_bus.h"
 #include "predictor.h"
 #include "registers.h"
+#include "sampling.h"
 #include "simulator_exception.h"
 #include "symboltable.h"
 
 #include <QObject>
 #include <QTimer>
+#include <atomic>
 #include <cstdint>
+#include <exception>
+#include <memory>
 
 namespace machine {
 
+struct LoadedProgram;
+
 class Machine : public QObject {
     Q_OBJECT
 public:
     explicit Machine(MachineConfig config, bool load_symtab = false, bool load_executable = true);
+    /**
+     * Creates machine running already loaded program, the ELF file given by the configuration
+     * is not used. Symbol table is not available.
+     */
+    Machine(MachineConfig config, const LoadedProgram &program);
+    /** Loads the ELF file given by the configuration in memory layout of the configuration. */
+    static LoadedProgram load_program(const MachineConfig &config);
     ~Machine() override;
 
     const MachineConfig &config();
     void set_speed(unsigned int ips, unsigned int time_chunk = 0);
+    /**
+     * Headless mode switches off all observer signals of the simulated components (core step
+     * notifications, register, CSR, cache and predictor updates). It is intended for batch runs
+     * where nothing visualizes the state. Machine control signals (exit, trap, exception stop)
+     * are still delivered. Running (not single stepping) headless machine lets the core execute
+     * whole basic blocks at once, see `Core::step_block`.
+     */
+    void set_headless(bool headless);
+    bool is_headless() const;
+    /**
+     * Records memory accesses of the core (at the first level caches) and outcomes of branches
+     * to the trace, null pointer stops the recording. The trace has to outlive the recording.
+     */
+    void set_access_trace(AccessTraceWriter *trace);
+    /**
+     * Feeds all remaining records of the trace to the caches and the branch predictor, the core
+     * is not run. Fetches go to the program cache and data accesses to the data cache (zeros are
+     * written), lower cache levels are accessed by them as in a running machine. Branches are
+     * predicted, mispredictions counted and the predictor updated as by the core (with an empty
+     * instruction word). No signals of the machine are emitted.
+     *
+     * @return  number of replayed records
+     */
+    uint64_t replay_access_trace(AccessTraceReader &trace);
 
     const Registers *registers();
     const CSR::ControlState *control_state();
@@ -39,6 +77,7 @@ public:
     const Cache *cache_program();
     const Cache *cache_data();
     const Cache *cache_level2();
+    Cache *cache_program_rw();
     Cache *cache_data_rw();
     void cache_sync();
     const MemoryDataBus *memory_data_bus();
@@ -69,6 +108,117 @@ public:
     enum Status status();
     bool exited();
 
+    /**
+     * Complete state of the simulated machine, see `Machine::snapshot`.
+     */
+    struct Snapshot {
+        Registers::Snapshot registers;
+        CSR::ControlState::Snapshot control_state;
+        /** Copy of the main memory, with paged backend it shares pages copy-on-write. */
+        std::unique_ptr<Memory> memory;
+        Cache::Snapshot cache_program;
+        Cache::Snapshot cache_data;
+        Cache::Snapshot cache_level2;
+        BranchPredictor::Snapshot predictor;
+        Core::Snapshot core;
+        aclint::AclintMtimer::Snapshot mtimer;
+        aclint::AclintMswi::Snapshot mswi;
+        enum Status status = ST_READY;
+    };
+    /**
+     * Captures registers, CSRs, memory, caches, predictor, core pipeline state and ACLINT timer
+     * and software interrupt registers.
+     *
+     * With the paged memory backend (`MachineConfig::MB_PAGED`) no memory content is copied,
+     * pages are shared with the machine until one side writes to them. Snapshot can be restored
+     * any number of times and discarded by its destruction. State of other peripherals (serial
+     * port, LCD) and symbol table is not captured.
+     */
+    [[nodiscard]] Snapshot snapshot() const;
+    /** Restores state captured by `snapshot` of this machine. Running machine is paused. */
+    void restore(const Snapshot &snapshot);
+
+    /**
+     * Writes snapshot of the machine (see `snapshot`) to a binary checkpoint file.
+     *
+     * Checkpoint starts with a versioned header describing the build and the machine
+     * configuration, it can be loaded only by a machine of the same configuration (caches,
+     * predictor, pipeline and XLEN). State of the registered exception handlers (e.g. emulated
+     * operating system, see `ExceptionHandler::save_checkpoint`) is stored too, the same handlers
+     * have to be registered to load it. Throws `SimulatorExceptionInput` on failure.
+     */
+    void save_checkpoint(const QString &path) const;
+    /**
+     * Restores state from a checkpoint written by `save_checkpoint`. Memory content is replaced
+     * whole, the loaded program and symbol table of this machine are kept. Throws
+     * `SimulatorExceptionInput` when the file cannot be read or does not match the machine.
+     */
+    void load_checkpoint(const QString &path);
+
+    /**
+     * Reasons for termination of `run`. Optional reasons are also used as bits of `StopMask`.
+     */
+    enum StopReason : unsigned {
+        SR_NONE = 0,
+        SR_EXIT = 1U << 0,        //> Program reached its end (always stops)
+        SR_TRAP = 1U << 1,        //> Simulator exception, machine is trapped (always stops)
+        SR_EXCEPTION = 1U << 2,   //> Core requested stop on exception (including breakpoints)
+        SR_CYCLE_LIMIT = 1U << 3, //> Core cycle count reached `set_cycle_limit`
+        SR_STEP_LIMIT = 1U << 4,  //> `max_steps` instructions executed (always stops)
+        SR_PAUSED = 1U << 5,      //> `pause` was called during the run (always stops)
+    };
+    using StopMask = unsigned;
+    static constexpr StopMask STOP_DEFAULT = SR_EXCEPTION | SR_CYCLE_LIMIT;
+
+    /**
+     * Runs the machine synchronously in a tight loop, without the timer and the Qt event loop.
+     *
+     * Intended for command line and test runs. Signals are emitted as if the machine was run by
+     * `play` (`program_exit`, `program_trap`, and a single `tick`/`post_tick` pair around the
+     * whole run). Headless machine executes whole basic blocks, the step and cycle limits are
+     * therefore checked only between blocks when far enough from the step limit.
+     *
+     * @param max_steps  maximal number of executed instructions, 0 for unlimited
+     * @param stop_mask  optional conditions (SR_EXCEPTION, SR_CYCLE_LIMIT) ending the run,
+     *                   masked out exception stops are ignored
+     * @return           reason why the run ended
+     */
+    StopReason run(uint64_t max_steps = 0, StopMask stop_mask = STOP_DEFAULT);
+    /**
+     * Phases of `run` for callers executing the steps in another thread (see `MachineWorker`).
+     *
+     * `begin_run` and `end_run` change the status and emit the signals, they have to be called
+     * from the thread owning the machine. `begin_run` returns `SR_NONE` when the run started.
+     * `run_steps` can be called repeatedly in between from any thread, provided nothing else
+     * accesses the machine meanwhile (except `pause` and `request_pause`). It emits no signals
+     * of the machine, a trap is kept and reported by `end_run`.
+     */
+    StopReason begin_run();
+    StopReason run_steps(uint64_t max_steps, StopMask stop_mask);
+    void end_run(StopReason reason);
+    /** Requests the running `run_steps` to end with `SR_PAUSED`, can be called from any thread. */
+    void request_pause();
+    /** True between `begin_run` and `end_run`, the machine may be stepped by another thread. */
+    bool is_run_active() const;
+    /** Cycle count ending the `run` with `SR_CYCLE_LIMIT`, 0 disables the limit. */
+    void set_cycle_limit(uint64_t limit);
+    uint64_t get_cycle_limit() const;
+
+    /**
+     * Enables sampled simulation in following `run` calls (see `SamplingConfig`), config with
+     * zero period disables it. Statistics of previous windows are discarded.
+     *
+     * Fast-forward phases run on an additional functional core (`CoreSingle`) sharing registers,
+     * caches and the predictor with the detailed core. The detailed core is drained at the end
+     * of each measured window. Its cycle count (and thus the cycle limit) includes only detailed
+     * phases. Phases are switched between basic blocks in headless mode, so they may be a few
+     * instructions longer. Hardware breakpoints are checked only by the detailed core.
+     */
+    void set_sampling(const SamplingConfig &config);
+    const SamplingConfig &get_sampling() const;
+    /** Measured windows of the sampled simulation. */
+    const SamplingStatistics &sampling_statistics() const;
+
     void register_exception_handler(ExceptionCause excause, ExceptionHandler *exhandler);
     bool memory_bus_insert_range(
         BackendMemory *mem_acces,
@@ -101,6 +251,7 @@ signals:
 
 private slots:
     void step_timer();
+    void exception_stop_reached();
 
 private:
     void step_internal(bool skip_break = false);
@@ -127,14 +278,41 @@ private:
     CSR::ControlState *controlst = nullptr;
     BranchPredictor *predictor = nullptr;
     Core *cr = nullptr;
+    /** Core fast-forwarding sampled simulation, see `set_sampling`. */
+    Core *cr_functional = nullptr;
+    /** Core executing `run_steps`, `cr` unless fast-forwarding. */
+    Core *cr_active = nullptr;
+
+    enum SamplingPhase { SP_FAST_FORWARD, SP_WARMUP, SP_MEASURE };
+    SamplingConfig sampling {};
+    SamplingPhase sampling_phase = SP_FAST_FORWARD;
+    /** Retired instruction count (`MINSTRET`) ending the current phase. */
+    uint64_t sampling_phase_end = 0;
+    SampleCounters sampling_window_start {};
+    SamplingStatistics sampling_stats {};
 
     QTimer *run_t = nullptr;
     unsigned int time_chunk = { 0 };
+    bool headless = false;
+    uint64_t cycle_limit = 0;
+    /** Stop requests for `run` raised by signal handlers during a step or by other thread. */
+    bool exception_stop = false;
+    std::atomic<bool> pause_requested { false };
+    bool run_resumed = false;
+    bool run_active = false;
+    std::exception_ptr trap_exception;
 
     SymbolTable *symtab = nullptr;
     Address program_end = 0xffff0000_addr;
     enum Status stat = ST_READY;
     void set_status(enum Status st);
+    /** Starts the first fast-forward phase of the sampled simulation. */
+    void start_sampling();
+    /** Switches the phase of the sampled simulation when the current one ended. */
+    void update_sampling();
+    SampleCounters sampling_counters() const;
+    void setup_program(LoadedProgram program);
+    void setup_components();
     void setup_serial_port();
     void setup_perip_spi_led();
     void setup_lcd_display();
@@ -0,0 +1,114 @@
+#include "machine_worker.h"
+
+#include <QElapsedTimer>
+
+using namespace machine;
+
+// Number of instructions executed between checks for publishing.
+constexpr uint64_t RUN_CHUNK_STEPS = 4096;
+
+class MachineWorker::Thread : public QThread {
+public:
+    explicit Thread(MachineWorker *worker) : worker(worker) {}
+
+protected:
+    void run() override { worker->execute(); }
+
+private:
+    BORROWED MachineWorker *const worker;
+};
+
+static void publish_cache(PublishedCacheState &state, const Cache *cache) {
+    state.stats = cache->get_statistics();
+    state.stall_count = cache->get_stall_count();
+    state.speed_improvement = cache->get_speed_improvement();
+    state.hit_rate = cache->get_hit_rate();
+}
+
+MachineWorker::MachineWorker(Machine *machine, QObject *parent)
+    : QObject(parent)
+    , machine(machine)
+    , thread(new Thread(this)) {
+    connect(thread.get(), &QThread::finished, this, &MachineWorker::thread_finished);
+}
+
+MachineWorker::~MachineWorker() {
+    stop();
+}
+
+bool MachineWorker::start(Machine::StopMask stop_mask) {
+    if (running) { return false; }
+    was_headless = machine->is_headless();
+    machine->set_headless(true);
+    if (machine->begin_run() != Machine::SR_NONE) {
+        machine->set_headless(was_headless);
+        return false;
+    }
+    this->stop_mask = stop_mask;
+    stop_reason = Machine::SR_NONE;
+    publish_count = 0;
+    running = true;
+    thread->start();
+    return true;
+}
+
+void MachineWorker::stop() {
+    if (!running) { return; }
+    machine->request_pause();
+    thread_finished();
+}
+
+bool MachineWorker::is_running() const {
+    return running;
+}
+
+bool MachineWorker::poll() {
+    return published.update();
+}
+
+const PublishedState &MachineWorker::state() const {
+    return published.front();
+}
+
+void MachineWorker::set_publish_period(unsigned msec) {
+    publish_period = msec;
+}
+
+void MachineWorker::thread_finished() {
+    // Run may be already completed by `stop`, queued `QThread::finished` arrives later.
+    if (!running) { return; }
+    thread->wait();
+    running = false;
+    machine->set_headless(was_headless);
+    machine->end_run(stop_reason);
+    emit finished(stop_reason);
+}
+
+void MachineWorker::execute() {
+    QElapsedTimer publish_timer;
+    publish_timer.start();
+    Machine::StopReason reason;
+    do {
+        reason = machine->run_steps(RUN_CHUNK_STEPS, stop_mask);
+        if (publish_timer.elapsed() >= publish_period) {
+            publish();
+            publish_timer.restart();
+        }
+    } while (reason == Machine::SR_STEP_LIMIT);
+    // Final state is always published, so the owner can refresh views without the signals.
+    publish();
+    stop_reason = reason;
+}
+
+void MachineWorker::publish() {
+    PublishedState &state = published.back();
+    state.sequence = ++publish_count;
+    state.registers = machine->registers()->snapshot();
+    state.control_state = machine->control_state()->snapshot();
+    state.core_state = machine->core()->get_state();
+    publish_cache(state.cache_program, machine->cache_program());
+    publish_cache(state.cache_data, machine->cache_data());
+    publish_cache(state.cache_level2, machine->cache_level2());
+    state.predictor_stats = machine->core()->get_predictor()->get_total_stats();
+    published.publish();
+}
@@ -0,0 +1,104 @@
+#ifndef MACHINE_WORKER_H
+#define MACHINE_WORKER_H
+
+#include "common/containers/triple_buffer.h"
+#include "common/memory_ownership.h"
+#include "machine.h"
+
+#include <QObject>
+#include <QThread>
+#include <memory>
+
+namespace machine {
+
+/**
+ * Statistics of a single cache as published by `MachineWorker`.
+ */
+struct PublishedCacheState {
+    CacheStatistics stats;
+    uint32_t stall_count = 0;
+    double speed_improvement = 0;
+    double hit_rate = 0;
+};
+
+/**
+ * Copy of the machine state published by `MachineWorker` for display.
+ *
+ * All values are held by value, vector payloads of `core_state` are immutable and shared by
+ * reference counting (see `VectorValueRef`), so the copy does not refer to any data the running
+ * machine modifies.
+ */
+struct PublishedState {
+    /** Number of the publication within the run, 0 when nothing was published yet. */
+    uint64_t sequence = 0;
+    Registers::Snapshot registers;
+    CSR::ControlState::Snapshot control_state;
+    CoreState core_state;
+    PublishedCacheState cache_program;
+    PublishedCacheState cache_data;
+    PublishedCacheState cache_level2;
+    PredictionStatistics predictor_stats;
+};
+
+/**
+ * Runs a machine in its own thread at full speed.
+ *
+ * The machine is switched to headless mode for the run and it is stepped by `Machine::run_steps`
+ * in the worker thread. A copy of the state is published periodically through a lock-free triple
+ * buffer, the owner thread polls it (e.g. at display refresh rate) without ever waiting for the
+ * simulation. Nothing but `stop` may access the machine until `finished` is emitted.
+ *
+ * Signals of peripherals emitted during the run are delivered as queued to receivers in other
+ * threads, signals returning values through references (input polling) are therefore not
+ * served during the run.
+ */
+class MachineWorker : public QObject {
+    Q_OBJECT
+public:
+    explicit MachineWorker(Machine *machine, QObject *parent = nullptr);
+    ~MachineWorker() override;
+
+    /**
+     * Starts the run in the worker thread.
+     *
+     * @return  false when the machine cannot run (exited, trapped) or it is already running
+     */
+    bool start(Machine::StopMask stop_mask = Machine::STOP_DEFAULT);
+    /** Ends the run and waits for the worker, `finished` is emitted before return. */
+    void stop();
+    bool is_running() const;
+
+    /** Takes the latest published state, returns false when no new state was published. */
+    bool poll();
+    /** State taken by the last `poll`. */
+    const PublishedState &state() const;
+    /** Minimal period of publishing during the run in milliseconds. */
+    void set_publish_period(unsigned msec);
+
+signals:
+    /** Run ended, machine is owned by its thread again and it is no longer headless. */
+    void finished(machine::Machine::StopReason reason);
+
+private slots:
+    void thread_finished();
+
+private:
+    class Thread;
+
+    BORROWED Machine *const machine;
+    std::unique_ptr<Thread> thread;
+    TripleBuffer<PublishedState> published;
+    uint64_t publish_count = 0;
+    unsigned publish_period = 16;
+    Machine::StopMask stop_mask = Machine::STOP_DEFAULT;
+    Machine::StopReason stop_reason = Machine::SR_NONE;
+    bool running = false;
+    bool was_headless = false;
+
+    void execute();
+    void publish();
+};
+
+} // namespace machine
+
+#endif // MACHINE_WORKER_H
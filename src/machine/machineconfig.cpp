@@ -1,7 +1,9 @@
 #include "machineconfig.h"
 
 #include "common/endian.h"
+#include "simulator_exception.h"
 
+#include <QJsonDocument>
 #include <QMap>
 #include <utility>
 
@@ -19,6 +21,7 @@ using namespace machine;
 #define DF_MEM_ACC_BURST 0
 #define DF_MEM_ACC_LEVEL2 2
 #define DF_MEM_ACC_BURST_ENABLE false
+#define DF_MEM_BACKEND MB_PAGED
 #define DF_ELF QString("")
 /// Default config of branch predictor
 #define DFC_BP_ENABLED false
@@ -166,6 +169,7 @@ MachineConfig::MachineConfig() {
     mem_acc_burst = DF_MEM_ACC_BURST;
     mem_acc_level2 = DF_MEM_ACC_LEVEL2;
     mem_acc_enable_burst = DF_MEM_ACC_BURST_ENABLE;
+    mem_backend = DF_MEM_BACKEND;
     osem_enable = true;
     osem_known_syscall_stop = true;
     osem_unknown_syscall_stop = true;
@@ -185,7 +189,7 @@ MachineConfig::MachineConfig() {
     bp_btb_bits = DFC_BP_BTB_BITS;
     bp_bhr_bits = DFC_BP_BHR_BITS;
     bp_bht_addr_bits = DFC_BP_BHT_ADDR_BITS;
-    bp_bht_bits = bp_bhr_bits + bp_bht_addr_bits;
+    bp_bht_bits = predictor_table_bits(bp_type, bp_bhr_bits, bp_bht_addr_bits);
 }
 
 MachineConfig::MachineConfig(const MachineConfig *config) {
@@ -202,6 +206,7 @@ MachineConfig::MachineConfig(const MachineConfig *config) {
     mem_acc_burst = config->memory_access_time_burst();
     mem_acc_level2 = config->memory_access_time_level2();
     mem_acc_enable_burst = config->memory_access_enable_burst();
+    mem_backend = config->memory_backend();
     osem_enable = config->osemu_enable();
     osem_known_syscall_stop = config->osemu_known_syscall_stop();
     osem_unknown_syscall_stop = config->osemu_unknown_syscall_stop();
@@ -213,6 +218,7 @@ MachineConfig::MachineConfig(const MachineConfig *config) {
     cch_program = config->cache_program();
     cch_data = config->cache_data();
     cch_level2 = config->cache_level2();
+    timing = config->timing_model();
 
     // Branch predictor
     bp_enabled = config->get_bp_enabled();
@@ -221,7 +227,7 @@ MachineConfig::MachineConfig(const MachineConfig *config) {
     bp_btb_bits = config->get_bp_btb_bits();
     bp_bhr_bits = config->get_bp_bhr_bits();
     bp_bht_addr_bits = config->get_bp_bht_addr_bits();
-    bp_bht_bits = bp_bhr_bits + bp_bht_addr_bits;
+    bp_bht_bits = predictor_table_bits(bp_type, bp_bhr_bits, bp_bht_addr_bits);
 }
 
 #define N(STR) (prefix + QString(STR))
@@ -244,6 +250,7 @@ MachineConfig::MachineConfig(const QSettings *sts, const QString &prefix) {
     mem_acc_burst = sts->value(N("MemoryBurst"), DF_MEM_ACC_BURST).toUInt();
     mem_acc_level2 = sts->value(N("MemoryLevel2"), DF_MEM_ACC_LEVEL2).toUInt();
     mem_acc_enable_burst = sts->value(N("MemoryBurstEnable"), DF_MEM_ACC_BURST_ENABLE).toBool();
+    mem_backend = (enum MemoryBackend)sts->value(N("MemoryBackend"), DF_MEM_BACKEND).toUInt();
     osem_enable = sts->value(N("OsemuEnable"), true).toBool();
     osem_known_syscall_stop = sts->value(N("OsemuKnownSyscallStop"), true).toBool();
     osem_unknown_syscall_stop = sts->value(N("OsemuUnknownSyscallStop"), true).toBool();
@@ -255,6 +262,13 @@ MachineConfig::MachineConfig(const QSettings *sts, const QString &prefix) {
     cch_program = CacheConfig(sts, N("ProgramCache_"));
     cch_data = CacheConfig(sts, N("DataCache_"));
     cch_level2 = CacheConfig(sts, N("Level2Cache_"));
+    // Model is stored as JSON, empty or malformed value selects the built-in model.
+    const QByteArray timing_json = sts->value(N("TimingModel"), "").toString().toUtf8();
+    if (!timing_json.isEmpty()) {
+        try {
+            timing = TimingModel::from_json(QJsonDocument::fromJson(timing_json).object());
+        } catch (SimulatorException &) { timing = TimingModel(); }
+    }
 
     // Branch predictor
     bp_enabled = sts->value(N("BranchPredictor_Enabled"), DFC_BP_ENABLED).toBool();
@@ -265,7 +279,7 @@ MachineConfig::MachineConfig(const QSettings *sts, const QString &prefix) {
     bp_btb_bits = sts->value(N("BranchPredictor_BitsBTB"), DFC_BP_BTB_BITS).toUInt();
     bp_bhr_bits = sts->value(N("BranchPredictor_BitsBHR"), DFC_BP_BHR_BITS).toUInt();
     bp_bht_addr_bits = sts->value(N("BranchPredictor_BitsBHTAddr"), DFC_BP_BHT_ADDR_BITS).toUInt();
-    bp_bht_bits = bp_bhr_bits + bp_bht_addr_bits;
+    bp_bht_bits = predictor_table_bits(bp_type, bp_bhr_bits, bp_bht_addr_bits);
 }
 
 void MachineConfig::store(QSettings *sts, const QString &prefix) {
@@ -279,6 +293,7 @@ void MachineConfig::store(QSettings *sts, const QString &prefix) {
     sts->setValue(N("MemoryBurst"), memory_access_time_burst());
     sts->setValue(N("MemoryLevel2"), memory_access_time_level2());
     sts->setValue(N("MemoryBurstEnable"), memory_access_enable_burst());
+    sts->setValue(N("MemoryBackend"), (unsigned)memory_backend());
     sts->setValue(N("OsemuEnable"), osemu_enable());
     sts->setValue(N("OsemuKnownSyscallStop"), osemu_known_syscall_stop());
     sts->setValue(N("OsemuUnknownSyscallStop"), osemu_unknown_syscall_stop());
@@ -290,6 +305,11 @@ void MachineConfig::store(QSettings *sts, const QString &prefix) {
     cch_program.store(sts, N("ProgramCache_"));
     cch_data.store(sts, N("DataCache_"));
     cch_level2.store(sts, N("Level2Cache_"));
+    sts->setValue(
+        N("TimingModel"),
+        timing == TimingModel()
+            ? QString()
+            : QString::fromUtf8(QJsonDocument(timing.to_json()).toJson(QJsonDocument::Compact)));
 
     // Branch predictor
     sts->setValue(N("BranchPredictor_Enabled"), get_bp_enabled());
@@ -328,6 +348,7 @@ void MachineConfig::preset(enum ConfigPresets p) {
     set_memory_access_time_burst(DF_MEM_ACC_BURST);
     set_memory_access_time_level2(DF_MEM_ACC_LEVEL2);
     set_memory_access_enable_burst(DF_MEM_ACC_BURST_ENABLE);
+    set_timing_model(TimingModel());
 
     // Branch predictor
     set_bp_enabled(DFC_BP_ENABLED);
@@ -404,6 +425,20 @@ void MachineConfig::set_memory_access_enable_burst(bool v) {
     mem_acc_enable_burst = v;
 }
 
+void MachineConfig::set_memory_backend(enum MachineConfig::MemoryBackend mb) {
+    mem_backend = mb;
+}
+
+bool MachineConfig::set_memory_backend(const QString &mbkind) {
+    static QMap<QString, enum MemoryBackend> mbkind_map = {
+        { "tree", MB_TREE },
+        { "paged", MB_PAGED },
+    };
+    if (!mbkind_map.contains(mbkind)) { return false; }
+    set_memory_backend(mbkind_map.value(mbkind));
+    return true;
+}
+
 void MachineConfig::set_osemu_enable(bool v) {
     osem_enable = v;
 }
@@ -506,6 +541,10 @@ bool MachineConfig::memory_access_enable_burst() const {
     return mem_acc_enable_burst;
 }
 
+enum MachineConfig::MemoryBackend MachineConfig::memory_backend() const {
+    return mem_backend;
+}
+
 bool MachineConfig::osemu_enable() const {
     return osem_enable;
 }
@@ -570,12 +609,21 @@ ConfigIsaWord MachineConfig::get_isa_word() const {
     return isa_word;
 }
 
+void MachineConfig::set_timing_model(const TimingModel &model) {
+    timing = model;
+}
+
+const TimingModel &MachineConfig::timing_model() const {
+    return timing;
+}
+
 void MachineConfig::set_bp_enabled(bool e) {
     bp_enabled = e;
 }
 
 void MachineConfig::set_bp_type(PredictorType t) {
     bp_type = t;
+    bp_bht_bits = predictor_table_bits(bp_type, bp_bhr_bits, bp_bht_addr_bits);
 }
 
 void MachineConfig::set_bp_init_state(PredictorState i) {
@@ -590,15 +638,13 @@ void MachineConfig::set_bp_bhr_bits(uint8_t b) {
     bp_bhr_bits = b > BP_MAX_BHR_BITS ? BP_MAX_BHR_BITS : b;
     bp_bht_addr_bits
         = bp_bht_addr_bits > BP_MAX_BHT_ADDR_BITS ? BP_MAX_BHT_ADDR_BITS : bp_bht_addr_bits;
-    bp_bht_bits = bp_bhr_bits + bp_bht_addr_bits;
-    bp_bht_bits = bp_bht_bits > BP_MAX_BHT_BITS ? BP_MAX_BHT_BITS : bp_bht_bits;
+    bp_bht_bits = predictor_table_bits(bp_type, bp_bhr_bits, bp_bht_addr_bits);
 }
 
 void MachineConfig::set_bp_bht_addr_bits(uint8_t b) {
     bp_bht_addr_bits = b > BP_MAX_BHT_ADDR_BITS ? BP_MAX_BHT_ADDR_BITS : b;
     bp_bhr_bits = bp_bhr_bits > BP_MAX_BHR_BITS ? BP_MAX_BHR_BITS : bp_bhr_bits;
-    bp_bht_bits = bp_bhr_bits + bp_bht_addr_bits;
-    bp_bht_bits = bp_bht_bits > BP_MAX_BHT_BITS ? BP_MAX_BHT_BITS : bp_bht_bits;
+    bp_bht_bits = predictor_table_bits(bp_type, bp_bhr_bits, bp_bht_addr_bits);
 }
 
 bool MachineConfig::get_bp_enabled() const {
@@ -638,8 +684,8 @@ bool MachineConfig::operator==(const MachineConfig &c) const {
            && CMP(memory_execute_protection) && CMP(memory_write_protection)
            && CMP(memory_access_time_read) && CMP(memory_access_time_write)
            && CMP(memory_access_time_burst) && CMP(memory_access_time_level2)
-           && CMP(memory_access_enable_burst) && CMP(elf) && CMP(cache_program) && CMP(cache_data)
-           && CMP(cache_level2);
+           && CMP(memory_access_enable_burst) && CMP(memory_backend) && CMP(elf) && CMP(cache_program) && CMP(cache_data)
+           && CMP(cache_level2) && CMP(timing_model);
 #undef CMP
 }
 
@@ -4,6 +4,7 @@
 #include "common/endian.h"
 #include "config_isa.h"
 #include "predictor_types.h"
+#include "timing_model.h"
 
 #include <QSettings>
 #include <QString>
@@ -92,6 +93,10 @@ public:
     void preset(enum ConfigPresets);
 
     enum HazardUnit { HU_NONE, HU_STALL, HU_STALL_FORWARD };
+    enum MemoryBackend {
+        MB_TREE, // Tree of small sections, 32-bit address space
+        MB_PAGED // Sparse copy-on-write 4 KiB pages, 64-bit address space
+    };
 
     // Configure if CPU is pipelined
     // In default disabled.
@@ -114,6 +119,9 @@ public:
     void set_memory_access_time_burst(unsigned);
     void set_memory_access_time_level2(unsigned);
     void set_memory_access_enable_burst(bool);
+    // Storage organization of the main memory
+    void set_memory_backend(enum MemoryBackend);
+    bool set_memory_backend(const QString &mbkind);
     // Operating system and exceptions setup
     void set_osemu_enable(bool);
     void set_osemu_known_syscall_stop(bool);
@@ -134,6 +142,8 @@ public:
     void set_simulated_xlen(Xlen xlen);
     void set_isa_word(ConfigIsaWord bits);
     void modify_isa_word(ConfigIsaWord mask, ConfigIsaWord val);
+    // Cycle cost model of the core
+    void set_timing_model(const TimingModel &model);
 
     bool pipelined() const;
     bool delay_slot() const;
@@ -145,6 +155,7 @@ public:
     unsigned memory_access_time_burst() const;
     unsigned memory_access_time_level2() const;
     bool memory_access_enable_burst() const;
+    enum MemoryBackend memory_backend() const;
     bool osemu_enable() const;
     bool osemu_known_syscall_stop() const;
     bool osemu_unknown_syscall_stop() const;
@@ -159,6 +170,7 @@ public:
     Endian get_simulated_endian() const;
     Xlen get_simulated_xlen() const;
     ConfigIsaWord get_isa_word() const;
+    const TimingModel &timing_model() const;
 
     // Branch predictor - Setters
     void set_bp_enabled(bool e);
@@ -189,6 +201,7 @@ private:
     bool exec_protect, write_protect;
     unsigned mem_acc_read, mem_acc_write, mem_acc_burst, mem_acc_level2;
     bool mem_acc_enable_burst;
+    enum MemoryBackend mem_backend;
     bool osem_enable, osem_known_syscall_stop, osem_unknown_syscall_stop;
     bool osem_interrupt_stop, osem_exception_stop;
     bool res_at_compile;
@@ -198,6 +211,7 @@ private:
     Endian simulated_endian;
     Xlen simulated_xlen;
     ConfigIsaWord isa_word;
+    TimingModel timing;
 
     // Branch predictor
     bool bp_enabled;
@@ -206,7 +220,7 @@ private:
     uint8_t bp_btb_bits;
     uint8_t bp_bhr_bits;
     uint8_t bp_bht_addr_bits;
-    uint8_t bp_bht_bits; // = bp_bhr_bits + bp_bht_addr_bits
+    uint8_t bp_bht_bits; // See `predictor_table_bits`
 };
 
 } // namespace machine
@@ -99,6 +99,15 @@ enum LocationStatus {
 };
 
 const Address STAGEADDR_NONE = 0xffffffff_addr;
+
+/** Last address of the RAM, peripherals are mapped above it. */
+constexpr Address RAM_LAST_ADDR = 0xefffffff_addr;
+/**
+ * RV64 machines with paged memory have RAM above 4 GiB too, it is mapped to the same offsets
+ * of the memory and ends by the end of the Sv39 user address space.
+ */
+constexpr Address RAM_HIGH_START_ADDR = 0x100000000_addr;
+constexpr Address RAM_HIGH_LAST_ADDR = 0x3fffffffff_addr;
 } // namespace machine
 
 Q_DECLARE_METATYPE(machine::AccessControl)
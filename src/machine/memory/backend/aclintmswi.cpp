@@ -3,6 +3,7 @@
 #include "common/endian.h"
 
 #include <QTimerEvent>
+#include <algorithm>
 
 using ae = machine::AccessEffects; // For enum values, type is obvious from
                                    // context.
@@ -32,6 +33,18 @@ bool AclintMswi::update_mswi_irq() {
     return active;
 }
 
+AclintMswi::Snapshot AclintMswi::snapshot() const {
+    Snapshot snapshot;
+    std::copy(std::begin(mswi_value), std::end(mswi_value), snapshot.msip);
+    return snapshot;
+}
+
+void AclintMswi::restore(const Snapshot &snapshot) {
+    for (unsigned i = 0; i < mswi_count; i++) {
+        write_reg32(ACLINT_MSWI_OFFSET + 4 * i, snapshot.msip[i] ? 1 : 0);
+    }
+}
+
 WriteResult AclintMswi::write(
     Offset destination,
     const void *source,
@@ -50,6 +50,13 @@ public:
 
     [[nodiscard]] LocationStatus location_status(Offset offset) const override;
 
+    /** Software interrupt pending bits, see `Machine::snapshot`. */
+    struct Snapshot {
+        bool msip[ACLINT_MSWI_COUNT_MAX] {};
+    };
+    [[nodiscard]] Snapshot snapshot() const;
+    void restore(const Snapshot &snapshot);
+
 private:
     /** endian of internal registers of the periphery use. */
     static constexpr Endian internal_endian = NATIVE_ENDIAN;
@@ -3,6 +3,7 @@
 #include "common/endian.h"
 
 #include <QTimerEvent>
+#include <algorithm>
 #include <common/logging.h>
 
 LOG_CATEGORY("machine.memory.aclintmtimer");
@@ -38,6 +39,20 @@ uint64_t AclintMtimer::mtime_fetch_current() const {
     return mtime_last_current_fetch;
 }
 
+AclintMtimer::Snapshot AclintMtimer::snapshot() const {
+    Snapshot snapshot;
+    snapshot.mtime = mtime_fetch_current() + mtime_user_offset;
+    std::copy(std::begin(mtimecmp_value), std::end(mtimecmp_value), snapshot.mtimecmp);
+    return snapshot;
+}
+
+void AclintMtimer::restore(const Snapshot &snapshot) {
+    for (unsigned i = 0; i < mtimecmp_count; i++) {
+        write_reg64(ACLINT_MTIMECMP_OFFSET + 8 * i, snapshot.mtimecmp[i]);
+    }
+    write_reg64(ACLINT_MTIME_OFFSET, snapshot.mtime);
+}
+
 bool AclintMtimer::update_mtimer_irq() {
     bool active;
 
@@ -40,6 +40,16 @@ namespace machine { namespace aclint {
     public:
         uint64_t mtime_fetch_current() const;
 
+        /** Timer registers, see `Machine::snapshot`. */
+        struct Snapshot {
+            uint64_t mtime = 0;
+            uint64_t mtimecmp[ACLINT_MTIMECMP_COUNT_MAX] {};
+        };
+        [[nodiscard]] Snapshot snapshot() const;
+        /** Sets registers as by writes of the program, `mtime` continues from the value. */
+        void restore(const Snapshot &snapshot);
+
+
         WriteResult
         write(Offset destination, const void *source, size_t size, WriteOptions options) override;
 
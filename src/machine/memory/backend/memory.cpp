@@ -3,7 +3,10 @@
 #include "common/endian.h"
 #include "simulator_exception.h"
 
+#include <algorithm>
+#include <array>
 #include <memory>
+#include <vector>
 
 namespace machine {
 
@@ -125,34 +128,71 @@ Memory::Memory() : BackendMemory(BIG) {
     this->mt_root = nullptr;
 }
 
-Memory::Memory(Endian simulated_machine_endian)
+Memory::Memory(Endian simulated_machine_endian, MemoryLayout layout)
     : BackendMemory(simulated_machine_endian) {
-    this->mt_root = allocate_section_tree();
+    if (layout == MemoryLayout::PAGED) {
+        this->mt_root = nullptr;
+        this->page_table = new PageTable();
+    } else {
+        this->mt_root = allocate_section_tree();
+    }
 }
 
 Memory::Memory(const Memory &other)
     : BackendMemory(other.simulated_machine_endian) {
-    this->mt_root = copy_section_tree(other.get_memory_tree_root(), 0);
+    this->mt_root = nullptr;
+    copy_storage(other);
 }
 
 Memory::~Memory() {
-    free_section_tree(this->mt_root, 0);
-    delete[] this->mt_root;
+    release_storage();
 }
 
 void Memory::reset() {
-    free_section_tree(this->mt_root, 0);
-    delete[] this->mt_root;
+    if (this->page_table != nullptr) {
+        this->page_table->clear();
+        return;
+    }
+    release_storage();
     this->mt_root = allocate_section_tree();
 }
 
 void Memory::reset(const Memory &m) {
-    free_section_tree(this->mt_root, 0);
-    this->mt_root = copy_section_tree(m.get_memory_tree_root(), 0);
+    if (&m == this) { return; }
+    if (this->page_table != nullptr && m.page_table != nullptr) {
+        this->page_table->assign(*m.page_table);
+        return;
+    }
+    release_storage();
+    copy_storage(m);
+}
+
+MemoryLayout Memory::layout() const {
+    return (this->page_table != nullptr) ? MemoryLayout::PAGED : MemoryLayout::TREE;
+}
+
+void Memory::release_storage() {
+    delete this->page_table;
+    this->page_table = nullptr;
+    if (this->mt_root != nullptr) {
+        free_section_tree(this->mt_root, 0);
+        delete[] this->mt_root;
+        this->mt_root = nullptr;
+    }
+}
+
+void Memory::copy_storage(const Memory &m) {
+    if (m.page_table != nullptr) {
+        // Pages are shared until one of the memories writes to them.
+        this->page_table = new PageTable(*m.page_table);
+    } else if (m.get_memory_tree_root() != nullptr) {
+        this->mt_root = copy_section_tree(m.get_memory_tree_root(), 0);
+    }
 }
 
 MemorySection *Memory::get_section(size_t offset, bool create) const {
     union MemoryTree *w = this->mt_root;
+    if (w == nullptr) { return nullptr; }
     size_t row_num;
     // Walk memory tree branch from root to leaf and create new nodes when
     // needed and requested (`create` flag).
@@ -183,11 +223,95 @@ size_t get_section_offset_mask(size_t addr) {
     return addr & generate_mask(MEMORY_SECTION_BITS, 0);
 }
 
+const byte *Memory::direct_read_pointer(Offset offset, size_t size) const {
+    if (page_table != nullptr) {
+        const size_t page_offset = offset & (PAGE_TABLE_PAGE_SIZE - 1);
+        if (page_offset + size > PAGE_TABLE_PAGE_SIZE) { return nullptr; }
+        const byte *page = page_table->find_page(offset);
+        return (page != nullptr) ? page + page_offset : nullptr;
+    }
+    const size_t section_offset = get_section_offset_mask(offset);
+    if (section_offset + size > MEMORY_SECTION_SIZE) { return nullptr; }
+    const MemorySection *section = get_section(offset, false);
+    return (section != nullptr) ? section->data() + section_offset : nullptr;
+}
+
+void Memory::discard(Offset offset, size_t size) {
+    if (page_table != nullptr) {
+        page_table->discard(offset, size);
+        return;
+    }
+    const uint64_t end = std::min<uint64_t>(offset + size, uint64_t(1) << 32);
+    if (mt_root != nullptr && offset < end) { discard_section_tree(mt_root, 0, 0, offset, end); }
+}
+
+bool Memory::discard_section_tree(
+    union MemoryTree *mt,
+    size_t depth,
+    uint64_t base,
+    uint64_t start,
+    uint64_t end) {
+    static const std::array<byte, MEMORY_SECTION_SIZE> zeros {};
+    const uint64_t child_size = uint64_t(1) << tree_row_bit_offset(depth);
+    bool empty = true;
+    for (size_t i = 0; i < MEMORY_TREE_ROW_SIZE; i++) {
+        const uint64_t child_start = base + i * child_size;
+        const uint64_t child_end = child_start + child_size;
+        const bool covered = start <= child_start && child_end <= end;
+        const bool touched = start < child_end && child_start < end;
+        if (depth < (MEMORY_TREE_DEPTH - 1)) { // Following level is memory tree
+            if (mt[i].subtree == nullptr) { continue; }
+            if (touched
+                && discard_section_tree(mt[i].subtree, depth + 1, child_start, start, end)) {
+                delete[] mt[i].subtree;
+                mt[i].subtree = nullptr;
+                continue;
+            }
+        } else { // Following level is memory section
+            if (mt[i].sec == nullptr) { continue; }
+            if (covered) {
+                delete mt[i].sec;
+                mt[i].sec = nullptr;
+                continue;
+            }
+            if (touched) {
+                const uint64_t from = std::max(child_start, start) - child_start;
+                const uint64_t to = std::min(child_end, end) - child_start;
+                mt[i].sec->write(from, zeros.data(), to - from, {});
+            }
+        }
+        empty = false;
+    }
+    return empty;
+}
+
 WriteResult Memory::write(
     Offset destination,
     const void *source,
     size_t size,
     WriteOptions options) {
+    if (page_table != nullptr) {
+        return repeat_access_until_completed<WriteResult>(
+            destination, source, size, options,
+            [this](Offset _destination, const void *_source, size_t _size, WriteOptions) {
+                const size_t page_offset = _destination & (PAGE_TABLE_PAGE_SIZE - 1);
+                const size_t available_size = std::min(_size, PAGE_TABLE_PAGE_SIZE - page_offset);
+                const byte *page = page_table->find_page(_destination);
+                bool changed;
+                if (page != nullptr) {
+                    changed = memcmp(_source, page + page_offset, available_size) != 0;
+                } else {
+                    // Unallocated page reads as zeros, writing zeros does not allocate it.
+                    const auto *src = static_cast<const byte *>(_source);
+                    changed = std::any_of(src, src + available_size, [](byte b) { return b != 0; });
+                }
+                if (changed) {
+                    memcpy(page_table->page_for_write(_destination) + page_offset, _source,
+                           available_size);
+                }
+                return WriteResult { .n_bytes = available_size, .changed = changed };
+            });
+    }
     return repeat_access_until_completed<WriteResult>(
         destination, source, size, options,
         [this](
@@ -204,6 +328,21 @@ ReadResult Memory::read(
     Offset source,
     size_t size,
     ReadOptions options) const {
+    if (page_table != nullptr) {
+        return repeat_access_until_completed<ReadResult>(
+            destination, source, size, options,
+            [this](void *_destination, Offset _source, size_t _size, ReadOptions) {
+                const size_t page_offset = _source & (PAGE_TABLE_PAGE_SIZE - 1);
+                const size_t available_size = std::min(_size, PAGE_TABLE_PAGE_SIZE - page_offset);
+                const byte *page = page_table->find_page(_source);
+                if (page == nullptr) {
+                    memset(_destination, 0, available_size);
+                } else {
+                    memcpy(_destination, page + page_offset, available_size);
+                }
+                return ReadResult { .n_bytes = available_size };
+            });
+    }
     return repeat_access_until_completed<ReadResult>(
         destination, source, size, options,
         [this](
@@ -227,7 +366,54 @@ uint32_t Memory::get_change_counter() const {
 }
 
 bool Memory::operator==(const Memory &m) const {
-    return compare_section_tree(this->mt_root, m.get_memory_tree_root(), 0);
+    if (this->mt_root != nullptr && m.get_memory_tree_root() != nullptr) {
+        return compare_section_tree(this->mt_root, m.get_memory_tree_root(), 0);
+    }
+    return compare_content(m);
+}
+
+bool Memory::compare_content(const Memory &m) const {
+    // Storage which has never been written reads as zeros, so allocated blocks of each memory
+    // are compared with the same range read from the other one.
+    bool equal = true;
+    auto compare_allocated = [&equal](const Memory &a, const Memory &b) {
+        std::vector<byte> buffer;
+        a.for_each_allocated([&](uint64_t offset, const byte *data, size_t length) {
+            if (!equal) { return; }
+            buffer.resize(length);
+            b.read(buffer.data(), offset, length, { .type = AccessEffects::INTERNAL });
+            equal = memcmp(buffer.data(), data, length) == 0;
+        });
+    };
+    compare_allocated(*this, m);
+    if (equal) { compare_allocated(m, *this); }
+    return equal;
+}
+
+template<typename FUNC>
+void Memory::for_each_allocated(FUNC fn) const {
+    if (page_table != nullptr) {
+        page_table->for_each_page(
+            [&fn](uint64_t offset, const byte *data) { fn(offset, data, PAGE_TABLE_PAGE_SIZE); });
+    } else if (mt_root != nullptr) {
+        for_each_section(mt_root, 0, 0, fn);
+    }
+}
+
+void Memory::for_each_block(const std::function<void(Offset, const byte *, size_t)> &fn) const {
+    for_each_allocated(fn);
+}
+
+template<typename FUNC>
+void Memory::for_each_section(const union MemoryTree *mt, size_t depth, uint64_t base, FUNC &fn) {
+    for (size_t i = 0; i < MEMORY_TREE_ROW_SIZE; i++) {
+        const uint64_t offset = base | (uint64_t(i) << tree_row_bit_offset(depth));
+        if (depth < (MEMORY_TREE_DEPTH - 1)) { // Following level is memory tree
+            if (mt[i].subtree != nullptr) { for_each_section(mt[i].subtree, depth + 1, offset, fn); }
+        } else if (mt[i].sec != nullptr) { // Following level is memory section
+            fn(offset, mt[i].sec->data(), mt[i].sec->length());
+        }
+    }
 }
 
 bool Memory::operator!=(const Memory &m) const {
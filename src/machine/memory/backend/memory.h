@@ -5,12 +5,14 @@
 #include "machinedefs.h"
 #include "memory/address.h"
 #include "memory/backend/backend_memory.h"
+#include "memory/backend/page_table.h"
 #include "memory/memory_utils.h"
 #include "simulator_exception.h"
 #include "utils.h"
 
 #include <QObject>
 #include <cstdint>
+#include <functional>
 
 namespace machine {
 
@@ -68,6 +70,14 @@ union MemoryTree {
     MemorySection *sec;
 };
 
+/**
+ * Storage organization used by `Memory`.
+ */
+enum class MemoryLayout {
+    TREE,  //> Tree of 256 B sections (offsets limited to 32 bits)
+    PAGED, //> Copy-on-write 4 KiB pages, see `PageTable` (full 64-bit offsets)
+};
+
 /**
  * NOTE: Internal endian of memory must be the same as endian of the whole
  * simulated machine. Therefore it does not have internal_endian field.
@@ -77,14 +87,36 @@ class Memory final : public BackendMemory {
 public:
     // This is dummy constructor for qt internal uses only.
     Memory();
-    explicit Memory(Endian simulated_machine_endian);
+    explicit Memory(Endian simulated_machine_endian, MemoryLayout layout = MemoryLayout::TREE);
+    /** Copy has the same layout as the original. Pages of paged memory are shared (COW). */
     Memory(const Memory &);
     ~Memory() override;
     void reset(); // Reset whole content of memory (removes old tree and creates
                   // new one)
     void reset(const Memory &);
 
-    // returns section containing given address
+    [[nodiscard]] MemoryLayout layout() const;
+
+    /**
+     * Returns pointer to `size` bytes stored at `offset`, when they are held contiguously
+     * (within a single section or page). Returns nullptr otherwise, including never written
+     * areas. The pointer is valid until the next write or reset.
+     */
+    [[nodiscard]] const byte *direct_read_pointer(Offset offset, size_t size) const;
+
+    /**
+     * Calls `fn(offset, data, length)` for each allocated section or page, never written areas
+     * are skipped. Used to store the content (see `Machine::save_checkpoint`).
+     */
+    void for_each_block(const std::function<void(Offset, const byte *, size_t)> &fn) const;
+
+    /**
+     * Zeroes `size` bytes at `offset`. Pages of paged memory and sections of the tree layout
+     * covered entirely by the range are released.
+     */
+    void discard(Offset offset, size_t size);
+
+    // returns section containing given address (tree layout only, nullptr otherwise)
     [[nodiscard]] MemorySection *get_section(size_t offset, bool create) const;
 
     WriteResult write(
@@ -108,9 +140,28 @@ public:
 
 private:
     union MemoryTree *mt_root;
+    PageTable *page_table = nullptr;
     uint32_t change_counter = 0;
+    void release_storage();
+    void copy_storage(const Memory &);
+    bool compare_content(const Memory &) const;
+    template<typename FUNC>
+    void for_each_allocated(FUNC fn) const;
+    template<typename FUNC>
+    static void for_each_section(const union MemoryTree *, size_t depth, uint64_t base, FUNC &fn);
     static union MemoryTree *allocate_section_tree();
     static void free_section_tree(union MemoryTree *, size_t depth);
+    /**
+     * Releases sections of the subtree `mt` (covering offsets from `base`) within the range
+     * `start` to `end` and zeroes the partially covered ones. Returns whether the subtree holds
+     * no section anymore.
+     */
+    static bool discard_section_tree(
+        union MemoryTree *mt,
+        size_t depth,
+        uint64_t base,
+        uint64_t start,
+        uint64_t end);
     static bool compare_section_tree(
         const union MemoryTree *,
         const union MemoryTree *,
@@ -122,5 +173,6 @@ private:
 } // namespace machine
 
 Q_DECLARE_METATYPE(machine::Memory);
+Q_DECLARE_METATYPE(machine::MemoryLayout)
 
 #endif // MEMORY_H
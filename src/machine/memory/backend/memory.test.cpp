@@ -8,6 +8,10 @@
 #include "tests/utils/integer_decomposition.h"
 
 #include <cinttypes>
+#include <fstream>
+#ifdef __linux__
+    #include <unistd.h>
+#endif
 
 using namespace machine;
 
@@ -102,13 +106,28 @@ void TestMemory::memory_data() {
 }
 
 void TestMemory::memory() {
+    memory_access_test(MemoryLayout::TREE);
+}
+
+void TestMemory::memory_paged_data() {
+    // Includes page boundary crossing and offsets beyond 32 bits.
+    constexpr array<Offset, 5> addresses { 0x0, 0xFFFFFFFC, 0xFFFFC, 0x123456789FFC,
+                                           0xFFFFFFFFFFFFFF00 };
+    prepare_data(default_endians, addresses, default_strides, default_values);
+}
+
+void TestMemory::memory_paged() {
+    memory_access_test(MemoryLayout::PAGED);
+}
+
+void TestMemory::memory_access_test(MemoryLayout layout) {
     QFETCH(Endian, endian);
     QFETCH(Offset, address);
     QFETCH(Offset, stride);
     QFETCH(IntegerDecomposition, value);
     QFETCH(IntegerDecomposition, result);
 
-    Memory m(endian);
+    Memory m(endian, layout);
 
     // Uninitialized memory should read as zero
     QCOMPARE(memory_read_u8(&m, address + stride), (uint8_t)0);
@@ -253,6 +272,38 @@ void TestMemory::memory_compare() {
     QVERIFY(m1 != m3);
 }
 
+void TestMemory::memory_paged_copy_on_write_data() {
+    prepare_endian_test();
+}
+
+void TestMemory::memory_paged_copy_on_write() {
+    QFETCH(Endian, endian);
+
+    Memory m1(endian, MemoryLayout::PAGED);
+    memory_write_u32(&m1, 0x1000, 0x11223344);
+    memory_write_u32(&m1, 0x100000000, 0x55667788);
+
+    Memory m2(m1);
+    QCOMPARE(m2.layout(), MemoryLayout::PAGED);
+    QCOMPARE(m1, m2);
+    memory_write_u32(&m2, 0x1000, 0xdeadbeef);
+    QCOMPARE(memory_read_u32(&m1, 0x1000), (uint32_t)0x11223344);
+    QCOMPARE(memory_read_u32(&m2, 0x1000), (uint32_t)0xdeadbeef);
+    QVERIFY(m1 != m2);
+
+    m2.reset(m1);
+    QCOMPARE(m1, m2);
+    memory_write_u32(&m1, 0x100000000, 0);
+    QCOMPARE(memory_read_u32(&m2, 0x100000000), (uint32_t)0x55667788);
+
+    // Content comparison between layouts
+    Memory tree(endian, MemoryLayout::TREE);
+    memory_write_u32(&tree, 0x1000, 0x11223344);
+    QCOMPARE(tree, m1);
+    memory_write_u8(&tree, 0x2000, 0x1);
+    QVERIFY(tree != m1);
+}
+
 void TestMemory::memory_write_ctl_data() {
     QTest::addColumn<AccessControl>("ctl");
     QTest::addColumn<Memory>("result");
@@ -369,4 +420,164 @@ void TestMemory::memory_memtest() {
     }
 }
 
+void TestMemory::memory_discard_data() {
+    QTest::addColumn<MemoryLayout>("layout");
+    QTest::addRow("tree") << MemoryLayout::TREE;
+    QTest::addRow("paged") << MemoryLayout::PAGED;
+}
+
+void TestMemory::memory_discard() {
+    QFETCH(MemoryLayout, layout);
+
+    Memory ram(LITTLE, layout);
+    MemoryDataBus bus(LITTLE);
+    QVERIFY(bus.insert_device_to_range(&ram, 0x0_addr, 0xefffffff_addr, false));
+    for (uint64_t offset = 0; offset < 0x5000; offset += 4) {
+        bus.write_u32(Address(0x10000 + offset), uint32_t(offset) | 1);
+    }
+
+    // Range starts and ends within a page.
+    bus.discard_span(0x10ffc_addr, 0x3008);
+    QCOMPARE(bus.read_u32(0x10ff8_addr), (uint32_t)0xff9);
+    QCOMPARE(bus.read_u32(0x10ffc_addr), (uint32_t)0);
+    QCOMPARE(bus.read_u32(0x12000_addr), (uint32_t)0);
+    QCOMPARE(bus.read_u32(0x14000_addr), (uint32_t)0);
+    QCOMPARE(bus.read_u32(0x14004_addr), (uint32_t)0x4005);
+
+    bus.discard_span(0x0_addr, 0x100000);
+    QCOMPARE(bus.read_u32(0x10ff8_addr), (uint32_t)0);
+    // All storage is released, comparison of the tree layout is structural.
+    QCOMPARE(ram, Memory(LITTLE, layout));
+    bus.write_u32(0x12000_addr, 0x1234);
+    QCOMPARE(bus.read_u32(0x12000_addr), (uint32_t)0x1234);
+}
+
+void TestMemory::memory_discard_release() {
+#ifdef __linux__
+    // Resident size of the process, the second field of statm in host pages.
+    const auto resident_bytes = []() {
+        std::ifstream statm("/proc/self/statm");
+        uint64_t size = 0, resident = 0;
+        statm >> size >> resident;
+        return resident * uint64_t(sysconf(_SC_PAGESIZE));
+    };
+    constexpr uint64_t SIZE = 64 << 20;
+
+    Memory ram(LITTLE, MemoryLayout::PAGED);
+    TrivialBus bus(&ram);
+    const uint64_t before = resident_bytes();
+    for (uint64_t offset = 0; offset < SIZE; offset += PAGE_TABLE_PAGE_SIZE) {
+        bus.write_u32(Address(offset), uint32_t(offset) | 1);
+    }
+    const uint64_t written = resident_bytes();
+    QVERIFY(written >= before + SIZE / 2);
+
+    // Discarded pages are given back to the host, not only kept for reuse.
+    ram.discard(0, SIZE);
+    QVERIFY(resident_bytes() + SIZE / 2 <= written);
+
+    // Reused pages read as zero.
+    for (uint64_t offset = 0; offset < SIZE; offset += PAGE_TABLE_PAGE_SIZE) {
+        bus.write_u8(Address(offset), 1);
+        QCOMPARE(bus.read_u8(Address(offset)), uint8_t(1));
+        QCOMPARE(bus.read_u32(Address(offset + 4)), uint32_t(0));
+    }
+#else
+    QSKIP("Resident memory size is measured only on Linux.");
+#endif
+}
+
+void TestMemory::memory_bus_range_cache() {
+    Memory ram(BIG, MemoryLayout::PAGED);
+    auto *device = new Memory(BIG);
+    MemoryDataBus bus(BIG);
+    QVERIFY(bus.insert_device_to_range(&ram, 0x0_addr, 0xefffffff_addr, false));
+    QVERIFY(bus.insert_device_to_range(device, 0xffffc000_addr, 0xffffc03f_addr, true));
+
+    bus.write_u32(0x1000_addr, 0x11223344);
+    bus.write_u32(0xffffc010_addr, 0x55667788);
+    for (int i = 0; i < 4; i++) {
+        QCOMPARE(bus.read_u32(0x1000_addr), (uint32_t)0x11223344);
+        QCOMPARE(bus.read_u32(0xffffc010_addr), (uint32_t)0x55667788);
+        QCOMPARE(bus.read_u32(0xf0000000_addr), (uint32_t)0);
+    }
+    // Read crossing page boundary cannot use direct pointer.
+    bus.write_u64(0xffc_addr, 0x0102030405060708);
+    QCOMPARE(bus.read_u64(0xffc_addr), (uint64_t)0x0102030405060708);
+
+    // Range found last must not survive change of mapping.
+    QCOMPARE(bus.read_u32(0xffffc010_addr), (uint32_t)0x55667788);
+    QVERIFY(bus.remove_device(device));
+    QCOMPARE(bus.read_u32(0xffffc010_addr), (uint32_t)0);
+    auto *replacement = new Memory(BIG);
+    QVERIFY(bus.insert_device_to_range(replacement, 0xffffc000_addr, 0xffffc03f_addr, true));
+    bus.write_u32(0xffffc010_addr, 0xcafe);
+    QCOMPARE(memory_read_u32(replacement, 0x10), (uint32_t)0xcafe);
+    QCOMPARE(bus.read_u32(0xffffc010_addr), (uint32_t)0xcafe);
+}
+
+void TestMemory::memory_bus_device_ranges() {
+    Memory ram(LITTLE, MemoryLayout::PAGED);
+    MemoryDataBus bus(LITTLE);
+    QVERIFY(bus.insert_device_to_range(&ram, 0x0_addr, 0xefffffff_addr, false));
+    QVERIFY(bus.insert_device_to_range(
+        &ram, 0x100000000_addr, 0x3fffffffff_addr, false, 0x100000000));
+    QVERIFY(!bus.insert_device_to_range(&ram, 0x200000000_addr, 0x200000fff_addr, false));
+
+    // The high range is mapped to the same offsets, the hole is left for peripherals.
+    TrivialBus device_view(&ram);
+    bus.write_u32(0x2000001000_addr, 0x11223344);
+    bus.write_u32(0x1000_addr, 0x55667788);
+    QCOMPARE(device_view.read_u32(0x2000001000_addr), (uint32_t)0x11223344);
+    QCOMPARE(device_view.read_u32(0x1000_addr), (uint32_t)0x55667788);
+    QCOMPARE(bus.read_u32(0x2000001000_addr), (uint32_t)0x11223344);
+    QCOMPARE(bus.location_status(0xf0000000_addr), LOCSTAT_ILLEGAL);
+    bus.discard_span(0x2000000000_addr, 0x2000);
+    QCOMPARE(device_view.read_u32(0x2000001000_addr), (uint32_t)0);
+
+    // Removal of the device removes all its ranges.
+    QVERIFY(bus.remove_device(&ram));
+    QCOMPARE(bus.location_status(0x1000_addr), LOCSTAT_ILLEGAL);
+    QCOMPARE(bus.location_status(0x2000001000_addr), LOCSTAT_ILLEGAL);
+    QVERIFY(!bus.remove_device(&ram));
+}
+
+void TestMemory::memory_bus_lookup_benchmark_data() {
+    QTest::addColumn<MemoryLayout>("layout");
+    QTest::addRow("tree") << MemoryLayout::TREE;
+    QTest::addRow("paged") << MemoryLayout::PAGED;
+}
+
+void TestMemory::memory_bus_lookup_benchmark() {
+    QFETCH(MemoryLayout, layout);
+    constexpr uint64_t accesses = 1 << 20;
+
+    // Same ranges as the simulated machine.
+    Memory ram(LITTLE, layout);
+    MemoryDataBus bus(LITTLE);
+    bus.insert_device_to_range(&ram, 0x0_addr, 0xefffffff_addr, false);
+    bus.insert_device_to_range(new Memory(LITTLE), 0xffffc000_addr, 0xffffc03f_addr, true);
+    bus.insert_device_to_range(new Memory(LITTLE), 0xffe00000_addr, 0xffe4afff_addr, true);
+    bus.insert_device_to_range(new Memory(LITTLE), 0xffffc100_addr, 0xffffc1ff_addr, true);
+    for (uint64_t offset = 0; offset < 0x4000; offset += 4) {
+        bus.write_u32(Address(0x10000 + offset), uint32_t(offset));
+    }
+
+    uint32_t sum = 0;
+    QElapsedTimer timer;
+    timer.start();
+    for (uint64_t i = 0; i < accesses; i++) {
+        sum += bus.read_u32(Address(0x10000 + ((i * 4) & 0x3fff)));
+    }
+    const qint64 elapsed_ns = std::max<qint64>(timer.nsecsElapsed(), 1);
+    qInfo("%.1f M lookups/s", double(accesses) * 1e3 / double(elapsed_ns));
+    QCOMPARE(sum, uint32_t((accesses / 0x1000) * (0x3ffc / 2) * 0x1000));
+
+    QBENCHMARK {
+        for (uint64_t i = 0; i < 0x1000; i++) {
+            sum += bus.read_u32(Address(0x10000 + i * 4));
+        }
+    }
+}
+
 QTEST_APPLESS_MAIN(TestMemory)
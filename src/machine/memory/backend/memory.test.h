@@ -1,6 +1,8 @@
 #ifndef MEMORY_TEST_H
 #define MEMORY_TEST_H
 
+#include "machine/memory/backend/memory.h"
+
 #include <QtTest>
 
 class TestMemory : public QObject {
@@ -8,10 +10,15 @@ class TestMemory : public QObject {
 
 private:
     static void integer_decomposition();
+    static void memory_access_test(machine::MemoryLayout layout);
 
 private slots:
     static void memory();
     static void memory_data();
+    static void memory_paged();
+    static void memory_paged_data();
+    static void memory_paged_copy_on_write();
+    static void memory_paged_copy_on_write_data();
     static void memory_section();
     static void memory_section_data();
     void memory_compare();
@@ -22,6 +29,13 @@ private slots:
     static void memory_read_ctl();
     static void memory_memtest_data();
     static void memory_memtest();
+    static void memory_discard_data();
+    static void memory_discard();
+    static void memory_discard_release();
+    static void memory_bus_range_cache();
+    static void memory_bus_device_ranges();
+    static void memory_bus_lookup_benchmark_data();
+    static void memory_bus_lookup_benchmark();
 };
 
 #endif // MEMORY_TEST_H
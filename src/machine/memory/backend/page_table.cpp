@@ -0,0 +1,228 @@
+#include "memory/backend/page_table.h"
+
+#include "simulator_exception.h"
+
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+#if !defined(_WIN32) && !defined(__EMSCRIPTEN__)
+    #include <sys/mman.h>
+    #include <unistd.h>
+    #define PAGE_TABLE_USE_MMAP 1
+    #ifdef __linux__
+        // Private anonymous memory released by MADV_DONTNEED reads as zero when touched again.
+        #define PAGE_TABLE_RELEASE_TO_HOST 1
+    #endif
+#endif
+
+namespace machine {
+
+/**
+ * Process wide source of zeroed page storage.
+ *
+ * Storage is obtained in chunks from anonymous memory mappings (host kernel provides zeroed
+ * pages lazily on first touch). Released pages are kept for reuse, they are always zeroed when
+ * released. On Linux the host memory of a released page is given back to the kernel, which also
+ * zeroes it, so discarded simulated memory lowers the resident size of the process.
+ */
+class PageAllocator {
+public:
+    static PageAllocator &instance() {
+        static PageAllocator allocator;
+        return allocator;
+    }
+
+    byte *allocate() {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!free_pages.empty()) {
+            byte *data = free_pages.back();
+            free_pages.pop_back();
+            return data;
+        }
+        if (chunk_remaining == 0) { allocate_chunk(); }
+        byte *data = chunk_next;
+        chunk_next += PAGE_TABLE_PAGE_SIZE;
+        chunk_remaining--;
+        return data;
+    }
+
+    void release(byte *data) {
+        if (!release_to_host(data)) { memset(data, 0, PAGE_TABLE_PAGE_SIZE); }
+        std::lock_guard<std::mutex> lock(mutex);
+        free_pages.push_back(data);
+    }
+
+private:
+    // Number of pages requested from the host at once (256 KiB).
+    static constexpr size_t CHUNK_PAGES = 64;
+
+    std::mutex mutex;
+    /** Zeroed pages available for reuse. */
+    std::vector<byte *> free_pages;
+    byte *chunk_next = nullptr;
+    size_t chunk_remaining = 0;
+
+    void allocate_chunk() {
+        const size_t length = CHUNK_PAGES * PAGE_TABLE_PAGE_SIZE;
+#ifdef PAGE_TABLE_USE_MMAP
+        void *chunk
+            = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (chunk == MAP_FAILED) { chunk = nullptr; }
+#else
+        void *chunk = calloc(1, length);
+#endif
+        if (chunk == nullptr) {
+            throw SIMULATOR_EXCEPTION(
+                OutOfMemoryAccess, "Cannot allocate storage for simulated memory",
+                QString::number(length));
+        }
+        // Chunks stay mapped, host memory of released pages is given back by `release_to_host`.
+        chunk_next = static_cast<byte *>(chunk);
+        chunk_remaining = CHUNK_PAGES;
+    }
+
+    /** Frees host memory of the page, returns false when the page has to be zeroed manually. */
+    static bool release_to_host(byte *data) {
+#ifdef PAGE_TABLE_RELEASE_TO_HOST
+        // Chunks are aligned to host pages, so are pages when host pages are not larger.
+        static const bool supported = PAGE_TABLE_PAGE_SIZE % size_t(sysconf(_SC_PAGESIZE)) == 0;
+        return supported && madvise(data, PAGE_TABLE_PAGE_SIZE, MADV_DONTNEED) == 0;
+#else
+        UNUSED(data)
+        return false;
+#endif
+    }
+};
+
+PageTable::PageTable(const PageTable &other) {
+    assign(other);
+}
+
+PageTable::~PageTable() {
+    clear();
+}
+
+void PageTable::clear() {
+    for (auto &dir : directories) {
+        for (Page *page : dir.second->pages) {
+            if (page != nullptr) { release_page(page); }
+        }
+    }
+    directories.clear();
+    forget_cached_pages();
+}
+
+void PageTable::assign(const PageTable &other) {
+    if (&other == this) { return; }
+    clear();
+    directories.reserve(other.directories.size());
+    for (const auto &dir : other.directories) {
+        auto copy = std::make_unique<Directory>();
+        for (size_t i = 0; i < PAGE_TABLE_DIRECTORY_SIZE; i++) {
+            Page *page = dir.second->pages[i];
+            if (page != nullptr) { copy->pages[i] = share_page(page); }
+        }
+        directories.emplace(dir.first, std::move(copy));
+    }
+}
+
+void PageTable::discard(uint64_t offset, uint64_t size) {
+    if (size == 0) { return; }
+    const uint64_t end = offset + size;
+    const uint64_t first_page = offset >> PAGE_TABLE_PAGE_BITS;
+    const uint64_t last_page = (end - 1) >> PAGE_TABLE_PAGE_BITS;
+    // Ranges may be huge and mostly unallocated, only existing directories are visited.
+    for (auto dir = directories.begin(); dir != directories.end();) {
+        const uint64_t dir_first = dir->first << PAGE_TABLE_DIRECTORY_BITS;
+        if (dir_first + PAGE_TABLE_DIRECTORY_SIZE <= first_page || dir_first > last_page) {
+            ++dir;
+            continue;
+        }
+        bool empty = true;
+        for (size_t i = 0; i < PAGE_TABLE_DIRECTORY_SIZE; i++) {
+            Page *&page = dir->second->pages[i];
+            const uint64_t page_number = dir_first + i;
+            if (page != nullptr && page_number >= first_page && page_number <= last_page) {
+                const uint64_t page_start = page_number << PAGE_TABLE_PAGE_BITS;
+                const uint64_t from = std::max(page_start, offset) - page_start;
+                const uint64_t to = std::min(page_start + PAGE_TABLE_PAGE_SIZE, end) - page_start;
+                if (from == 0 && to == PAGE_TABLE_PAGE_SIZE) {
+                    release_page(page);
+                    page = nullptr;
+                } else {
+                    // Partially discarded page keeps the rest of its content.
+                    memset(page_for_write(page_start) + from, 0, to - from);
+                }
+            }
+            if (page != nullptr) { empty = false; }
+        }
+        if (empty) {
+            dir = directories.erase(dir);
+        } else {
+            ++dir;
+        }
+    }
+    forget_cached_pages();
+}
+
+size_t PageTable::page_count() const {
+    size_t count = 0;
+    for_each_page([&count](uint64_t, const byte *) { count++; });
+    return count;
+}
+
+const byte *PageTable::find_page_slow(uint64_t page_number) const {
+    auto dir = directories.find(page_number >> PAGE_TABLE_DIRECTORY_BITS);
+    if (dir == directories.end()) { return nullptr; }
+    const Page *page = dir->second->pages[page_number & (PAGE_TABLE_DIRECTORY_SIZE - 1)];
+    if (page == nullptr) { return nullptr; }
+    last_read_page.store(page, std::memory_order_relaxed);
+    return page->data;
+}
+
+byte *PageTable::page_for_write_slow(uint64_t page_number) {
+    std::unique_ptr<Directory> &dir = directories[page_number >> PAGE_TABLE_DIRECTORY_BITS];
+    if (dir == nullptr) { dir = std::make_unique<Directory>(); }
+    Page *&page = dir->pages[page_number & (PAGE_TABLE_DIRECTORY_SIZE - 1)];
+    if (page == nullptr) {
+        page = allocate_page(page_number);
+    } else if (page->refs.load(std::memory_order_acquire) != 1) {
+        // Page is shared with another table, make a private copy.
+        Page *copy = allocate_page(page_number);
+        memcpy(copy->data, page->data, PAGE_TABLE_PAGE_SIZE);
+        release_page(page);
+        page = copy;
+    }
+    last_write_number = page_number;
+    last_write_page = page;
+    last_read_page.store(page, std::memory_order_relaxed);
+    return page->data;
+}
+
+void PageTable::forget_cached_pages() {
+    last_read_page.store(nullptr, std::memory_order_relaxed);
+    last_write_number = UINT64_MAX;
+    last_write_page = nullptr;
+}
+
+PageTable::Page *PageTable::allocate_page(uint64_t page_number) {
+    Page *page = new Page(page_number);
+    page->data = PageAllocator::instance().allocate();
+    return page;
+}
+
+PageTable::Page *PageTable::share_page(Page *page) {
+    page->refs.fetch_add(1, std::memory_order_relaxed);
+    return page;
+}
+
+void PageTable::release_page(Page *page) {
+    if (page->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        PageAllocator::instance().release(page->data);
+        delete page;
+    }
+}
+
+} // namespace machine
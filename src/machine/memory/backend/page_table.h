@@ -0,0 +1,124 @@
+#ifndef MACHINE_PAGE_TABLE_H
+#define MACHINE_PAGE_TABLE_H
+
+#include "utils.h"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+
+namespace machine {
+
+//////////////////////////////////////////////////////////////////////////////
+/// Page table layout
+// Size of one page in bits (2^12=4 KiB)
+constexpr size_t PAGE_TABLE_PAGE_BITS = 12;
+// Number of pages in one directory in bits (2^10 pages = 4 MiB)
+constexpr size_t PAGE_TABLE_DIRECTORY_BITS = 10;
+//////////////////////////////////////////////////////////////////////////////
+constexpr size_t PAGE_TABLE_PAGE_SIZE = (size_t(1) << PAGE_TABLE_PAGE_BITS);
+constexpr size_t PAGE_TABLE_DIRECTORY_SIZE = (size_t(1) << PAGE_TABLE_DIRECTORY_BITS);
+
+/**
+ * Sparse storage of 4 KiB pages covering full 64-bit offset range.
+ *
+ * Two level structure: hash map of directories indexed by upper part of the page number, each
+ * directory is a flat array of page pointers. Pages are allocated lazily on first write from
+ * anonymous memory mappings and they are shared copy-on-write between tables created by
+ * `assign` (or copy constructor). The last page used for reading and writing is cached.
+ *
+ * Const lookups (`find_page`) may run concurrently, modifications of a single table may not run
+ * together with any other access. Pages shared between tables use atomic reference counts, so
+ * tables sharing pages may be used from different threads.
+ */
+class PageTable {
+public:
+    PageTable() = default;
+    PageTable(const PageTable &other);
+    PageTable &operator=(const PageTable &) = delete;
+    ~PageTable();
+
+    /** Releases all pages. */
+    void clear();
+    /** Makes this table a copy-on-write copy of the `other`. */
+    void assign(const PageTable &other);
+
+    /** Returns page data containing `offset` or nullptr when the page was never written. */
+    [[nodiscard]] const byte *find_page(uint64_t offset) const {
+        const uint64_t page_number = offset >> PAGE_TABLE_PAGE_BITS;
+        const Page *page = last_read_page.load(std::memory_order_relaxed);
+        if (page != nullptr && page->number == page_number) { return page->data; }
+        return find_page_slow(page_number);
+    }
+
+    /**
+     * Returns writable page data containing `offset`. The page is allocated or unshared when
+     * necessary.
+     */
+    [[nodiscard]] byte *page_for_write(uint64_t offset) {
+        const uint64_t page_number = offset >> PAGE_TABLE_PAGE_BITS;
+        if (page_number == last_write_number && last_write_page != nullptr
+            && last_write_page->refs.load(std::memory_order_acquire) == 1) {
+            return last_write_page->data;
+        }
+        return page_for_write_slow(page_number);
+    }
+
+    /**
+     * Calls `fn(uint64_t page_offset, const byte *data)` for every allocated page.
+     */
+    template<typename FUNC>
+    void for_each_page(FUNC fn) const {
+        for (const auto &dir : directories) {
+            for (size_t i = 0; i < PAGE_TABLE_DIRECTORY_SIZE; i++) {
+                const Page *page = dir.second->pages[i];
+                if (page == nullptr) { continue; }
+                const uint64_t page_number = (dir.first << PAGE_TABLE_DIRECTORY_BITS) | i;
+                fn(page_number << PAGE_TABLE_PAGE_BITS, static_cast<const byte *>(page->data));
+            }
+        }
+    }
+
+    /**
+     * Zeroes `size` bytes starting at `offset`. Pages covered entirely are released, so the range
+     * costs no memory until it is written again.
+     */
+    void discard(uint64_t offset, uint64_t size);
+
+    [[nodiscard]] size_t page_count() const;
+
+private:
+    struct Page {
+        explicit Page(uint64_t number) : number(number) {}
+        std::atomic<uint32_t> refs { 1 };
+        /** Tables sharing the page hold it at the same number. */
+        const uint64_t number;
+        byte *data = nullptr;
+    };
+    struct Directory {
+        std::array<Page *, PAGE_TABLE_DIRECTORY_SIZE> pages {};
+    };
+
+    std::unordered_map<uint64_t, std::unique_ptr<Directory>> directories;
+    /**
+     * Page found by the last lookup. The page carries its number, so a single atomic pointer
+     * keeps the cache consistent when const lookups run concurrently.
+     */
+    mutable std::atomic<const Page *> last_read_page { nullptr };
+    uint64_t last_write_number = UINT64_MAX;
+    Page *last_write_page = nullptr;
+
+    const byte *find_page_slow(uint64_t page_number) const;
+    byte *page_for_write_slow(uint64_t page_number);
+    void forget_cached_pages();
+
+    static Page *allocate_page(uint64_t page_number);
+    static Page *share_page(Page *page);
+    static void release_page(Page *page);
+};
+
+} // namespace machine
+
+#endif // MACHINE_PAGE_TABLE_H
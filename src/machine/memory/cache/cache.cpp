@@ -31,14 +31,9 @@ Cache::Cache(
         return;
     }
 
-    dt.resize(
-        config->associativity(),
-        std::vector<CacheLine>(
-            config->set_count(),
-            { .valid = false,
-              .dirty = false,
-              .tag = 0,
-              .data = std::vector<uint32_t>(config->block_size()) }));
+    lines = CacheLines(config->associativity(), config->set_count(), config->block_size());
+    pending_lines.reserve(config->associativity() * config->set_count());
+    pending_line_index.assign(config->associativity() * config->set_count(), 0);
 }
 
 Cache::~Cache() = default;
@@ -48,11 +43,13 @@ WriteResult Cache::write(
     const void *source,
     size_t size,
     WriteOptions options) {
+    if (access_trace != nullptr && options.type != ae::INTERNAL) {
+        access_trace->record_access(ATK_WRITE, destination, size);
+    }
     if (!cache_config.enabled() || is_in_uncached_area(destination)
         || is_in_uncached_area(destination + size)) {
-        mem_writes++;
-        emit memory_writes_update(mem_writes);
-        update_all_statistics();
+        stats.mem_writes++;
+        access_done();
         return mem->write(destination, source, size, options);
     }
 
@@ -63,12 +60,12 @@ WriteResult Cache::write(
         = access(destination, const_cast<void *>(source), size, WRITE);
 
     if (cache_config.write_policy() != CacheConfig::WP_BACK) {
-        mem_writes++;
-        emit memory_writes_update(mem_writes);
-        update_all_statistics();
+        stats.mem_writes++;
+        access_done();
         return mem->write(destination, source, size, options);
     }
 
+    access_done();
     return { .n_bytes = size, .changed = changed };
 }
 
@@ -77,11 +74,13 @@ ReadResult Cache::read(
     Address source,
     size_t size,
     ReadOptions options) const {
+    if (access_trace != nullptr && options.type != ae::INTERNAL) {
+        access_trace->record_access(access_trace_read_kind, source, size);
+    }
     if (!cache_config.enabled() || is_in_uncached_area(source)
         || is_in_uncached_area(source + size)) {
-        mem_reads++;
-        emit memory_reads_update(mem_reads);
-        update_all_statistics();
+        stats.mem_reads++;
+        access_done();
         return mem->read(destination, source, size, options);
     }
 
@@ -95,9 +94,87 @@ ReadResult Cache::read(
     }
 
     access(source, destination, size, READ);
+    access_done();
 
     return {};
 }
+template<typename FUNC>
+void Cache::for_each_cached_part(Address start, size_t size, FUNC fn) const {
+    if (!cache_config.enabled() || size == 0) { return; }
+    const uint64_t block_bytes = cache_config.block_size() * BLOCK_ITEM_SIZE;
+    const uint64_t first = start.get_raw();
+    const uint64_t end = first + size;
+    const uint64_t line_count = cache_config.associativity() * cache_config.set_count();
+    if ((size + block_bytes - 1) / block_bytes > line_count) {
+        // Range larger than the cache (e.g. unmapped area), visiting the lines is cheaper.
+        for (size_t way = 0; way < cache_config.associativity(); way++) {
+            for (size_t row = 0; row < cache_config.set_count(); row++) {
+                if (!lines.valid(way, row)) { continue; }
+                const uint64_t block = calc_base_address(lines.tag(way, row), row).get_raw();
+                const uint64_t part_start = std::max(block, first);
+                const uint64_t part_end = std::min(block + block_bytes, end);
+                if (part_start >= part_end) { continue; }
+                fn(way, row, part_start - block, part_start - first, part_end - part_start);
+            }
+        }
+        return;
+    }
+    for (uint64_t block = first - first % block_bytes; block < end; block += block_bytes) {
+        const CacheLocation loc = compute_location(Address(block));
+        const size_t way = find_block_index(loc);
+        if (way >= cache_config.associativity()) { continue; }
+        const uint64_t part_start = std::max(block, first);
+        const uint64_t part_end = std::min(block + block_bytes, end);
+        fn(way, loc.row, part_start - block, part_start - first, part_end - part_start);
+    }
+}
+
+void Cache::read_span(void *destination, Address source, size_t size) const {
+    mem->read_span(destination, source, size);
+    // Only lines of a write-back cache can differ from the memory.
+    if (cache_config.write_policy() != CacheConfig::WP_BACK) { return; }
+    for_each_cached_part(
+        source, size,
+        [this, destination](size_t way, size_t row, size_t block_offset, size_t offset,
+                            size_t part_size) {
+            if (!lines.dirty(way, row)) { return; }
+            memcpy(
+                (byte *)destination + offset, (const byte *)lines.data(way, row) + block_offset,
+                part_size);
+        });
+}
+
+void Cache::write_span(Address destination, const void *source, size_t size) {
+    mem->write_span(destination, source, size);
+    for_each_cached_part(
+        destination, size,
+        [this, source](size_t way, size_t row, size_t block_offset, size_t offset,
+                       size_t part_size) {
+            memcpy(
+                (byte *)lines.data(way, row) + block_offset, (const byte *)source + offset,
+                part_size);
+            change_counter++;
+            if (!headless) {
+                note_line_update(
+                    way, row, (block_offset + part_size - 1) / BLOCK_ITEM_SIZE, WRITE);
+            }
+        });
+}
+
+void Cache::discard_span(Address start, size_t size) {
+    mem->discard_span(start, size);
+    for_each_cached_part(
+        start, size,
+        [this](size_t way, size_t row, size_t block_offset, size_t, size_t part_size) {
+            memset((byte *)lines.data(way, row) + block_offset, 0, part_size);
+            change_counter++;
+            if (!headless) {
+                note_line_update(
+                    way, row, (block_offset + part_size - 1) / BLOCK_ITEM_SIZE, WRITE);
+            }
+        });
+}
+
 bool Cache::is_in_uncached_area(Address source) const {
     return (source >= uncached_start && source <= uncached_last);
 }
@@ -111,15 +188,15 @@ void Cache::flush() {
          assoc_index += 1) {
         for (size_t set_index = 0; set_index < cache_config.set_count();
              set_index += 1) {
-            if (dt[assoc_index][set_index].valid) {
+            if (lines.valid(assoc_index, set_index)) {
                 kick(assoc_index, set_index);
-                emit cache_update(
-                    assoc_index, set_index, 0, false, false, 0, nullptr, false);
+                if (!headless) { note_line_update(assoc_index, set_index, 0, READ); }
             }
         }
     }
     change_counter++;
-    update_all_statistics();
+    statistics_changed = true;
+    publish_updates();
 }
 
 void Cache::sync() {
@@ -129,23 +206,13 @@ void Cache::sync() {
 void Cache::reset() {
     // Set all cells to invalid
     if (cache_config.enabled()) {
-        for (auto &set : dt) {
-            for (auto &block : set) {
-                block.valid = false;
-            }
-        }
+        lines.invalidate_all();
         // Note: We don't have to zero replacement policy data as those are
         // zeroed when first used on invalid cell.
     }
 
-    hit_read = 0;
-    hit_write = 0;
-    miss_read = 0;
-    miss_write = 0;
-    mem_reads = 0;
-    mem_writes = 0;
-    burst_reads = 0;
-    burst_writes = 0;
+    stats = {};
+    discard_pending_updates();
 
     emit hit_update(get_hit_count());
     emit miss_update(get_miss_count());
@@ -162,21 +229,47 @@ void Cache::reset() {
                     assoc_index, set_index, 0, false, false, 0, nullptr, false);
             }
         }
+        emit cache_updates_published();
+    }
+}
+
+Cache::Snapshot Cache::snapshot() const {
+    return { lines, replacement_policy->clone(), stats };
+}
+
+void Cache::restore(const Snapshot &snapshot) {
+    lines = snapshot.lines;
+    replacement_policy->restore(*snapshot.replacement_policy);
+    stats = snapshot.stats;
+    change_counter++;
+    discard_pending_updates();
+
+    emit hit_update(get_hit_count());
+    emit miss_update(get_miss_count());
+    emit memory_reads_update(get_read_count());
+    emit memory_writes_update(get_write_count());
+    update_all_statistics();
+
+    if (cache_config.enabled()) {
+        for (size_t assoc_index = 0; assoc_index < cache_config.associativity(); assoc_index++) {
+            for (size_t set_index = 0; set_index < cache_config.set_count(); set_index++) {
+                const bool valid = lines.valid(assoc_index, set_index);
+                emit cache_update(
+                    assoc_index, set_index, 0, valid, lines.dirty(assoc_index, set_index),
+                    valid ? lines.tag(assoc_index, set_index) : 0,
+                    lines.data(assoc_index, set_index), false);
+            }
+        }
+        emit cache_updates_published();
     }
 }
 
 void Cache::internal_read(Address source, void *destination, size_t size) const {
     CacheLocation loc = compute_location(source);
-    for (size_t assoc_index = 0; assoc_index < cache_config.associativity();
-         assoc_index++) {
-        if (dt[assoc_index][loc.row].valid
-            && dt[assoc_index][loc.row].tag == loc.tag) {
-            memcpy(
-                destination,
-                (byte *)&dt[assoc_index][loc.row].data[loc.col] + loc.byte,
-                size);
-            return;
-        }
+    const size_t way = find_block_index(loc);
+    if (way < cache_config.associativity()) {
+        memcpy(destination, (const byte *)&lines.data(way, loc.row)[loc.col] + loc.byte, size);
+        return;
     }
     memset(destination, 0, size); // TODO is this correct
 }
@@ -200,9 +293,7 @@ bool Cache::access(
         // allocate
         if (access_type == WRITE
             && cache_config.write_policy() == CacheConfig::WP_THROUGH_NOALLOC) {
-            miss_write++;
-            emit miss_update(get_miss_count());
-            update_all_statistics();
+            stats.miss_write++;
 
             const size_t size_overflow
                 = calculate_overflow_to_next_blocks(size, loc);
@@ -225,42 +316,35 @@ bool Cache::access(
             "Probably unimplemented replacement policy");
     }
 
-    struct CacheLine &cd = dt[way][loc.row];
+    uint32_t *const block_data = lines.data(way, loc.row);
 
     // Update statistics and otherwise read from memory
-    if (cd.valid) {
+    if (lines.valid(way, loc.row)) {
         if (access_type == WRITE) {
-            hit_write++;
+            stats.hit_write++;
         } else {
-            hit_read++;
+            stats.hit_read++;
         }
-        emit hit_update(get_hit_count());
-        update_all_statistics();
     } else {
         if (access_type == WRITE) {
-            miss_write++;
+            stats.miss_write++;
         } else {
-            miss_read++;
+            stats.miss_read++;
         }
-        emit miss_update(get_miss_count());
 
         mem->read(
-            cd.data.data(), calc_base_address(loc.tag, loc.row),
+            block_data, calc_base_address(loc.tag, loc.row),
             cache_config.block_size() * BLOCK_ITEM_SIZE,
             { .type = ae::REGULAR });
 
-        cd.valid = true;
-        cd.dirty = false;
-        cd.tag = loc.tag;
+        lines.fill(way, loc.row, loc.tag);
 
         change_counter += cache_config.block_size();
-        mem_reads += cache_config.block_size();
-        burst_reads += cache_config.block_size() - 1;
-        emit memory_reads_update(mem_reads);
-        update_all_statistics();
+        stats.mem_reads += cache_config.block_size();
+        stats.burst_reads += cache_config.block_size() - 1;
     }
 
-    replacement_policy->update_stats(way, loc.row, cd.valid);
+    replacement_policy->update_stats(way, loc.row, true);
 
     const size_t size_overflow = calculate_overflow_to_next_blocks(size, loc);
     const size_t size_within_block = size - size_overflow;
@@ -268,26 +352,24 @@ bool Cache::access(
     bool changed = false;
 
     if (access_type == READ) {
-        memcpy(buffer, (byte *)&cd.data[loc.col] + loc.byte, size_within_block);
+        memcpy(buffer, (byte *)&block_data[loc.col] + loc.byte, size_within_block);
     } else if (access_type == WRITE) {
-        cd.dirty = true;
+        lines.set_dirty(way, loc.row);
         changed = memcmp(
-                      (byte *)&cd.data[loc.col] + loc.byte, buffer,
+                      (byte *)&block_data[loc.col] + loc.byte, buffer,
                       size_within_block)
                   != 0;
         if (changed) {
             memcpy(
-                ((byte *)&cd.data[loc.col]) + loc.byte, buffer,
+                ((byte *)&block_data[loc.col]) + loc.byte, buffer,
                 size_within_block);
             change_counter++;
         }
     }
-    const auto last_affected_col
-        = (loc.col * BLOCK_ITEM_SIZE + loc.byte + size_within_block - 1) / BLOCK_ITEM_SIZE;
-    for (auto col = loc.col; col <= last_affected_col; col++) {
-        emit cache_update(
-            way, loc.row, col, cd.valid, cd.dirty, cd.tag, cd.data.data(),
-            access_type);
+    if (!headless) {
+        const auto last_affected_col
+            = (loc.col * BLOCK_ITEM_SIZE + loc.byte + size_within_block - 1) / BLOCK_ITEM_SIZE;
+        note_line_update(way, loc.row, last_affected_col, access_type);
     }
 
     if (size_overflow > 0) {
@@ -309,34 +391,94 @@ size_t Cache::calculate_overflow_to_next_blocks(
 }
 
 size_t Cache::find_block_index(const CacheLocation &loc) const {
-    uint32_t index = 0;
-    while (
-        index < cache_config.associativity()
-        and (!dt[index][loc.row].valid or dt[index][loc.row].tag != loc.tag)) {
-        index++;
-    }
-    return index;
+    return lines.find_way(loc.row, loc.tag);
 }
 
 void Cache::kick(size_t way, size_t row) const {
-    struct CacheLine &cd = dt[way][row];
-    if (cd.dirty && cache_config.write_policy() == CacheConfig::WP_BACK) {
+    if (lines.valid(way, row) && lines.dirty(way, row)
+        && cache_config.write_policy() == CacheConfig::WP_BACK) {
         mem->write(
-            calc_base_address(cd.tag, row), cd.data.data(),
+            calc_base_address(lines.tag(way, row), row), lines.data(way, row),
             cache_config.block_size() * BLOCK_ITEM_SIZE, {});
-        mem_writes += cache_config.block_size();
-        burst_writes += cache_config.block_size() - 1;
-        emit memory_writes_update(mem_writes);
+        stats.mem_writes += cache_config.block_size();
+        stats.burst_writes += cache_config.block_size() - 1;
     }
-    cd.valid = false;
-    cd.dirty = false;
+    lines.invalidate(way, row);
 
     change_counter++;
 
     replacement_policy->update_stats(way, row, false);
 }
 
+const CacheStatistics &Cache::get_statistics() const {
+    return stats;
+}
+
+void Cache::set_publish_interval(unsigned accesses) {
+    publish_interval = accesses;
+}
+
+void Cache::access_done() const {
+    statistics_changed = true;
+    if (publish_interval != 0 && ++accesses_since_publish >= publish_interval) {
+        publish_updates();
+    }
+}
+
+void Cache::note_line_update(size_t way, size_t row, size_t col, AccessType access_type) const {
+    uint32_t &index = pending_line_index[way * cache_config.set_count() + row];
+    if (index == 0) {
+        pending_lines.push_back(
+            { uint32_t(way), uint32_t(row), uint32_t(col), access_type });
+        index = pending_lines.size();
+    } else {
+        pending_lines[index - 1].col = col;
+        pending_lines[index - 1].access_type = access_type;
+    }
+}
+
+void Cache::set_headless(bool headless) {
+    this->headless = headless;
+    blockSignals(headless);
+    discard_pending_updates();
+}
+
+void Cache::publish_updates() const {
+    accesses_since_publish = 0;
+    if (statistics_changed) {
+        statistics_changed = false;
+        emit hit_update(get_hit_count());
+        emit miss_update(get_miss_count());
+        emit memory_reads_update(get_read_count());
+        emit memory_writes_update(get_write_count());
+        update_all_statistics();
+    }
+    for (const LineUpdate &update : pending_lines) {
+        pending_line_index[update.way * cache_config.set_count() + update.row] = 0;
+        const bool valid = lines.valid(update.way, update.row);
+        emit cache_update(
+            update.way, update.row, update.col, valid, lines.dirty(update.way, update.row),
+            valid ? lines.tag(update.way, update.row) : 0, lines.data(update.way, update.row),
+            update.access_type);
+    }
+    if (!pending_lines.empty()) {
+        pending_lines.clear();
+        emit cache_updates_published();
+    }
+}
+
+void Cache::discard_pending_updates() const {
+    for (const LineUpdate &update : pending_lines) {
+        pending_line_index[update.way * cache_config.set_count() + update.row] = 0;
+    }
+    pending_lines.clear();
+    statistics_changed = false;
+    accesses_since_publish = 0;
+}
+
 void Cache::update_all_statistics() const {
+    // Skip the floating point statistics when nobody can observe them (headless machine).
+    if (headless) { return; }
     emit statistics_update(
         get_stall_count(), get_speed_improvement(), get_hit_rate());
 }
@@ -370,17 +512,14 @@ enum LocationStatus Cache::location_status(Address address) const {
     const CacheLocation loc = compute_location(address);
 
     if (cache_config.enabled()) {
-        for (auto const &set : dt) {
-            auto const &block = set[loc.row];
-
-            if (block.valid && block.tag == loc.tag) {
-                if (block.dirty
-                    && cache_config.write_policy() == CacheConfig::WP_BACK) {
-                    return (enum LocationStatus)(
-                        LOCSTAT_CACHED | LOCSTAT_DIRTY);
-                } else {
-                    return LOCSTAT_CACHED;
-                }
+        const size_t way = find_block_index(loc);
+        if (way < cache_config.associativity()) {
+            if (lines.dirty(way, loc.row)
+                && cache_config.write_policy() == CacheConfig::WP_BACK) {
+                return (enum LocationStatus)(
+                    LOCSTAT_CACHED | LOCSTAT_DIRTY);
+            } else {
+                return LOCSTAT_CACHED;
             }
         }
     }
@@ -391,33 +530,38 @@ const CacheConfig &Cache::get_config() const {
     return cache_config;
 }
 
+void Cache::set_access_trace(AccessTraceWriter *trace, bool instruction_stream) {
+    access_trace = trace;
+    access_trace_read_kind = instruction_stream ? ATK_FETCH : ATK_READ;
+}
+
 uint32_t Cache::get_change_counter() const {
     return change_counter;
 }
 
 uint32_t Cache::get_hit_count() const {
-    return hit_read + hit_write;
+    return stats.hit_read + stats.hit_write;
 }
 
 uint32_t Cache::get_miss_count() const {
-    return miss_read + miss_write;
+    return stats.miss_read + stats.miss_write;
 }
 
 uint32_t Cache::get_read_count() const {
-    return mem_reads;
+    return stats.mem_reads;
 }
 
 uint32_t Cache::get_write_count() const {
-    return mem_writes;
+    return stats.mem_writes;
 }
 
 uint32_t Cache::get_stall_count() const {
     uint32_t st_cycles
-        = mem_reads * (access_pen_r - 1) + mem_writes * (access_pen_w - 1);
-    st_cycles += (miss_read + miss_write) * cache_config.block_size();
+        = stats.mem_reads * (access_pen_r - 1) + stats.mem_writes * (access_pen_w - 1);
+    st_cycles += (stats.miss_read + stats.miss_write) * cache_config.block_size();
     if (access_ena_b) {
-        st_cycles -= burst_reads * (access_pen_r - access_pen_b)
-                     + burst_writes * (access_pen_w - access_pen_b);
+        st_cycles -= stats.burst_reads * (access_pen_r - access_pen_b)
+                     + stats.burst_writes * (access_pen_w - access_pen_b);
     }
     return st_cycles;
 }
@@ -425,30 +569,30 @@ uint32_t Cache::get_stall_count() const {
 double Cache::get_speed_improvement() const {
     uint32_t lookup_time;
     uint32_t mem_access_time;
-    uint32_t comp = hit_read + hit_write + miss_read + miss_write;
+    uint32_t comp = stats.hit_read + stats.hit_write + stats.miss_read + stats.miss_write;
     if (comp == 0) {
         return 100.0;
     }
-    lookup_time = hit_read + miss_read;
+    lookup_time = stats.hit_read + stats.miss_read;
     if (cache_config.write_policy() == CacheConfig::WP_BACK) {
-        lookup_time += hit_write + miss_write;
+        lookup_time += stats.hit_write + stats.miss_write;
     }
-    mem_access_time = mem_reads * access_pen_r + mem_writes * access_pen_w;
+    mem_access_time = stats.mem_reads * access_pen_r + stats.mem_writes * access_pen_w;
     if (access_ena_b) {
-        mem_access_time -= burst_reads * (access_pen_r - access_pen_b)
-                           + burst_writes * (access_pen_w - access_pen_b);
+        mem_access_time -= stats.burst_reads * (access_pen_r - access_pen_b)
+                           + stats.burst_writes * (access_pen_w - access_pen_b);
     }
     return (
-        (double)((miss_read + hit_read) * access_pen_r + (miss_write + hit_write) * access_pen_w)
+        (double)((stats.miss_read + stats.hit_read) * access_pen_r + (stats.miss_write + stats.hit_write) * access_pen_w)
         / (double)(lookup_time + mem_access_time) * 100);
 }
 
 double Cache::get_hit_rate() const {
-    uint32_t comp = hit_read + hit_write + miss_read + miss_write;
+    uint32_t comp = stats.hit_read + stats.hit_write + stats.miss_read + stats.miss_write;
     if (comp == 0) {
         return 0.0;
     }
-    return (double)(hit_read + hit_write) / (double)comp * 100.0;
+    return (double)(stats.hit_read + stats.hit_write) / (double)comp * 100.0;
 }
 
 } // namespace machine
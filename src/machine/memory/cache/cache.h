@@ -1,7 +1,9 @@
 #ifndef CACHE_H
 #define CACHE_H
 
+#include "access_trace.h"
 #include "machineconfig.h"
+#include "memory/cache/cache_lines.h"
 #include "memory/cache/cache_policy.h"
 #include "memory/cache/cache_types.h"
 #include "memory/frontend_memory.h"
@@ -70,6 +72,13 @@ public:
         size_t size,
         ReadOptions options) const override;
 
+    /** Reads the backing memory, dirty lines hold newer data and are copied over it. */
+    void read_span(void *destination, Address source, size_t size) const override;
+    /** Writes through to the backing memory and updates lines holding the range. */
+    void write_span(Address destination, const void *source, size_t size) override;
+    /** Discards the backing memory and zeroes lines holding the range. */
+    void discard_span(Address start, size_t size) override;
+
     uint32_t get_change_counter() const override;
 
     void flush();         // flush cache
@@ -87,8 +96,42 @@ public:
 
     void reset(); // Reset whole state of cache
 
+    const CacheStatistics &get_statistics() const;
+
+    /**
+     * Observer signals (`hit_update`, `statistics_update`, `cache_update`...) are not emitted
+     * by individual accesses. Counters and touched lines are collected and published together
+     * by `publish_updates`, either explicitly (`Machine` does it on every `post_tick`) or
+     * automatically after every `accesses` accesses. Zero (default) disables the automatic
+     * publishing.
+     */
+    void set_publish_interval(unsigned accesses);
+    /** Emits observer signals for all changes since the last publication. */
+    void publish_updates() const;
+    /**
+     * Suppresses all observer signals. Touched lines are not recorded by accesses of a headless
+     * cache at all.
+     */
+    void set_headless(bool headless);
+
+    /** Content, replacement policy state and statistics, see `Machine::snapshot`. */
+    struct Snapshot {
+        CacheLines lines;
+        std::unique_ptr<CachePolicy> replacement_policy;
+        CacheStatistics stats;
+    };
+    [[nodiscard]] Snapshot snapshot() const;
+    /** Restores snapshot taken from a cache with the same configuration. */
+    void restore(const Snapshot &snapshot);
+
     const CacheConfig &get_config() const;
 
+    /**
+     * Records all regular accesses to the cache to the trace (as fetches from the instruction
+     * stream or data reads and writes). Null pointer stops the recording.
+     */
+    void set_access_trace(AccessTraceWriter *trace, bool instruction_stream);
+
     enum LocationStatus location_status(Address address) const override;
 
 signals:
@@ -109,6 +152,8 @@ signals:
         bool write) const;
     void memory_writes_update(uint32_t) const;
     void memory_reads_update(uint32_t) const;
+    /** Ends a batch of `cache_update` signals emitted by `publish_updates`. */
+    void cache_updates_published() const;
 
 private:
     const CacheConfig cache_config;
@@ -118,15 +163,47 @@ private:
     const uint32_t access_pen_r, access_pen_w, access_pen_b;
     const bool access_ena_b;
     const std::unique_ptr<CachePolicy> replacement_policy;
-
-    mutable std::vector<std::vector<CacheLine>> dt;
-
-    mutable uint32_t hit_read = 0, miss_read = 0, hit_write = 0, miss_write = 0,
-                     mem_reads = 0, mem_writes = 0, burst_reads = 0,
-                     burst_writes = 0, change_counter = 0;
+    AccessTraceWriter *access_trace = nullptr;
+    AccessTraceKind access_trace_read_kind = ATK_READ;
+
+    mutable CacheLines lines;
+
+    mutable CacheStatistics stats {};
+    mutable uint32_t change_counter = 0;
+
+    /** Last access to a line waiting for publication by `cache_update` signal. */
+    struct LineUpdate {
+        uint32_t way;
+        uint32_t row;
+        uint32_t col;
+        AccessType access_type;
+    };
+    /** Pending line updates in order of the first access, capacity is reserved upfront. */
+    mutable std::vector<LineUpdate> pending_lines;
+    /** Position in `pending_lines` plus one for each line (way major), zero if not pending. */
+    mutable std::vector<uint32_t> pending_line_index;
+    mutable bool statistics_changed = false;
+    /** Same as `signalsBlocked()`, kept in the cache as it is checked by every access. */
+    bool headless = false;
+    unsigned publish_interval = 0;
+    mutable unsigned accesses_since_publish = 0;
+
+    void note_line_update(size_t way, size_t row, size_t col, AccessType access_type) const;
+    /** Finishes one access of the cache interface, publishes updates when the interval
+     * elapsed. */
+    void access_done() const;
+    void discard_pending_updates() const;
 
     void internal_read(Address source, void *destination, size_t size) const;
 
+    /**
+     * Calls `fn(way, row, block_offset, span_offset, size)` for each part of the range of `size`
+     * bytes starting at `start` held by a valid line. Offsets are in bytes from the start of the
+     * block and of the range.
+     */
+    template<typename FUNC>
+    void for_each_cached_part(Address start, size_t size, FUNC fn) const;
+
     bool access(
         Address address,
         void *buffer,
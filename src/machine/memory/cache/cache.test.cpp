@@ -16,6 +16,9 @@ using std::array;
 using std::pair;
 using std::size_t;
 using std::tuple;
+
+Q_DECLARE_METATYPE(CacheConfig::ReplacementPolicy) // NOLINT(performance-no-int-to-ptr)
+
 using Testcase
     = tuple<Endian, Address, size_t, IntegerDecomposition, IntegerDecomposition, CacheConfig>;
 
@@ -139,6 +142,203 @@ void TestCache::cache() {
     QCOMPARE(cache.get_miss_count(), miss);
 }
 
+void TestCache::cache_batched_updates() {
+    CacheConfig cache_c;
+    cache_c.set_write_policy(CacheConfig::WP_BACK);
+    cache_c.set_enabled(true);
+    cache_c.set_set_count(4);
+    cache_c.set_block_size(2);
+    cache_c.set_associativity(2);
+
+    Memory m(BIG);
+    TrivialBus m_frontend(&m);
+    Cache cache(&m_frontend, &cache_c);
+    QSignalSpy hit_spy(&cache, &Cache::hit_update);
+    QSignalSpy line_spy(&cache, &Cache::cache_update);
+    QSignalSpy batch_spy(&cache, &Cache::cache_updates_published);
+
+    // Nothing is published by the accesses themselves.
+    for (int i = 0; i < 8; i++) {
+        cache.read_u32(0x200_addr);
+        cache.write_u32(0x204_addr, i);
+    }
+    QCOMPARE(hit_spy.count(), 0);
+    QCOMPARE(line_spy.count(), 0);
+    QCOMPARE(cache.get_statistics().hit_read, 7U);
+    QCOMPARE(cache.get_statistics().miss_read, 1U);
+    QCOMPARE(cache.get_statistics().hit_write, 8U);
+
+    // Single update per changed line, with the state after the last access.
+    cache.publish_updates();
+    QCOMPARE(hit_spy.count(), 1);
+    QCOMPARE(hit_spy.at(0).at(0).toUInt(), 15U);
+    QCOMPARE(line_spy.count(), 1);
+    QCOMPARE(line_spy.at(0).at(2).toUInt(), 1U);          // col
+    QCOMPARE(line_spy.at(0).at(4).toBool(), true);        // dirty
+    QCOMPARE(line_spy.at(0).at(7).toBool(), bool(WRITE)); // last access
+    QCOMPARE(batch_spy.count(), 1);
+    cache.publish_updates();
+    QCOMPARE(hit_spy.count(), 1);
+    QCOMPARE(batch_spy.count(), 1);
+
+    cache.set_publish_interval(4);
+    for (int i = 0; i < 8; i++) {
+        cache.read_u32(0x200_addr);
+    }
+    QCOMPARE(hit_spy.count(), 3);
+    QCOMPARE(batch_spy.count(), 3);
+
+    // Headless cache records no lines and publishes nothing.
+    cache.set_publish_interval(0);
+    cache.set_headless(true);
+    cache.write_u32(0x204_addr, 1);
+    cache.read_u32(0x300_addr);
+    cache.publish_updates();
+    cache.set_headless(false);
+    cache.publish_updates();
+    QCOMPARE(hit_spy.count(), 3);
+    QCOMPARE(line_spy.count(), 3);
+    QCOMPARE(cache.get_statistics().hit_write, 9U);
+}
+
+void TestCache::cache_high_associativity() {
+    CacheConfig cache_c;
+    cache_c.set_write_policy(CacheConfig::WP_BACK);
+    cache_c.set_replacement_policy(CacheConfig::RP_LRU);
+    cache_c.set_enabled(true);
+    cache_c.set_set_count(2);
+    cache_c.set_block_size(1);
+    cache_c.set_associativity(32);
+
+    Memory m(LITTLE);
+    TrivialBus m_frontend(&m);
+    Cache cache(&m_frontend, &cache_c);
+
+    // 32 blocks mapped to the same set fill all ways.
+    for (uint32_t i = 0; i < 32; i++) {
+        cache.write_u32(Address(i * 8), i + 1);
+    }
+    for (uint32_t i = 0; i < 32; i++) {
+        QCOMPARE(cache.read_u32(Address(i * 8)), i + 1);
+    }
+    QCOMPARE(cache.get_miss_count(), 32U);
+    QCOMPARE(cache.get_hit_count(), 32U);
+
+    // Evicts the least recently used block (address 0), which is written back.
+    QCOMPARE(memory_read_u32(&m, 0), 0U);
+    cache.write_u32(Address(32 * 8), 33);
+    QCOMPARE(memory_read_u32(&m, 0), 1U);
+    QCOMPARE(cache.location_status(0x0_addr), LOCSTAT_NONE);
+    QCOMPARE(
+        cache.location_status(0x8_addr), (LocationStatus)(LOCSTAT_CACHED | LOCSTAT_DIRTY));
+    QCOMPARE(cache.read_u32(Address(31 * 8)), 32U);
+    QCOMPARE(cache.get_miss_count(), 33U);
+}
+
+void TestCache::cache_checkpoint_data() {
+    QTest::addColumn<CacheConfig::ReplacementPolicy>("policy");
+    QTest::addRow("plru") << CacheConfig::RP_PLRU;
+    QTest::addRow("rand") << CacheConfig::RP_RAND;
+}
+
+void TestCache::cache_checkpoint() {
+    QFETCH(CacheConfig::ReplacementPolicy, policy);
+    CacheConfig cache_c;
+    cache_c.set_write_policy(CacheConfig::WP_BACK);
+    cache_c.set_replacement_policy(policy);
+    cache_c.set_enabled(true);
+    cache_c.set_set_count(2);
+    cache_c.set_block_size(2);
+    cache_c.set_associativity(4);
+
+    Memory m(LITTLE);
+    TrivialBus m_frontend(&m);
+    Cache cache(&m_frontend, &cache_c);
+    // Six blocks of the same set, two of them are evicted.
+    for (uint32_t i = 0; i < 6; i++) {
+        cache.write_u32(Address(i * 16), i + 1);
+    }
+    QByteArray bytes;
+    {
+        QDataStream out(&bytes, QIODevice::WriteOnly);
+        const Cache::Snapshot snapshot = cache.snapshot();
+        snapshot.lines.save(out);
+        snapshot.replacement_policy->save(out);
+    }
+
+    Cache restored(&m_frontend, &cache_c);
+    Cache::Snapshot snapshot = restored.snapshot();
+    QDataStream in(bytes);
+    snapshot.lines.load(in);
+    snapshot.replacement_policy->load(in);
+    restored.restore(snapshot);
+
+    // Both caches hold the same lines and evict the same ones.
+    const unsigned miss_count = cache.get_miss_count();
+    for (uint32_t i = 0; i < 8; i++) {
+        QCOMPARE(restored.location_status(Address(i * 16)), cache.location_status(Address(i * 16)));
+    }
+    for (uint32_t i : { 5U, 6U, 0U, 3U }) {
+        QCOMPARE(cache.read_u32(Address(i * 16)), restored.read_u32(Address(i * 16)));
+    }
+    QCOMPARE(restored.get_miss_count(), cache.get_miss_count() - miss_count);
+
+    // Geometry of the checkpoint has to match.
+    CacheConfig other_c(cache_c);
+    other_c.set_set_count(4);
+    Cache other(&m_frontend, &other_c);
+    Cache::Snapshot other_snapshot = other.snapshot();
+    QDataStream other_in(bytes);
+    bool thrown = false;
+    try {
+        other_snapshot.lines.load(other_in);
+    } catch (SimulatorExceptionInput &) { thrown = true; }
+    QVERIFY(thrown);
+}
+
+void TestCache::cache_span_coherence() {
+    CacheConfig cache_c;
+    cache_c.set_write_policy(CacheConfig::WP_BACK);
+    cache_c.set_replacement_policy(CacheConfig::RP_LRU);
+    cache_c.set_enabled(true);
+    cache_c.set_set_count(4);
+    cache_c.set_block_size(2);
+    cache_c.set_associativity(2);
+
+    Memory m(LITTLE);
+    TrivialBus m_frontend(&m);
+    Cache cache(&m_frontend, &cache_c);
+    for (uint32_t i = 0; i < 16; i++) {
+        memory_write_u32(&m, i * 4, i);
+    }
+    // Dirty line holds newer data than the memory, clean line the same ones.
+    cache.write_u32(0x8_addr, 0xaabbccdd);
+    QCOMPARE(cache.read_u32(0x18_addr), 6U);
+    const CacheStatistics stats = cache.get_statistics();
+
+    array<uint32_t, 8> words {};
+    cache.read_span(words.data(), 0x4_addr, sizeof(words));
+    QCOMPARE(words[0], 1U);
+    QCOMPARE(words[1], 0xaabbccddU);
+    QCOMPARE(words[7], 8U);
+
+    // Written range spans both cached lines and uncached ones.
+    const array<uint32_t, 6> update { 100, 101, 102, 103, 104, 105 };
+    cache.write_span(0xc_addr, update.data(), sizeof(update));
+    QCOMPARE(memory_read_u32(&m, 0x10), 101U);
+    QCOMPARE(cache.location_status(0x10_addr), LOCSTAT_NONE);
+    QCOMPARE(cache.get_statistics().hit_read, stats.hit_read);
+    QCOMPARE(cache.get_statistics().miss_read, stats.miss_read);
+    QCOMPARE(cache.get_statistics().mem_writes, stats.mem_writes);
+
+    QCOMPARE(cache.read_u32(0x8_addr), 0xaabbccddU);
+    QCOMPARE(cache.read_u32(0xc_addr), 100U);
+    QCOMPARE(cache.read_u32(0x18_addr), 103U);
+    cache.flush();
+    QCOMPARE(memory_read_u32(&m, 0x8), 0xaabbccddU);
+    QCOMPARE(memory_read_u32(&m, 0xc), 100U);
+}
+
 void TestCache::cache_correctness_data() {
     QTest::addColumn<Endian>("endian");
     QTest::addColumn<Address>("address");
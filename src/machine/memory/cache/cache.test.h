@@ -8,6 +8,11 @@ class TestCache : public QObject {
 private slots:
     static void cache_data();
     static void cache();
+    static void cache_batched_updates();
+    static void cache_high_associativity();
+    static void cache_checkpoint_data();
+    static void cache_checkpoint();
+    static void cache_span_coherence();
     static void cache_correctness_data();
     static void cache_correctness();
 };
@@ -0,0 +1,78 @@
+#include "memory/cache/cache_lines.h"
+
+#include "checkpoint.h"
+
+#include <algorithm>
+
+#if defined(__AVX2__)
+    #include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+    #include <emmintrin.h>
+    #define CACHE_LINES_USE_SSE2 1
+#endif
+
+namespace machine {
+
+CacheLines::CacheLines(size_t associativity, size_t set_count, size_t block_size)
+    : associativity(associativity)
+    , block_size(block_size)
+    , tags(associativity * set_count, INVALID_TAG)
+    , dirty_flags(associativity * set_count, 0)
+    , slab(associativity * set_count * block_size, 0) {}
+
+/** Index of the lowest set bit of a non zero comparison mask (at most 4 bits). */
+static inline size_t first_match(unsigned mask) {
+    size_t index = 0;
+    while ((mask & 1U) == 0) {
+        mask >>= 1U;
+        index++;
+    }
+    return index;
+}
+
+size_t CacheLines::find_way(size_t row, uint64_t tag) const {
+    const uint64_t *set = &tags[row * associativity];
+    size_t way = 0;
+#if defined(__AVX2__)
+    const __m256i needle = _mm256_set1_epi64x(static_cast<long long>(tag));
+    for (; way + 4 <= associativity; way += 4) {
+        const __m256i ways = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(set + way));
+        const int mask = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(ways, needle)));
+        if (mask != 0) { return way + first_match(mask); }
+    }
+#elif defined(CACHE_LINES_USE_SSE2)
+    // SSE2 has no 64-bit compare, both 32-bit halves have to match.
+    const __m128i needle = _mm_set1_epi64x(static_cast<long long>(tag));
+    for (; way + 2 <= associativity; way += 2) {
+        const __m128i ways = _mm_loadu_si128(reinterpret_cast<const __m128i *>(set + way));
+        const __m128i halves = _mm_cmpeq_epi32(ways, needle);
+        const __m128i swapped = _mm_shuffle_epi32(halves, _MM_SHUFFLE(2, 3, 0, 1));
+        const __m128i equal = _mm_and_si128(halves, swapped);
+        const int mask = _mm_movemask_pd(_mm_castsi128_pd(equal));
+        if (mask != 0) { return way + first_match(mask); }
+    }
+#endif
+    for (; way < associativity; way++) {
+        if (set[way] == tag) { return way; }
+    }
+    return associativity;
+}
+
+void CacheLines::invalidate_all() {
+    std::fill(tags.begin(), tags.end(), INVALID_TAG);
+    std::fill(dirty_flags.begin(), dirty_flags.end(), 0);
+}
+
+void CacheLines::save(QDataStream &out) const {
+    checkpoint::write_vector(out, tags);
+    checkpoint::write_vector(out, dirty_flags);
+    checkpoint::write_vector(out, slab);
+}
+
+void CacheLines::load(QDataStream &in) {
+    checkpoint::read_array(in, tags.data(), tags.size());
+    checkpoint::read_array(in, dirty_flags.data(), dirty_flags.size());
+    checkpoint::read_array(in, slab.data(), slab.size());
+}
+
+} // namespace machine
@@ -0,0 +1,81 @@
+#ifndef CACHE_LINES_H
+#define CACHE_LINES_H
+
+#include <QDataStream>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace machine {
+
+/**
+ * Storage of all lines of a cache in structure of arrays layout.
+ *
+ * Lines of one set (row) are adjacent, line index is `row * associativity + way`. Tag and valid
+ * bit of a line are kept together in a single word (`INVALID_TAG` marks invalid line), so the
+ * lookup is a single equality test per way and several ways are compared at once with SIMD
+ * instructions when available. Block data are kept in a separate contiguous slab and the lookup
+ * touches only the tags.
+ *
+ * For clarification of cache terminology, see docstring of `Cache` in `memory/cache/cache.h`.
+ */
+class CacheLines {
+public:
+    /** Tag value of an invalid line, real tags never reach it (tag is a part of an address). */
+    static constexpr uint64_t INVALID_TAG = UINT64_MAX;
+
+    CacheLines() = default;
+    CacheLines(size_t associativity, size_t set_count, size_t block_size);
+
+    /**
+     * Searches for given tag in a set.
+     *
+     * @return          way of the valid line with the `tag`, associativity if not found
+     */
+    [[nodiscard]] size_t find_way(size_t row, uint64_t tag) const;
+
+    [[nodiscard]] bool valid(size_t way, size_t row) const {
+        return tags[line(way, row)] != INVALID_TAG;
+    }
+    /** Tag of a valid line. */
+    [[nodiscard]] uint64_t tag(size_t way, size_t row) const { return tags[line(way, row)]; }
+    [[nodiscard]] bool dirty(size_t way, size_t row) const {
+        return dirty_flags[line(way, row)] != 0;
+    }
+    [[nodiscard]] uint32_t *data(size_t way, size_t row) {
+        return &slab[line(way, row) * block_size];
+    }
+    [[nodiscard]] const uint32_t *data(size_t way, size_t row) const {
+        return &slab[line(way, row) * block_size];
+    }
+
+    /** Marks line valid and clean, data have to be filled by the caller. */
+    void fill(size_t way, size_t row, uint64_t new_tag) {
+        tags[line(way, row)] = new_tag;
+        dirty_flags[line(way, row)] = 0;
+    }
+    void set_dirty(size_t way, size_t row) { dirty_flags[line(way, row)] = 1; }
+    void invalidate(size_t way, size_t row) {
+        tags[line(way, row)] = INVALID_TAG;
+        dirty_flags[line(way, row)] = 0;
+    }
+    void invalidate_all();
+
+    /** Writes tags, dirty flags and data to a checkpoint (see `Machine::save_checkpoint`). */
+    void save(QDataStream &out) const;
+    /** Reads lines written by `save` of the same geometry. */
+    void load(QDataStream &in);
+
+private:
+    size_t associativity = 0;
+    size_t block_size = 0;
+    std::vector<uint64_t> tags;
+    std::vector<uint8_t> dirty_flags;
+    std::vector<uint32_t> slab;
+
+    [[nodiscard]] size_t line(size_t way, size_t row) const { return row * associativity + way; }
+};
+
+} // namespace machine
+
+#endif // CACHE_LINES_H
@@ -1,10 +1,12 @@
 #include "cache_policy.h"
 
+#include "checkpoint.h"
 #include "simulator_exception.h"
 #include "utils.h"
 
 #include <cmath>
 #include <cstddef>
+#include <sstream>
 
 namespace machine {
 
@@ -76,6 +78,22 @@ size_t CachePolicyLRU::select_way_to_evict(size_t row) const {
     return stats.at(row).at(0);
 }
 
+std::unique_ptr<CachePolicy> CachePolicyLRU::clone() const {
+    return std::make_unique<CachePolicyLRU>(*this);
+}
+
+void CachePolicyLRU::restore(const CachePolicy &snapshot) {
+    stats = static_cast<const CachePolicyLRU &>(snapshot).stats;
+}
+
+void CachePolicyLRU::save(QDataStream &out) const {
+    checkpoint::write_rows(out, stats);
+}
+
+void CachePolicyLRU::load(QDataStream &in) {
+    checkpoint::read_rows(in, stats);
+}
+
 CachePolicyLFU::CachePolicyLFU(size_t associativity, size_t set_count) {
     stats.resize(set_count, std::vector<uint32_t>(associativity, 0));
 }
@@ -113,13 +131,27 @@ size_t CachePolicyLFU::select_way_to_evict(size_t row) const {
     return index;
 }
 
+std::unique_ptr<CachePolicy> CachePolicyLFU::clone() const {
+    return std::make_unique<CachePolicyLFU>(*this);
+}
+
+void CachePolicyLFU::restore(const CachePolicy &snapshot) {
+    stats = static_cast<const CachePolicyLFU &>(snapshot).stats;
+}
+
+void CachePolicyLFU::save(QDataStream &out) const {
+    checkpoint::write_rows(out, stats);
+}
+
+void CachePolicyLFU::load(QDataStream &in) {
+    checkpoint::read_rows(in, stats);
+}
+
 CachePolicyRAND::CachePolicyRAND(size_t associativity)
-    : associativity(associativity) {
-    // Reset random generator to make result reproducible.
-    // Random is by default seeded by 1 (by cpp standard), so this makes it
-    // consistent across multiple runs.
-    // NOTE: Reproducibility applies only on the same execution environment.
-    std::srand(1); // NOLINT(cert-msc51-cpp)
+    : associativity(associativity)
+    , generator(1) {
+    // Each cache has own generator seeded by a constant, so the result is reproducible and does
+    // not depend on other caches. Generator state is part of the snapshot and checkpoint.
 }
 
 void CachePolicyRAND::update_stats(size_t way, size_t row, bool is_valid) {
@@ -129,7 +161,31 @@ void CachePolicyRAND::update_stats(size_t way, size_t row, bool is_valid) {
 
 size_t CachePolicyRAND::select_way_to_evict(size_t row) const {
     UNUSED(row)
-    return std::rand() % associativity; // NOLINT(cert-msc50-cpp)
+    return generator() % associativity;
+}
+
+std::unique_ptr<CachePolicy> CachePolicyRAND::clone() const {
+    return std::make_unique<CachePolicyRAND>(*this);
+}
+
+void CachePolicyRAND::restore(const CachePolicy &snapshot) {
+    generator = static_cast<const CachePolicyRAND &>(snapshot).generator;
+}
+
+void CachePolicyRAND::save(QDataStream &out) const {
+    // Engine state has no portable binary form, its textual representation is stored.
+    std::ostringstream state;
+    state << generator;
+    out << QByteArray::fromStdString(state.str());
+}
+
+void CachePolicyRAND::load(QDataStream &in) {
+    QByteArray stored;
+    in >> stored;
+    if (in.status() != QDataStream::Ok) { checkpoint::throw_truncated(); }
+    std::istringstream state(stored.toStdString());
+    state >> generator;
+    if (state.fail()) { checkpoint::throw_mismatch("random replacement policy state"); }
 }
 
 CachePolicyPLRU::CachePolicyPLRU(size_t associativity, size_t set_count)
@@ -172,4 +228,20 @@ size_t CachePolicyPLRU::select_way_to_evict(size_t row) const {
     }
     return (idx >= associativity) ? (associativity - 1) : idx;
 }
+
+std::unique_ptr<CachePolicy> CachePolicyPLRU::clone() const {
+    return std::make_unique<CachePolicyPLRU>(*this);
+}
+
+void CachePolicyPLRU::restore(const CachePolicy &snapshot) {
+    plru_ptr = static_cast<const CachePolicyPLRU &>(snapshot).plru_ptr;
+}
+
+void CachePolicyPLRU::save(QDataStream &out) const {
+    checkpoint::write_rows(out, plru_ptr);
+}
+
+void CachePolicyPLRU::load(QDataStream &in) {
+    checkpoint::read_rows(in, plru_ptr);
+}
 } // namespace machine
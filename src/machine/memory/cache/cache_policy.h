@@ -4,9 +4,11 @@
 #include "machineconfig.h"
 #include "memory/cache/cache_types.h"
 
+#include <QDataStream>
 #include <cstdint>
 #include <cstdlib>
 #include <memory>
+#include <random>
 
 using std::size_t;
 
@@ -30,6 +32,20 @@ public:
      */
     virtual void update_stats(size_t way, size_t row, bool is_valid) = 0;
 
+    /** Returns copy of the policy including its replacement state (for cache snapshots). */
+    [[nodiscard]] virtual std::unique_ptr<CachePolicy> clone() const = 0;
+
+    /**
+     * Replaces replacement state by state of `snapshot`.
+     * @param snapshot      policy of the same type obtained by `clone`
+     */
+    virtual void restore(const CachePolicy &snapshot) = 0;
+
+    /** Writes replacement state to a checkpoint (see `Machine::save_checkpoint`). */
+    virtual void save(QDataStream &out) const = 0;
+    /** Reads state written by `save` of the policy of the same type and geometry. */
+    virtual void load(QDataStream &in) = 0;
+
     virtual ~CachePolicy() = default;
 
     static std::unique_ptr<CachePolicy>
@@ -56,6 +72,14 @@ public:
 
     void update_stats(size_t way, size_t row, bool is_valid) final;
 
+    [[nodiscard]] std::unique_ptr<CachePolicy> clone() const final;
+
+    void restore(const CachePolicy &snapshot) final;
+
+    void save(QDataStream &out) const final;
+
+    void load(QDataStream &in) final;
+
 private:
     /**
      * Last access order queues for each cache set (row)
@@ -83,6 +107,14 @@ public:
 
     void update_stats(size_t way, size_t row, bool is_valid) final;
 
+    [[nodiscard]] std::unique_ptr<CachePolicy> clone() const final;
+
+    void restore(const CachePolicy &snapshot) final;
+
+    void save(QDataStream &out) const final;
+
+    void load(QDataStream &in) final;
+
 private:
     std::vector<std::vector<uint32_t>> stats;
 };
@@ -98,8 +130,18 @@ public:
 
     void update_stats(size_t way, size_t row, bool is_valid) final;
 
+    [[nodiscard]] std::unique_ptr<CachePolicy> clone() const final;
+
+    void restore(const CachePolicy &snapshot) final;
+
+    void save(QDataStream &out) const final;
+
+    void load(QDataStream &in) final;
+
 private:
     size_t associativity;
+    /** Selection of the evicted way advances the generator, hence mutable. */
+    mutable std::minstd_rand generator;
 };
 
 /**
@@ -120,6 +162,14 @@ public:
 
     void update_stats(size_t way, size_t row, bool is_valid) final;
 
+    [[nodiscard]] std::unique_ptr<CachePolicy> clone() const final;
+
+    void restore(const CachePolicy &snapshot) final;
+
+    void save(QDataStream &out) const final;
+
+    void load(QDataStream &in) final;
+
 private:
     /**
      * Pointer to Least Recently Used Block
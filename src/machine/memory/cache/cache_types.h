@@ -17,12 +17,17 @@ struct CacheLocation {
 };
 
 /**
- * Single cache line. Appropriate cache block is stored in `data`.
+ * Access counters of a single cache.
  */
-struct CacheLine {
-    bool valid, dirty;
-    uint64_t tag;
-    std::vector<uint32_t> data;
+struct CacheStatistics {
+    uint32_t hit_read = 0;
+    uint32_t miss_read = 0;
+    uint32_t hit_write = 0;
+    uint32_t miss_write = 0;
+    uint32_t mem_reads = 0;
+    uint32_t mem_writes = 0;
+    uint32_t burst_reads = 0;
+    uint32_t burst_writes = 0;
 };
 
 /**
@@ -2,6 +2,9 @@
 
 #include "common/endian.h"
 
+#include <algorithm>
+#include <array>
+
 namespace machine {
 
 bool FrontendMemory::write_u8(
@@ -151,6 +154,24 @@ FrontendMemory::read_ctl(enum AccessControl ctl, Address address, uint8_t vl) co
 
 void FrontendMemory::sync() {}
 
+void FrontendMemory::read_span(void *destination, Address source, size_t size) const {
+    read(destination, source, size, { .type = ae::REGULAR });
+}
+
+void FrontendMemory::write_span(Address destination, const void *source, size_t size) {
+    write(destination, source, size, { .type = ae::REGULAR });
+}
+
+void FrontendMemory::discard_span(Address start, size_t size) {
+    static const std::array<byte, 4096> zeros {};
+    while (size > 0) {
+        const size_t chunk = std::min(size, zeros.size());
+        write_span(start, zeros.data(), chunk);
+        start += chunk;
+        size -= chunk;
+    }
+}
+
 LocationStatus FrontendMemory::location_status(Address address) const {
     (void)address;
     return LOCSTAT_NONE;
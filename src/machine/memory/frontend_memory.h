@@ -125,6 +125,36 @@ public:
         size_t size,
         ReadOptions options) const = 0;
 
+    /**
+     * Copies a guest range to a host buffer in a single transfer.
+     *
+     * Intended for bulk transfers which are not accesses of the simulated program (e.g. buffers
+     * of emulated system calls). Caches are bypassed, they are neither filled nor accounted in
+     * statistics, but data held only by them are taken into account. Default implementation is
+     * a regular `read`.
+     *
+     * @param destination   pointer to destination buffer
+     * @param source        emulated address of data to be read
+     * @param size          number of bytes to be read
+     */
+    virtual void read_span(void *destination, Address source, size_t size) const;
+
+    /**
+     * Copies a host buffer to a guest range in a single transfer.
+     *
+     * Counterpart of `read_span`, data are written to the backing memory and copies held by
+     * caches are updated in place. Default implementation is a regular `write`.
+     */
+    virtual void write_span(Address destination, const void *source, size_t size);
+
+    /**
+     * Zeroes a guest range which is no longer used (e.g. unmapped by an emulated system call).
+     *
+     * Unlike writing zeros, backing storage of the range may be released, so discarded areas
+     * cost no host memory. Default implementation writes zeros by `write_span`.
+     */
+    virtual void discard_span(Address start, size_t size);
+
     /**
      * Endian of the simulated CPU/memory system.
      *
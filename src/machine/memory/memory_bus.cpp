@@ -1,6 +1,7 @@
 #include "memory/memory_bus.h"
 
 #include "common/endian.h"
+#include "memory/backend/memory.h"
 #include "memory/memory_utils.h"
 
 using namespace machine;
@@ -10,6 +11,7 @@ MemoryDataBus::MemoryDataBus(Endian simulated_endian)
 
 MemoryDataBus::~MemoryDataBus() {
     ranges_by_addr.clear(); // No stored values are owned.
+    last_range.store(nullptr, std::memory_order_relaxed);
     auto iter = ranges_by_device.begin();
     while (iter != ranges_by_device.end()) {
         const RangeDesc *range = iter.value();
@@ -45,7 +47,7 @@ WriteResult MemoryDataBus::write_single(
         return (WriteResult) { .n_bytes = 0, .changed = false };
     }
     WriteResult result = range->device->write(
-        destination - range->start_addr, source, size, options);
+        range->device_offset(destination), source, size, options);
 
     if (result.changed) {
         change_counter++;
@@ -79,8 +81,27 @@ ReadResult MemoryDataBus::read_single(
         return (ReadResult) { .n_bytes = size };
     }
 
+    if (p_range->ram != nullptr) {
+        const byte *data = p_range->ram->direct_read_pointer(p_range->device_offset(source), size);
+        if (data != nullptr) {
+            memcpy(destination, data, size);
+            return (ReadResult) { .n_bytes = size };
+        }
+    }
+
     return p_range->device->read(
-        destination, source - p_range->start_addr, size, options);
+        destination, p_range->device_offset(source), size, options);
+}
+
+void MemoryDataBus::discard_span(Address start, size_t size) {
+    const RangeDesc *range = find_range(start);
+    if (size > 0 && range != nullptr && range->ram != nullptr
+        && start + (size - 1) <= range->last_addr) {
+        range->ram->discard(range->device_offset(start), size);
+        change_counter++;
+        return;
+    }
+    FrontendMemory::discard_span(start, size);
 }
 
 uint32_t MemoryDataBus::get_change_counter() const {
@@ -92,11 +113,11 @@ enum LocationStatus MemoryDataBus::location_status(Address address) const {
     if (range == nullptr) {
         return LOCSTAT_ILLEGAL;
     }
-    return range->device->location_status(address - range->start_addr);
+    return range->device->location_status(range->device_offset(address));
 }
 
 const MemoryDataBus::RangeDesc *
-MemoryDataBus::find_range(Address address) const {
+MemoryDataBus::find_range_slow(Address address) const {
     // lowerBound finds range what has highest key (which is range->last_addr)
     // less then or equal to address.
     // See comment in insert_device_to_range for description, why this works.
@@ -107,6 +128,7 @@ MemoryDataBus::find_range(Address address) const {
 
     const RangeDesc *range = iter.value();
     if (address >= range->start_addr && address <= range->last_addr) {
+        last_range.store(range, std::memory_order_relaxed);
         return range;
     }
 
@@ -117,14 +139,16 @@ bool MemoryDataBus::insert_device_to_range(
     BackendMemory *device,
     Address start_addr,
     Address last_addr,
-    bool move_ownership) {
+    bool move_ownership,
+    Offset device_start) {
     auto iter = ranges_by_addr.lowerBound(start_addr);
     if (iter != ranges_by_addr.end()
         && iter.value()->overlaps(start_addr, last_addr)) {
         // Some part of requested range in already taken.
         return false;
     }
-    auto *range = new RangeDesc(device, start_addr, last_addr, move_ownership);
+    auto *range = new RangeDesc(device, start_addr, last_addr, move_ownership, device_start);
+    last_range.store(nullptr, std::memory_order_relaxed);
 
     // Why are we using last address as key?
     //
@@ -136,38 +160,52 @@ bool MemoryDataBus::insert_device_to_range(
     // rang. Finally we just make sure, that the found range contains the
     // searched address for case that range is not present.
     ranges_by_addr.insert(last_addr, range);
+    if (!ranges_by_device.contains(device)) {
+        connect(
+            device, &BackendMemory::external_backend_change_notify, this,
+            &MemoryDataBus::range_backend_external_change);
+    }
     ranges_by_device.insert(device, range);
-    connect(
-        device, &BackendMemory::external_backend_change_notify, this,
-        &MemoryDataBus::range_backend_external_change);
     return true;
 }
 
 bool MemoryDataBus::remove_device(BackendMemory *device) {
-    const RangeDesc *range = ranges_by_device.take(device);
-    if (range == nullptr) {
+    const QList<const RangeDesc *> ranges = ranges_by_device.values(device);
+    if (ranges.isEmpty()) {
         return false; // Device not present.
     }
+    ranges_by_device.remove(device);
+    disconnect(device, nullptr, this, nullptr);
 
-    ranges_by_addr.remove(range->last_addr);
-    if (range->owns_device) {
-        delete range->device;
+    bool owns_device = false;
+    for (const RangeDesc *range : ranges) {
+        ranges_by_addr.remove(range->last_addr);
+        owns_device = owns_device || range->owns_device;
+        delete range;
+    }
+    last_range.store(nullptr, std::memory_order_relaxed);
+    if (owns_device) {
+        delete device;
     }
-    delete range;
 
     return true;
 }
 
 void MemoryDataBus::clean_range(Address start_addr, Address last_addr) {
+    // Devices are collected first, removal of a device removes all its ranges.
+    QList<BackendMemory *> devices;
     for (auto iter = ranges_by_addr.lowerBound(start_addr);
          iter != ranges_by_addr.end(); iter++) {
         const RangeDesc *range = iter.value();
         if (range->start_addr <= last_addr) {
-            remove_device(range->device);
+            if (!devices.contains(range->device)) { devices.append(range->device); }
         } else {
             break;
         }
     }
+    for (BackendMemory *device : devices) {
+        remove_device(device);
+    }
 }
 
 void MemoryDataBus::range_backend_external_change(
@@ -179,12 +217,16 @@ void MemoryDataBus::range_backend_external_change(
 
     // We only use device here for lookup, so const_cast is safe as find takes
     // it by const reference .
-    for (auto i = ranges_by_device.find(const_cast<BackendMemory *>(device));
-         i != ranges_by_device.end(); i++) {
-        const RangeDesc *range = i.value();
+    for (const RangeDesc *range : ranges_by_device.values(const_cast<BackendMemory *>(device))) {
+        if (last_offset < range->device_start
+            || start_offset > range->device_offset(range->last_addr)) {
+            continue; // Change is not visible through this range.
+        }
+        const Offset start = std::max(start_offset, range->device_start);
         emit external_change_notify(
-            this, range->start_addr + start_offset,
-            std::max(range->start_addr + last_offset, range->last_addr), type);
+            this, range->start_addr + (start - range->device_start),
+            std::max(range->start_addr + (last_offset - range->device_start), range->last_addr),
+            type);
     }
 }
 
@@ -192,11 +234,14 @@ MemoryDataBus::RangeDesc::RangeDesc(
     BackendMemory *device,
     Address start_addr,
     Address last_addr,
-    bool owns_device)
+    bool owns_device,
+    Offset device_start)
     : device(device)
+    , ram(dynamic_cast<Memory *>(device))
     , start_addr(start_addr)
     , last_addr(last_addr)
-    , owns_device(owns_device) {}
+    , owns_device(owns_device)
+    , device_start(device_start) {}
 
 bool MemoryDataBus::RangeDesc::contains(Address address) const {
     return start_addr <= address && address <= last_addr;
@@ -10,10 +10,13 @@
 
 #include <QMultiMap>
 #include <QObject>
+#include <atomic>
 #include <cstdint>
 
 namespace machine {
 
+class Memory;
+
 /**
  * Memory bus serves as last level of frontend memory and interconnects it with
  * backend memory devices, that are subscribed to given address range.
@@ -65,6 +68,9 @@ public:
         size_t size,
         ReadOptions options) const override;
 
+    /** Range held wholly by a RAM device is discarded by it (see `Memory::discard`). */
+    void discard_span(Address start, size_t size) override;
+
     /**
      * Number of writes and external changes recorded.
      */
@@ -80,6 +86,9 @@ public:
      * @param move_ownership    if true, bus will be responsible for for
      *                          device destruction
      *                          TODO: consider replace with a smartpointer
+     * @param device_start      offset within the device, which is accessible at
+     *                          `start_addr`, a device may be mapped to several
+     *                          ranges this way
      * @return                  result of connection, it will fail if range is
      *                          already occupied
      */
@@ -87,10 +96,11 @@ public:
         BackendMemory *device,
         Address start_addr,
         Address last_addr,
-        bool move_ownership);
+        bool move_ownership,
+        Offset device_start = 0);
 
     /**
-     * Disconnect a device by a pointer to it.
+     * Disconnect a device (all its ranges) by a pointer to it.
      * Owned device will be deallocated.
      *
      * @param device    simulated backend memory device object
@@ -129,6 +139,15 @@ private:
      * once.
      */
     QMap<Address, const RangeDesc *> ranges_by_addr;
+    /**
+     * Range found by the last lookup. Nearly all accesses go to the main memory, so this saves
+     * the map lookup. Reset whenever the set of ranges changes.
+     *
+     * Const lookups may run concurrently (e.g. memory view reading while the core runs), so the
+     * cache is atomic. Relaxed ordering is enough, each value is a complete lookup result and
+     * ranges themselves are modified only when no access is in progress.
+     */
+    mutable std::atomic<const RangeDesc *> last_range { nullptr };
     mutable uint32_t change_counter = 0;
 
     /**
@@ -161,7 +180,10 @@ private:
     /**
      * Get range (or nullptr) for arbitrary address (not just start or last).
      */
-    const MemoryDataBus::RangeDesc *find_range(Address address) const;
+    inline const MemoryDataBus::RangeDesc *find_range(Address address) const;
+
+    /** Lookup in `ranges_by_addr`, remembers found range in `last_range`. */
+    const MemoryDataBus::RangeDesc *find_range_slow(Address address) const;
 };
 
 /**
@@ -173,13 +195,21 @@ public:
         BackendMemory *device,
         Address start_addr,
         Address last_addr,
-        bool owns_device);
+        bool owns_device,
+        Offset device_start);
 
     /**
      * Tells, whether given address belongs to this range.
      */
     [[nodiscard]] bool contains(Address address) const;
 
+    /**
+     * Offset within the device of given address of this range.
+     */
+    [[nodiscard]] Offset device_offset(Address address) const {
+        return address - start_addr + device_start;
+    }
+
     /*
      * Tells, whether this range (of the RangeDesc) overlaps with supplied
      * range.
@@ -187,11 +217,22 @@ public:
     [[nodiscard]] bool overlaps(Address start, Address last) const;
 
     BackendMemory *const device; // TODO consider a shared pointer
+    /** Same as `device` when it is plain RAM, its content can be accessed directly. */
+    Memory *const ram;
     const Address start_addr;
     const Address last_addr;
     const bool owns_device;
+    const Offset device_start;
 };
 
+inline const MemoryDataBus::RangeDesc *MemoryDataBus::find_range(Address address) const {
+    const RangeDesc *range = last_range.load(std::memory_order_relaxed);
+    if (range != nullptr && range->contains(address)) {
+        return range;
+    }
+    return find_range_slow(address);
+}
+
 /**
  * Minimal frontend-backend wrapper.
  *
@@ -15,6 +15,7 @@
 #ifndef STAGES_H
 #define STAGES_H
 
+#include "core/scoreboard.h"
 #include "instruction.h"
 #include "machinedefs.h"
 #include "memory/address.h"
@@ -105,6 +106,9 @@ struct DecodeInterstage {
     RegisterId num_rs = 0;                          // Number of the register s1
     RegisterId num_rt = 0;                          // Number of the register s2
     RegisterId num_rd = 0;                          // Number of the register d
+    RegisterMask rs_mask = 0;                       // Register rs when required, see Scoreboard
+    RegisterMask rt_mask = 0;                       // Register rt when required
+    RegisterMask rd_mask = 0;                       // Register d when written
     bool memread = false;                           // If memory should be read
     bool memwrite = false;                          // If memory should write input
     bool alusrc = false;      // If second value to alu is immediate value (rt used otherwise)
@@ -180,6 +184,7 @@ struct ExecuteInterstage {
     ExceptionCause excause = EXCAUSE_NONE;
     AccessControl memctl = AC_NONE;
     RegisterId num_rd = 0;
+    RegisterMask rd_mask = 0;
     bool memread = false;
     bool memwrite = false;
     bool regwrite = false;
@@ -261,6 +266,7 @@ struct MemoryInterstage {
     RegisterValueUnion towrite_val = 0;
     ExceptionCause excause = EXCAUSE_NONE;
     RegisterId num_rd = 0;
+    RegisterMask rd_mask = 0;
     bool memtoreg = false;
     bool regwrite = false;
     bool is_valid = false;
@@ -333,6 +339,42 @@ struct Pipeline {
     MemoryState memory {};
     WritebackState writeback {};
 };
+
+/**
+ * Calls `fn(value)` for every `RegisterValueUnion` stored in the pipeline (both result and final
+ * copies of interstage registers). `PIPELINE` is `Pipeline` or `const Pipeline`.
+ */
+template<typename PIPELINE, typename FUNC>
+void for_each_pipeline_value(PIPELINE &p, FUNC fn) {
+    fn(p.fetch.internal.fetched_value);
+    fn(p.decode.internal.inst_bus);
+    for (auto *id : { &p.decode.result, &p.decode.final }) {
+        fn(id->val_rs);
+        fn(id->val_rs_orig);
+        fn(id->val_rt);
+        fn(id->val_rt_orig);
+        fn(id->immediate_val);
+        fn(id->csr_read_val);
+    }
+    fn(p.execute.internal.alu_src1);
+    fn(p.execute.internal.alu_src2);
+    fn(p.execute.internal.immediate);
+    fn(p.execute.internal.rs);
+    fn(p.execute.internal.rt);
+    for (auto *ex : { &p.execute.result, &p.execute.final }) {
+        fn(ex->val_rt);
+        fn(ex->alu_val);
+        fn(ex->immediate_val);
+        fn(ex->csr_read_val);
+    }
+    fn(p.memory.internal.mem_read_val);
+    fn(p.memory.internal.mem_write_val);
+    fn(p.memory.internal.mem_addr);
+    fn(p.memory.result.towrite_val);
+    fn(p.memory.final.towrite_val);
+    fn(p.writeback.internal.value);
+}
+
 } // namespace machine
 
 #endif // STAGES_H
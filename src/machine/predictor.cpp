@@ -32,6 +32,10 @@ QStringView machine::predictor_type_to_string(const PredictorType type) {
     case PredictorType::SMITH_1_BIT: return u"Smith 1 bit";
     case PredictorType::SMITH_2_BIT: return u"Smith 2 bit";
     case PredictorType::SMITH_2_BIT_HYSTERESIS: return u"Smith 2 bit with hysteresis";
+    case PredictorType::GSHARE: return u"Gshare";
+    case PredictorType::TOURNAMENT: return u"Tournament (bimodal and gshare)";
+    case PredictorType::TAGE_LITE: return u"TAGE-lite";
+    case PredictorType::PERCEPTRON: return u"Hashed perceptron";
     default: return u"";
     }
 }
@@ -62,6 +66,10 @@ bool machine::is_predictor_type_dynamic(const PredictorType type) {
     case PredictorType::SMITH_1_BIT:
     case PredictorType::SMITH_2_BIT:
     case PredictorType::SMITH_2_BIT_HYSTERESIS:
+    case PredictorType::GSHARE:
+    case PredictorType::TOURNAMENT:
+    case PredictorType::TAGE_LITE:
+    case PredictorType::PERCEPTRON:
         return true;
 
     default:
@@ -69,6 +77,51 @@ bool machine::is_predictor_type_dynamic(const PredictorType type) {
     }
 }
 
+bool machine::predictor_type_has_initial_state(const PredictorType type) {
+    return is_predictor_type_dynamic(type) && type != PredictorType::PERCEPTRON;
+}
+
+// XOR of consecutive `bits` wide chunks of the `length` youngest history bits
+static uint32_t fold_history(uint64_t history, uint8_t length, uint8_t bits) {
+    if (bits == 0) { return 0; }
+    if (length < 64) { history &= (UINT64_C(1) << length) - 1; }
+    uint64_t folded = 0;
+    while (history != 0) {
+        folded ^= history;
+        history = (bits < 64) ? history >> bits : 0;
+    }
+    return (uint32_t)(folded & ((UINT64_C(1) << bits) - 1));
+}
+
+// Multiplicative hash of `value` to `bits` bits, distinct `seed`s give unrelated indexes
+static uint32_t hash_index(uint64_t value, uint64_t seed, uint8_t bits) {
+    if (bits == 0) { return 0; }
+    const uint64_t multiplier = UINT64_C(0x9e3779b97f4a7c15);
+    uint64_t hash = (value ^ (seed * UINT64_C(0xff51afd7ed558ccd))) * multiplier;
+    hash ^= hash >> 32;
+    return (uint32_t)((hash * multiplier) >> (64 - bits));
+}
+
+static uint64_t address_bits(const Address address) {
+    return address.get_raw() >> 2;
+}
+
+// Saturating counter of given width
+static uint32_t counter_update(uint32_t counter, uint8_t bits, bool increment) {
+    if (increment) { return (counter < (1U << bits) - 1) ? counter + 1 : counter; }
+    return (counter > 0) ? counter - 1 : counter;
+}
+
+static uint32_t state_to_counter(PredictorState state) {
+    switch (state) {
+    case PredictorState::STRONGLY_NOT_TAKEN: return 0;
+    case PredictorState::WEAKLY_TAKEN: return 2;
+    case PredictorState::TAKEN:
+    case PredictorState::STRONGLY_TAKEN: return 3;
+    default: return 1;
+    }
+}
+
 /////////////////////////////////
 // BranchHistoryRegister class //
 /////////////////////////////////
@@ -88,21 +141,20 @@ uint8_t BranchHistoryRegister::init_number_of_bits(const uint8_t b) const {
 }
 
 // Init helper function to create the register mask used for masking unused bits
-uint16_t BranchHistoryRegister::init_register_mask(const uint8_t b) const {
-    if (b >= BP_MAX_BHR_BITS) { return ~0x0; }
-    if (b == 0) { return 0x0; }
-    return (1 << b) - 1;
+uint64_t BranchHistoryRegister::init_register_mask(const uint8_t b) const {
+    if (b >= 64) { return ~UINT64_C(0); }
+    return (UINT64_C(1) << b) - 1;
 }
 
 uint8_t BranchHistoryRegister::get_number_of_bits() const {
     return number_of_bits;
 }
 
-uint16_t BranchHistoryRegister::get_register_mask() const {
+uint64_t BranchHistoryRegister::get_register_mask() const {
     return register_mask;
 }
 
-uint16_t BranchHistoryRegister::get_value() const {
+uint64_t BranchHistoryRegister::get_value() const {
     return value;
 }
 
@@ -126,6 +178,11 @@ void BranchHistoryRegister::clear() {
     emit bhr_updated(number_of_bits, value);
 }
 
+void BranchHistoryRegister::set_value(const uint64_t new_value) {
+    value = new_value & register_mask;
+    emit bhr_updated(number_of_bits, value);
+}
+
 //////////////////////////////
 // BranchTargetBuffer class //
 //////////////////////////////
@@ -197,6 +254,42 @@ void BranchTargetBuffer::clear() {
     }
 }
 
+const std::vector<BranchTargetBufferEntry> &BranchTargetBuffer::get_entries() const {
+    return btb;
+}
+
+void BranchTargetBuffer::set_entries(const std::vector<BranchTargetBufferEntry> &entries) {
+    for (uint16_t i = 0; i < btb.size() && i < entries.size(); i++) {
+        btb.at(i) = entries.at(i);
+        emit btb_row_updated(i, btb.at(i));
+    }
+}
+
+//////////////////////////
+// PackedBitTable class //
+//////////////////////////
+
+PackedBitTable::PackedBitTable(uint8_t field_bits, uint32_t size, uint32_t initial_value)
+    : field_bits(field_bits)
+    , fields_per_word(64 / field_bits)
+    , field_mask((field_bits >= 32) ? UINT32_MAX : (UINT64_C(1) << field_bits) - 1)
+    , number_of_fields(size)
+    , words((size + fields_per_word - 1) / fields_per_word) {
+    fill(initial_value);
+}
+
+void PackedBitTable::fill(uint32_t value) {
+    uint64_t word = 0;
+    for (uint32_t i = 0; i < fields_per_word; i++) {
+        word |= ((uint64_t)value & field_mask) << (i * field_bits);
+    }
+    std::fill(words.begin(), words.end(), word);
+}
+
+void PackedBitTable::set_words(const uint64_t *source) {
+    std::copy(source, source + words.size(), words.begin());
+}
+
 /////////////////////
 // Predictor class //
 /////////////////////
@@ -207,13 +300,16 @@ void BranchTargetBuffer::clear() {
 Predictor::Predictor(
     uint8_t number_of_bht_addr_bits,
     uint8_t number_of_bht_bits,
-    PredictorState initial_state)
+    PredictorState initial_state,
+    bool has_state_table)
     : number_of_bht_addr_bits(init_number_of_bht_addr_bits(number_of_bht_addr_bits))
     , number_of_bht_bits(init_number_of_bht_bits(number_of_bht_bits))
-    , initial_state(initial_state) {
-    bht.resize(qPow(2, number_of_bht_bits));
-    clear_bht_state();
-    clear_bht_stats();
+    , bht_index_mask((1U << this->number_of_bht_bits) - 1)
+    , initial_state(initial_state)
+    , bht(3, has_state_table ? 1U << this->number_of_bht_bits : 0, (uint32_t)initial_state)
+    , view_stride_bits(init_view_stride_bits(this->number_of_bht_bits))
+    , bht_stats(1U << (this->number_of_bht_bits - view_stride_bits)) {
+    add_table(&bht);
 }
 
 uint8_t Predictor::init_number_of_bht_addr_bits(const uint8_t b) const {
@@ -234,6 +330,10 @@ uint8_t Predictor::init_number_of_bht_bits(const uint8_t b) const {
     return b;
 }
 
+uint8_t Predictor::init_view_stride_bits(const uint8_t b) const {
+    return (b > BP_MAX_BHT_VIEW_BITS) ? b - BP_MAX_BHT_VIEW_BITS : 0;
+}
+
 BranchResult Predictor::convert_state_to_prediction(PredictorState state) const {
     if (state == PredictorState::NOT_TAKEN) {
         return BranchResult::NOT_TAKEN;
@@ -253,6 +353,38 @@ BranchResult Predictor::convert_state_to_prediction(PredictorState state) const
     }
 }
 
+// Transition of 2 bit saturating counter, shared by Smith 2 bit and the newer predictors
+PredictorState Predictor::next_2bit_state(PredictorState state, BranchResult result) {
+    if (result == BranchResult::NOT_TAKEN) {
+        if (state == PredictorState::STRONGLY_TAKEN) {
+            return PredictorState::WEAKLY_TAKEN;
+        } else if (state == PredictorState::WEAKLY_TAKEN) {
+            return PredictorState::WEAKLY_NOT_TAKEN;
+        } else if (state == PredictorState::WEAKLY_NOT_TAKEN) {
+            return PredictorState::STRONGLY_NOT_TAKEN;
+        } else if (state == PredictorState::STRONGLY_NOT_TAKEN) {
+            return PredictorState::STRONGLY_NOT_TAKEN;
+        } else {
+            WARN("Smith 2 bit predictor BHT has returned invalid state");
+        }
+    } else if (result == BranchResult::TAKEN) {
+        if (state == PredictorState::STRONGLY_TAKEN) {
+            return PredictorState::STRONGLY_TAKEN;
+        } else if (state == PredictorState::WEAKLY_TAKEN) {
+            return PredictorState::STRONGLY_TAKEN;
+        } else if (state == PredictorState::WEAKLY_NOT_TAKEN) {
+            return PredictorState::WEAKLY_TAKEN;
+        } else if (state == PredictorState::STRONGLY_NOT_TAKEN) {
+            return PredictorState::WEAKLY_NOT_TAKEN;
+        } else {
+            WARN("Smith 2 bit predictor BHT has returned invalid state");
+        }
+    } else {
+        WARN("Smith 2 bit predictor has received invalid prediction result");
+    }
+    return state;
+}
+
 void Predictor::update_stats(bool prediction_was_correct) {
     stats.total += 1;
     if (prediction_was_correct) {
@@ -260,53 +392,75 @@ void Predictor::update_stats(bool prediction_was_correct) {
     } else {
         stats.wrong += 1;
     }
-    stats.accuracy = ((stats.correct * 100) / stats.total);
     emit stats_updated(stats);
 }
 
-void Predictor::update_bht_stats(uint16_t bht_index, bool prediction_was_correct) {
-    if (bht_index >= bht.capacity()) {
+// Only sampled entries keep statistics, see `get_bht_view_stride_bits`
+void Predictor::update_bht_stats(uint32_t bht_index, bool prediction_was_correct) {
+    if (bht_index > bht_index_mask) {
         WARN("Tried to access BHT at invalid index: %u", bht_index);
         return;
     }
+    if ((bht_index & ((1U << view_stride_bits) - 1)) != 0) { return; }
 
-    bht.at(bht_index).stats.total += 1;
+    PredictionStatistics &entry_stats = bht_stats.at(bht_index >> view_stride_bits);
+    entry_stats.total += 1;
     if (prediction_was_correct) {
-        bht.at(bht_index).stats.correct += 1;
+        entry_stats.correct += 1;
     } else {
-        bht.at(bht_index).stats.wrong += 1;
+        entry_stats.wrong += 1;
     }
-    bht.at(bht_index).stats.accuracy = ((bht.at(bht_index).stats.correct * 100) / bht.at(bht_index).stats.total);
-    emit bht_row_updated(bht_index, bht.at(bht_index));
+    notify_bht_entry(bht_index);
+}
+
+void Predictor::set_bht_state(uint32_t bht_index, PredictorState state) {
+    bht.set(bht_index, (uint32_t)state);
+    notify_bht_entry(bht_index);
+}
+
+void Predictor::notify_bht_entry(uint32_t bht_index) const {
+    if ((bht_index & ((1U << view_stride_bits) - 1)) != 0) { return; }
+    const uint32_t row = bht_index >> view_stride_bits;
+    emit bht_row_updated(row, get_bht_row(row));
+}
+
+void Predictor::add_table(PackedBitTable *table) {
+    tables.push_back(table);
 }
 
 // Calculate index for addressing Branch History Table from BHR and instruction address
-uint16_t Predictor::calculate_bht_index(
-    const uint16_t bhr_value,
+uint32_t Predictor::calculate_bht_index(
+    const uint64_t bhr_value,
     const Address instruction_address) const {
-    const uint16_t bhr_part = bhr_value << number_of_bht_addr_bits;
-    const uint16_t address_mask = (1 << number_of_bht_addr_bits) - 1;
-    const uint16_t address_part = ((uint16_t)(instruction_address.get_raw() >> 2)) & address_mask;
-    const uint16_t index = bhr_part | address_part;
+    const uint64_t bhr_part = bhr_value << number_of_bht_addr_bits;
+    const uint64_t address_mask = (UINT64_C(1) << number_of_bht_addr_bits) - 1;
+    const uint64_t address_part = address_bits(instruction_address) & address_mask;
+    const uint32_t index = (uint32_t)((bhr_part | address_part) & bht_index_mask);
     return index;
 }
 
+PredictorState Predictor::get_bht_state(uint32_t bht_index) const {
+    if (bht_index >= bht.size()) { return initial_state; }
+    return (PredictorState)bht.get(bht_index);
+}
+
 void Predictor::clear_stats() {
     stats = PredictionStatistics();
     emit stats_updated(stats);
 }
 
 void Predictor::clear_bht_stats() {
-    for (uint16_t i = 0; i < bht.capacity(); i++) {
-        bht.at(i).stats = PredictionStatistics();
-        emit bht_row_updated(i, bht.at(i));
+    for (uint32_t i = 0; i < bht_stats.size(); i++) {
+        bht_stats.at(i) = PredictionStatistics();
+        emit bht_row_updated(i, get_bht_row(i));
     }
 }
 
 void Predictor::clear_bht_state() {
-    for (uint16_t i = 0; i < bht.capacity(); i++) {
-        bht.at(i).state = initial_state;
-        emit bht_row_updated(i, bht.at(i));
+    bht.fill((uint32_t)initial_state);
+    clear_tables();
+    for (uint32_t i = 0; i < bht_stats.size(); i++) {
+        emit bht_row_updated(i, get_bht_row(i));
     }
 }
 
@@ -320,6 +474,52 @@ void Predictor::flush() {
     clear_bht_state();
 }
 
+PredictionStatistics Predictor::get_stats() const {
+    return stats;
+}
+
+uint8_t Predictor::get_bht_view_stride_bits() const {
+    return view_stride_bits;
+}
+
+uint32_t Predictor::get_bht_view_size() const {
+    return bht_stats.size();
+}
+
+BranchHistoryTableEntry Predictor::get_bht_row(uint32_t row) const {
+    return { get_bht_state(row << view_stride_bits), bht_stats.at(row) };
+}
+
+const std::vector<PredictionStatistics> &Predictor::get_bht_stats() const {
+    return bht_stats;
+}
+
+std::vector<uint64_t> Predictor::get_tables() const {
+    std::vector<uint64_t> words;
+    for (const PackedBitTable *table : tables) {
+        words.insert(words.end(), table->get_words().begin(), table->get_words().end());
+    }
+    return words;
+}
+
+void Predictor::restore(
+    const PredictionStatistics &new_stats,
+    const std::vector<PredictionStatistics> &new_bht_stats,
+    const std::vector<uint64_t> &new_tables) {
+    stats = new_stats;
+    emit stats_updated(stats);
+    size_t offset = 0;
+    for (PackedBitTable *table : tables) {
+        if (offset + table->get_words().size() > new_tables.size()) { break; }
+        table->set_words(new_tables.data() + offset);
+        offset += table->get_words().size();
+    }
+    for (uint32_t i = 0; i < bht_stats.size(); i++) {
+        if (i < new_bht_stats.size()) { bht_stats.at(i) = new_bht_stats.at(i); }
+        emit bht_row_updated(i, get_bht_row(i));
+    }
+}
+
 // Always Not Taken
 // ################
 
@@ -382,35 +582,28 @@ PredictorSmith1Bit::PredictorSmith1Bit(
     : Predictor(number_of_bht_addr_bits, number_of_bht_bits, initial_state) {};
 
 BranchResult PredictorSmith1Bit::predict(PredictionInput input) {
-    const uint16_t index { calculate_bht_index(input.bhr_value, input.instruction_address) };
-    if (index >= bht.capacity()) {
-        WARN("Tried to access BHT at invalid index: %u", index);
-        return BranchResult::NOT_TAKEN;
-    }
+    const uint32_t index { calculate_bht_index(input.bhr_value, input.instruction_address) };
 
     // Decide prediction
-    return convert_state_to_prediction(bht.at(index).state);
+    return convert_state_to_prediction(get_bht_state(index));
 }
 
 void PredictorSmith1Bit::update(PredictionFeedback feedback) {
-    const uint16_t index { calculate_bht_index(feedback.bhr_value, feedback.instruction_address) };
-    if (index >= bht.capacity()) {
-        WARN("Tried to access BHT at invalid index: %u", index);
-        return;
-    }
+    const uint32_t index { calculate_bht_index(feedback.bhr_value, feedback.instruction_address) };
+    const bool prediction_was_correct
+        = feedback.result == convert_state_to_prediction(get_bht_state(index));
 
-    update_bht_stats(index, feedback.result == convert_state_to_prediction(bht.at(index).state));
-    update_stats(feedback.result == convert_state_to_prediction(bht.at(index).state));
+    update_bht_stats(index, prediction_was_correct);
+    update_stats(prediction_was_correct);
 
     // Update internal state
     if (feedback.result == BranchResult::NOT_TAKEN) {
-        bht.at(index).state = PredictorState::NOT_TAKEN;
+        set_bht_state(index, PredictorState::NOT_TAKEN);
     } else if (feedback.result == BranchResult::TAKEN) {
-        bht.at(index).state = PredictorState::TAKEN;
+        set_bht_state(index, PredictorState::TAKEN);
     } else {
         WARN("Smith 1 bit predictor has received invalid prediction result");
     }
-    emit bht_row_updated(index, bht.at(index));
 }
 
 // Smith 2 Bit
@@ -423,58 +616,24 @@ PredictorSmith2Bit::PredictorSmith2Bit(
     : Predictor(number_of_bht_addr_bits, number_of_bht_bits, initial_state) {};
 
 BranchResult PredictorSmith2Bit::predict(PredictionInput input) {
-    const uint16_t index { calculate_bht_index(input.bhr_value, input.instruction_address) };
-    if (index >= bht.capacity()) {
-        WARN("Tried to access BHT at invalid index: %u", index);
-        return BranchResult::NOT_TAKEN;
-    }
+    const uint32_t index { calculate_bht_index(input.bhr_value, input.instruction_address) };
 
     // Decide prediction
-    return convert_state_to_prediction(bht.at(index).state);
+    return convert_state_to_prediction(get_bht_state(index));
 }
 
 void PredictorSmith2Bit::update(PredictionFeedback feedback) {
-    const uint16_t index { calculate_bht_index(feedback.bhr_value, feedback.instruction_address) };
-    if (index >= bht.capacity()) {
-        WARN("Tried to access BHT at invalid index: %u", index);
-        return;
-    }
-
-    update_bht_stats(index, feedback.result == convert_state_to_prediction(bht.at(index).state));
-    update_stats(feedback.result == convert_state_to_prediction(bht.at(index).state));
+    const uint32_t index { calculate_bht_index(feedback.bhr_value, feedback.instruction_address) };
 
     // Read value from BHT at correct index
-    const PredictorState state = bht.at(index).state;
+    const PredictorState state = get_bht_state(index);
+    const bool prediction_was_correct = feedback.result == convert_state_to_prediction(state);
+
+    update_bht_stats(index, prediction_was_correct);
+    update_stats(prediction_was_correct);
 
     // Update internal state
-    if (feedback.result == BranchResult::NOT_TAKEN) {
-        if (state == PredictorState::STRONGLY_TAKEN) {
-            bht.at(index).state = PredictorState::WEAKLY_TAKEN;
-        } else if (state == PredictorState::WEAKLY_TAKEN) {
-            bht.at(index).state = PredictorState::WEAKLY_NOT_TAKEN;
-        } else if (state == PredictorState::WEAKLY_NOT_TAKEN) {
-            bht.at(index).state = PredictorState::STRONGLY_NOT_TAKEN;
-        } else if (state == PredictorState::STRONGLY_NOT_TAKEN) {
-            bht.at(index).state = PredictorState::STRONGLY_NOT_TAKEN;
-        } else {
-            WARN("Smith 2 bit predictor BHT has returned invalid state");
-        }
-    } else if (feedback.result == BranchResult::TAKEN) {
-        if (state == PredictorState::STRONGLY_TAKEN) {
-            bht.at(index).state = PredictorState::STRONGLY_TAKEN;
-        } else if (state == PredictorState::WEAKLY_TAKEN) {
-            bht.at(index).state = PredictorState::STRONGLY_TAKEN;
-        } else if (state == PredictorState::WEAKLY_NOT_TAKEN) {
-            bht.at(index).state = PredictorState::WEAKLY_TAKEN;
-        } else if (state == PredictorState::STRONGLY_NOT_TAKEN) {
-            bht.at(index).state = PredictorState::WEAKLY_NOT_TAKEN;
-        } else {
-            WARN("Smith 2 bit predictor BHT has returned invalid state");
-        }
-    } else {
-        WARN("Smith 2 bit predictor has received invalid prediction result");
-    }
-    emit bht_row_updated(index, bht.at(index));
+    set_bht_state(index, next_2bit_state(state, feedback.result));
 }
 
 // Smith 2 Bit with hysteresis
@@ -487,58 +646,375 @@ PredictorSmith2BitHysteresis::PredictorSmith2BitHysteresis(
     : Predictor(number_of_bht_addr_bits, number_of_bht_bits, initial_state) {};
 
 BranchResult PredictorSmith2BitHysteresis::predict(PredictionInput input) {
-    const uint16_t index { calculate_bht_index(input.bhr_value, input.instruction_address) };
-    if (index >= bht.capacity()) {
-        WARN("Tried to access BHT at invalid index: %u", index);
-        return BranchResult::NOT_TAKEN;
-    }
+    const uint32_t index { calculate_bht_index(input.bhr_value, input.instruction_address) };
 
     // Decide prediction
-    return convert_state_to_prediction(bht.at(index).state);
+    return convert_state_to_prediction(get_bht_state(index));
 }
 
 void PredictorSmith2BitHysteresis::update(PredictionFeedback feedback) {
-    const uint16_t index { calculate_bht_index(feedback.bhr_value, feedback.instruction_address) };
-    if (index >= bht.capacity()) {
-        WARN("Tried to access BHT at invalid index: %u", index);
-        return;
-    }
-
-    update_bht_stats(index, feedback.result == convert_state_to_prediction(bht.at(index).state));
-    update_stats(feedback.result == convert_state_to_prediction(bht.at(index).state));
+    const uint32_t index { calculate_bht_index(feedback.bhr_value, feedback.instruction_address) };
 
     // Read value from BHT at correct index
-    const PredictorState state = bht.at(index).state;
+    const PredictorState state = get_bht_state(index);
+    const bool prediction_was_correct = feedback.result == convert_state_to_prediction(state);
+
+    update_bht_stats(index, prediction_was_correct);
+    update_stats(prediction_was_correct);
 
     // Update internal state
     if (feedback.result == BranchResult::NOT_TAKEN) {
         if (state == PredictorState::STRONGLY_TAKEN) {
-            bht.at(index).state = PredictorState::WEAKLY_TAKEN;
+            set_bht_state(index, PredictorState::WEAKLY_TAKEN);
         } else if (state == PredictorState::WEAKLY_TAKEN) {
-            bht.at(index).state = PredictorState::STRONGLY_NOT_TAKEN;
+            set_bht_state(index, PredictorState::STRONGLY_NOT_TAKEN);
         } else if (state == PredictorState::WEAKLY_NOT_TAKEN) {
-            bht.at(index).state = PredictorState::STRONGLY_NOT_TAKEN;
+            set_bht_state(index, PredictorState::STRONGLY_NOT_TAKEN);
         } else if (state == PredictorState::STRONGLY_NOT_TAKEN) {
-            bht.at(index).state = PredictorState::STRONGLY_NOT_TAKEN;
+            set_bht_state(index, PredictorState::STRONGLY_NOT_TAKEN);
         } else {
             WARN("Smith 2 bit hysteresis predictor BHT has returned invalid state");
         }
     } else if (feedback.result == BranchResult::TAKEN) {
         if (state == PredictorState::STRONGLY_TAKEN) {
-            bht.at(index).state = PredictorState::STRONGLY_TAKEN;
+            set_bht_state(index, PredictorState::STRONGLY_TAKEN);
         } else if (state == PredictorState::WEAKLY_TAKEN) {
-            bht.at(index).state = PredictorState::STRONGLY_TAKEN;
+            set_bht_state(index, PredictorState::STRONGLY_TAKEN);
         } else if (state == PredictorState::WEAKLY_NOT_TAKEN) {
-            bht.at(index).state = PredictorState::STRONGLY_TAKEN;
+            set_bht_state(index, PredictorState::STRONGLY_TAKEN);
         } else if (state == PredictorState::STRONGLY_NOT_TAKEN) {
-            bht.at(index).state = PredictorState::WEAKLY_NOT_TAKEN;
+            set_bht_state(index, PredictorState::WEAKLY_NOT_TAKEN);
         } else {
             WARN("Smith 2 bit hysteresis predictor BHT has returned invalid state");
         }
     } else {
         WARN("Smith 2 bit hysteresis predictor has received invalid prediction result");
     }
-    emit bht_row_updated(index, bht.at(index));
+}
+
+// Gshare
+// ######
+
+PredictorGshare::PredictorGshare(
+    uint8_t number_of_bhr_bits,
+    uint8_t number_of_bht_bits,
+    PredictorState initial_state)
+    : Predictor(number_of_bht_bits, number_of_bht_bits, initial_state)
+    , number_of_bhr_bits(number_of_bhr_bits) {};
+
+// History longer than the index is folded into it
+uint32_t PredictorGshare::calculate_bht_index(
+    const uint64_t bhr_value,
+    const Address instruction_address) const {
+    const uint32_t history = fold_history(bhr_value, number_of_bhr_bits, number_of_bht_bits);
+    return ((uint32_t)address_bits(instruction_address) ^ history) & bht_index_mask;
+}
+
+BranchResult PredictorGshare::predict(PredictionInput input) {
+    const uint32_t index { calculate_bht_index(input.bhr_value, input.instruction_address) };
+    return convert_state_to_prediction(get_bht_state(index));
+}
+
+void PredictorGshare::update(PredictionFeedback feedback) {
+    const uint32_t index { calculate_bht_index(feedback.bhr_value, feedback.instruction_address) };
+    const PredictorState state = get_bht_state(index);
+    const bool prediction_was_correct = feedback.result == convert_state_to_prediction(state);
+
+    update_bht_stats(index, prediction_was_correct);
+    update_stats(prediction_was_correct);
+    set_bht_state(index, next_2bit_state(state, feedback.result));
+}
+
+// Tournament
+// ##########
+
+PredictorTournament::PredictorTournament(
+    uint8_t number_of_bhr_bits,
+    uint8_t number_of_bht_bits,
+    PredictorState initial_state)
+    : Predictor(number_of_bht_bits, number_of_bht_bits, initial_state)
+    , number_of_bhr_bits(number_of_bhr_bits)
+    , bimodal(2, 1U << this->number_of_bht_bits, state_to_counter(initial_state))
+    , chooser(2, 1U << this->number_of_bht_bits, 1) {
+    add_table(&bimodal);
+    add_table(&chooser);
+}
+
+void PredictorTournament::clear_tables() {
+    bimodal.fill(state_to_counter(initial_state));
+    chooser.fill(1);
+}
+
+uint32_t PredictorTournament::calculate_bht_index(
+    const uint64_t bhr_value,
+    const Address instruction_address) const {
+    const uint32_t history = fold_history(bhr_value, number_of_bhr_bits, number_of_bht_bits);
+    return ((uint32_t)address_bits(instruction_address) ^ history) & bht_index_mask;
+}
+
+BranchResult PredictorTournament::predict(PredictionInput input) {
+    const uint32_t address_index = (uint32_t)address_bits(input.instruction_address)
+                                   & bht_index_mask;
+    if (chooser.get(address_index) >= 2) {
+        const uint32_t index { calculate_bht_index(input.bhr_value, input.instruction_address) };
+        return convert_state_to_prediction(get_bht_state(index));
+    }
+    return (bimodal.get(address_index) >= 2) ? BranchResult::TAKEN : BranchResult::NOT_TAKEN;
+}
+
+void PredictorTournament::update(PredictionFeedback feedback) {
+    const uint32_t index { calculate_bht_index(feedback.bhr_value, feedback.instruction_address) };
+    const uint32_t address_index = (uint32_t)address_bits(feedback.instruction_address)
+                                   & bht_index_mask;
+    const bool taken = feedback.result == BranchResult::TAKEN;
+
+    const PredictorState gshare_state = get_bht_state(index);
+    const uint32_t bimodal_counter = bimodal.get(address_index);
+    const bool gshare_correct = feedback.result == convert_state_to_prediction(gshare_state);
+    const bool bimodal_correct = (bimodal_counter >= 2) == taken;
+    const uint32_t choice = chooser.get(address_index);
+    const bool prediction_was_correct = (choice >= 2) ? gshare_correct : bimodal_correct;
+
+    update_bht_stats(index, prediction_was_correct);
+    update_stats(prediction_was_correct);
+
+    // Chooser moves towards the component which was right when they disagree
+    if (gshare_correct != bimodal_correct) {
+        chooser.set(address_index, counter_update(choice, 2, gshare_correct));
+    }
+    bimodal.set(address_index, counter_update(bimodal_counter, 2, taken));
+    set_bht_state(index, next_2bit_state(gshare_state, feedback.result));
+}
+
+// TAGE-lite
+// #########
+
+// Tagged entry fields
+static constexpr uint32_t TAGE_COUNTER_BITS = 3;
+static constexpr uint32_t TAGE_USEFUL_BITS = 2;
+static constexpr uint32_t TAGE_USEFUL_SHIFT = TAGE_COUNTER_BITS;
+static constexpr uint32_t TAGE_TAG_SHIFT = TAGE_COUNTER_BITS + TAGE_USEFUL_BITS;
+
+static uint32_t tage_counter(uint32_t entry) {
+    return entry & ((1U << TAGE_COUNTER_BITS) - 1);
+}
+
+static uint32_t tage_useful(uint32_t entry) {
+    return (entry >> TAGE_USEFUL_SHIFT) & ((1U << TAGE_USEFUL_BITS) - 1);
+}
+
+static uint32_t tage_tag(uint32_t entry) {
+    return entry >> TAGE_TAG_SHIFT;
+}
+
+static uint32_t tage_entry(uint32_t counter, uint32_t useful, uint32_t tag) {
+    return counter | (useful << TAGE_USEFUL_SHIFT) | (tag << TAGE_TAG_SHIFT);
+}
+
+static BranchResult tage_prediction(uint32_t entry) {
+    return (tage_counter(entry) >= (1U << (TAGE_COUNTER_BITS - 1))) ? BranchResult::TAKEN
+                                                                    : BranchResult::NOT_TAKEN;
+}
+
+PredictorTageLite::PredictorTageLite(
+    uint8_t number_of_bhr_bits,
+    uint8_t number_of_bht_bits,
+    PredictorState initial_state)
+    : Predictor(number_of_bht_bits, number_of_bht_bits, initial_state)
+    , tagged_table_bits((this->number_of_bht_bits > 2) ? this->number_of_bht_bits - 2 : 0) {
+    const uint8_t history_bits = qMin<uint8_t>(number_of_bhr_bits, BP_MAX_BHR_BITS);
+    tagged.reserve(TAGGED_TABLES);
+    for (unsigned i = 0; i < TAGGED_TABLES; i++) {
+        // Geometric series ending with the whole register
+        history_lengths[i] = history_bits >> (TAGGED_TABLES - 1 - i);
+        tagged.emplace_back(TAGE_TAG_SHIFT + TAG_BITS, 1U << tagged_table_bits);
+    }
+    for (PackedBitTable &table : tagged) {
+        add_table(&table);
+    }
+}
+
+void PredictorTageLite::clear_tables() {
+    for (PackedBitTable &table : tagged) {
+        table.fill(0);
+    }
+}
+
+PredictorTageLite::Lookup PredictorTageLite::lookup(
+    const uint64_t bhr_value,
+    const Address instruction_address) const {
+    const uint64_t pc = address_bits(instruction_address);
+    Lookup result {};
+    result.provider = -1;
+    result.alternate = -1;
+    for (unsigned i = 0; i < TAGGED_TABLES; i++) {
+        const uint8_t length = history_lengths[i];
+        result.indexes[i] = (uint32_t)(pc ^ (pc >> tagged_table_bits)
+                                       ^ fold_history(bhr_value, length, tagged_table_bits))
+                            & ((1U << tagged_table_bits) - 1);
+        result.tags[i] = (uint32_t)(pc ^ fold_history(bhr_value, length, TAG_BITS)
+                                    ^ (fold_history(bhr_value, length, TAG_BITS - 1) << 1))
+                         & ((1U << TAG_BITS) - 1);
+        // Tag 0 marks an empty entry
+        if (result.tags[i] == 0) { result.tags[i] = 1; }
+    }
+    for (int i = TAGGED_TABLES - 1; i >= 0; i--) {
+        const uint32_t entry = tagged[i].get(result.indexes[i]);
+        if (tage_tag(entry) != result.tags[i]) { continue; }
+        if (result.provider < 0) {
+            result.provider = i;
+        } else {
+            result.alternate = i;
+            break;
+        }
+    }
+    const BranchResult base_prediction = convert_state_to_prediction(
+        get_bht_state(calculate_bht_index(bhr_value, instruction_address)));
+    result.alternate_prediction
+        = (result.alternate >= 0)
+              ? tage_prediction(tagged[result.alternate].get(result.indexes[result.alternate]))
+              : base_prediction;
+    result.provider_prediction
+        = (result.provider >= 0)
+              ? tage_prediction(tagged[result.provider].get(result.indexes[result.provider]))
+              : base_prediction;
+    return result;
+}
+
+BranchResult PredictorTageLite::predict(PredictionInput input) {
+    return lookup(input.bhr_value, input.instruction_address).provider_prediction;
+}
+
+void PredictorTageLite::update(PredictionFeedback feedback) {
+    const uint32_t index { calculate_bht_index(feedback.bhr_value, feedback.instruction_address) };
+    const Lookup found = lookup(feedback.bhr_value, feedback.instruction_address);
+    const bool taken = feedback.result == BranchResult::TAKEN;
+    const bool prediction_was_correct = found.provider_prediction == feedback.result;
+
+    update_bht_stats(index, prediction_was_correct);
+    update_stats(prediction_was_correct);
+
+    if (found.provider >= 0) {
+        PackedBitTable &table = tagged[found.provider];
+        const uint32_t entry_index = found.indexes[found.provider];
+        const uint32_t entry = table.get(entry_index);
+        uint32_t useful = tage_useful(entry);
+        if (found.provider_prediction != found.alternate_prediction) {
+            useful = counter_update(useful, TAGE_USEFUL_BITS, prediction_was_correct);
+        }
+        table.set(
+            entry_index,
+            tage_entry(
+                counter_update(tage_counter(entry), TAGE_COUNTER_BITS, taken), useful,
+                tage_tag(entry)));
+    } else {
+        set_bht_state(index, next_2bit_state(get_bht_state(index), feedback.result));
+    }
+
+    // Misprediction allocates an entry with longer history, or ages the candidates
+    if (prediction_was_correct) { return; }
+    bool allocated = false;
+    for (unsigned i = found.provider + 1; i < TAGGED_TABLES; i++) {
+        if (tage_useful(tagged[i].get(found.indexes[i])) == 0) {
+            const uint32_t counter = taken ? 1U << (TAGE_COUNTER_BITS - 1)
+                                           : (1U << (TAGE_COUNTER_BITS - 1)) - 1;
+            tagged[i].set(found.indexes[i], tage_entry(counter, 0, found.tags[i]));
+            allocated = true;
+            break;
+        }
+    }
+    if (!allocated) {
+        for (unsigned i = found.provider + 1; i < TAGGED_TABLES; i++) {
+            const uint32_t entry = tagged[i].get(found.indexes[i]);
+            const uint32_t useful = counter_update(tage_useful(entry), TAGE_USEFUL_BITS, false);
+            tagged[i].set(
+                found.indexes[i], tage_entry(tage_counter(entry), useful, tage_tag(entry)));
+        }
+    }
+}
+
+// Hashed perceptron
+// #################
+
+static constexpr uint8_t PERCEPTRON_WEIGHT_BITS = 8;
+
+static int32_t perceptron_weight(uint32_t field) {
+    return (int8_t)(uint8_t)field;
+}
+
+static uint32_t perceptron_field(int32_t weight) {
+    return (uint8_t)(int8_t)weight;
+}
+
+PredictorPerceptron::PredictorPerceptron(uint8_t number_of_bhr_bits, uint8_t number_of_bht_bits)
+    : Predictor(number_of_bht_bits, number_of_bht_bits, PredictorState::UNDEFINED, false)
+    , number_of_bhr_bits(qMin<uint8_t>(number_of_bhr_bits, BP_MAX_BHR_BITS))
+    // Training threshold of Jimenez and Lin for the history length
+    , threshold((int32_t)(1.93 * this->number_of_bhr_bits + 14)) {
+    const unsigned segments = (this->number_of_bhr_bits + SEGMENT_BITS - 1) / SEGMENT_BITS;
+    weights.reserve(segments + 1);
+    for (unsigned i = 0; i <= segments; i++) {
+        weights.emplace_back(PERCEPTRON_WEIGHT_BITS, 1U << this->number_of_bht_bits);
+    }
+    for (PackedBitTable &table : weights) {
+        add_table(&table);
+    }
+}
+
+void PredictorPerceptron::clear_tables() {
+    for (PackedBitTable &table : weights) {
+        table.fill(0);
+    }
+}
+
+// Sum of the weights selected by the instruction address and each history segment
+int32_t PredictorPerceptron::output(
+    const uint64_t bhr_value,
+    const Address instruction_address,
+    uint32_t *indexes) const {
+    const uint64_t pc = address_bits(instruction_address);
+    indexes[0] = (uint32_t)pc & bht_index_mask;
+    int32_t sum = perceptron_weight(weights[0].get(indexes[0]));
+    for (unsigned i = 1; i < weights.size(); i++) {
+        const uint8_t shift = (i - 1) * SEGMENT_BITS;
+        const uint8_t length = qMin<uint8_t>(number_of_bhr_bits - shift, SEGMENT_BITS);
+        const uint64_t segment = (bhr_value >> shift) & ((UINT64_C(1) << length) - 1);
+        indexes[i] = hash_index(pc ^ (segment << 32), i, number_of_bht_bits);
+        sum += perceptron_weight(weights[i].get(indexes[i]));
+    }
+    return sum;
+}
+
+PredictorState PredictorPerceptron::get_bht_state(uint32_t bht_index) const {
+    if (bht_index > bht_index_mask) { return PredictorState::UNDEFINED; }
+    return (perceptron_weight(weights[0].get(bht_index)) >= 0) ? PredictorState::TAKEN
+                                                               : PredictorState::NOT_TAKEN;
+}
+
+BranchResult PredictorPerceptron::predict(PredictionInput input) {
+    uint32_t indexes[MAX_WEIGHT_TABLES];
+    return (output(input.bhr_value, input.instruction_address, indexes) >= 0)
+               ? BranchResult::TAKEN
+               : BranchResult::NOT_TAKEN;
+}
+
+void PredictorPerceptron::update(PredictionFeedback feedback) {
+    uint32_t indexes[MAX_WEIGHT_TABLES];
+    const int32_t sum = output(feedback.bhr_value, feedback.instruction_address, indexes);
+    const bool taken = feedback.result == BranchResult::TAKEN;
+    const bool prediction_was_correct = (sum >= 0) == taken;
+
+    update_bht_stats(indexes[0], prediction_was_correct);
+    update_stats(prediction_was_correct);
+
+    if (prediction_was_correct && qAbs(sum) > threshold) { return; }
+    const int32_t max_weight = (1 << (PERCEPTRON_WEIGHT_BITS - 1)) - 1;
+    for (unsigned i = 0; i < weights.size(); i++) {
+        const int32_t weight = perceptron_weight(weights[i].get(indexes[i]));
+        const int32_t trained = qBound(-max_weight - 1, weight + (taken ? 1 : -1), max_weight);
+        weights[i].set(indexes[i], perceptron_field(trained));
+    }
+    notify_bht_entry(indexes[0]);
 }
 
 ///////////////////////////
@@ -557,7 +1033,8 @@ BranchPredictor::BranchPredictor(
     , number_of_btb_bits(init_number_of_btb_bits(number_of_btb_bits))
     , number_of_bhr_bits(init_number_of_bhr_bits(number_of_bhr_bits))
     , number_of_bht_addr_bits(init_number_of_bht_addr_bits(number_of_bht_addr_bits))
-    , number_of_bht_bits(init_number_of_bht_bits(number_of_bhr_bits, number_of_bht_addr_bits)) {
+    , number_of_bht_bits(
+          predictor_table_bits(predictor_type, number_of_bhr_bits, number_of_bht_addr_bits)) {
     
     // Create predicotr
     switch (predictor_type) {
@@ -585,6 +1062,22 @@ BranchPredictor::BranchPredictor(
         predictor = new PredictorSmith2BitHysteresis(number_of_bht_addr_bits, number_of_bht_bits, initial_state);
         break;
 
+    case PredictorType::GSHARE:
+        predictor = new PredictorGshare(number_of_bhr_bits, number_of_bht_bits, initial_state);
+        break;
+
+    case PredictorType::TOURNAMENT:
+        predictor = new PredictorTournament(number_of_bhr_bits, number_of_bht_bits, initial_state);
+        break;
+
+    case PredictorType::TAGE_LITE:
+        predictor = new PredictorTageLite(number_of_bhr_bits, number_of_bht_bits, initial_state);
+        break;
+
+    case PredictorType::PERCEPTRON:
+        predictor = new PredictorPerceptron(number_of_bhr_bits, number_of_bht_bits);
+        break;
+
     default: throw std::invalid_argument("Invalid predictor type selected");
     }
 
@@ -653,26 +1146,6 @@ uint8_t BranchPredictor::init_number_of_bht_addr_bits(const uint8_t b) const {
     return b;
 }
 
-uint8_t BranchPredictor::init_number_of_bht_bits(const uint8_t b_bhr, const uint8_t b_addr) const {
-    // Clamp number of BHR bits
-    uint8_t checked_number_of_bits_bhr { b_bhr };
-    if (checked_number_of_bits_bhr > BP_MAX_BHR_BITS) {
-        checked_number_of_bits_bhr = BP_MAX_BHR_BITS;
-    }
-
-    // Clamp number of address index bits
-    uint8_t checked_number_of_bits_addr { b_addr };
-    if (checked_number_of_bits_addr > BP_MAX_BHT_ADDR_BITS) {
-        checked_number_of_bits_addr = BP_MAX_BHT_ADDR_BITS;
-    }
-
-    // Check sum
-    uint8_t b_sum { (uint8_t)(checked_number_of_bits_bhr + checked_number_of_bits_addr) };
-    if (b_sum > BP_MAX_BHT_BITS) { b_sum = BP_MAX_BHT_BITS; }
-
-    return b_sum;
-}
-
 bool BranchPredictor::get_enabled() const {
     return enabled;
 }
@@ -712,21 +1185,28 @@ uint8_t BranchPredictor::get_number_of_bht_bits() const {
     return number_of_bht_bits;
 }
 
+uint8_t BranchPredictor::get_bht_view_stride_bits() const {
+    return predictor->get_bht_view_stride_bits();
+}
+
+uint32_t BranchPredictor::get_bht_view_size() const {
+    if (!enabled) { return 0; }
+    return predictor->get_bht_view_size();
+}
+
+const PredictionStatistics &BranchPredictor::get_total_stats() const {
+    return total_stats;
+}
+
 void BranchPredictor::increment_jumps() {
     total_stats.total += 1;
     total_stats.correct = total_stats.total - total_stats.wrong;
-    if (total_stats.total > 0) {
-        total_stats.accuracy = ((total_stats.correct * 100) / total_stats.total);
-    }
     emit total_stats_updated(total_stats);
 }
 
 void BranchPredictor::increment_mispredictions() {
     total_stats.wrong += 1;
     total_stats.correct = total_stats.total - total_stats.wrong;
-    if (total_stats.total > 0) {
-        total_stats.accuracy = ((total_stats.correct * 100) / total_stats.total);
-    }
     emit total_stats_updated(total_stats);
 }
 
@@ -776,6 +1256,10 @@ void BranchPredictor::update(
     const Address target_address,
     const BranchType branch_type,
     const BranchResult result) {
+    if (access_trace != nullptr) {
+        access_trace->record_branch(instruction_address, target_address, branch_type, result);
+    }
+
     // Check if predictor is enabled
     if (!enabled) { return; }
 
@@ -819,3 +1303,31 @@ void BranchPredictor::flush() {
     predictor->flush();
     emit flushed();
 }
+
+BranchPredictor::Snapshot BranchPredictor::snapshot() const {
+    return { total_stats,
+             predictor->get_stats(),
+             predictor->get_bht_stats(),
+             predictor->get_tables(),
+             bhr->get_value(),
+             btb->get_entries() };
+}
+
+void BranchPredictor::restore(const Snapshot &snapshot) {
+    total_stats = snapshot.total_stats;
+    emit total_stats_updated(total_stats);
+    predictor->restore(snapshot.predictor_stats, snapshot.bht_stats, snapshot.tables);
+    bhr->set_value(snapshot.bhr_value);
+    btb->set_entries(snapshot.btb);
+}
+
+void BranchPredictor::set_access_trace(AccessTraceWriter *trace) {
+    access_trace = trace;
+}
+
+void BranchPredictor::set_headless(bool headless) {
+    blockSignals(headless);
+    predictor->blockSignals(headless);
+    bhr->blockSignals(headless);
+    btb->blockSignals(headless);
+}
@@ -1,6 +1,7 @@
 #ifndef PREDICTOR_H
 #define PREDICTOR_H
 
+#include "access_trace.h"
 #include "common/logging.h"
 #include "instruction.h"
 #include "memory/address.h"
@@ -8,6 +9,7 @@
 
 #include <QObject>
 #include <QtMath>
+#include <vector>
 
 namespace machine {
 
@@ -23,6 +25,9 @@ QString addr_to_hex_str(const machine::Address address);
 
 bool is_predictor_type_dynamic(const PredictorType type);
 
+// Predictor keeps its table in initial state given by configuration (perceptron does not)
+bool predictor_type_has_initial_state(const PredictorType type);
+
 /////////////////////////////////
 // BranchHistoryRegister class //
 /////////////////////////////////
@@ -35,22 +40,23 @@ public: // Constructors & Destructor
 
 private: // Internal functions
     uint8_t init_number_of_bits(const uint8_t b) const;
-    uint16_t init_register_mask(const uint8_t b) const;
+    uint64_t init_register_mask(const uint8_t b) const;
 
 public: // General functions
     uint8_t get_number_of_bits() const;
-    uint16_t get_register_mask() const;
-    uint16_t get_value() const;
+    uint64_t get_register_mask() const;
+    uint64_t get_value() const;
     void update(const BranchResult result);
     void clear();
+    void set_value(const uint64_t new_value);
 
 signals:
-    void bhr_updated(uint8_t number_of_bhr_bits, uint16_t register_value);
+    void bhr_updated(uint8_t number_of_bhr_bits, uint64_t register_value);
 
 private: // Internal variables
     const uint8_t number_of_bits;
-    const uint16_t register_mask;
-    uint16_t value { 0 };
+    const uint64_t register_mask;
+    uint64_t value { 0 };
 };
 
 /////////////////////////////
@@ -79,6 +85,8 @@ public: // General functions
     BranchTargetBufferEntry get_entry(const Address instruction_address) const;
     void update(const Address instruction_address, const Address target_address, const BranchType branch_type);
     void clear();
+    const std::vector<BranchTargetBufferEntry> &get_entries() const;
+    void set_entries(const std::vector<BranchTargetBufferEntry> &entries);
 
 signals:
     void btb_row_updated(uint16_t index, BranchTargetBufferEntry btb_entry) const;
@@ -88,20 +96,54 @@ private: // Internal variables
     std::vector<BranchTargetBufferEntry> btb;
 };
 
+//////////////////////////
+// PackedBitTable class //
+//////////////////////////
+
+// Table of unsigned fields of fixed width (1 - 32 bits) packed into 64-bit words, fields do not
+// cross word boundaries. Keeps predictor tables of 2^20 entries compact.
+class PackedBitTable {
+public: // Constructors & Destructor
+    PackedBitTable(uint8_t field_bits, uint32_t size, uint32_t initial_value = 0);
+
+public: // General functions
+    uint32_t size() const { return number_of_fields; }
+    uint8_t get_field_bits() const { return field_bits; }
+    uint32_t get(uint32_t index) const {
+        const uint64_t word = words[index / fields_per_word];
+        return (uint32_t)((word >> ((index % fields_per_word) * field_bits)) & field_mask);
+    }
+    void set(uint32_t index, uint32_t value) {
+        const unsigned shift = (index % fields_per_word) * field_bits;
+        uint64_t &word = words[index / fields_per_word];
+        word = (word & ~(field_mask << shift)) | (((uint64_t)value & field_mask) << shift);
+    }
+    void fill(uint32_t value);
+    const std::vector<uint64_t> &get_words() const { return words; }
+    void set_words(const uint64_t *source); // Copies `get_words().size()` words
+
+private: // Internal variables
+    uint8_t field_bits;
+    uint32_t fields_per_word;
+    uint64_t field_mask;
+    uint32_t number_of_fields;
+    std::vector<uint64_t> words;
+};
+
 /////////////////////
 // Predictor class //
 /////////////////////
 
 struct PredictionInput {
     Instruction instruction {};
-    uint16_t bhr_value { 0 };
+    uint64_t bhr_value { 0 };
     Address instruction_address { Address::null() };
     Address target_address { Address::null() };
 };
 
 struct PredictionFeedback {
     Instruction instruction {};
-    uint16_t bhr_value { 0 };
+    uint64_t bhr_value { 0 };
     Address instruction_address { Address::null() };
     Address target_address { Address::null() };
     BranchResult result { BranchResult::UNDEFINED };
@@ -109,12 +151,17 @@ struct PredictionFeedback {
 };
 
 struct PredictionStatistics {
-    float accuracy { 0 }; // 0 - 100 %
-    uint32_t total { 0 };
-    uint32_t correct { 0 };
-    uint32_t wrong { 0 };
+    uint64_t total { 0 };
+    uint64_t correct { 0 };
+    uint64_t wrong { 0 };
+
+    // 0 - 100 %, computed on read so updates only count
+    double get_accuracy() const {
+        return (total > 0) ? (double)correct * 100.0 / (double)total : 0.0;
+    }
 };
 
+// Row of the BHT view, state of the table entry and statistics of branches which used it
 struct BranchHistoryTableEntry {
     PredictorState state { PredictorState::UNDEFINED };
     PredictionStatistics stats {}; // Per-entry statistics
@@ -127,18 +174,29 @@ public: // Constructors & Destructor
     Predictor(
         uint8_t number_of_bht_addr_bits,
         uint8_t number_of_bht_bits,
-        PredictorState initial_state);
+        PredictorState initial_state,
+        bool has_state_table = true);
     virtual ~Predictor() = default;
 
 protected: // Internal functions
     uint8_t init_number_of_bht_addr_bits(uint8_t b) const;
     uint8_t init_number_of_bht_bits(uint8_t b) const;
+    uint8_t init_view_stride_bits(uint8_t b) const;
     BranchResult convert_state_to_prediction(PredictorState state) const;
+    static PredictorState next_2bit_state(PredictorState state, BranchResult result);
     void update_stats(bool prediction_was_correct);
-    void update_bht_stats(uint16_t bht_index, bool prediction_was_correct);
-    
+    void update_bht_stats(uint32_t bht_index, bool prediction_was_correct);
+    void set_bht_state(uint32_t bht_index, PredictorState state);
+    void notify_bht_entry(uint32_t bht_index) const; // Emits row update if the entry is sampled
+    void add_table(PackedBitTable *table); // Registers additional table for snapshots
+    virtual void clear_tables() {}         // Resets additional tables on flush
+
 public: // General functions
-    uint16_t calculate_bht_index(const uint16_t bhr_value, const Address instruction_address) const;
+    // Smith predictors concatenate BHR and instruction address, others index by address only
+    virtual uint32_t calculate_bht_index(
+        const uint64_t bhr_value,
+        const Address instruction_address) const;
+    virtual PredictorState get_bht_state(uint32_t bht_index) const;
     virtual PredictorType get_type() const = 0;
     virtual BranchResult predict(PredictionInput input) = 0; // Function which handles all actions ties
                                                              // to making a branch prediction
@@ -149,18 +207,36 @@ public: // General functions
     void clear_bht_state();
     void clear();
     void flush();
+    PredictionStatistics get_stats() const;
+    // BHT view samples every 2^stride_bits-th entry, it is complete for tables up to
+    // 2^BP_MAX_BHT_VIEW_BITS entries
+    uint8_t get_bht_view_stride_bits() const;
+    uint32_t get_bht_view_size() const;
+    BranchHistoryTableEntry get_bht_row(uint32_t row) const;
+    const std::vector<PredictionStatistics> &get_bht_stats() const;
+    std::vector<uint64_t> get_tables() const; // Words of all tables
+    void restore(
+        const PredictionStatistics &new_stats,
+        const std::vector<PredictionStatistics> &new_bht_stats,
+        const std::vector<uint64_t> &new_tables);
 
 signals:
     void stats_updated(PredictionStatistics stats) const;
-    void bht_row_updated(uint16_t index, BranchHistoryTableEntry entry) const;
+    void bht_row_updated(uint32_t row, BranchHistoryTableEntry entry) const;
 
 protected: // Internal variables
     const uint8_t number_of_bht_addr_bits; // Number of Branch History Table (BHT) bits taken from
                                            // instruction address
     const uint8_t number_of_bht_bits;      // Number of Branch History Table (BHT) bits
+    const uint32_t bht_index_mask;
     const PredictorState initial_state;
     PredictionStatistics stats; // Total predictor statistics
-    std::vector<BranchHistoryTableEntry> bht; // Branch History Table (BHT)
+    PackedBitTable bht;         // Branch History Table (BHT) of `PredictorState` values
+
+private: // Internal variables
+    const uint8_t view_stride_bits;
+    std::vector<PredictionStatistics> bht_stats; // Statistics of sampled BHT entries
+    std::vector<PackedBitTable *> tables;        // All tables, BHT is the first one
 };
 
 //  Static Predictor - Always predicts not taking the branch
@@ -238,6 +314,118 @@ public: // General functions
     void update(PredictionFeedback feedback) override;
 };
 
+// Dynamic Predictor - gshare, 2 bit counters indexed by global history XOR instruction address
+class PredictorGshare final : public Predictor {
+public: // Constructors & Destructor
+    PredictorGshare(
+        uint8_t number_of_bhr_bits,
+        uint8_t number_of_bht_bits,
+        PredictorState initial_state);
+
+public: // General functions
+    PredictorType get_type() const override { return PredictorType::GSHARE; };
+    uint32_t calculate_bht_index(const uint64_t bhr_value, const Address instruction_address)
+        const override;
+    BranchResult predict(PredictionInput input) override;
+    void update(PredictionFeedback feedback) override;
+
+private: // Internal variables
+    const uint8_t number_of_bhr_bits;
+};
+
+// Dynamic Predictor - Tournament of bimodal and gshare components, 2 bit chooser counters indexed
+// by instruction address select the component. BHT holds the gshare component.
+class PredictorTournament final : public Predictor {
+public: // Constructors & Destructor
+    PredictorTournament(
+        uint8_t number_of_bhr_bits,
+        uint8_t number_of_bht_bits,
+        PredictorState initial_state);
+
+protected: // Internal functions
+    void clear_tables() override;
+
+public: // General functions
+    PredictorType get_type() const override { return PredictorType::TOURNAMENT; };
+    uint32_t calculate_bht_index(const uint64_t bhr_value, const Address instruction_address)
+        const override;
+    BranchResult predict(PredictionInput input) override;
+    void update(PredictionFeedback feedback) override;
+
+private: // Internal variables
+    const uint8_t number_of_bhr_bits;
+    PackedBitTable bimodal; // 2 bit counters indexed by instruction address
+    PackedBitTable chooser; // 2 bit counters, upper half selects gshare
+};
+
+// Dynamic Predictor - TAGE-lite, BHT is the bimodal base predictor, tagged tables with history
+// lengths of 1/8, 1/4, 1/2 and all BHR bits override it on a tag match
+class PredictorTageLite final : public Predictor {
+public: // Constructors & Destructor
+    PredictorTageLite(
+        uint8_t number_of_bhr_bits,
+        uint8_t number_of_bht_bits,
+        PredictorState initial_state);
+
+    static constexpr unsigned TAGGED_TABLES = 4;
+    static constexpr uint8_t TAG_BITS = 8;
+
+private: // Internal functions
+    struct Lookup {
+        uint32_t indexes[TAGGED_TABLES];
+        uint32_t tags[TAGGED_TABLES];
+        int provider;  // Longest matching table, -1 for base predictor
+        int alternate; // Next matching table, -1 for base predictor
+        BranchResult provider_prediction;
+        BranchResult alternate_prediction;
+    };
+    Lookup lookup(const uint64_t bhr_value, const Address instruction_address) const;
+
+protected: // Internal functions
+    void clear_tables() override;
+
+public: // General functions
+    PredictorType get_type() const override { return PredictorType::TAGE_LITE; };
+    BranchResult predict(PredictionInput input) override;
+    void update(PredictionFeedback feedback) override;
+
+private: // Internal variables
+    const uint8_t tagged_table_bits;
+    uint8_t history_lengths[TAGGED_TABLES];
+    // Entries hold 3 bit counter, 2 bit usefulness and tag
+    std::vector<PackedBitTable> tagged;
+};
+
+// Dynamic Predictor - Hashed perceptron, signed 8 bit weights of the instruction address (bias)
+// and of each 8 bits of history are summed, BHT states show the sign of the bias weights
+class PredictorPerceptron final : public Predictor {
+public: // Constructors & Destructor
+    PredictorPerceptron(uint8_t number_of_bhr_bits, uint8_t number_of_bht_bits);
+
+    static constexpr uint8_t SEGMENT_BITS = 8;
+    static constexpr unsigned MAX_WEIGHT_TABLES = BP_MAX_BHR_BITS / SEGMENT_BITS + 1;
+
+private: // Internal functions
+    int32_t output(
+        const uint64_t bhr_value,
+        const Address instruction_address,
+        uint32_t *indexes) const;
+
+protected: // Internal functions
+    void clear_tables() override;
+
+public: // General functions
+    PredictorType get_type() const override { return PredictorType::PERCEPTRON; };
+    PredictorState get_bht_state(uint32_t bht_index) const override;
+    BranchResult predict(PredictionInput input) override;
+    void update(PredictionFeedback feedback) override;
+
+private: // Internal variables
+    const uint8_t number_of_bhr_bits;
+    const int32_t threshold; // Correct predictions with smaller output still train
+    std::vector<PackedBitTable> weights; // Bias weights first, then one table per history segment
+};
+
 ///////////////////////////
 // BranchPredictor class //
 ///////////////////////////
@@ -259,8 +447,7 @@ private: // Internal functions
     uint8_t init_number_of_btb_bits(const uint8_t b) const;
     uint8_t init_number_of_bhr_bits(const uint8_t b) const;
     uint8_t init_number_of_bht_addr_bits(const uint8_t b) const;
-    uint8_t init_number_of_bht_bits(const uint8_t b_bhr, const uint8_t b_addr) const;
-    
+
 
 public: // General functions
     bool get_enabled() const;
@@ -271,6 +458,9 @@ public: // General functions
     uint8_t get_number_of_bhr_bits() const;
     uint8_t get_number_of_bht_addr_bits() const;
     uint8_t get_number_of_bht_bits() const;
+    uint8_t get_bht_view_stride_bits() const;
+    uint32_t get_bht_view_size() const;
+    const PredictionStatistics &get_total_stats() const;
     void increment_jumps();
     void increment_mispredictions();
     Address predict_next_pc_address(const Instruction instruction, const Address instruction_address) const;
@@ -282,20 +472,36 @@ public: // General functions
         const BranchResult result);
     void clear();
     void flush();
+    void set_headless(bool headless); // Suppress all observer signals of predictor and its parts
+    // Records outcomes of all updated branches (also when disabled), null stops the recording
+    void set_access_trace(AccessTraceWriter *trace);
+
+    // Complete state of the predictor and its parts, see `Machine::snapshot`
+    struct Snapshot {
+        PredictionStatistics total_stats {};
+        PredictionStatistics predictor_stats {};
+        std::vector<PredictionStatistics> bht_stats {};
+        std::vector<uint64_t> tables {};
+        uint64_t bhr_value { 0 };
+        std::vector<BranchTargetBufferEntry> btb {};
+    };
+    Snapshot snapshot() const;
+    void restore(const Snapshot &snapshot); // Snapshot has to come from predictor with same config
 
 signals:
     void total_stats_updated(PredictionStatistics total_stats);
-    void prediction_done(uint16_t btb_index, uint16_t bht_index, PredictionInput input, BranchResult result, BranchType branch_type) const;
-    void update_done(uint16_t btb_index, uint16_t bht_index, PredictionFeedback feedback) const;
+    void prediction_done(uint16_t btb_index, uint32_t bht_index, PredictionInput input, BranchResult result, BranchType branch_type) const;
+    void update_done(uint16_t btb_index, uint32_t bht_index, PredictionFeedback feedback) const;
     void predictor_stats_updated(PredictionStatistics stats) const;
-    void predictor_bht_row_updated(uint16_t index, BranchHistoryTableEntry entry) const;
-    void bhr_updated(uint8_t number_of_bhr_bits, uint16_t register_value) const;
+    void predictor_bht_row_updated(uint32_t row, BranchHistoryTableEntry entry) const;
+    void bhr_updated(uint8_t number_of_bhr_bits, uint64_t register_value) const;
     void btb_row_updated(uint16_t index, BranchTargetBufferEntry btb_entry) const;
     void cleared() const; // All infomration was reset
     void flushed() const; // Only BHT state and BTB rows were reset
 
 private: // Internal variables
     bool enabled{ false };
+    AccessTraceWriter *access_trace{ nullptr };
     PredictionStatistics total_stats;
     Predictor *predictor;
     BranchHistoryRegister *bhr;
@@ -306,7 +512,7 @@ private: // Internal variables
     const uint8_t number_of_bhr_bits; // Number of bits in Branch History Register
     const uint8_t number_of_bht_addr_bits; // Number of bits in Branch History Table which are taken
                                            // from instruction address
-    const uint8_t number_of_bht_bits;      // = number_of_bhr_bits + number_of_bht_addr_bits
+    const uint8_t number_of_bht_bits;      // See `predictor_table_bits`
 };
 
 } // namespace machine
@@ -0,0 +1,140 @@
+#include "predictor.test.h"
+
+#include "machine/predictor.h"
+
+#include <vector>
+
+using namespace machine;
+
+Q_DECLARE_METATYPE(std::vector<bool>)
+
+static BranchPredictor *make_predictor(
+    PredictorType type,
+    uint8_t number_of_bhr_bits,
+    uint8_t number_of_bht_addr_bits) {
+    const PredictorState initial_state = predictor_type_has_initial_state(type)
+                                             ? PredictorState::WEAKLY_NOT_TAKEN
+                                             : PredictorState::NOT_TAKEN;
+    auto *predictor = new BranchPredictor(
+        true, type, initial_state, 4, number_of_bhr_bits, number_of_bht_addr_bits);
+    predictor->set_headless(true);
+    return predictor;
+}
+
+// Repeats outcomes of a single backward branch
+static void run_pattern(
+    BranchPredictor &predictor,
+    const std::vector<bool> &pattern,
+    unsigned first,
+    unsigned count) {
+    for (unsigned i = first; i < first + count; i++) {
+        const bool taken = pattern[i % pattern.size()];
+        predictor.update(
+            Instruction(), 0x200_addr, 0x100_addr, BranchType::BRANCH,
+            taken ? BranchResult::TAKEN : BranchResult::NOT_TAKEN);
+    }
+}
+
+void TestPredictor::packed_bit_table() {
+    PackedBitTable table(3, 1000, 5);
+    // 21 fields fit into a word, the last bit of each word stays unused
+    QCOMPARE(table.get_words().size(), size_t(48));
+    QCOMPARE(table.get(999), 5U);
+
+    for (uint32_t i = 0; i < table.size(); i++) {
+        table.set(i, i % 8);
+    }
+    for (uint32_t i = 0; i < table.size(); i++) {
+        QCOMPARE(table.get(i), i % 8);
+    }
+    table.set(20, 0xff); // Truncated to the field, neighbours are kept
+    QCOMPARE(table.get(19), 3U);
+    QCOMPARE(table.get(20), 7U);
+    QCOMPARE(table.get(21), 5U);
+
+    PackedBitTable copy(3, 1000);
+    copy.set_words(table.get_words().data());
+    for (uint32_t i = 0; i < copy.size(); i++) {
+        QCOMPARE(copy.get(i), table.get(i));
+    }
+    copy.fill(2);
+    QCOMPARE(copy.get(0), 2U);
+    QCOMPARE(copy.get(999), 2U);
+}
+
+void TestPredictor::predictor_learns_history_data() {
+    QTest::addColumn<PredictorType>("type");
+    QTest::addColumn<std::vector<bool>>("pattern");
+
+    const std::vector<bool> period_3 { true, true, false };
+    const std::vector<bool> loop_7 { true, true, true, true, true, true, false };
+    const struct {
+        const char *name;
+        PredictorType type;
+    } types[] = {
+        { "gshare", PredictorType::GSHARE },
+        { "tournament", PredictorType::TOURNAMENT },
+        { "tage", PredictorType::TAGE_LITE },
+        { "perceptron", PredictorType::PERCEPTRON },
+    };
+    for (const auto &t : types) {
+        QTest::newRow(qPrintable(QString(t.name) + " period 3")) << t.type << period_3;
+        QTest::newRow(qPrintable(QString(t.name) + " loop 7")) << t.type << loop_7;
+    }
+}
+
+void TestPredictor::predictor_learns_history() {
+    QFETCH(PredictorType, type);
+    QFETCH(std::vector<bool>, pattern);
+
+    QScopedPointer<BranchPredictor> predictor(make_predictor(type, 8, 10));
+    QCOMPARE(predictor->get_predictor_type(), type);
+    run_pattern(*predictor, pattern, 0, 200);
+    const PredictionStatistics warm = predictor->snapshot().predictor_stats;
+    run_pattern(*predictor, pattern, 200, 600);
+    const PredictionStatistics stats = predictor->snapshot().predictor_stats;
+
+    QCOMPARE(stats.total - warm.total, uint64_t(600));
+    QCOMPARE(stats.correct - warm.correct, uint64_t(600));
+    QVERIFY(stats.get_accuracy() > warm.get_accuracy());
+}
+
+void TestPredictor::predictor_sampled_view() {
+    QScopedPointer<BranchPredictor> small(make_predictor(PredictorType::SMITH_2_BIT, 2, 3));
+    QCOMPARE(small->get_number_of_bht_bits(), uint8_t(5));
+    QCOMPARE(small->get_bht_view_stride_bits(), uint8_t(0));
+    QCOMPARE(small->get_bht_view_size(), 32U);
+
+    QScopedPointer<BranchPredictor> large(make_predictor(PredictorType::GSHARE, 64, 24));
+    QCOMPARE(large->get_number_of_bhr_bits(), uint8_t(BP_MAX_BHR_BITS));
+    QCOMPARE(large->get_number_of_bht_bits(), uint8_t(BP_MAX_BHT_BITS));
+    QCOMPARE(large->get_bht_view_stride_bits(), uint8_t(BP_MAX_BHT_BITS - BP_MAX_BHT_VIEW_BITS));
+    QCOMPARE(large->get_bht_view_size(), 1U << BP_MAX_BHT_VIEW_BITS);
+    QCOMPARE(large->snapshot().bht_stats.size(), size_t(1) << BP_MAX_BHT_VIEW_BITS);
+
+    // Smith predictors concatenate history and address bits up to the table limit
+    QCOMPARE(predictor_table_bits(PredictorType::SMITH_1_BIT, 12, 12), uint8_t(BP_MAX_BHT_BITS));
+    QCOMPARE(predictor_table_bits(PredictorType::TAGE_LITE, 12, 12), uint8_t(12));
+}
+
+void TestPredictor::predictor_snapshot_restore() {
+    const std::vector<bool> pattern { true, false, true, true, false, false, true };
+    QScopedPointer<BranchPredictor> original(make_predictor(PredictorType::TAGE_LITE, 16, 12));
+    run_pattern(*original, pattern, 0, 100);
+    const BranchPredictor::Snapshot saved = original->snapshot();
+
+    QScopedPointer<BranchPredictor> restored(make_predictor(PredictorType::TAGE_LITE, 16, 12));
+    restored->restore(saved);
+    run_pattern(*original, pattern, 100, 100);
+    run_pattern(*restored, pattern, 100, 100);
+
+    const BranchPredictor::Snapshot expected = original->snapshot();
+    const BranchPredictor::Snapshot actual = restored->snapshot();
+    QCOMPARE(actual.bhr_value, expected.bhr_value);
+    QCOMPARE(actual.predictor_stats.correct, expected.predictor_stats.correct);
+    QCOMPARE(actual.predictor_stats.total, expected.predictor_stats.total);
+    QVERIFY(actual.tables == expected.tables);
+    QCOMPARE(actual.bht_stats.size(), expected.bht_stats.size());
+}
+
+QTEST_APPLESS_MAIN(TestPredictor)
@@ -0,0 +1,16 @@
+#ifndef PREDICTOR_TEST_H
+#define PREDICTOR_TEST_H
+
+#include <QtTest>
+
+class TestPredictor : public QObject {
+    Q_OBJECT
+private slots:
+    static void packed_bit_table();
+    static void predictor_learns_history_data();
+    static void predictor_learns_history();
+    static void predictor_sampled_view();
+    static void predictor_snapshot_restore();
+};
+
+#endif // PREDICTOR_TEST_H
@@ -1,14 +1,21 @@
 #ifndef PREDICTOR_TYPES_H
 #define PREDICTOR_TYPES_H
 
+#include <algorithm>
+#include <cstdint>
+
 namespace machine {
 Q_NAMESPACE
 
-// Should not exceed 16, because uint16_t is used for addressing
+// BTB should not exceed 16, because uint16_t is used for its addressing
 #define BP_MAX_BTB_BITS 8
-#define BP_MAX_BHR_BITS 8
-#define BP_MAX_BHT_ADDR_BITS 8
-#define BP_MAX_BHT_BITS (BP_MAX_BHT_ADDR_BITS + BP_MAX_BHT_ADDR_BITS)
+// History is kept in uint64_t
+#define BP_MAX_BHR_BITS 64
+// Predictor tables are addressed by uint32_t and stored packed, 2^20 entries at most
+#define BP_MAX_BHT_ADDR_BITS 20
+#define BP_MAX_BHT_BITS 20
+// Larger tables are shown sampled, every 2^(bits - BP_MAX_BHT_VIEW_BITS)-th entry
+#define BP_MAX_BHT_VIEW_BITS 16
 
 enum class BranchType {
     JUMP, // JAL, JALR - Unconditional
@@ -31,6 +38,10 @@ enum class PredictorType {
     SMITH_1_BIT,
     SMITH_2_BIT,
     SMITH_2_BIT_HYSTERESIS,
+    GSHARE,     // Global history XOR address
+    TOURNAMENT, // Bimodal and gshare with chooser
+    TAGE_LITE,  // Bimodal base with tagged tables of geometric history lengths
+    PERCEPTRON, // Hashed perceptron
     UNDEFINED
 };
 Q_ENUM_NS(machine::PredictorType)
@@ -46,6 +57,25 @@ enum class PredictorState {
 };
 Q_ENUM_NS(machine::PredictorState)
 
+// Number of table index bits, Smith predictors concatenate BHR and address bits, other dynamic
+// predictors hash the history into the table addressed by the address bits
+inline uint8_t predictor_table_bits(
+    const PredictorType type,
+    const uint8_t number_of_bhr_bits,
+    const uint8_t number_of_bht_addr_bits) {
+    const unsigned addr_bits = std::min<unsigned>(number_of_bht_addr_bits, BP_MAX_BHT_ADDR_BITS);
+    switch (type) {
+    case PredictorType::GSHARE:
+    case PredictorType::TOURNAMENT:
+    case PredictorType::TAGE_LITE:
+    case PredictorType::PERCEPTRON: return std::min<unsigned>(addr_bits, BP_MAX_BHT_BITS);
+    default: {
+        const unsigned bhr_bits = std::min<unsigned>(number_of_bhr_bits, BP_MAX_BHR_BITS);
+        return std::min<unsigned>(bhr_bits + addr_bits, BP_MAX_BHT_BITS);
+    }
+    }
+}
+
 } // namespace machine
 
 #endif // PREDICTOR_TYPES_H
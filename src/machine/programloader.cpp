@@ -17,10 +17,16 @@ LOG_CATEGORY("machine.ProgramLoader");
 
 using namespace machine;
 
+/** Initializes the elf library once, its global state is not safe to modify from more threads. */
+static bool init_elf_library() {
+    static const bool initialized = elf_version(EV_CURRENT) != EV_NONE;
+    return initialized;
+}
+
 ProgramLoader::ProgramLoader(const QString &file) : elf_file(file) {
     const GElf_Ehdr *elf_ehdr;
     // Initialize elf library
-    if (elf_version(EV_CURRENT) == EV_NONE) {
+    if (!init_elf_library()) {
         throw SIMULATOR_EXCEPTION(
             Input, "Elf library initialization failed", elf_errmsg(-1));
     }
@@ -173,8 +179,6 @@ SymbolTable *ProgramLoader::get_symbol_table() {
     Elf_Data *data;
     int count, ii;
 
-    elf_version(EV_CURRENT);
-
     while (true) {
         if ((scn = elf_nextscn(this->elf, scn)) == nullptr) {
             return p_st;
@@ -219,3 +223,19 @@ Endian ProgramLoader::get_endian() const {
 ArchitectureType ProgramLoader::get_architecture_type() const {
     return architecture_type;
 }
+
+LoadedProgram::LoadedProgram(ProgramLoader &loader, MemoryLayout layout)
+    : memory(new Memory(loader.get_endian(), layout))
+    , endian(loader.get_endian())
+    , architecture_type(loader.get_architecture_type())
+    , executable_entry(loader.get_executable_entry())
+    , end(loader.end()) {
+    loader.to_memory(memory.get());
+}
+
+LoadedProgram::LoadedProgram(const LoadedProgram &other)
+    : memory(new Memory(*other.memory))
+    , endian(other.endian)
+    , architecture_type(other.architecture_type)
+    , executable_entry(other.executable_entry)
+    , end(other.end) {}
@@ -8,6 +8,7 @@
 #include <QFile>
 #include <cstdint>
 #include <gelf.h>
+#include <memory>
 #include <qstring.h>
 #include <qvector.h>
 
@@ -52,6 +53,28 @@ private:
     Address executable_entry;
 };
 
+/**
+ * Executable loaded to memory, ready to be used by machines.
+ *
+ * The ELF file is read and parsed once and any number of machines can be created from the
+ * image (see `Machine(MachineConfig, const LoadedProgram &)`), e.g. to simulate the same
+ * program with different configurations. Machines copy the memory, with paged memory layout
+ * the pages are shared copy-on-write. The image is not modified by the machines and copies
+ * can be created from more threads at once.
+ */
+struct LoadedProgram {
+    LoadedProgram(ProgramLoader &loader, MemoryLayout layout);
+    LoadedProgram(const LoadedProgram &other);
+    LoadedProgram(LoadedProgram &&) = default;
+
+    std::unique_ptr<Memory> memory;
+    Endian endian;
+    ArchitectureType architecture_type;
+    Address executable_entry;
+    /** See `ProgramLoader::end`. */
+    Address end;
+};
+
 } // namespace machine
 
 #endif // PROGRAM_H
@@ -5,6 +5,7 @@
 
 #include <QMetaType>
 #include <array>
+#include <memory>
 
 namespace machine {
 
@@ -127,10 +128,12 @@ public:
     constexpr inline VectorRegisterValue(const VectorRegisterValue &other) = default;
     constexpr inline VectorRegisterValue &operator=(const VectorRegisterValue &other) = default;
 
-    inline vector_register_storage_t as_vec() {
+    inline vector_register_storage_t as_vec() const {
         return data;
     }
 
+    inline const vector_register_storage_t &storage() const { return data; }
+
     inline bool operator==(const VectorRegisterValue &other) const {
         return data == other.data;
     }
@@ -157,40 +160,89 @@ private:
     vector_register_storage_t data;
 };
 
+/**
+ * Shared immutable vector payload of a transient value (interstage registers, ALU and memory
+ * results).
+ *
+ * Payload is reference counted, it lives as long as any copy of the value refers to it, so copies
+ * of the pipeline (snapshots, state published to other threads) are self-contained. Copying a
+ * reference costs no payload copy, references to scalar values hold no payload at all and read
+ * as zero vector. Architectural vector registers are kept in `Registers`.
+ *
+ * Provides the read only subset of `VectorRegisterValue` interface, so the vector operands can
+ * be used the same way as if they were stored inline.
+ */
+class VectorValueRef {
+public:
+    VectorValueRef() = default;
+    explicit VectorValueRef(const vector_register_storage_t &value)
+        : payload(std::make_shared<const vector_register_storage_t>(value)) {}
+
+    inline const vector_register_storage_t &storage() const {
+        static const vector_register_storage_t zero {};
+        return payload ? *payload : zero;
+    }
+    inline vector_register_storage_t as_vec() const { return storage(); }
+    inline const uint32_t &operator[](size_t i) const { return storage()[i]; }
+    // NOLINTNEXTLINE(google-explicit-constructor)
+    inline operator VectorRegisterValue() const { return VectorRegisterValue(storage()); }
+
+    inline bool operator==(const VectorValueRef &other) const {
+        return payload == other.payload || storage() == other.storage();
+    }
+    inline bool operator!=(const VectorValueRef &other) const { return !(other == *this); }
+
+private:
+    std::shared_ptr<const vector_register_storage_t> payload;
+};
+
 enum RegisterValueType {
     REGISTER_VALUE_TYPE_I,
     REGISTER_VALUE_TYPE_V
 };
+
+/**
+ * Scalar or vector value passed between pipeline stages.
+ *
+ * Only the scalar value is stored inline, vector payload is referenced (see `VectorValueRef`).
+ * This keeps interstage registers small, they are copied several times every step. Member `v` is
+ * empty unless the type is `REGISTER_VALUE_TYPE_V`.
+ */
 struct RegisterValueUnion {
     RegisterValueType type;
-    union {
-        RegisterValue i;
-        VectorRegisterValue v;
-    };
+    RegisterValue i;
+    VectorValueRef v;
+
     RegisterValueUnion() : type(REGISTER_VALUE_TYPE_I), i() {}
     RegisterValueUnion(RegisterValue value) : type(REGISTER_VALUE_TYPE_I), i(value) {}
     RegisterValueUnion(register_storage_t value) : type(REGISTER_VALUE_TYPE_I), i(RegisterValue(value)) {}
-    RegisterValueUnion(VectorRegisterValue value) : type(REGISTER_VALUE_TYPE_V), v(value) {}
-    RegisterValueUnion(vector_register_storage_t value) : type(REGISTER_VALUE_TYPE_V), v(VectorRegisterValue(value)) {}
+    RegisterValueUnion(VectorRegisterValue value)
+        : type(REGISTER_VALUE_TYPE_V)
+        , v(value.storage()) {}
+    RegisterValueUnion(vector_register_storage_t value) : type(REGISTER_VALUE_TYPE_V), v(value) {}
 
-    RegisterValueUnion operator=(RegisterValue value) {
+    RegisterValueUnion &operator=(RegisterValue value) {
         type = REGISTER_VALUE_TYPE_I;
         i = value;
+        v = {};
         return *this;
     }
-    RegisterValueUnion operator=(register_storage_t value) {
+    RegisterValueUnion &operator=(register_storage_t value) {
         type = REGISTER_VALUE_TYPE_I;
         i = RegisterValue(value);
+        v = {};
         return *this;
     }
-    RegisterValueUnion operator=(VectorRegisterValue value) {
+    RegisterValueUnion &operator=(VectorRegisterValue value) {
         type = REGISTER_VALUE_TYPE_V;
-        v = value;
+        i = RegisterValue();
+        v = VectorValueRef(value.storage());
         return *this;
     }
-    RegisterValueUnion operator=(vector_register_storage_t value) {
+    RegisterValueUnion &operator=(vector_register_storage_t value) {
         type = REGISTER_VALUE_TYPE_V;
-        v = VectorRegisterValue(value);
+        i = RegisterValue();
+        v = VectorValueRef(value);
         return *this;
     }
 
@@ -101,3 +101,16 @@ void Registers::reset() {
     write_gp(2_reg, SP_INIT.get_raw()); // initialize to safe RAM area -
                                          // corresponds to Linux
 }
+
+Registers::Snapshot Registers::snapshot() const {
+    return { this->gp, this->vr, this->pc, this->vl };
+}
+
+void Registers::restore(const Snapshot &snapshot) {
+    write_pc(snapshot.pc);
+    for (int i = 1; i < 32; i++) {
+        write_gp(i, snapshot.gp[i]);
+        write_vr(i, snapshot.vr[i]);
+    }
+    write_vl(snapshot.vl);
+}
@@ -76,6 +76,16 @@ public:
 
     void reset(); // Reset all values to zero (except pc)
 
+    /** Complete content of the register file, see `Machine::snapshot`. */
+    struct Snapshot {
+        std::array<RegisterValue, REGISTER_COUNT> gp {};
+        std::array<VectorRegisterValue, REGISTER_COUNT> vr {};
+        Address pc {};
+        uint8_t vl = 0;
+    };
+    [[nodiscard]] Snapshot snapshot() const;
+    void restore(const Snapshot &snapshot); // Emits update signals for all registers
+
 signals:
     void pc_update(Address val);
     void gp_update(RegisterId reg, RegisterValue val);
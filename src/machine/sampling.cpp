@@ -0,0 +1,78 @@
+#include "sampling.h"
+
+#include <cmath>
+
+using namespace machine;
+
+SampleCounters SampleCounters::since(const SampleCounters &start) const {
+    return {
+        instructions - start.instructions,       cycles - start.cycles,
+        stalls - start.stalls,                   program_accesses - start.program_accesses,
+        program_misses - start.program_misses,   data_accesses - start.data_accesses,
+        data_misses - start.data_misses,
+    };
+}
+
+SampleCounters &SampleCounters::operator+=(const SampleCounters &other) {
+    instructions += other.instructions;
+    cycles += other.cycles;
+    stalls += other.stalls;
+    program_accesses += other.program_accesses;
+    program_misses += other.program_misses;
+    data_accesses += other.data_accesses;
+    data_misses += other.data_misses;
+    return *this;
+}
+
+void SamplingStatistics::add_window(const SampleCounters &window) {
+    windows++;
+    total += window;
+    cpi.add(window.cycles, window.instructions);
+    spi.add(window.stalls, window.instructions);
+    program_miss.add(window.program_misses, window.program_accesses);
+    data_miss.add(window.data_misses, window.data_accesses);
+}
+
+void SamplingStatistics::reset() {
+    *this = {};
+}
+
+SampleEstimate SamplingStatistics::cycles_per_instruction(double z) const {
+    return cpi.estimate(z);
+}
+
+SampleEstimate SamplingStatistics::stalls_per_instruction(double z) const {
+    return spi.estimate(z);
+}
+
+SampleEstimate SamplingStatistics::program_miss_rate(double z) const {
+    return program_miss.estimate(z);
+}
+
+SampleEstimate SamplingStatistics::data_miss_rate(double z) const {
+    return data_miss.estimate(z);
+}
+
+SampleEstimate SamplingStatistics::extrapolate_cycles(uint64_t instructions, double z) const {
+    const SampleEstimate per_instruction = cpi.estimate(z);
+    return { per_instruction.mean * (double)instructions,
+             per_instruction.confidence * (double)instructions };
+}
+
+void SamplingStatistics::Accumulator::add(uint64_t numerator, uint64_t denominator) {
+    // Windows without any event (e.g. no data access) carry no information about the ratio.
+    if (denominator == 0) { return; }
+    const double value = (double)numerator / (double)denominator;
+    count++;
+    sum += value;
+    sum_squares += value * value;
+}
+
+SampleEstimate SamplingStatistics::Accumulator::estimate(double z) const {
+    if (count == 0) { return {}; }
+    const double mean = sum / (double)count;
+    if (count < 2) { return { mean, 0 }; }
+    const double variance
+        = std::fmax(0.0, (sum_squares - (double)count * mean * mean) / (double)(count - 1));
+    return { mean, z * std::sqrt(variance / (double)count) };
+}
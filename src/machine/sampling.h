@@ -0,0 +1,101 @@
+#ifndef SAMPLING_H
+#define SAMPLING_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace machine {
+
+/**
+ * Parameters of sampled simulation (see `Machine::set_sampling`).
+ *
+ * Execution is divided into sampling units of `period` retired instructions. The beginning of
+ * each unit is fast-forwarded by a functional core, which keeps caches and the branch predictor
+ * warm but has no pipeline. The last `warmup + window` instructions of the unit run on the
+ * detailed core of the machine. The first `warmup` of them fill the pipeline, only the following
+ * `window` instructions are measured.
+ */
+struct SamplingConfig {
+    /** Instructions of a sampling unit, 0 disables sampling. */
+    uint64_t period = 0;
+    uint64_t warmup = 0;
+    uint64_t window = 0;
+
+    [[nodiscard]] bool enabled() const { return period != 0; }
+    /** Window has to be non empty and fit in the period with the warm-up. */
+    [[nodiscard]] bool valid() const {
+        return !enabled() || (window > 0 && warmup + window <= period);
+    }
+};
+
+/** Counters of the detailed core and caches, absolute or measured over one window. */
+struct SampleCounters {
+    uint64_t instructions = 0;
+    uint64_t cycles = 0;
+    uint64_t stalls = 0;
+    uint64_t program_accesses = 0;
+    uint64_t program_misses = 0;
+    uint64_t data_accesses = 0;
+    uint64_t data_misses = 0;
+
+    /** Counters accumulated since `start`. */
+    [[nodiscard]] SampleCounters since(const SampleCounters &start) const;
+    SampleCounters &operator+=(const SampleCounters &other);
+};
+
+/** Estimate of the mean of a per window ratio. */
+struct SampleEstimate {
+    double mean = 0;
+    /** Half width of the confidence interval of the mean, 0 for less than two windows. */
+    double confidence = 0;
+};
+
+/**
+ * Statistics of measured windows of a sampled simulation.
+ *
+ * Ratios (cycles per instruction, miss rates) are estimated as means of per window values with
+ * confidence intervals based on their sample standard deviation. Whole program values are
+ * extrapolated by scaling the mean per instruction ratio by the count of all retired
+ * instructions.
+ */
+class SamplingStatistics {
+public:
+    /** Normal distribution quantile of the reported 95% confidence intervals. */
+    static constexpr double Z_95 = 1.96;
+
+    void add_window(const SampleCounters &window);
+    void reset();
+
+    [[nodiscard]] size_t window_count() const { return windows; }
+    /** Sum of all measured windows. */
+    [[nodiscard]] const SampleCounters &measured() const { return total; }
+
+    [[nodiscard]] SampleEstimate cycles_per_instruction(double z = Z_95) const;
+    [[nodiscard]] SampleEstimate stalls_per_instruction(double z = Z_95) const;
+    [[nodiscard]] SampleEstimate program_miss_rate(double z = Z_95) const;
+    [[nodiscard]] SampleEstimate data_miss_rate(double z = Z_95) const;
+    /** Cycles of the whole run of `instructions` retired instructions. */
+    [[nodiscard]] SampleEstimate extrapolate_cycles(uint64_t instructions, double z = Z_95) const;
+
+private:
+    /** Sums of a ratio over windows. */
+    struct Accumulator {
+        size_t count = 0;
+        double sum = 0;
+        double sum_squares = 0;
+
+        void add(uint64_t numerator, uint64_t denominator);
+        [[nodiscard]] SampleEstimate estimate(double z) const;
+    };
+
+    size_t windows = 0;
+    SampleCounters total {};
+    Accumulator cpi {};
+    Accumulator spi {};
+    Accumulator program_miss {};
+    Accumulator data_miss {};
+};
+
+} // namespace machine
+
+#endif // SAMPLING_H
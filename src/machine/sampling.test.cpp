@@ -0,0 +1,63 @@
+#include "sampling.test.h"
+
+#include "machine/sampling.h"
+
+#include <cmath>
+
+using namespace machine;
+
+static SampleCounters window(uint64_t instructions, uint64_t cycles, uint64_t data_misses) {
+    SampleCounters counters;
+    counters.instructions = instructions;
+    counters.cycles = cycles;
+    counters.data_accesses = 100;
+    counters.data_misses = data_misses;
+    return counters;
+}
+
+void TestSampling::sampling_estimates() {
+    SamplingStatistics stats;
+    // CPI of the windows is 1, 2 and 3, data miss rates 0.1, 0.2 and 0.3.
+    stats.add_window(window(100, 100, 10));
+    stats.add_window(window(100, 200, 20));
+    stats.add_window(window(100, 300, 30));
+
+    QCOMPARE(stats.window_count(), size_t(3));
+    QCOMPARE(stats.measured().instructions, uint64_t(300));
+    QCOMPARE(stats.measured().cycles, uint64_t(600));
+
+    // Sample standard deviation is 1, half width is z * 1 / sqrt(3).
+    const SampleEstimate cpi = stats.cycles_per_instruction(2.0);
+    QCOMPARE(cpi.mean, 2.0);
+    QVERIFY(qAbs(cpi.confidence - 2.0 / std::sqrt(3.0)) < 1e-9);
+
+    const SampleEstimate miss_rate = stats.data_miss_rate(2.0);
+    QVERIFY(qAbs(miss_rate.mean - 0.2) < 1e-9);
+    QVERIFY(qAbs(miss_rate.confidence - 0.2 / std::sqrt(3.0)) < 1e-9);
+    // Windows without program accesses do not contribute to the program miss rate.
+    QCOMPARE(stats.program_miss_rate().mean, 0.0);
+
+    const SampleEstimate cycles = stats.extrapolate_cycles(1000000, 2.0);
+    QCOMPARE(cycles.mean, 2000000.0);
+    QVERIFY(qAbs(cycles.confidence - 2000000.0 / std::sqrt(3.0)) < 1e-3);
+
+    stats.reset();
+    QCOMPARE(stats.window_count(), size_t(0));
+    QCOMPARE(stats.cycles_per_instruction().mean, 0.0);
+}
+
+void TestSampling::sampling_single_window() {
+    SamplingStatistics stats;
+    stats.add_window(window(200, 300, 0));
+    QCOMPARE(stats.cycles_per_instruction().mean, 1.5);
+    QCOMPARE(stats.cycles_per_instruction().confidence, 0.0);
+}
+
+void TestSampling::sampling_config_valid() {
+    QVERIFY(SamplingConfig {}.valid());
+    QVERIFY((SamplingConfig { 1000, 100, 900 }.valid()));
+    QVERIFY(!(SamplingConfig { 1000, 200, 900 }.valid()));
+    QVERIFY(!(SamplingConfig { 1000, 100, 0 }.valid()));
+}
+
+QTEST_APPLESS_MAIN(TestSampling)
@@ -0,0 +1,14 @@
+#ifndef SAMPLING_TEST_H
+#define SAMPLING_TEST_H
+
+#include <QtTest>
+
+class TestSampling : public QObject {
+    Q_OBJECT
+private slots:
+    static void sampling_estimates();
+    static void sampling_single_window();
+    static void sampling_config_valid();
+};
+
+#endif // SAMPLING_TEST_H
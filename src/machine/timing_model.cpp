@@ -0,0 +1,200 @@
+#include "timing_model.h"
+
+#include "simulator_exception.h"
+
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <cmath>
+#include <limits>
+
+using namespace machine;
+
+/** Mnemonics with own cost, keeps the slots of the compiled table within 16 bits. */
+static constexpr int MAX_MNEMONIC_COSTS = 1024;
+
+static InstructionClass parse_class(const QJsonValue &value) {
+    const QString name = value.toString();
+    for (size_t i = 0; i < IC_COUNT; i++) {
+        if (name == INSTRUCTION_CLASS_NAMES[i]) { return static_cast<InstructionClass>(i); }
+    }
+    throw SIMULATOR_EXCEPTION(Input, "Unknown instruction class in timing model", name);
+}
+
+/** Reads optional integer item, JSON numbers are doubles (Qt 5.9 has no integer accessor). */
+static int32_t parse_int(const QJsonObject &json, const QString &key, int32_t default_value) {
+    const QJsonValue value = json.value(key);
+    if (value.isUndefined()) { return default_value; }
+    const double number = value.toDouble(NAN);
+    if (!value.isDouble() || std::trunc(number) != number
+        || number < std::numeric_limits<int32_t>::min()
+        || number > std::numeric_limits<int32_t>::max()) {
+        throw SIMULATOR_EXCEPTION(Input, "Timing model value is not an integer", key);
+    }
+    return static_cast<int32_t>(number);
+}
+
+static InstructionCost parse_cost(const QJsonValue &value, const InstructionCost &defaults) {
+    if (!value.isObject()) {
+        throw SIMULATOR_EXCEPTION(Input, "Timing model cost has to be an object", "");
+    }
+    const QJsonObject json = value.toObject();
+    return { parse_int(json, "base", defaults.base), parse_int(json, "per_vl", defaults.per_vl) };
+}
+
+static QJsonObject cost_to_json(const InstructionCost &cost) {
+    QJsonObject json;
+    json["base"] = cost.base;
+    json["per_vl"] = cost.per_vl;
+    return json;
+}
+
+TimingModel::TimingModel() {
+    class_costs[IC_ALU] = { 5, 0 };
+    class_costs[IC_MUL] = { 8, 0 };
+    class_costs[IC_MEM] = { 36, 0 };
+    class_costs[IC_VEC_ALU] = { 4, 1 };
+    class_costs[IC_VEC_MUL] = { 4, 4 };      // assume it is chained
+    class_costs[IC_VEC_REDSUM] = { 8, 2 };   // 1 + 2 + 4 + ... +vl <= vl * 2
+    class_costs[IC_VEC_CONFIG] = { 5, 0 };
+    class_costs[IC_VEC_MEM] = { 36, 1 };
+    // Reduction consumes the products as they are produced.
+    chaining = { { IC_VEC_MUL, IC_VEC_REDSUM, { -4, -1 } } };
+}
+
+TimingModel TimingModel::from_json(const QJsonObject &json) {
+    TimingModel model;
+    const QJsonObject classes = json.value("classes").toObject();
+    for (const QString &name : classes.keys()) {
+        const InstructionClass inst_class = parse_class(name);
+        model.class_costs[inst_class]
+            = parse_cost(classes.value(name), model.class_costs[inst_class]);
+    }
+    const QJsonObject mnemonics = json.value("mnemonics").toObject();
+    if (mnemonics.size() > MAX_MNEMONIC_COSTS) {
+        throw SIMULATOR_EXCEPTION(
+            Input, "Too many mnemonics in timing model", QString::number(mnemonics.size()));
+    }
+    for (const QString &mnemonic : mnemonics.keys()) {
+        model.mnemonics.insert(mnemonic, parse_cost(mnemonics.value(mnemonic), {}));
+    }
+    if (json.contains("chaining")) {
+        model.chaining.clear();
+        for (const QJsonValue &value : json.value("chaining").toArray()) {
+            const QJsonObject rule = value.toObject();
+            model.chaining.push_back(
+                { parse_class(rule.value("previous")), parse_class(rule.value("current")),
+                  parse_cost(rule, {}) });
+        }
+    }
+    return model;
+}
+
+TimingModel TimingModel::load(const QString &path) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        throw SIMULATOR_EXCEPTION(
+            Input, QString("Can't open timing model file (") + path + ")", file.errorString());
+    }
+    QJsonParseError error {};
+    const QJsonDocument document = QJsonDocument::fromJson(file.readAll(), &error);
+    if (error.error != QJsonParseError::NoError || !document.isObject()) {
+        throw SIMULATOR_EXCEPTION(
+            Input, QString("Timing model is not a JSON object (") + path + ")",
+            error.errorString());
+    }
+    return from_json(document.object());
+}
+
+QJsonObject TimingModel::to_json() const {
+    QJsonObject classes;
+    for (size_t i = 0; i < IC_COUNT; i++) {
+        classes[INSTRUCTION_CLASS_NAMES[i]] = cost_to_json(class_costs[i]);
+    }
+    QJsonObject mnemonic_costs;
+    for (auto it = mnemonics.cbegin(); it != mnemonics.cend(); ++it) {
+        mnemonic_costs[it.key()] = cost_to_json(it.value());
+    }
+    QJsonArray rules;
+    for (const ChainingRule &rule : chaining) {
+        QJsonObject json = cost_to_json(rule.adjustment);
+        json["previous"] = INSTRUCTION_CLASS_NAMES[rule.previous];
+        json["current"] = INSTRUCTION_CLASS_NAMES[rule.current];
+        rules.append(json);
+    }
+    QJsonObject json;
+    json["classes"] = classes;
+    json["mnemonics"] = mnemonic_costs;
+    json["chaining"] = rules;
+    return json;
+}
+
+void TimingModel::set_class_cost(InstructionClass inst_class, InstructionCost cost) {
+    class_costs[inst_class] = cost;
+}
+
+void TimingModel::set_mnemonic_cost(const QString &mnemonic, InstructionCost cost) {
+    Q_ASSERT(mnemonics.contains(mnemonic) || mnemonics.size() < MAX_MNEMONIC_COSTS);
+    mnemonics.insert(mnemonic, cost);
+}
+
+void TimingModel::set_chaining_rules(const QVector<ChainingRule> &rules) {
+    chaining = rules;
+}
+
+const InstructionCost &TimingModel::class_cost(InstructionClass inst_class) const {
+    return class_costs[inst_class];
+}
+
+const QMap<QString, InstructionCost> &TimingModel::mnemonic_costs() const {
+    return mnemonics;
+}
+
+const QVector<ChainingRule> &TimingModel::chaining_rules() const {
+    return chaining;
+}
+
+bool TimingModel::operator==(const TimingModel &other) const {
+    return class_costs == other.class_costs && mnemonics == other.mnemonics
+           && chaining == other.chaining;
+}
+
+bool TimingModel::operator!=(const TimingModel &other) const {
+    return !(*this == other);
+}
+
+TimingTable::TimingTable(const TimingModel &model)
+    : slot_count(IC_COUNT * (1 + model.mnemonic_costs().size()))
+    , costs(IC_COUNT * slot_count) {
+    std::vector<InstructionCost> slot_costs;
+    slot_costs.reserve(slot_count);
+    for (size_t i = 0; i < IC_COUNT; i++) {
+        slot_costs.push_back(model.class_cost(static_cast<InstructionClass>(i)));
+    }
+    const QMap<QString, InstructionCost> &mnemonics = model.mnemonic_costs();
+    for (auto it = mnemonics.cbegin(); it != mnemonics.cend(); ++it) {
+        mnemonic_slots.insert(it.key(), static_cast<uint16_t>(slot_costs.size()));
+        slot_costs.insert(slot_costs.end(), IC_COUNT, it.value());
+    }
+
+    for (size_t previous = 0; previous < IC_COUNT; previous++) {
+        for (size_t slot = 0; slot < slot_count; slot++) {
+            InstructionCost cost = slot_costs[slot];
+            const size_t current = slot % IC_COUNT;
+            for (const ChainingRule &rule : model.chaining_rules()) {
+                if (rule.previous == previous && rule.current == current) {
+                    cost.base += rule.adjustment.base;
+                    cost.per_vl += rule.adjustment.per_vl;
+                }
+            }
+            costs[previous * slot_count + slot] = cost;
+        }
+    }
+}
+
+uint16_t TimingTable::slot(const char *mnemonic, InstructionClass inst_class) const {
+    if (mnemonic == nullptr) { return inst_class; }
+    const auto it = mnemonic_slots.constFind(QString::fromLatin1(mnemonic));
+    if (it == mnemonic_slots.cend()) { return inst_class; }
+    return static_cast<uint16_t>(it.value() + inst_class);
+}
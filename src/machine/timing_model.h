@@ -0,0 +1,135 @@
+#ifndef TIMING_MODEL_H
+#define TIMING_MODEL_H
+
+#include <QJsonObject>
+#include <QMap>
+#include <QString>
+#include <QVector>
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace machine {
+
+/** Instruction classes of the cycle cost model (see `TimingModel`). */
+enum InstructionClass : uint8_t {
+    IC_ALU,
+    IC_MUL,
+    IC_MEM,
+    IC_VEC_ALU,
+    IC_VEC_MUL,
+    IC_VEC_REDSUM,
+    IC_VEC_CONFIG,
+    IC_VEC_MEM,
+    IC_COUNT,
+};
+
+/** Names of instruction classes used in reports and timing model files. */
+inline constexpr std::array<const char *, IC_COUNT> INSTRUCTION_CLASS_NAMES {
+    "alu", "mul", "mem", "vec-alu", "vec-mul", "vec-redsum", "vec-config", "vec-mem",
+};
+
+/** Cycles of an instruction, `base + per_vl * vl`. */
+struct InstructionCost {
+    int32_t base = 0;
+    int32_t per_vl = 0;
+
+    bool operator==(const InstructionCost &other) const {
+        return base == other.base && per_vl == other.per_vl;
+    }
+    bool operator!=(const InstructionCost &other) const { return !(*this == other); }
+};
+
+/**
+ * Cost change of an instruction of class `current` directly following an instruction of class
+ * `previous` (e.g. reduction chained to the preceding vector multiplication).
+ */
+struct ChainingRule {
+    InstructionClass previous = IC_ALU;
+    InstructionClass current = IC_ALU;
+    InstructionCost adjustment {};
+
+    bool operator==(const ChainingRule &other) const {
+        return previous == other.previous && current == other.current
+               && adjustment == other.adjustment;
+    }
+};
+
+/**
+ * Cycle cost model of the cores (`CoreState::cycle_count`).
+ *
+ * Each instruction costs the cost of its class, unless its mnemonic has its own cost. Chaining
+ * rules adjust the cost by the class of the previous instruction. Default constructed model is
+ * the built-in one. Models can be stored in JSON:
+ *
+ *     {
+ *         "classes": { "mem": { "base": 36 }, "vec-mul": { "base": 4, "per_vl": 4 } },
+ *         "mnemonics": { "div": { "base": 34 } },
+ *         "chaining": [ { "previous": "vec-mul", "current": "vec-redsum",
+ *                         "base": -4, "per_vl": -1 } ]
+ *     }
+ *
+ * Classes missing in the file keep their built-in costs, listed chaining rules replace the
+ * built-in ones.
+ */
+class TimingModel {
+public:
+    TimingModel();
+
+    /** @throws SimulatorExceptionInput when the model is malformed */
+    static TimingModel from_json(const QJsonObject &json);
+    /** @throws SimulatorExceptionInput when the file can't be read or is malformed */
+    static TimingModel load(const QString &path);
+    [[nodiscard]] QJsonObject to_json() const;
+
+    void set_class_cost(InstructionClass inst_class, InstructionCost cost);
+    void set_mnemonic_cost(const QString &mnemonic, InstructionCost cost);
+    void set_chaining_rules(const QVector<ChainingRule> &rules);
+
+    [[nodiscard]] const InstructionCost &class_cost(InstructionClass inst_class) const;
+    [[nodiscard]] const QMap<QString, InstructionCost> &mnemonic_costs() const;
+    [[nodiscard]] const QVector<ChainingRule> &chaining_rules() const;
+
+    bool operator==(const TimingModel &other) const;
+    bool operator!=(const TimingModel &other) const;
+
+private:
+    std::array<InstructionCost, IC_COUNT> class_costs;
+    QMap<QString, InstructionCost> mnemonics;
+    QVector<ChainingRule> chaining;
+};
+
+/**
+ * Timing model compiled into a flat table indexed by the class of the previous instruction and
+ * the cost slot of the current one.
+ *
+ * Slot of an instruction is resolved once, when it is decoded (see `DecodedInstruction`). Slots
+ * below `IC_COUNT` are the instruction classes, each mnemonic with its own cost has `IC_COUNT`
+ * slots following them (one per class, as chaining rules depend on the class).
+ */
+class TimingTable {
+public:
+    explicit TimingTable(const TimingModel &model = TimingModel());
+
+    [[nodiscard]] bool has_mnemonic_costs() const { return !mnemonic_slots.isEmpty(); }
+    /** Cost slot of an instruction with `mnemonic` (may be null) and `inst_class`. */
+    [[nodiscard]] uint16_t slot(const char *mnemonic, InstructionClass inst_class) const;
+
+    /** Cycles of the instruction in `slot` following an instruction of class `previous`. */
+    [[nodiscard]] unsigned
+    cycles(InstructionClass previous, uint16_t slot, unsigned vl) const {
+        const InstructionCost &cost = costs[previous * slot_count + slot];
+        const int64_t cycles = cost.base + (int64_t)cost.per_vl * vl;
+        return cycles > 0 ? (unsigned)cycles : 0;
+    }
+
+private:
+    size_t slot_count;
+    std::vector<InstructionCost> costs;
+    /** First slot of each mnemonic with its own cost. */
+    QMap<QString, uint16_t> mnemonic_slots;
+};
+
+} // namespace machine
+
+#endif // TIMING_MODEL_H
@@ -0,0 +1,123 @@
+#include "host_io.h"
+
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+#include <QWaitCondition>
+#include <utility>
+#include <vector>
+
+using namespace osemu;
+
+/** Time given to a blocked job to finish when the simulation ends. */
+static constexpr unsigned long SHUTDOWN_WAIT_MS = 100;
+
+/** Shared with the worker, so it outlives an abandoned thread. */
+struct HostIoThread::State {
+    QMutex mutex;
+    QWaitCondition job_submitted;
+    QWaitCondition job_finished;
+    Job job;
+    bool has_job = false;
+    bool finished = false;
+    bool stopping = false;
+    int64_t result = 0;
+};
+
+class HostIoThread::Worker : public QThread {
+public:
+    explicit Worker(std::shared_ptr<State> state) : state(std::move(state)) {}
+
+protected:
+    void run() override {
+        while (true) {
+            Job job;
+            {
+                QMutexLocker locker(&state->mutex);
+                while (!state->has_job && !state->stopping) {
+                    state->job_submitted.wait(&state->mutex);
+                }
+                if (!state->has_job) { return; }
+                job = std::move(state->job);
+                state->has_job = false;
+            }
+            const int64_t result = job();
+            QMutexLocker locker(&state->mutex);
+            state->result = result;
+            state->finished = true;
+            state->job_finished.wakeAll();
+        }
+    }
+
+private:
+    const std::shared_ptr<State> state;
+};
+
+/**
+ * Threads abandoned with a job blocked in the host. They are deleted by a later destruction of
+ * a `HostIoThread` once they finish, no event loop is required for it.
+ */
+static QMutex abandoned_mutex;
+static std::vector<QThread *> abandoned_workers;
+
+/** Deletes finished abandoned threads, then adds `worker` (unless null) to the abandoned ones. */
+static void abandon_worker(QThread *worker) {
+    QMutexLocker locker(&abandoned_mutex);
+    auto it = abandoned_workers.begin();
+    while (it != abandoned_workers.end()) {
+        if ((*it)->isFinished()) {
+            delete *it;
+            it = abandoned_workers.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    if (worker != nullptr) { abandoned_workers.push_back(worker); }
+}
+
+HostIoThread::~HostIoThread() {
+    if (worker == nullptr) { return; }
+    {
+        QMutexLocker locker(&state->mutex);
+        state->stopping = true;
+        state->job_submitted.wakeAll();
+    }
+    if (worker->wait(SHUTDOWN_WAIT_MS)) {
+        delete worker;
+        abandon_worker(nullptr);
+    } else {
+        // Running thread can't be destroyed, it holds the state and ends on its own.
+        abandon_worker(worker);
+    }
+}
+
+void HostIoThread::submit(Job job) {
+    Q_ASSERT(!busy);
+    if (worker == nullptr) {
+        state = std::make_shared<State>();
+        worker = new Worker(state);
+        worker->start();
+    }
+    QMutexLocker locker(&state->mutex);
+    state->job = std::move(job);
+    state->has_job = true;
+    state->finished = false;
+    state->job_submitted.wakeOne();
+    busy = true;
+}
+
+bool HostIoThread::wait(unsigned long timeout_ms) {
+    QMutexLocker locker(&state->mutex);
+    if (!state->finished && timeout_ms > 0) {
+        state->job_finished.wait(&state->mutex, timeout_ms);
+    }
+    return state->finished;
+}
+
+int64_t HostIoThread::take_result() {
+    QMutexLocker locker(&state->mutex);
+    Q_ASSERT(state->finished);
+    state->finished = false;
+    busy = false;
+    return state->result;
+}
@@ -0,0 +1,54 @@
+#ifndef HOST_IO_H
+#define HOST_IO_H
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+namespace osemu {
+
+/**
+ * Thread executing blocking host I/O of emulated system calls.
+ *
+ * The simulation thread submits a job and polls for its result, so a guest reading from a pipe
+ * or a slow file does not stop the rest of the simulator. Only one job is in progress at a time,
+ * the calling core is stalled until its result is delivered (see
+ * `OsSyscallExceptionHandler::handle_exception`).
+ * The thread is started by the first job, programs without host file I/O never start it.
+ */
+class HostIoThread {
+public:
+    /** Host operation, returns the result of the system call (negative target errno). */
+    using Job = std::function<int64_t()>;
+
+    HostIoThread() = default;
+    /**
+     * Waits shortly for the job in progress. The thread is abandoned when the job stays blocked
+     * in the host (e.g. reading a pipe nobody writes to), it ends once the operation returns and
+     * it is deleted by a later destruction of a `HostIoThread`.
+     */
+    ~HostIoThread();
+    HostIoThread(const HostIoThread &) = delete;
+    HostIoThread &operator=(const HostIoThread &) = delete;
+
+    /** Starts the `job`, the result of the previous one has to be taken. */
+    void submit(Job job);
+    /** Job was submitted and its result was not taken yet. */
+    [[nodiscard]] bool is_busy() const { return busy; }
+    /** Waits at most `timeout_ms` for the job, returns whether it has finished. */
+    bool wait(unsigned long timeout_ms);
+    /** Result of the finished job, the thread is ready for another one. */
+    int64_t take_result();
+
+private:
+    class Worker;
+    struct State;
+
+    std::shared_ptr<State> state;
+    Worker *worker = nullptr;
+    bool busy = false;
+};
+
+} // namespace osemu
+
+#endif // HOST_IO_H
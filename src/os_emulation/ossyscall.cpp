@@ -1,16 +1,19 @@
 #include "ossyscall.h"
 
+#include "machine/checkpoint.h"
 #include "machine/core.h"
 #include "machine/utils.h"
 #include "syscall_nr.h"
 #include "target_errno.h"
 #include "posix_polyfill.h"
 
+#include <algorithm>
 #include <cerrno>
-#include <cinttypes>
+#include <climits>
 #include <cstdio>
 #include <fcntl.h>
 #include <sys/stat.h>
+#include <vector>
 
 using namespace machine;
 using namespace osemu;
@@ -508,43 +511,90 @@ int status_from_result(uint32_t result) {
         return -result;
 }
 
-typedef int (OsSyscallExceptionHandler::*syscall_handler_t)(
-    uint64_t &result,
-    Core *core,
-    uint64_t syscall_num,
-    uint64_t a1,
-    uint64_t a2,
-    uint64_t a3,
-    uint64_t a4,
-    uint64_t a5,
-    uint64_t a6);
-
-struct mips_syscall_desc_t {
-    const char *name;
-    unsigned int args;
-    syscall_handler_t handler;
+static int host_open_flags(int flags) {
+    int hostflags = 0;
+    for (auto i = map_target_o_flags_to_o_flags.begin(); i != map_target_o_flags_to_o_flags.end();
+         i++)
+        if (flags & i.key()) hostflags |= i.value();
+
+    switch (flags & TARGET_O_ACCMODE) {
+    case TARGET_O_RDONLY: hostflags |= O_RDONLY; break;
+    case TARGET_O_WRONLY: hostflags |= O_WRONLY; break;
+    case TARGET_O_RDWR: hostflags |= O_RDWR; break;
+    }
+    return hostflags;
+}
+
+namespace osemu {
+/** Part of the guest memory transferred by host I/O, data are owned by the transfer. */
+struct HostIoSegment {
+    Address base;
+    uint32_t len;
+    QVector<uint8_t> data;
 };
+} // namespace osemu
+
+static std::vector<HostIoSegment> read_iovec(FrontendMemory *mem, Address iov, int iovcnt) {
+    std::vector<HostIoSegment> segments;
+    for (; iovcnt > 0; iovcnt--, iov += 8) {
+        segments.push_back({ Address(mem->read_u32(iov)), mem->read_u32(iov + 4), {} });
+    }
+    return segments;
+}
+
+/**
+ * Transfers segments between the host file and their buffers in order, stops after a short
+ * transfer like `readv`/`writev`. Runs in the host I/O thread, buffers of read segments are
+ * resized to the received data.
+ *
+ * @return  total count of transferred bytes or negative target errno when nothing was transferred
+ */
+static int64_t host_transfer(int fd, std::vector<HostIoSegment> &segments, bool write_to_host) {
+    int64_t total = 0;
+    for (HostIoSegment &segment : segments) {
+        int32_t count;
+        if (write_to_host) {
+            count = result_errno_if_error(write(fd, segment.data.constData(), segment.len));
+        } else {
+            segment.data.resize(segment.len);
+            count = result_errno_if_error(read(fd, segment.data.data(), segment.len));
+            segment.data.resize(std::max(count, 0));
+        }
+        if (count < 0) { return (total == 0) ? count : total; }
+        total += count;
+        if ((uint32_t)count < segment.len) { break; }
+    }
+    return total;
+}
 
 struct rv_syscall_desc_t {
     unsigned int args;
-    syscall_handler_t handler;
+    SyscallEntry<OsSyscallExceptionHandler> handler;
     const char *name;
 };
 
-static const rv_syscall_desc_t rv_syscall_args[] = {
+static constexpr rv_syscall_desc_t rv_syscall_args[] = {
 #include "syscallent.h"
 };
 
-const unsigned rv_syscall_count = sizeof(rv_syscall_args) / sizeof(*rv_syscall_args);
+constexpr unsigned rv_syscall_count = sizeof(rv_syscall_args) / sizeof(*rv_syscall_args);
+
+/** Dispatch by number indexes the table directly, each number has to be described. */
+static constexpr bool is_syscall_table_dense() {
+    for (const rv_syscall_desc_t &desc : rv_syscall_args) {
+        if (desc.handler.call == nullptr || desc.name == nullptr) { return false; }
+    }
+    return true;
+}
+static_assert(is_syscall_table_dense(), "System call table has a gap.");
 
 OsSyscallExceptionHandler::OsSyscallExceptionHandler(
     bool known_syscall_stop,
     bool unknown_syscall_stop,
-    QString fs_root)
-    : fd_mapping(3, FD_TERMINAL) {
-    brk_limit = 0;
-    anonymous_base = 0x60000000;
-    anonymous_last = anonymous_base;
+    QString fs_root,
+    Xlen xlen)
+    : fd_mapping(3, FD_TERMINAL)
+    , virtual_memory(xlen) {
     this->known_syscall_stop = known_syscall_stop;
     this->unknown_syscall_stop = unknown_syscall_stop;
     this->fs_root = fs_root;
@@ -558,70 +608,164 @@ bool OsSyscallExceptionHandler::handle_exception(
     Address next_addr,
     Address jump_branch_pc,
     Address mem_ref_addr) {
-    uint64_t syscall_num = regs->read_gp(17).as_u64();
-    const rv_syscall_desc_t *sdesc;
-    RegisterValue a1 = 0, a2 = 0, a3 = 0, a4 = 0, a5 = 0, a6 = 0;
-    uint64_t result;
-    int status;
-
-    FrontendMemory *mem_program = core->get_mem_program();
-    (void)mem_program;
-
-#if 1
-    printf(
-        "Exception cause %d instruction PC 0x%08" PRIx64 " next PC 0x%08" PRIx64 " jump branch "
-        "PC 0x%08" PRIx64
-        "registers PC 0x%08" PRIx64 " mem ref 0x%08" PRIx64 "\n",
-        excause, inst_addr.get_raw(), next_addr.get_raw(),
-        jump_branch_pc.get_raw(), regs->read_pc().get_raw(),
-        mem_ref_addr.get_raw());
-#else
     (void)excause;
-    (void)inst_addr;
     (void)next_addr;
-    (void)mem_ref_addr;
-    (void)regs;
     (void)jump_branch_pc;
-#endif
+    (void)mem_ref_addr;
+    uint64_t syscall_num = regs->read_gp(17).as_u64();
 
     // handle Linux syscalls
-    if (syscall_num < rv_syscall_count) {
-        sdesc = &rv_syscall_args[syscall_num];
-    } else {
+    if (syscall_num >= rv_syscall_count) {
         throw SIMULATOR_EXCEPTION(
             SyscallUnknown, "System call number unknown ", QString::number(syscall_num));
     }
-    // sdesc is populated by syscall description matching syscall number.
-    // if such syscall doesn't exist, this part is unreachable, because
-    // of the above exception.
-
-    // read out values from registers. Not sure I like this...
-    // Maybe the handling functions themselves should do this on their own.
-    a1 = regs->read_gp(10);
-    a2 = regs->read_gp(11);
-    a3 = regs->read_gp(12);
-    a4 = regs->read_gp(13);
-    a5 = regs->read_gp(14);
-    a6 = regs->read_gp(15);
-
-#if 1
-    printf(
-        "Syscall %s number %" PRId64 "/0x%" PRIx64 " a1=%" PRIu64 " a2=%" PRIu64 " a3=%" PRIu64 " a4=%" PRIu64 "\n",
-        sdesc->name, syscall_num, syscall_num, a1.as_u64(), a2.as_u64(), a3.as_u64(), a4.as_u64());
-
-#endif
-    status = (this->*sdesc->handler)(
-        result, core, syscall_num, a1.as_u64(), a2.as_u64(), a3.as_u64(), a4.as_u64(), a5.as_u64(),
-        a6.as_u64());
+    const rv_syscall_desc_t &sdesc = rv_syscall_args[syscall_num];
+
+    // Arguments are truncated to XLEN once, handlers get them already converted.
+    const bool xlen_32 = core->get_xlen() == Xlen::_32;
+    SyscallArgs args;
+    for (size_t i = 0; i < SYSCALL_MAX_ARGS; i++) {
+        const uint64_t value = regs->read_gp(10 + i).as_u64();
+        args[i] = xlen_32 ? (uint32_t)value : value;
+    }
+
+    uint64_t result = 0;
+    const int status = sdesc.handler.call(*this, result, core, args);
+    if (status == SYSCALL_PENDING) {
+        // The step which finds the host I/O finished delivers the result and ends the stall.
+        core->stall_until([this, core, regs, inst_addr, syscall_num, args]() {
+            if (!host_io.wait(0)) { return false; }
+            uint64_t io_result = 0;
+            const int io_status = finish_host_io(io_result);
+            complete_syscall(core, regs, inst_addr, syscall_num, args, io_status, io_result);
+            return true;
+        });
+        return true;
+    }
+    complete_syscall(core, regs, inst_addr, syscall_num, args, status, result);
+    return true;
+}
+
+void OsSyscallExceptionHandler::complete_syscall(
+    Core *core,
+    Registers *regs,
+    Address inst_addr,
+    uint64_t syscall_num,
+    const SyscallArgs &args,
+    int status,
+    uint64_t result) {
+    const rv_syscall_desc_t &sdesc = rv_syscall_args[syscall_num];
+    const bool xlen_32 = core->get_xlen() == Xlen::_32;
     if (known_syscall_stop) { emit core->stop_on_exception_reached(); }
 
-    if (status < 0) {
-        regs->write_gp(10, status);
-    } else {
-        regs->write_gp(10, result);
+    const uint64_t returned = (status < 0) ? (uint64_t)(int64_t)status : result;
+    regs->write_gp(10, returned);
+
+    if (trace_sink != nullptr) {
+        SyscallTraceRecord record;
+        record.pc = inst_addr;
+        record.number = syscall_num;
+        record.name = sdesc.name;
+        record.implemented
+            = sdesc.handler.call
+              != SyscallBinding<&OsSyscallExceptionHandler::syscall_default_handler>::call;
+        record.arg_count = sdesc.args;
+        record.arg_kinds
+            = (sdesc.handler.arg_count >= sdesc.args) ? sdesc.handler.arg_kinds : nullptr;
+        record.args = args;
+        record.result = xlen_32 ? (int64_t)(int32_t)returned : (int64_t)returned;
+        trace_sink->syscall_handled(record);
     }
+}
 
-    return true;
+int OsSyscallExceptionHandler::start_host_io(
+    Core *core,
+    uint64_t &result,
+    HostIoThread::Job job,
+    HostIoCompletion completion) {
+    // Results of headless runs must not depend on the speed of the host.
+    if (!async_host_io || core->is_headless()) { return completion(result, job()); }
+    if (host_io.is_busy()) {
+        // Job of a call abandoned by the reset of the core, its result is dropped.
+        host_io.wait(ULONG_MAX);
+        host_io.take_result();
+    }
+    host_io_completion = std::move(completion);
+    host_io.submit(std::move(job));
+    if (!host_io.wait(HOST_IO_START_WAIT_MS)) { return SYSCALL_PENDING; }
+    return finish_host_io(result);
+}
+
+int OsSyscallExceptionHandler::start_host_transfer(
+    Core *core,
+    uint64_t &result,
+    FrontendMemory *mem,
+    int fd,
+    std::vector<HostIoSegment> segments,
+    bool write_to_host) {
+    auto shared_segments = std::make_shared<std::vector<HostIoSegment>>(std::move(segments));
+    return start_host_io(
+        core, result,
+        [fd, shared_segments, write_to_host]() {
+            return host_transfer(fd, *shared_segments, write_to_host);
+        },
+        [mem, shared_segments, write_to_host](uint64_t &result, int64_t count) {
+            if (!write_to_host) {
+                for (const HostIoSegment &segment : *shared_segments) {
+                    mem->write_span(segment.base, segment.data.data(), segment.data.size());
+                }
+            }
+            result = count;
+            return status_from_result(result);
+        });
+}
+
+int OsSyscallExceptionHandler::finish_host_io(uint64_t &result) {
+    const int64_t io_result = host_io.take_result();
+    HostIoCompletion completion = std::move(host_io_completion);
+    host_io_completion = nullptr;
+    return completion(result, io_result);
+}
+
+void OsSyscallExceptionHandler::save_checkpoint(QDataStream &out) const {
+    if (host_io.is_busy()) {
+        throw SIMULATOR_EXCEPTION(
+            Input, "Checkpoint cannot be saved during host I/O of a system call", "");
+    }
+    for (int fd = 0; fd < fd_mapping.size(); fd++) {
+        if (fd_mapping[fd] >= 0) {
+            throw SIMULATOR_EXCEPTION(
+                Input, "Checkpoint cannot be saved while a host file is open, descriptor",
+                QString::number(fd));
+        }
+    }
+    checkpoint::write_array(out, fd_mapping.constData(), fd_mapping.size());
+    virtual_memory.save_checkpoint(out);
+}
+
+void OsSyscallExceptionHandler::load_checkpoint(QDataStream &in) {
+    std::vector<int> loaded_mapping;
+    checkpoint::read_vector(in, loaded_mapping);
+    for (int host_fd : loaded_mapping) {
+        if (host_fd != FD_UNUSED && host_fd != FD_TERMINAL) { checkpoint::throw_truncated(); }
+    }
+    virtual_memory.load_checkpoint(in);
+    fd_mapping.resize(static_cast<int>(loaded_mapping.size()));
+    std::copy(loaded_mapping.begin(), loaded_mapping.end(), fd_mapping.begin());
+    if (host_io.is_busy()) {
+        // Call of the replaced program is abandoned, as on the reset of the core.
+        host_io.wait(ULONG_MAX);
+        host_io.take_result();
+    }
+    host_io_completion = nullptr;
+}
+
+void OsSyscallExceptionHandler::set_async_host_io(bool enable) {
+    async_host_io = enable;
+}
+
+void OsSyscallExceptionHandler::set_trace_sink(std::shared_ptr<SyscallTraceSink> sink) {
+    trace_sink = std::move(sink);
 }
 
 int32_t OsSyscallExceptionHandler::write_mem(
@@ -631,10 +775,7 @@ int32_t OsSyscallExceptionHandler::write_mem(
     uint32_t count) {
     if ((uint32_t)data.size() < count) count = data.size();
 
-    for (uint32_t i = 0; i < count; i++) {
-        mem->write_u8(addr, data[i]);
-        addr += 1;
-    }
+    mem->write_span(addr, data.data(), count);
     return count;
 }
 
@@ -644,10 +785,7 @@ int32_t OsSyscallExceptionHandler::read_mem(
     QVector<uint8_t> &data,
     uint32_t count) {
     data.resize(count);
-    for (uint32_t i = 0; i < count; i++) {
-        data[i] = mem->read_u8(addr);
-        addr += 1;
-    }
+    mem->read_span(data.data(), addr, count);
     return count;
 }
 
@@ -656,8 +794,10 @@ int32_t OsSyscallExceptionHandler::write_io(int fd, const QVector<uint8_t> &data
     if (fd == FD_UNUSED) {
         return -1;
     } else if (fd == FD_TERMINAL) {
-        for (uint32_t i = 0; i < count; i++)
-            emit char_written(fd, data[i]);
+        for (uint32_t i = 0; i < count; i += TERMINAL_CHUNK_SIZE) {
+            const uint32_t chunk = std::min(count - i, TERMINAL_CHUNK_SIZE);
+            emit data_written(fd, QByteArray((const char *)data.data() + i, chunk));
+        }
     } else {
         count = write(fd, data.data(), count);
     }
@@ -707,33 +847,6 @@ int OsSyscallExceptionHandler::allocate_fd(int val) {
     return i;
 }
 
-int OsSyscallExceptionHandler::file_open(QString fname, int flags, int mode) {
-    int targetfd, fd;
-    int hostflags = 0;
-    (void)mode;
-    for (auto i = map_target_o_flags_to_o_flags.begin(); i != map_target_o_flags_to_o_flags.end();
-         i++)
-        if (flags & i.key()) hostflags |= i.value();
-
-    switch (flags & TARGET_O_ACCMODE) {
-    case TARGET_O_RDONLY: hostflags |= O_RDONLY; break;
-    case TARGET_O_WRONLY: hostflags |= O_WRONLY; break;
-    case TARGET_O_RDWR: hostflags |= O_RDWR; break;
-    }
-
-    if (fs_root.size() == 0) { return allocate_fd(FD_TERMINAL); }
-
-    fname = filepath_to_host(fname);
-
-    fd = open(fname.toLatin1().data(), hostflags, OPEN_MODE);
-    if (fd >= 0) {
-        targetfd = allocate_fd(fd);
-    } else {
-        targetfd = result_errno_if_error(fd);
-    }
-    return targetfd;
-}
-
 int OsSyscallExceptionHandler::targetfd_to_fd(int targetfd) {
     if (targetfd < 0) return FD_INVALID;
     if (targetfd >= fd_mapping.size()) return FD_INVALID;
@@ -773,61 +886,16 @@ QString OsSyscallExceptionHandler::filepath_to_host(QString path) {
     return path;
 }
 
-int OsSyscallExceptionHandler::syscall_default_handler(
-    uint64_t &result,
-    Core *core,
-    uint64_t syscall_num,
-    uint64_t a1,
-    uint64_t a2,
-    uint64_t a3,
-    uint64_t a4,
-    uint64_t a5,
-    uint64_t a6) {
-    const rv_syscall_desc_t *sdesc = &rv_syscall_args[syscall_num];
-#if 1
-    printf(
-        "Unimplemented syscall %s number %" PRId64 "/0x%" PRIx64 " a1 %" PRId64
-        " a2 %" PRId64 " a3 %" PRId64 " a4 %" PRId64 "\n", sdesc->name,
-        syscall_num, syscall_num, a1, a2, a3, a4);
-
-#endif
-    (void)core;
-    (void)syscall_num;
-    (void)a1;
-    (void)a2;
-    (void)a3;
-    (void)a4;
-    (void)a5;
-    (void)a6;
+int OsSyscallExceptionHandler::syscall_default_handler(uint64_t &result, Core *core) {
     result = 0;
     if (unknown_syscall_stop) emit core->stop_on_exception_reached();
     return TARGET_ENOSYS;
 }
 
 // void exit(int status);
-int OsSyscallExceptionHandler::do_sys_exit(
-    uint64_t &result,
-    Core *core,
-    uint64_t syscall_num,
-    uint64_t a1,
-    uint64_t a2,
-    uint64_t a3,
-    uint64_t a4,
-    uint64_t a5,
-    uint64_t a6) {
-    (void)core;
-    (void)syscall_num;
-    (void)a1;
-    (void)a2;
-    (void)a3;
-    (void)a4;
-    (void)a5;
-    (void)a6;
-
+int OsSyscallExceptionHandler::do_sys_exit(uint64_t &result, Core *core, int status) {
+    (void)status;
     result = 0;
-    int status = a1;
-
-    printf("sys_exit status %d\n", status);
     emit core->stop_on_exception_reached();
 
     return 0;
@@ -837,51 +905,37 @@ int OsSyscallExceptionHandler::do_sys_exit(
 int OsSyscallExceptionHandler::do_sys_writev(
     uint64_t &result,
     Core *core,
-    uint64_t syscall_num,
-    uint64_t a1,
-    uint64_t a2,
-    uint64_t a3,
-    uint64_t a4,
-    uint64_t a5,
-    uint64_t a6) {
-    (void)core;
-    (void)syscall_num;
-    (void)a1;
-    (void)a2;
-    (void)a3;
-    (void)a4;
-    (void)a5;
-    (void)a6;
-
+    TargetFd targetfd,
+    Address iov,
+    int iovcnt) {
     result = 0;
-    int fd = a1;
-    Address iov = Address(core->get_xlen_from_reg(a2));
-    int iovcnt = a3;
     FrontendMemory *mem = core->get_mem_data();
     int32_t count;
     QVector<uint8_t> data;
 
-    printf("sys_writev to fd %d\n", fd);
-
-    fd = targetfd_to_fd(fd);
+    int fd = targetfd_to_fd(targetfd.value);
     if (fd == FD_INVALID) {
         result = -TARGET_EINVAL;
         return 0;
     }
 
-    while (iovcnt-- > 0) {
-        Address iov_base = Address(mem->read_u32(iov));
-        uint32_t iov_len = mem->read_u32(iov + 4);
-        iov += 8;
+    std::vector<HostIoSegment> segments = read_iovec(mem, iov, iovcnt);
+    if (fd >= 0) {
+        for (HostIoSegment &segment : segments) {
+            read_mem(mem, segment.base, segment.data, segment.len);
+        }
+        return start_host_transfer(core, result, mem, fd, std::move(segments), true);
+    }
 
-        read_mem(mem, iov_base, data, iov_len);
-        count = write_io(fd, data, iov_len);
+    for (const HostIoSegment &segment : segments) {
+        read_mem(mem, segment.base, data, segment.len);
+        count = write_io(fd, data, segment.len);
         if (count >= 0) {
             result += count;
         } else {
             if (result == 0) result = count;
         }
-        if (count < (int32_t)iov_len) break;
+        if (count < (int32_t)segment.len) break;
     }
 
     return status_from_result(result);
@@ -891,39 +945,25 @@ int OsSyscallExceptionHandler::do_sys_writev(
 int OsSyscallExceptionHandler::do_sys_write(
     uint64_t &result,
     Core *core,
-    uint64_t syscall_num,
-    uint64_t a1,
-    uint64_t a2,
-    uint64_t a3,
-    uint64_t a4,
-    uint64_t a5,
-    uint64_t a6) {
-    (void)core;
-    (void)syscall_num;
-    (void)a1;
-    (void)a2;
-    (void)a3;
-    (void)a4;
-    (void)a5;
-    (void)a6;
-
+    TargetFd targetfd,
+    Address buf,
+    uint64_t size) {
     result = 0;
-    int fd = a1;
-    Address buf = Address(core->get_xlen_from_reg(a2));
-    int size = core->get_xlen_from_reg(a3);
     FrontendMemory *mem = core->get_mem_data();
     int32_t count;
     QVector<uint8_t> data;
 
-    printf("sys_write to fd %d\n", fd);
-
-    fd = targetfd_to_fd(fd);
+    int fd = targetfd_to_fd(targetfd.value);
     if (fd == FD_INVALID) {
         result = -TARGET_EINVAL;
         return 0;
     }
 
     read_mem(mem, buf, data, size);
+    if (fd >= 0) {
+        return start_host_transfer(
+            core, result, mem, fd, { { buf, (uint32_t)size, data } }, true);
+    }
     count = write_io(fd, data, size);
 
     result = count;
@@ -935,51 +975,32 @@ int OsSyscallExceptionHandler::do_sys_write(
 int OsSyscallExceptionHandler::do_sys_readv(
     uint64_t &result,
     Core *core,
-    uint64_t syscall_num,
-    uint64_t a1,
-    uint64_t a2,
-    uint64_t a3,
-    uint64_t a4,
-    uint64_t a5,
-    uint64_t a6) {
-    (void)core;
-    (void)syscall_num;
-    (void)a1;
-    (void)a2;
-    (void)a3;
-    (void)a4;
-    (void)a5;
-    (void)a6;
-
+    TargetFd targetfd,
+    Address iov,
+    int iovcnt) {
     result = 0;
-    int fd = a1;
-    Address iov = Address(core->get_xlen_from_reg(a2));
-    int iovcnt = a3;
     FrontendMemory *mem = core->get_mem_data();
     int32_t count;
     QVector<uint8_t> data;
 
-    printf("sys_readv to fd %d\n", fd);
-
-    fd = targetfd_to_fd(fd);
+    int fd = targetfd_to_fd(targetfd.value);
     if (fd == FD_INVALID) {
         result = -TARGET_EINVAL;
         return 0;
     }
 
-    while (iovcnt-- > 0) {
-        Address iov_base = Address(mem->read_u32(iov));
-        uint32_t iov_len = mem->read_u32(iov + 4);
-        iov += 8;
+    std::vector<HostIoSegment> segments = read_iovec(mem, iov, iovcnt);
+    if (fd >= 0) { return start_host_transfer(core, result, mem, fd, std::move(segments), false); }
 
-        count = read_io(fd, data, iov_len, true);
+    for (const HostIoSegment &segment : segments) {
+        count = read_io(fd, data, segment.len, true);
         if (count >= 0) {
-            write_mem(mem, iov_base, data, count);
+            write_mem(mem, segment.base, data, count);
             result += count;
         } else {
             if (result == 0) result = count;
         }
-        if (count < (int32_t)iov_len) break;
+        if (count < (int32_t)segment.len) break;
     }
 
     return status_from_result(result);
@@ -989,40 +1010,23 @@ int OsSyscallExceptionHandler::do_sys_readv(
 int OsSyscallExceptionHandler::do_sys_read(
     uint64_t &result,
     Core *core,
-    uint64_t syscall_num,
-    uint64_t a1,
-    uint64_t a2,
-    uint64_t a3,
-    uint64_t a4,
-    uint64_t a5,
-    uint64_t a6) {
-    (void)core;
-    (void)syscall_num;
-    (void)a1;
-    (void)a2;
-    (void)a3;
-    (void)a4;
-    (void)a5;
-    (void)a6;
-
+    TargetFd targetfd,
+    Address buf,
+    uint64_t size) {
     result = 0;
-    int fd = a1;
-    Address buf = Address(core->get_xlen_from_reg(a2));
-    int size = core->get_xlen_from_reg(a3);
     FrontendMemory *mem = core->get_mem_data();
     int32_t count;
     QVector<uint8_t> data;
 
-    printf("sys_read to fd %d\n", fd);
-
-    fd = targetfd_to_fd(fd);
+    int fd = targetfd_to_fd(targetfd.value);
     if (fd == FD_INVALID) {
         result = -TARGET_EINVAL;
         return 0;
     }
 
-    result = 0;
-
+    if (fd >= 0) {
+        return start_host_transfer(core, result, mem, fd, { { buf, (uint32_t)size, {} } }, false);
+    }
     count = read_io(fd, data, size, true);
     if (count >= 0) { write_mem(mem, buf, data, size); }
     result = count;
@@ -1034,36 +1038,18 @@ int OsSyscallExceptionHandler::do_sys_read(
 int OsSyscallExceptionHandler::do_sys_openat(
     uint64_t &result,
     Core *core,
-    uint64_t syscall_num,
-    uint64_t a1,
-    uint64_t a2,
-    uint64_t a3,
-    uint64_t a4,
-    uint64_t a5,
-    uint64_t a6) {
-    (void)core;
-    (void)syscall_num;
-    (void)a1;
-    (void)a2;
-    (void)a3;
-    (void)a4;
-    (void)a5;
-    (void)a6;
-
+    TargetFd dirfd,
+    Address pathname_ptr,
+    int flags,
+    int mode) {
     result = 0;
-    if (int64_t(a1) != TARGET_AT_FDCWD) {
-        printf("Unimplemented openat argument a1 %" PRId64, a1);
+    if (dirfd.value != TARGET_AT_FDCWD) {
         if (unknown_syscall_stop) { emit core->stop_on_exception_reached(); }
         return TARGET_ENOSYS;
     }
-    Address pathname_ptr = Address(core->get_xlen_from_reg(a2));
-    int flags = a3;
-    int mode = a4;
     uint32_t ch;
     FrontendMemory *mem = core->get_mem_data();
 
-    printf("sys_open filename\n");
-
     QString fname;
     while (true) {
         ch = mem->read_u8(pathname_ptr);
@@ -1072,45 +1058,39 @@ int OsSyscallExceptionHandler::do_sys_openat(
         fname.append(QChar(ch));
     }
 
-    result = file_open(fname, flags, mode);
+    (void)mode;
+    if (fs_root.size() == 0) {
+        result = allocate_fd(FD_TERMINAL);
+        return status_from_result(result);
+    }
 
-    return status_from_result(result);
+    const QByteArray host_path = filepath_to_host(fname).toLatin1();
+    const int hostflags = host_open_flags(flags);
+    return start_host_io(
+        core, result,
+        [host_path, hostflags]() -> int64_t {
+            const int fd = open(host_path.constData(), hostflags, OPEN_MODE);
+            return (fd >= 0) ? fd : (int32_t)result_errno_if_error(fd);
+        },
+        [this](uint64_t &result, int64_t fd) {
+            result = (fd >= 0) ? allocate_fd((int)fd) : fd;
+            return status_from_result(result);
+        });
 }
 
 // int close(int fd);
-int OsSyscallExceptionHandler::do_sys_close(
-    uint64_t &result,
-    Core *core,
-    uint64_t syscall_num,
-    uint64_t a1,
-    uint64_t a2,
-    uint64_t a3,
-    uint64_t a4,
-    uint64_t a5,
-    uint64_t a6) {
+int OsSyscallExceptionHandler::do_sys_close(uint64_t &result, Core *core, TargetFd targetfd) {
     (void)core;
-    (void)syscall_num;
-    (void)a1;
-    (void)a2;
-    (void)a3;
-    (void)a4;
-    (void)a5;
-    (void)a6;
-
     result = 0;
-    int fd = a1;
 
-    printf("sys_close fd %d\n", fd);
-
-    int targetfd = fd;
-    fd = targetfd_to_fd(fd);
+    int fd = targetfd_to_fd(targetfd.value);
     if (fd == FD_INVALID) {
         result = -TARGET_EINVAL;
         return 0;
     }
 
     close(fd);
-    close_fd(targetfd);
+    close_fd(targetfd.value);
 
     return status_from_result(result);
 }
@@ -1119,32 +1099,13 @@ int OsSyscallExceptionHandler::do_sys_close(
 int OsSyscallExceptionHandler::do_sys_ftruncate(
     uint64_t &result,
     Core *core,
-    uint64_t syscall_num,
-    uint64_t a1,
-    uint64_t a2,
-    uint64_t a3,
-    uint64_t a4,
-    uint64_t a5,
-    uint64_t a6) {
-    (void)core;
-    (void)syscall_num;
-    (void)a1;
-    (void)a2;
-    (void)a3;
-    (void)a4;
-    (void)a5;
-    (void)a6;
-
+    TargetFd targetfd,
+    uint64_t length,
+    uint64_t length_high) {
     result = 0;
-    int fd = a1;
-    uint64_t length = core->get_xlen_from_reg(a2);
-    if (core->get_xlen() == Xlen::_32) {
-        length |= core->get_xlen_from_reg(a3) << 32;
-    }
-
-    printf("sys_ftruncate fd %d\n", fd);
+    if (core->get_xlen() == Xlen::_32) { length |= length_high << 32; }
 
-    fd = targetfd_to_fd(fd);
+    int fd = targetfd_to_fd(targetfd.value);
     if (fd == FD_INVALID) {
         result = -TARGET_EINVAL;
         return 0;
@@ -1156,29 +1117,8 @@ int OsSyscallExceptionHandler::do_sys_ftruncate(
 }
 
 // int or void * brk(void *addr);
-int OsSyscallExceptionHandler::do_sys_brk(
-    uint64_t &result,
-    Core *core,
-    uint64_t syscall_num,
-    uint64_t a1,
-    uint64_t a2,
-    uint64_t a3,
-    uint64_t a4,
-    uint64_t a5,
-    uint64_t a6) {
-    (void)core;
-    (void)syscall_num;
-    (void)a1;
-    (void)a2;
-    (void)a3;
-    (void)a4;
-    (void)a5;
-    (void)a6;
-
-    result = 0;
-    uint32_t new_limit = a1;
-    brk_limit = new_limit;
-    result = brk_limit;
+int OsSyscallExceptionHandler::do_sys_brk(uint64_t &result, Core *core, Address addr) {
+    result = virtual_memory.brk(core->get_mem_data(), addr.get_raw());
 
     return 0;
 }
@@ -1188,39 +1128,54 @@ int OsSyscallExceptionHandler::do_sys_brk(
 int OsSyscallExceptionHandler::do_sys_mmap(
     uint64_t &result,
     Core *core,
-    uint64_t syscall_num,
-    uint64_t a1,
-    uint64_t a2,
-    uint64_t a3,
-    uint64_t a4,
-    uint64_t a5,
-    uint64_t a6) {
-    (void)core;
-    (void)syscall_num;
-    (void)a1;
-    (void)a2;
-    (void)a3;
-    (void)a4;
-    (void)a5;
-    (void)a6;
-    // TODO: actually mmmap file, now that we can.
-
+    Address addr,
+    uint64_t length,
+    int prot,
+    int flags,
+    TargetFd targetfd,
+    uint64_t offset) {
     result = 0;
-    uint32_t addr = a1;
-    uint32_t lenght = a2;
-    uint32_t prot = a3;
-    uint32_t flags = a4;
-    uint32_t fd = a5;
-    uint64_t offset = a6;
-
-    printf(
-        "sys_mmap addr = 0x%08lx lenght= 0x%08lx prot = 0x%08lx flags = "
-        "0x%08lx fd = %d offset = 0x%08llx\n",
-        (unsigned long)addr, (unsigned long)lenght, (unsigned long)prot, (unsigned long)flags,
-        (int)fd, (unsigned long long)offset);
-
-    result = anonymous_last;
-    anonymous_last += lenght;
+    // RV32 Linux provides mmap2, the offset is given in 4 KiB units.
+    if (core->get_xlen() == Xlen::_32) { offset *= 4096; }
+
+    int fd = FD_UNUSED;
+    if (!(flags & TARGET_MAP_ANONYMOUS)) {
+        fd = targetfd_to_fd(targetfd.value);
+        if (fd == FD_INVALID) {
+            result = -TARGET_EBADF;
+            return 0;
+        }
+        if (fd == FD_TERMINAL) {
+            result = -TARGET_ENODEV;
+            return 0;
+        }
+    }
+
+    result = virtual_memory.mmap(
+        core->get_mem_data(), addr.get_raw(), length, prot, flags, fd, offset);
+
+    return 0;
+}
+
+// int munmap(void *addr, size_t length);
+int OsSyscallExceptionHandler::do_sys_munmap(
+    uint64_t &result,
+    Core *core,
+    Address addr,
+    uint64_t length) {
+    result = virtual_memory.munmap(core->get_mem_data(), addr.get_raw(), length);
+
+    return 0;
+}
+
+// int mprotect(void *addr, size_t len, int prot);
+int OsSyscallExceptionHandler::do_sys_mprotect(
+    uint64_t &result,
+    Core *,
+    Address addr,
+    uint64_t length,
+    int prot) {
+    result = virtual_memory.mprotect(addr.get_raw(), length, prot);
 
     return 0;
 }
@@ -8,17 +8,22 @@
 #include "machine/memory/frontend_memory.h"
 #include "machine/registers.h"
 #include "machine/simulator_exception.h"
+#include "host_io.h"
+#include "syscall_binding.h"
+#include "syscall_trace.h"
+#include "virtual_memory.h"
 
+#include <QByteArray>
 #include <QObject>
 #include <QString>
 #include <QVector>
+#include <functional>
+#include <memory>
+#include <vector>
 
 namespace osemu {
 
-#define OSSYCALL_HANDLER_DECLARE(name)                                                             \
-    int name(                                                                                      \
-        uint64_t &result, machine::Core *core, uint64_t syscall_num, uint64_t a1, uint64_t a2,     \
-        uint64_t a3, uint64_t a4, uint64_t a5, uint64_t a6)
+struct HostIoSegment;
 
 class OsSyscallExceptionHandler : public machine::ExceptionHandler {
     Q_OBJECT
@@ -26,7 +31,17 @@ public:
     explicit OsSyscallExceptionHandler(
         bool known_syscall_stop = false,
         bool unknown_syscall_stop = false,
-        QString fs_root = "");
+        QString fs_root = "",
+        machine::Xlen xlen = machine::Xlen::_32);
+    /**
+     * Emulates the system call requested by `ecall` at `inst_addr`.
+     *
+     * With `set_async_host_io` enabled, reads, writes and opens of host files run in a separate
+     * thread. While such a call is in progress the core is stalled (see `Core::stall_until`)
+     * until a step finds the result and delivers it. Timers, peripherals and the UI keep running
+     * in the meantime, the stalled steps count neither instructions nor cycles. Headless cores
+     * always complete the I/O synchronously.
+     */
     bool handle_exception(
         machine::Core *core,
         machine::Registers *regs,
@@ -35,29 +50,96 @@ public:
         machine::Address next_addr,
         machine::Address jump_branch_pc,
         machine::Address mem_ref_addr) override;
-    OSSYCALL_HANDLER_DECLARE(syscall_default_handler);
-    OSSYCALL_HANDLER_DECLARE(do_sys_exit);
-    OSSYCALL_HANDLER_DECLARE(do_sys_set_thread_area);
-    OSSYCALL_HANDLER_DECLARE(do_sys_writev);
-    OSSYCALL_HANDLER_DECLARE(do_sys_write);
-    OSSYCALL_HANDLER_DECLARE(do_sys_readv);
-    OSSYCALL_HANDLER_DECLARE(do_sys_read);
-    OSSYCALL_HANDLER_DECLARE(do_sys_openat);
-    OSSYCALL_HANDLER_DECLARE(do_sys_close);
-    OSSYCALL_HANDLER_DECLARE(do_sys_ftruncate);
-    OSSYCALL_HANDLER_DECLARE(do_sys_brk);
-    OSSYCALL_HANDLER_DECLARE(do_sys_mmap);
 
-    OSSYCALL_HANDLER_DECLARE(do_spim_print_integer);
-    OSSYCALL_HANDLER_DECLARE(do_spim_print_string);
-    OSSYCALL_HANDLER_DECLARE(do_spim_read_string);
-    OSSYCALL_HANDLER_DECLARE(do_spim_sbrk);
-    OSSYCALL_HANDLER_DECLARE(do_spim_exit);
-    OSSYCALL_HANDLER_DECLARE(do_spim_print_character);
-    OSSYCALL_HANDLER_DECLARE(do_spim_read_character);
+    /**
+     * Stores the descriptor table, the program break and the memory mappings of the emulated
+     * process. Descriptors of host files cannot be carried to another run, so a checkpoint is
+     * refused while the program has a host file open or host I/O in progress. Descriptors of the
+     * terminal and closed descriptors are stored.
+     */
+    void save_checkpoint(QDataStream &out) const override;
+    void load_checkpoint(QDataStream &in) override;
+
+    /**
+     * Runs host file I/O of cores which are not headless in a separate thread, so the interactive
+     * UI does not freeze on a blocking host operation. Disabled by default.
+     */
+    void set_async_host_io(bool enable);
+
+    /**
+     * Sets receiver of handled system calls, null disables tracing. Tracing is off by
+     * default, programs doing a lot of I/O are not slowed down by it.
+     */
+    void set_trace_sink(std::shared_ptr<SyscallTraceSink> sink);
+
+    // Handlers of implemented system calls, bound to the dispatch table by `SyscallBinding`.
+    // Parameters after `core` are the arguments of the call.
+    int syscall_default_handler(uint64_t &result, machine::Core *core);
+    int do_sys_exit(uint64_t &result, machine::Core *core, int status);
+    int do_sys_writev(
+        uint64_t &result,
+        machine::Core *core,
+        TargetFd fd,
+        machine::Address iov,
+        int iovcnt);
+    int do_sys_write(
+        uint64_t &result,
+        machine::Core *core,
+        TargetFd fd,
+        machine::Address buf,
+        uint64_t count);
+    int do_sys_readv(
+        uint64_t &result,
+        machine::Core *core,
+        TargetFd fd,
+        machine::Address iov,
+        int iovcnt);
+    int do_sys_read(
+        uint64_t &result,
+        machine::Core *core,
+        TargetFd fd,
+        machine::Address buf,
+        uint64_t count);
+    int do_sys_openat(
+        uint64_t &result,
+        machine::Core *core,
+        TargetFd dirfd,
+        machine::Address pathname,
+        int flags,
+        int mode);
+    int do_sys_close(uint64_t &result, machine::Core *core, TargetFd fd);
+    /** RV32 passes the 64-bit length in two registers, `length_high` is unused on RV64. */
+    int do_sys_ftruncate(
+        uint64_t &result,
+        machine::Core *core,
+        TargetFd fd,
+        uint64_t length,
+        uint64_t length_high);
+    int do_sys_brk(uint64_t &result, machine::Core *core, machine::Address addr);
+    int do_sys_mmap(
+        uint64_t &result,
+        machine::Core *core,
+        machine::Address addr,
+        uint64_t length,
+        int prot,
+        int flags,
+        TargetFd fd,
+        uint64_t offset);
+    int do_sys_munmap(
+        uint64_t &result,
+        machine::Core *core,
+        machine::Address addr,
+        uint64_t length);
+    int do_sys_mprotect(
+        uint64_t &result,
+        machine::Core *core,
+        machine::Address addr,
+        uint64_t length,
+        int prot);
 
 signals:
-    void char_written(int fd, unsigned int val);
+    /** Data written to the terminal, long writes are delivered in several chunks. */
+    void data_written(int fd, const QByteArray &data);
     void rx_byte_pool(int fd, unsigned int &data, bool &available);
 
 private:
@@ -66,6 +148,44 @@ private:
         FD_INVALID = -1,
         FD_TERMINAL = -2,
     };
+    /** Largest chunk of terminal output delivered by a single `data_written` signal. */
+    static constexpr uint32_t TERMINAL_CHUNK_SIZE = 4096;
+    /** Status of a handler which started host I/O, the call completes in a later step. */
+    static constexpr int SYSCALL_PENDING = -0x10000;
+    /**
+     * Time the step starting host I/O waits for it, ordinary file accesses finish within it and
+     * the core is not stalled at all. Stalled steps only poll.
+     */
+    static constexpr unsigned long HOST_IO_START_WAIT_MS = 5;
+    /** Finishes started host I/O in the simulation thread, gets the result of the job. */
+    using HostIoCompletion = std::function<int(uint64_t &result, int64_t io_result)>;
+    /**
+     * Runs `job` in the host I/O thread, returns `SYSCALL_PENDING` for the handler when it does
+     * not finish soon. Without asynchronous I/O the job and its completion run right away.
+     */
+    int start_host_io(
+        machine::Core *core,
+        uint64_t &result,
+        HostIoThread::Job job,
+        HostIoCompletion completion);
+    int finish_host_io(uint64_t &result);
+    /** Reads or writes the guest `segments` from/to host file `fd` (see `start_host_io`). */
+    int start_host_transfer(
+        machine::Core *core,
+        uint64_t &result,
+        machine::FrontendMemory *mem,
+        int fd,
+        std::vector<HostIoSegment> segments,
+        bool write_to_host);
+    /** Stores the result of system call `syscall_num` issued by `ecall` at `inst_addr`. */
+    void complete_syscall(
+        machine::Core *core,
+        machine::Registers *regs,
+        machine::Address inst_addr,
+        uint64_t syscall_num,
+        const SyscallArgs &args,
+        int status,
+        uint64_t result);
     int32_t write_mem(
         machine::FrontendMemory *mem,
         machine::Address addr,
@@ -79,22 +199,22 @@ private:
     int32_t write_io(int fd, const QVector<uint8_t> &data, uint32_t count);
     int32_t read_io(int fd, QVector<uint8_t> &data, uint32_t count, bool add_nl_at_eof = false);
     int allocate_fd(int val = FD_UNUSED);
-    int file_open(QString fname, int flags, int mode);
     int targetfd_to_fd(int targetfd);
     void close_fd(int targetfd);
     QString filepath_to_host(QString path);
 
     QVector<int> fd_mapping;
-    uint32_t brk_limit;
-    uint32_t anonymous_base;
-    uint32_t anonymous_last;
+    VirtualMemoryManager virtual_memory;
     bool known_syscall_stop;
     bool unknown_syscall_stop;
     QString fs_root;
+    std::shared_ptr<SyscallTraceSink> trace_sink;
+    /** Blocking operations on host files, terminal I/O stays in the simulation thread. */
+    HostIoThread host_io;
+    HostIoCompletion host_io_completion;
+    bool async_host_io = false;
 };
 
-#undef OSSYCALL_HANDLER_DECLARE
-
 } // namespace osemu
 
 #endif // OSSYCALL_H
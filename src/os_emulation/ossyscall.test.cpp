@@ -0,0 +1,278 @@
+#include "ossyscall.test.h"
+
+#include "machine/core.h"
+#include "machine/memory/backend/memory.h"
+#include "machine/memory/memory_bus.h"
+#include "machine/predictor.h"
+#include "ossyscall.h"
+#include "target_errno.h"
+
+#include <QBuffer>
+#include <QElapsedTimer>
+#include <QTemporaryDir>
+#include <QThread>
+
+#ifndef _WIN32
+    #include <fcntl.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+using namespace machine;
+using namespace osemu;
+
+static void compile_program(FrontendMemory &memory, Address pc, const QStringList &program) {
+    uint32_t code[2];
+    for (const QString &instruction : program) {
+        const size_t size = Instruction::code_from_string(code, 8, instruction, pc);
+        for (size_t i = 0; i < size; i += 4, pc += 4) {
+            memory.write_u32(pc, code[i]);
+        }
+    }
+}
+
+#ifndef _WIN32
+
+/** Opens the FIFO at `path` for writing after `delay_ms` and writes "abcd" into it. */
+class FifoWriter : public QThread {
+public:
+    FifoWriter(QString path, unsigned long delay_ms) : path(std::move(path)), delay_ms(delay_ms) {}
+
+protected:
+    void run() override {
+        msleep(delay_ms);
+        const int fd = open(path.toLocal8Bit().constData(), O_WRONLY);
+        if (fd < 0) { return; }
+        if (write(fd, "abcd", 4) != 4) { qWarning("FIFO write failed"); }
+        close(fd);
+    }
+
+private:
+    const QString path;
+    const unsigned long delay_ms;
+};
+
+struct HostIoRun {
+    uint64_t instret = 0;
+    uint64_t mcycle = 0;
+    uint64_t cycles = 0;
+    uint32_t data = 0;
+    bool stalled = false;
+};
+
+/** Runs a program opening and reading the FIFO `/pipe`, its writer waits `delay_ms`. */
+static HostIoRun run_fifo_read(const QTemporaryDir &root, unsigned long delay_ms) {
+    Memory memory_backend(LITTLE);
+    TrivialBus memory(&memory_backend);
+    Registers registers {};
+    BranchPredictor predictor {};
+    CSR::ControlState controlst {};
+    CoreSingle core(
+        &registers, &predictor, &memory, &memory, &controlst, Xlen::_32, config_isa_word_default);
+    OsSyscallExceptionHandler handler(false, false, root.path());
+    handler.set_async_host_io(true);
+    for (auto excause : { EXCAUSE_ECALL_ANY, EXCAUSE_ECALL_M, EXCAUSE_ECALL_S, EXCAUSE_ECALL_U }) {
+        core.register_exception_handler(excause, &handler);
+        core.set_stop_on_exception(excause, false);
+    }
+
+    memory.write_span(0x400_addr, "/pipe", 6);
+    compile_program(
+        memory, 0x200_addr,
+        { "addi a0, zero, -100", "addi a1, zero, 0x400", "addi a2, zero, 0", "addi a3, zero, 0",
+          "addi a7, zero, 56", "ecall", "addi a1, zero, 0x500", "addi a2, zero, 4",
+          "addi a7, zero, 63", "ecall" });
+    const Address end = 0x228_addr;
+    registers.write_pc(0x200_addr);
+
+    FifoWriter writer(root.filePath("pipe"), delay_ms);
+    writer.start();
+    HostIoRun run;
+    QElapsedTimer timer;
+    timer.start();
+    while (registers.read_pc() != end && timer.elapsed() < 10000) {
+        core.step();
+        run.stalled |= core.is_stalled();
+    }
+    writer.wait();
+    run.instret = controlst.read_internal(CSR::Id::MINSTRET).as_u64();
+    run.mcycle = controlst.read_internal(CSR::Id::MCYCLE).as_u64();
+    run.cycles = core.get_cycle_count();
+    run.data = memory.read_u32(0x500_addr);
+    return run;
+}
+
+#endif
+
+void TestOsSyscall::host_io_instret_independent_of_host_time() {
+#ifdef _WIN32
+    QSKIP("FIFOs are not available on this platform.");
+#else
+    QTemporaryDir root;
+    QVERIFY(root.isValid());
+    QCOMPARE(mkfifo(root.filePath("pipe").toLocal8Bit().constData(), 0600), 0);
+
+    const HostIoRun fast = run_fifo_read(root, 0);
+    const HostIoRun slow = run_fifo_read(root, 200);
+    // Opening the FIFO blocks until the writer comes, the core has to wait for it.
+    QVERIFY(slow.stalled);
+    QCOMPARE(slow.data, fast.data);
+    QCOMPARE(fast.data, (uint32_t)0x64636261);
+    QCOMPARE(slow.instret, fast.instret);
+    QCOMPARE(slow.mcycle, fast.mcycle);
+    QCOMPARE(slow.cycles, fast.cycles);
+#endif
+}
+
+/** Keeps traced system calls for inspection. */
+class RecordingTrace : public SyscallTraceSink {
+public:
+    void syscall_handled(const SyscallTraceRecord &record) override { records.push_back(record); }
+    std::vector<SyscallTraceRecord> records;
+};
+
+void TestOsSyscall::syscall_dispatch_trace() {
+    Memory memory_backend(LITTLE);
+    TrivialBus memory(&memory_backend);
+    Registers registers {};
+    BranchPredictor predictor {};
+    CSR::ControlState controlst {};
+    CoreSingle core(
+        &registers, &predictor, &memory, &memory, &controlst, Xlen::_32, config_isa_word_default);
+    OsSyscallExceptionHandler handler;
+    auto trace = std::make_shared<RecordingTrace>();
+    handler.set_trace_sink(trace);
+    QByteArray written;
+    QObject::connect(
+        &handler, &OsSyscallExceptionHandler::data_written,
+        [&written](int, const QByteArray &data) { written += data; });
+    for (auto excause : { EXCAUSE_ECALL_ANY, EXCAUSE_ECALL_M, EXCAUSE_ECALL_S, EXCAUSE_ECALL_U }) {
+        core.register_exception_handler(excause, &handler);
+        core.set_stop_on_exception(excause, false);
+    }
+
+    memory.write_span(0x400_addr, "abc", 3);
+    compile_program(
+        memory, 0x200_addr,
+        { "addi a0, zero, 1", "addi a1, zero, 0x400", "addi a2, zero, 3", "addi a7, zero, 64",
+          "ecall", "addi a0, zero, -1", "addi a1, zero, 16", "addi a7, zero, 0", "ecall",
+          "addi a0, zero, 0", "addi a7, zero, 214", "ecall" });
+    registers.write_pc(0x200_addr);
+    while (registers.read_pc() != 0x230_addr) {
+        core.step();
+    }
+
+    QCOMPARE(written, QByteArray("abc"));
+    QCOMPARE(trace->records.size(), (size_t)3);
+
+    const SyscallTraceRecord &write = trace->records[0];
+    QCOMPARE(write.pc, 0x210_addr);
+    QCOMPARE(write.number, (uint64_t)64);
+    QCOMPARE(QByteArray(write.name), QByteArray("write"));
+    QVERIFY(write.implemented);
+    QCOMPARE(write.arg_count, 3U);
+    QVERIFY(write.arg_kinds != nullptr);
+    QCOMPARE(write.arg_kinds[0], SyscallArgKind::FD);
+    QCOMPARE(write.arg_kinds[1], SyscallArgKind::ADDRESS);
+    QCOMPARE(write.arg_kinds[2], SyscallArgKind::UNSIGNED);
+    QCOMPARE(write.args[1], (uint64_t)0x400);
+    QCOMPARE(write.result, (int64_t)3);
+
+    // Arguments are truncated to XLEN, unimplemented calls have raw arguments and return zero.
+    const SyscallTraceRecord &unknown = trace->records[1];
+    QCOMPARE(QByteArray(unknown.name), QByteArray("io_setup"));
+    QVERIFY(!unknown.implemented);
+    QCOMPARE(unknown.arg_count, 2U);
+    QVERIFY(unknown.arg_kinds == nullptr);
+    QCOMPARE(unknown.args[0], (uint64_t)0xffffffff);
+    QCOMPARE(unknown.args[1], (uint64_t)16);
+    QCOMPARE(unknown.result, (int64_t)0);
+
+    const SyscallTraceRecord &brk = trace->records[2];
+    QCOMPARE(QByteArray(brk.name), QByteArray("brk"));
+    QCOMPARE(brk.arg_kinds[0], SyscallArgKind::ADDRESS);
+    QCOMPARE(brk.result, (int64_t)0);
+    QCOMPARE(registers.read_gp(10).as_u32(), 0U);
+}
+
+static QByteArray save_handler(const OsSyscallExceptionHandler &handler) {
+    QByteArray data;
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::WriteOnly);
+    QDataStream out(&buffer);
+    handler.save_checkpoint(out);
+    return data;
+}
+
+void TestOsSyscall::osemu_checkpoint() {
+    QTemporaryDir root;
+    QVERIFY(root.isValid());
+    QFile file(root.filePath("data"));
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.close();
+
+    Memory memory_backend(LITTLE);
+    TrivialBus memory(&memory_backend);
+    Registers registers {};
+    BranchPredictor predictor {};
+    CSR::ControlState controlst {};
+    CoreSingle core(
+        &registers, &predictor, &memory, &memory, &controlst, Xlen::_32, config_isa_word_default);
+    OsSyscallExceptionHandler handler(false, false, root.path());
+    for (auto excause : { EXCAUSE_ECALL_ANY, EXCAUSE_ECALL_M, EXCAUSE_ECALL_S, EXCAUSE_ECALL_U }) {
+        core.register_exception_handler(excause, &handler);
+        core.set_stop_on_exception(excause, false);
+    }
+
+    // Opens the host file, then closes it and the standard output and sets the program break.
+    memory.write_span(0x400_addr, "/data", 6);
+    compile_program(
+        memory, 0x200_addr,
+        { "addi a0, zero, -100", "addi a1, zero, 0x400", "addi a2, zero, 0", "addi a3, zero, 0",
+          "addi a7, zero, 56", "ecall", "addi a7, zero, 57", "ecall", "addi a0, zero, 1", "ecall",
+          "lui a0, 0x12", "addi a7, zero, 214", "ecall" });
+    registers.write_pc(0x200_addr);
+    while (registers.read_pc() != 0x218_addr) {
+        core.step();
+    }
+    QCOMPARE(registers.read_gp(10).as_u32(), 3U);
+
+    // Host file descriptor cannot be stored.
+    bool thrown = false;
+    try {
+        (void)save_handler(handler);
+    } catch (SimulatorExceptionInput &) { thrown = true; }
+    QVERIFY(thrown);
+
+    while (registers.read_pc() != 0x234_addr) {
+        core.step();
+    }
+    const QByteArray data = save_handler(handler);
+
+    // Restored handler has the standard output closed and continues with the same heap.
+    Registers restored_registers {};
+    CSR::ControlState restored_controlst {};
+    CoreSingle restored_core(
+        &restored_registers, &predictor, &memory, &memory, &restored_controlst, Xlen::_32,
+        config_isa_word_default);
+    OsSyscallExceptionHandler restored(false, false, root.path());
+    QDataStream in(data);
+    restored.load_checkpoint(in);
+    QCOMPARE(save_handler(restored), data);
+    for (auto excause : { EXCAUSE_ECALL_ANY, EXCAUSE_ECALL_M, EXCAUSE_ECALL_S, EXCAUSE_ECALL_U }) {
+        restored_core.register_exception_handler(excause, &restored);
+        restored_core.set_stop_on_exception(excause, false);
+    }
+    compile_program(
+        memory, 0x300_addr,
+        { "addi a0, zero, 1", "addi a1, zero, 0x400", "addi a2, zero, 4", "addi a7, zero, 64",
+          "ecall", "addi s0, a0, 0", "addi a0, zero, 0", "addi a7, zero, 214", "ecall" });
+    restored_registers.write_pc(0x300_addr);
+    while (restored_registers.read_pc() != 0x324_addr) {
+        restored_core.step();
+    }
+    QCOMPARE(restored_registers.read_gp(8).as_u32(), (uint32_t)-TARGET_EINVAL);
+    QCOMPARE(restored_registers.read_gp(10).as_u32(), 0x12000U);
+}
+
+QTEST_APPLESS_MAIN(TestOsSyscall)
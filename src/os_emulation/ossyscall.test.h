@@ -0,0 +1,14 @@
+#ifndef OSSYSCALL_TEST_H
+#define OSSYSCALL_TEST_H
+
+#include <QtTest>
+
+class TestOsSyscall : public QObject {
+    Q_OBJECT
+private slots:
+    static void host_io_instret_independent_of_host_time();
+    static void syscall_dispatch_trace();
+    static void osemu_checkpoint();
+};
+
+#endif // OSSYSCALL_TEST_H
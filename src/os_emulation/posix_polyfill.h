@@ -13,6 +13,7 @@
 #define close _close
 #define read _read
 #define write _write
+#define lseek _lseeki64
 #define ftruncate _chsize_s
 
 #endif // _WIN32
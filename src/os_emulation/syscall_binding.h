@@ -0,0 +1,114 @@
+#ifndef SYSCALL_BINDING_H
+#define SYSCALL_BINDING_H
+
+#include "machine/core.h"
+#include "machine/memory/address.h"
+#include "syscall_trace.h"
+
+#include <array>
+#include <cstdint>
+#include <utility>
+
+namespace osemu {
+
+/** File descriptor of the emulated process, handlers map it to the host one. */
+struct TargetFd {
+    int value;
+};
+
+/** Argument registers of a system call, truncated to XLEN. */
+using SyscallArgs = std::array<uint64_t, SYSCALL_MAX_ARGS>;
+
+/**
+ * Extraction of a handler parameter of type `T` from its argument register.
+ *
+ * Registers are truncated to XLEN once by the dispatcher, so the extraction is a plain
+ * conversion inlined into the generated call.
+ */
+template<typename T>
+struct SyscallArgument;
+
+template<>
+struct SyscallArgument<int> {
+    static constexpr SyscallArgKind KIND = SyscallArgKind::INT;
+    static int get(uint64_t value) { return (int32_t)value; }
+};
+
+template<>
+struct SyscallArgument<uint64_t> {
+    static constexpr SyscallArgKind KIND = SyscallArgKind::UNSIGNED;
+    static uint64_t get(uint64_t value) { return value; }
+};
+
+template<>
+struct SyscallArgument<machine::Address> {
+    static constexpr SyscallArgKind KIND = SyscallArgKind::ADDRESS;
+    static machine::Address get(uint64_t value) { return machine::Address(value); }
+};
+
+template<>
+struct SyscallArgument<TargetFd> {
+    static constexpr SyscallArgKind KIND = SyscallArgKind::FD;
+    static TargetFd get(uint64_t value) { return { (int32_t)value }; }
+};
+
+/** Handler of a system call bound to its typed implementation (see `SyscallBinding`). */
+template<typename HANDLER_CLASS>
+struct SyscallEntry {
+    using Call
+        = int (*)(HANDLER_CLASS &, uint64_t &result, machine::Core *, const SyscallArgs &);
+
+    Call call;
+    /** Parameters of the handler, may differ from the arguments of the call (see ftruncate). */
+    unsigned arg_count;
+    const SyscallArgKind *arg_kinds;
+};
+
+/**
+ * Binds a handler `int CLASS::method(uint64_t &result, Core *core, ARGS... args)` to the
+ * uniform call of the dispatch table.
+ *
+ * Each parameter is extracted from the argument register of the same position by
+ * `SyscallArgument`. The wrapper is generated for each handler, so the dispatch is one
+ * indirect call without any per argument decisions at run time.
+ */
+template<auto HANDLER>
+struct SyscallBinding;
+
+template<
+    typename HANDLER_CLASS,
+    typename... ARGS,
+    int (HANDLER_CLASS::*HANDLER)(uint64_t &, machine::Core *, ARGS...)>
+struct SyscallBinding<HANDLER> {
+    static_assert(sizeof...(ARGS) <= SYSCALL_MAX_ARGS, "System call has too many arguments.");
+
+    /** Sentinel keeps the array non-empty for handlers without arguments. */
+    static constexpr SyscallArgKind ARG_KINDS[sizeof...(ARGS) + 1]
+        = { SyscallArgument<ARGS>::KIND..., SyscallArgKind::RAW };
+
+    static int call(
+        HANDLER_CLASS &handler,
+        uint64_t &result,
+        machine::Core *core,
+        const SyscallArgs &args) {
+        return invoke(handler, result, core, args, std::index_sequence_for<ARGS...>());
+    }
+
+    static constexpr SyscallEntry<HANDLER_CLASS> ENTRY = { &call, sizeof...(ARGS), ARG_KINDS };
+
+private:
+    template<size_t... INDEX>
+    static int invoke(
+        HANDLER_CLASS &handler,
+        uint64_t &result,
+        machine::Core *core,
+        const SyscallArgs &args,
+        std::index_sequence<INDEX...>) {
+        (void)args;
+        return (handler.*HANDLER)(result, core, SyscallArgument<ARGS>::get(args[INDEX])...);
+    }
+};
+
+} // namespace osemu
+
+#endif // SYSCALL_BINDING_H
@@ -0,0 +1,26 @@
+#include "syscall_trace.h"
+
+#include <cinttypes>
+
+using namespace osemu;
+
+SyscallTextTrace::SyscallTextTrace(FILE *stream) : stream(stream) {}
+
+void SyscallTextTrace::syscall_handled(const SyscallTraceRecord &record) {
+    fprintf(stream, "[0x%08" PRIx64 "] %s(", record.pc.get_raw(), record.name);
+    for (unsigned i = 0; i < record.arg_count; i++) {
+        const SyscallArgKind kind
+            = (record.arg_kinds != nullptr) ? record.arg_kinds[i] : SyscallArgKind::RAW;
+        const uint64_t value = record.args[i];
+        if (i > 0) { fputs(", ", stream); }
+        switch (kind) {
+        case SyscallArgKind::INT:
+        case SyscallArgKind::FD: fprintf(stream, "%d", (int)(int32_t)value); break;
+        case SyscallArgKind::UNSIGNED: fprintf(stream, "%" PRIu64, value); break;
+        case SyscallArgKind::ADDRESS: fprintf(stream, "0x%08" PRIx64, value); break;
+        case SyscallArgKind::RAW: fprintf(stream, "0x%" PRIx64, value); break;
+        }
+    }
+    fprintf(stream, ") = %" PRId64 "%s\n", record.result,
+            record.implemented ? "" : " (unimplemented)");
+}
@@ -0,0 +1,70 @@
+#ifndef SYSCALL_TRACE_H
+#define SYSCALL_TRACE_H
+
+#include "machine/memory/address.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+namespace osemu {
+
+/** Most arguments of a system call, passed in registers `a0` to `a5`. */
+constexpr size_t SYSCALL_MAX_ARGS = 6;
+
+/** Meaning of a system call argument, selects its extraction and presentation. */
+enum class SyscallArgKind : uint8_t {
+    RAW,      //> Register value of unknown meaning (e.g. unimplemented system call)
+    INT,      //> Signed 32-bit integer
+    UNSIGNED, //> XLEN wide unsigned integer (sizes, lengths, offsets)
+    ADDRESS,  //> XLEN wide guest address
+    FD,       //> Target file descriptor
+};
+
+/** Emulated system call after it was handled. */
+struct SyscallTraceRecord {
+    /** Address of the `ecall` instruction. */
+    machine::Address pc;
+    uint64_t number = 0;
+    const char *name = nullptr;
+    /** False for calls not implemented by the emulation, they do nothing and return zero. */
+    bool implemented = false;
+    unsigned arg_count = 0;
+    /** Kinds of the first `arg_count` arguments, all are `RAW` when null. */
+    const SyscallArgKind *arg_kinds = nullptr;
+    /** Argument registers truncated to XLEN. */
+    std::array<uint64_t, SYSCALL_MAX_ARGS> args {};
+    /** Value returned to the program, sign extended from XLEN. */
+    int64_t result = 0;
+};
+
+/**
+ * Receiver of traced system calls (see `OsSyscallExceptionHandler::set_trace_sink`).
+ *
+ * Records are delivered synchronously from the simulation thread, the sink has to be cheap
+ * when simulated programs make many calls.
+ */
+class SyscallTraceSink {
+public:
+    virtual ~SyscallTraceSink() = default;
+    virtual void syscall_handled(const SyscallTraceRecord &record) = 0;
+};
+
+/**
+ * Prints one line per system call in the style of strace, e.g.
+ *
+ *     [0x00010094] write(1, 0x000110a8, 13) = 13
+ */
+class SyscallTextTrace final : public SyscallTraceSink {
+public:
+    explicit SyscallTextTrace(FILE *stream = stdout);
+    void syscall_handled(const SyscallTraceRecord &record) override;
+
+private:
+    FILE *stream;
+};
+
+} // namespace osemu
+
+#endif // SYSCALL_TRACE_H
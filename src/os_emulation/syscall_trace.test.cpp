@@ -0,0 +1,123 @@
+#include "syscall_trace.test.h"
+
+#include "syscall_binding.h"
+#include "syscall_trace.h"
+
+#include <cstdio>
+
+using namespace machine;
+using namespace osemu;
+
+/** Handler recording the converted arguments of its calls. */
+struct BindingProbe {
+    int value = 0;
+    uint64_t size = 0;
+    Address address {};
+    int fd = 0;
+
+    int handler(
+        uint64_t &result,
+        Core *core,
+        int value,
+        uint64_t size,
+        Address address,
+        TargetFd fd) {
+        (void)core;
+        this->value = value;
+        this->size = size;
+        this->address = address;
+        this->fd = fd.value;
+        result = 42;
+        return -7;
+    }
+
+    int no_arguments(uint64_t &result, Core *core) {
+        (void)core;
+        result = 1;
+        return 0;
+    }
+};
+
+void TestSyscallTrace::syscall_binding_arguments() {
+    using Binding = SyscallBinding<&BindingProbe::handler>;
+    const SyscallEntry<BindingProbe> &entry = Binding::ENTRY;
+    QCOMPARE(entry.arg_count, 4U);
+    QCOMPARE(entry.arg_kinds[0], SyscallArgKind::INT);
+    QCOMPARE(entry.arg_kinds[1], SyscallArgKind::UNSIGNED);
+    QCOMPARE(entry.arg_kinds[2], SyscallArgKind::ADDRESS);
+    QCOMPARE(entry.arg_kinds[3], SyscallArgKind::FD);
+
+    // Integers and descriptors take the low 32 bits, other kinds the whole register.
+    BindingProbe probe;
+    uint64_t result = 0;
+    const SyscallArgs args = { 0x1fffffffe, UINT64_MAX, 0x123456789a, 0xffffffff80000003, 5, 6 };
+    QCOMPARE(entry.call(probe, result, nullptr, args), -7);
+    QCOMPARE(result, (uint64_t)42);
+    QCOMPARE(probe.value, -2);
+    QCOMPARE(probe.size, UINT64_MAX);
+    QCOMPARE(probe.address, 0x123456789a_addr);
+    QCOMPARE(probe.fd, INT32_MIN + 3);
+
+    const SyscallEntry<BindingProbe> &empty = SyscallBinding<&BindingProbe::no_arguments>::ENTRY;
+    QCOMPARE(empty.arg_count, 0U);
+    QCOMPARE(empty.call(probe, result, nullptr, args), 0);
+    QCOMPARE(result, (uint64_t)1);
+}
+
+/** Lines printed by `SyscallTextTrace` for the records. */
+static QByteArray text_trace(std::initializer_list<SyscallTraceRecord> records) {
+    FILE *stream = tmpfile();
+    if (stream == nullptr) { return {}; }
+    SyscallTextTrace trace(stream);
+    for (const SyscallTraceRecord &record : records) {
+        trace.syscall_handled(record);
+    }
+    QByteArray text;
+    char buffer[256];
+    rewind(stream);
+    while (fgets(buffer, sizeof(buffer), stream) != nullptr) {
+        text.append(buffer);
+    }
+    fclose(stream);
+    return text;
+}
+
+void TestSyscallTrace::syscall_text_trace() {
+    static constexpr SyscallArgKind WRITE_KINDS[]
+        = { SyscallArgKind::FD, SyscallArgKind::ADDRESS, SyscallArgKind::UNSIGNED };
+    static constexpr SyscallArgKind EXIT_KINDS[] = { SyscallArgKind::INT };
+
+    SyscallTraceRecord write;
+    write.pc = 0x10094_addr;
+    write.number = 64;
+    write.name = "write";
+    write.implemented = true;
+    write.arg_count = 3;
+    write.arg_kinds = WRITE_KINDS;
+    write.args = { 1, 0x110a8, 13, 0, 0, 0 };
+    write.result = 13;
+
+    SyscallTraceRecord unknown;
+    unknown.pc = 0x200_addr;
+    unknown.number = 0;
+    unknown.name = "io_setup";
+    unknown.arg_count = 2;
+    unknown.args = { 0xffffffff, 0x10, 0, 0, 0, 0 };
+
+    SyscallTraceRecord exit;
+    exit.pc = 0x204_addr;
+    exit.number = 93;
+    exit.name = "exit";
+    exit.implemented = true;
+    exit.arg_count = 1;
+    exit.arg_kinds = EXIT_KINDS;
+    exit.args = { 0xfffffff6, 0, 0, 0, 0, 0 };
+
+    QCOMPARE(
+        text_trace({ write, unknown, exit }),
+        QByteArray("[0x00010094] write(1, 0x000110a8, 13) = 13\n"
+                   "[0x00000200] io_setup(0xffffffff, 0x10) = 0 (unimplemented)\n"
+                   "[0x00000204] exit(-10) = 0\n"));
+}
+
+QTEST_APPLESS_MAIN(TestSyscallTrace)
@@ -0,0 +1,13 @@
+#ifndef SYSCALL_TRACE_TEST_H
+#define SYSCALL_TRACE_TEST_H
+
+#include <QtTest>
+
+class TestSyscallTrace : public QObject {
+    Q_OBJECT
+private slots:
+    static void syscall_binding_arguments();
+    static void syscall_text_trace();
+};
+
+#endif // SYSCALL_TRACE_TEST_H
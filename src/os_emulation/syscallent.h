@@ -5,7 +5,7 @@
  * SPDX-License-Identifier: LGPL-2.1-or-later
  */
 
-#define HANDLER(syscall) &OsSyscallExceptionHandler::syscall
+#define HANDLER(syscall) SyscallBinding<&OsSyscallExceptionHandler::syscall>::ENTRY
 
 [0] = { 2, HANDLER(syscall_default_handler), "io_setup" },
     [1] = { 1, HANDLER(syscall_default_handler), "io_destroy" },
@@ -219,7 +219,7 @@
     [212] = { 3, HANDLER(syscall_default_handler), "recvmsg" },
     [213] = { 3, HANDLER(syscall_default_handler), "readahead" },
     [214] = { 1, HANDLER(do_sys_brk), "brk" },
-    [215] = { 2, HANDLER(syscall_default_handler), "munmap" },
+    [215] = { 2, HANDLER(do_sys_munmap), "munmap" },
     [216] = { 5, HANDLER(syscall_default_handler), "mremap" },
     [217] = { 5, HANDLER(syscall_default_handler), "add_key" },
     [218] = { 4, HANDLER(syscall_default_handler), "request_key" },
@@ -230,7 +230,7 @@
     [223] = { 4, HANDLER(syscall_default_handler), "fadvise64" },
     [224] = { 2, HANDLER(syscall_default_handler), "swapon" },
     [225] = { 1, HANDLER(syscall_default_handler), "swapoff" },
-    [226] = { 3, HANDLER(syscall_default_handler), "mprotect" },
+    [226] = { 3, HANDLER(do_sys_mprotect), "mprotect" },
     [227] = { 3, HANDLER(syscall_default_handler), "msync" },
     [228] = { 2, HANDLER(syscall_default_handler), "mlock" },
     [229] = { 2, HANDLER(syscall_default_handler), "munlock" },
@@ -0,0 +1,277 @@
+#include "virtual_memory.h"
+
+#include "machine/checkpoint.h"
+#include "posix_polyfill.h"
+#include "target_errno.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <iterator>
+#include <vector>
+
+using namespace machine;
+using namespace osemu;
+
+/** Largest part of a file copied to the guest memory at once. */
+static constexpr uint64_t FILE_CHUNK_SIZE = 64 * 1024;
+
+static uint64_t page_align_up(uint64_t value) {
+    return (value + VirtualMemoryManager::PAGE_SIZE - 1) & ~(VirtualMemoryManager::PAGE_SIZE - 1);
+}
+
+VirtualMemoryManager::VirtualMemoryManager(Xlen xlen)
+    : VirtualMemoryManager(
+        (xlen == Xlen::_64) ? MMAP_BASE_64 : MMAP_BASE_32,
+        ((xlen == Xlen::_64) ? RAM_HIGH_LAST_ADDR : RAM_LAST_ADDR).get_raw() + 1,
+        RAM_LAST_ADDR.get_raw() + 1,
+        (xlen == Xlen::_64) ? RAM_HIGH_START_ADDR.get_raw() : RAM_LAST_ADDR.get_raw() + 1) {}
+
+VirtualMemoryManager::VirtualMemoryManager(
+    uint64_t mmap_base,
+    uint64_t limit,
+    uint64_t hole_start,
+    uint64_t hole_end)
+    : mmap_base(mmap_base)
+    , limit(limit)
+    , hole_start(hole_start)
+    , hole_end(hole_end) {}
+
+uint64_t VirtualMemoryManager::brk(FrontendMemory *mem, uint64_t new_break) {
+    if (new_break == 0 || new_break >= limit) { return program_break; }
+    if (heap_start == 0) {
+        heap_start = new_break;
+        program_break = new_break;
+        return program_break;
+    }
+    if (new_break < heap_start) { return program_break; }
+    const uint64_t old_end = page_align_up(program_break);
+    const uint64_t new_end = page_align_up(new_break);
+    if (new_end > old_end) {
+        // Heap can grow only into unmapped pages.
+        if (overlapping_mapping_end(old_end, new_end - old_end) != 0
+            || overlaps_hole(old_end, new_end - old_end)) {
+            return program_break;
+        }
+    } else if (new_end < old_end) {
+        mem->discard_span(Address(new_end), old_end - new_end);
+    }
+    program_break = new_break;
+    return program_break;
+}
+
+int64_t VirtualMemoryManager::mmap(
+    FrontendMemory *mem,
+    uint64_t addr,
+    uint64_t length,
+    int prot,
+    int flags,
+    int host_fd,
+    uint64_t offset) {
+    const int type = flags & TARGET_MAP_TYPE;
+    if (length == 0 || offset % PAGE_SIZE != 0
+        || (type != TARGET_MAP_SHARED && type != TARGET_MAP_PRIVATE
+            && type != TARGET_MAP_SHARED_VALIDATE)) {
+        return -TARGET_EINVAL;
+    }
+    if (length > limit) { return -TARGET_ENOMEM; }
+    const uint64_t size = page_align_up(length);
+
+    uint64_t start;
+    if (flags & (TARGET_MAP_FIXED | TARGET_MAP_FIXED_NOREPLACE)) {
+        if (addr % PAGE_SIZE != 0) { return -TARGET_EINVAL; }
+        if (addr > limit - size || overlaps_hole(addr, size)) { return -TARGET_ENOMEM; }
+        if ((flags & TARGET_MAP_FIXED_NOREPLACE) && overlapping_mapping_end(addr, size) != 0) {
+            return -TARGET_EEXIST;
+        }
+        start = addr;
+    } else {
+        start = find_free(addr, size);
+        if (start == 0) { return -TARGET_ENOMEM; }
+    }
+
+    remove_regions(start, start + size);
+    mem->discard_span(Address(start), size);
+    const bool anonymous = flags & TARGET_MAP_ANONYMOUS;
+    if (!anonymous && !read_file(mem, start, size, host_fd, offset)) {
+        mem->discard_span(Address(start), size);
+        return -TARGET_EACCES;
+    }
+    regions[start] = { start, start + size, prot, flags, anonymous ? 0 : offset };
+    merge_regions(start, start + size);
+    return (int64_t)start;
+}
+
+int VirtualMemoryManager::munmap(FrontendMemory *mem, uint64_t addr, uint64_t length) {
+    if (addr % PAGE_SIZE != 0 || length == 0 || length > limit) { return -TARGET_EINVAL; }
+    const uint64_t size = page_align_up(length);
+    if (addr > limit - size || overlaps_hole(addr, size)) { return -TARGET_EINVAL; }
+    remove_regions(addr, addr + size);
+    mem->discard_span(Address(addr), size);
+    return 0;
+}
+
+int VirtualMemoryManager::mprotect(uint64_t addr, uint64_t length, int prot) {
+    if (addr % PAGE_SIZE != 0) { return -TARGET_EINVAL; }
+    if (length == 0) { return 0; }
+    if (length > limit || addr > limit - page_align_up(length)) { return -TARGET_ENOMEM; }
+    const uint64_t end = addr + page_align_up(length);
+
+    // Whole range has to be mapped.
+    uint64_t covered = addr;
+    auto it = regions.upper_bound(addr);
+    if (it != regions.begin()) { --it; }
+    for (; it != regions.end() && covered < end; ++it) {
+        if (it->second.end <= covered) { continue; }
+        if (it->first > covered) { break; }
+        covered = it->second.end;
+    }
+    if (covered < end) { return -TARGET_ENOMEM; }
+
+    split_at(addr);
+    split_at(end);
+    for (it = regions.lower_bound(addr); it != regions.end() && it->first < end; ++it) {
+        it->second.prot = prot;
+    }
+    merge_regions(addr, end);
+    return 0;
+}
+
+void VirtualMemoryManager::save_checkpoint(QDataStream &out) const {
+    std::vector<VirtualMemoryRegion> stored;
+    stored.reserve(regions.size());
+    for (const auto &region : regions) {
+        stored.push_back(region.second);
+    }
+    checkpoint::write_value(out, heap_start);
+    checkpoint::write_value(out, program_break);
+    checkpoint::write_vector(out, stored);
+}
+
+void VirtualMemoryManager::load_checkpoint(QDataStream &in) {
+    uint64_t loaded_heap_start = 0;
+    uint64_t loaded_break = 0;
+    std::vector<VirtualMemoryRegion> stored;
+    checkpoint::read_value(in, loaded_heap_start);
+    checkpoint::read_value(in, loaded_break);
+    checkpoint::read_vector(in, stored);
+    if (loaded_break < loaded_heap_start || loaded_break >= limit
+        || (loaded_heap_start == 0 && loaded_break != 0)) {
+        checkpoint::throw_truncated();
+    }
+    std::map<uint64_t, VirtualMemoryRegion> loaded_regions;
+    uint64_t previous_end = 0;
+    for (const VirtualMemoryRegion &region : stored) {
+        // Regions are stored ordered, they have to fit the address space of this manager.
+        if (region.start < previous_end || region.start >= region.end || region.end > limit
+            || region.start % PAGE_SIZE != 0 || region.end % PAGE_SIZE != 0
+            || overlaps_hole(region.start, region.end - region.start)) {
+            checkpoint::throw_truncated();
+        }
+        loaded_regions.emplace_hint(loaded_regions.end(), region.start, region);
+        previous_end = region.end;
+    }
+    heap_start = loaded_heap_start;
+    program_break = loaded_break;
+    regions = std::move(loaded_regions);
+}
+
+bool VirtualMemoryManager::overlaps_hole(uint64_t start, uint64_t size) const {
+    return start < hole_end && hole_start < start + size;
+}
+
+uint64_t VirtualMemoryManager::overlapping_mapping_end(uint64_t start, uint64_t size) const {
+    auto it = regions.lower_bound(start);
+    if (it != regions.begin()) {
+        auto previous = std::prev(it);
+        if (previous->second.end > start) { return previous->second.end; }
+    }
+    if (it != regions.end() && it->first < start + size) { return it->second.end; }
+    return 0;
+}
+
+uint64_t VirtualMemoryManager::find_free(uint64_t hint, uint64_t size) const {
+    const uint64_t heap_end = page_align_up(program_break);
+    auto blocked_until = [&](uint64_t start) -> uint64_t {
+        if (heap_start != 0 && start < heap_end && heap_start < start + size) { return heap_end; }
+        if (overlaps_hole(start, size)) { return hole_end; }
+        return overlapping_mapping_end(start, size);
+    };
+    // Hint below the mapping area could hit the program, which is not tracked.
+    if (hint >= mmap_base && hint % PAGE_SIZE == 0 && hint <= limit - size
+        && blocked_until(hint) == 0) {
+        return hint;
+    }
+    uint64_t candidate = mmap_base;
+    while (candidate <= limit - size) {
+        const uint64_t blocked = blocked_until(candidate);
+        if (blocked == 0) { return candidate; }
+        candidate = blocked;
+    }
+    return 0;
+}
+
+void VirtualMemoryManager::split_at(uint64_t address) {
+    auto it = regions.upper_bound(address);
+    if (it == regions.begin()) { return; }
+    --it;
+    VirtualMemoryRegion &region = it->second;
+    if (region.start == address || region.end <= address) { return; }
+    VirtualMemoryRegion tail = region;
+    tail.start = address;
+    if (!(tail.flags & TARGET_MAP_ANONYMOUS)) { tail.file_offset += address - region.start; }
+    region.end = address;
+    regions.emplace(address, tail);
+}
+
+void VirtualMemoryManager::remove_regions(uint64_t start, uint64_t end) {
+    split_at(start);
+    split_at(end);
+    regions.erase(regions.lower_bound(start), regions.lower_bound(end));
+}
+
+void VirtualMemoryManager::merge_regions(uint64_t start, uint64_t end) {
+    // File regions are not merged, the file they map is not recorded.
+    auto mergeable = [](const VirtualMemoryRegion &first, const VirtualMemoryRegion &second) {
+        return first.end == second.start && first.prot == second.prot
+               && first.flags == second.flags && (first.flags & TARGET_MAP_ANONYMOUS);
+    };
+    auto it = regions.lower_bound(start);
+    if (it != regions.begin()) { --it; }
+    while (it != regions.end() && it->first <= end) {
+        auto next = std::next(it);
+        if (next == regions.end()) { break; }
+        if (mergeable(it->second, next->second)) {
+            it->second.end = next->second.end;
+            regions.erase(next);
+        } else {
+            it = next;
+        }
+    }
+}
+
+bool VirtualMemoryManager::read_file(
+    FrontendMemory *mem,
+    uint64_t start,
+    uint64_t size,
+    int host_fd,
+    uint64_t offset) {
+    // Mapping does not move the file position of the descriptor.
+    const auto position = lseek(host_fd, 0, SEEK_CUR);
+    if (position < 0 || lseek(host_fd, offset, SEEK_SET) < 0) { return false; }
+    std::vector<uint8_t> buffer(std::min(size, FILE_CHUNK_SIZE));
+    bool success = true;
+    for (uint64_t done = 0; done < size;) {
+        const uint64_t chunk = std::min<uint64_t>(buffer.size(), size - done);
+        const auto count = read(host_fd, buffer.data(), chunk);
+        if (count < 0) {
+            success = false;
+            break;
+        }
+        // The rest of the range is past the end of the file and reads as zeros.
+        if (count == 0) { break; }
+        mem->write_span(Address(start + done), buffer.data(), count);
+        done += count;
+    }
+    lseek(host_fd, position, SEEK_SET);
+    return success;
+}
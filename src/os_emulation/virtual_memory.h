@@ -0,0 +1,146 @@
+#ifndef VIRTUAL_MEMORY_H
+#define VIRTUAL_MEMORY_H
+
+#include "machine/machineconfig.h"
+#include "machine/memory/frontend_memory.h"
+
+#include <QDataStream>
+#include <cstdint>
+#include <map>
+
+namespace osemu {
+
+// The copied from musl-libc
+
+#define TARGET_PROT_NONE  0
+#define TARGET_PROT_READ  1
+#define TARGET_PROT_WRITE 2
+#define TARGET_PROT_EXEC  4
+
+#define TARGET_MAP_SHARED          0x01
+#define TARGET_MAP_PRIVATE         0x02
+#define TARGET_MAP_SHARED_VALIDATE 0x03
+#define TARGET_MAP_TYPE            0x0f
+#define TARGET_MAP_FIXED           0x10
+#define TARGET_MAP_ANONYMOUS       0x20
+#define TARGET_MAP_FIXED_NOREPLACE 0x100000
+
+/** Area of the guest address space allocated by `mmap`. */
+struct VirtualMemoryRegion {
+    uint64_t start;
+    /** First address past the region, regions are whole pages. */
+    uint64_t end;
+    int prot;
+    int flags;
+    /** Offset in the file of the region start, unused for anonymous mappings. */
+    uint64_t file_offset;
+};
+
+/**
+ * Guest address space of the emulated process, program break and memory mappings.
+ *
+ * Mappings are placed between `mmap_base` and `limit` (end of the simulated RAM), the hole of
+ * peripherals between the RAM ranges of RV64 machines is never mapped. Content of
+ * a new mapping is discarded (see `FrontendMemory::discard_span`), so untouched pages of large
+ * allocations cost no host memory with paged memory layout. File mappings copy the file content
+ * at the time of the call, only the part of the range covered by the file is written, the rest
+ * reads as zeros. Changes of shared file mappings are not written back.
+ *
+ * Adjacent anonymous mappings with the same protection and flags are merged into one region.
+ * Protection is recorded only, the simulated machine has no MMU to enforce it.
+ */
+class VirtualMemoryManager {
+public:
+    static constexpr uint64_t PAGE_SIZE = 4096;
+    /** RV32 mappings are placed below the peripherals, see `machine::RAM_LAST_ADDR`. */
+    static constexpr uint64_t MMAP_BASE_32 = 0x60000000;
+    /** RV64 mappings are placed into the RAM above 4 GiB, see `machine::RAM_HIGH_START_ADDR`. */
+    static constexpr uint64_t MMAP_BASE_64 = 0x2000000000;
+
+    /** Address space of the RAM of a machine with given XLEN. */
+    explicit VirtualMemoryManager(machine::Xlen xlen);
+    /**
+     * @param hole_start    start of a range between `mmap_base` and `limit` never mapped
+     * @param hole_end      first address past the hole, the same as `hole_start` for no hole
+     */
+    VirtualMemoryManager(
+        uint64_t mmap_base,
+        uint64_t limit,
+        uint64_t hole_start = 0,
+        uint64_t hole_end = 0);
+
+    /**
+     * Moves the program break to `new_break`, zero only queries it. The first non-zero break
+     * starts the heap.
+     *
+     * @return new program break, the old one when the heap can't be moved there
+     */
+    uint64_t brk(machine::FrontendMemory *mem, uint64_t new_break);
+
+    /**
+     * @param host_fd   host file descriptor of file mappings, ignored for anonymous ones
+     * @param offset    offset in the file in bytes
+     * @return          address of the mapping or negative target errno
+     */
+    int64_t mmap(
+        machine::FrontendMemory *mem,
+        uint64_t addr,
+        uint64_t length,
+        int prot,
+        int flags,
+        int host_fd,
+        uint64_t offset);
+
+    /** @return 0 or negative target errno */
+    int munmap(machine::FrontendMemory *mem, uint64_t addr, uint64_t length);
+
+    /** @return 0 or negative target errno */
+    int mprotect(uint64_t addr, uint64_t length, int prot);
+
+    /** Mappings indexed by their start. */
+    [[nodiscard]] const std::map<uint64_t, VirtualMemoryRegion> &get_regions() const {
+        return regions;
+    }
+
+    /** Stores the heap and the mappings into a machine checkpoint, memory content is not stored. */
+    void save_checkpoint(QDataStream &out) const;
+    /**
+     * Restores state written by `save_checkpoint` by a manager of the same address space.
+     * Throws `SimulatorExceptionInput` and keeps the current state when the data are invalid.
+     */
+    void load_checkpoint(QDataStream &in);
+
+private:
+    /** Whether the range overlaps the hole of peripherals. */
+    [[nodiscard]] bool overlaps_hole(uint64_t start, uint64_t size) const;
+    /** End of a mapping overlapping the range, 0 when there is none. */
+    [[nodiscard]] uint64_t overlapping_mapping_end(uint64_t start, uint64_t size) const;
+    /** Start of a free range for a new mapping, 0 when there is none. */
+    [[nodiscard]] uint64_t find_free(uint64_t hint, uint64_t size) const;
+    /** Splits the region containing `address` so that a region starts there. */
+    void split_at(uint64_t address);
+    /** Forgets mappings of the range, the content is kept. */
+    void remove_regions(uint64_t start, uint64_t end);
+    /** Merges mergeable neighbouring regions touching the range. */
+    void merge_regions(uint64_t start, uint64_t end);
+    static bool read_file(
+        machine::FrontendMemory *mem,
+        uint64_t start,
+        uint64_t size,
+        int host_fd,
+        uint64_t offset);
+
+    const uint64_t mmap_base;
+    const uint64_t limit;
+    const uint64_t hole_start;
+    const uint64_t hole_end;
+    /** Start of the heap, 0 until the break is set. */
+    uint64_t heap_start = 0;
+    uint64_t program_break = 0;
+    /** Mappings indexed by their start. */
+    std::map<uint64_t, VirtualMemoryRegion> regions;
+};
+
+} // namespace osemu
+
+#endif // VIRTUAL_MEMORY_H
@@ -0,0 +1,288 @@
+#include "virtual_memory.test.h"
+
+#include "machine/memory/backend/memory.h"
+#include "machine/memory/memory_bus.h"
+#include "target_errno.h"
+#include "virtual_memory.h"
+
+#include <QBuffer>
+#include <QTemporaryFile>
+
+using namespace machine;
+using namespace osemu;
+
+constexpr int PROT_RW = TARGET_PROT_READ | TARGET_PROT_WRITE;
+constexpr int MAP_ANON = TARGET_MAP_PRIVATE | TARGET_MAP_ANONYMOUS;
+constexpr uint64_t BASE = 0x100000;
+constexpr uint64_t LIMIT = 0x200000;
+
+/** Start and end of each region. */
+static QList<QPair<uint64_t, uint64_t>> region_ranges(const VirtualMemoryManager &vm) {
+    QList<QPair<uint64_t, uint64_t>> ranges;
+    for (const auto &region : vm.get_regions()) {
+        ranges.append({ region.second.start, region.second.end });
+    }
+    return ranges;
+}
+
+void TestVirtualMemory::virtual_memory_brk() {
+    Memory ram(LITTLE, MemoryLayout::PAGED);
+    TrivialBus mem(&ram);
+    VirtualMemoryManager vm(BASE, LIMIT);
+
+    QCOMPARE(vm.brk(&mem, 0), (uint64_t)0);
+    QCOMPARE(vm.brk(&mem, 0x10010), (uint64_t)0x10010);
+    QCOMPARE(vm.brk(&mem, 0x12345), (uint64_t)0x12345);
+    QCOMPARE(vm.brk(&mem, 0), (uint64_t)0x12345);
+    mem.write_u32(0x12000_addr, 0x11223344);
+    mem.write_u32(0x10ffc_addr, 0x55667788);
+
+    // Released pages are zeroed, the page of the break is kept.
+    QCOMPARE(vm.brk(&mem, 0x10020), (uint64_t)0x10020);
+    QCOMPARE(mem.read_u32(0x12000_addr), (uint32_t)0);
+    QCOMPARE(mem.read_u32(0x10ffc_addr), (uint32_t)0x55667788);
+
+    // Break cannot move below the heap start nor past the limit.
+    QCOMPARE(vm.brk(&mem, 0x10000), (uint64_t)0x10020);
+    QCOMPARE(vm.brk(&mem, LIMIT), (uint64_t)0x10020);
+
+    // Heap cannot grow into a mapping.
+    QCOMPARE(vm.mmap(&mem, 0x14000, 0x1000, PROT_RW, MAP_ANON | TARGET_MAP_FIXED, -1, 0),
+             (int64_t)0x14000);
+    QCOMPARE(vm.brk(&mem, 0x14800), (uint64_t)0x10020);
+    QCOMPARE(vm.brk(&mem, 0x14000), (uint64_t)0x14000);
+}
+
+void TestVirtualMemory::virtual_memory_first_fit() {
+    Memory ram(LITTLE, MemoryLayout::PAGED);
+    TrivialBus mem(&ram);
+    VirtualMemoryManager vm(BASE, LIMIT);
+
+    QCOMPARE(vm.mmap(&mem, 0, 0x3000, PROT_RW, MAP_ANON, -1, 0), (int64_t)BASE);
+    QCOMPARE(vm.mmap(&mem, 0, 0x1001, TARGET_PROT_READ, MAP_ANON, -1, 0), (int64_t)0x103000);
+    QCOMPARE(vm.mmap(&mem, 0, 0x1000, PROT_RW, MAP_ANON, -1, 0), (int64_t)0x105000);
+    QCOMPARE(vm.munmap(&mem, 0x101000, 0x1000), 0);
+
+    // The first free range large enough is used, hint is preferred when it is free.
+    QCOMPARE(vm.mmap(&mem, 0, 0x2000, PROT_RW, MAP_ANON, -1, 0), (int64_t)0x106000);
+    QCOMPARE(vm.mmap(&mem, 0, 0x1000, PROT_RW, MAP_ANON, -1, 0), (int64_t)0x101000);
+    QCOMPARE(vm.mmap(&mem, 0x150000, 0x1000, PROT_RW, MAP_ANON, -1, 0), (int64_t)0x150000);
+    // Hint below the mapping area is ignored.
+    QCOMPARE(vm.mmap(&mem, 0x10000, 0x1000, PROT_RW, MAP_ANON, -1, 0), (int64_t)0x108000);
+
+    // Mappings skip the heap.
+    VirtualMemoryManager heap_vm(BASE, LIMIT);
+    QCOMPARE(heap_vm.brk(&mem, BASE), BASE);
+    QCOMPARE(heap_vm.brk(&mem, BASE + 0x1800), BASE + 0x1800);
+    QCOMPARE(heap_vm.mmap(&mem, 0, 0x1000, PROT_RW, MAP_ANON, -1, 0), (int64_t)0x102000);
+}
+
+void TestVirtualMemory::virtual_memory_split_merge() {
+    Memory ram(LITTLE, MemoryLayout::PAGED);
+    TrivialBus mem(&ram);
+    VirtualMemoryManager vm(BASE, LIMIT);
+
+    // Adjacent anonymous mappings are merged.
+    QCOMPARE(vm.mmap(&mem, 0, 0x2000, PROT_RW, MAP_ANON, -1, 0), (int64_t)0x100000);
+    QCOMPARE(vm.mmap(&mem, 0, 0x2000, PROT_RW, MAP_ANON, -1, 0), (int64_t)0x102000);
+    QCOMPARE(region_ranges(vm), (QList<QPair<uint64_t, uint64_t>> { { 0x100000, 0x104000 } }));
+
+    // Protection change splits the region and rejoins it.
+    QCOMPARE(vm.mprotect(0x101000, 0x2000, TARGET_PROT_READ), 0);
+    QCOMPARE(
+        region_ranges(vm), (QList<QPair<uint64_t, uint64_t>> {
+                               { 0x100000, 0x101000 },
+                               { 0x101000, 0x103000 },
+                               { 0x103000, 0x104000 } }));
+    QCOMPARE(vm.get_regions().at(0x101000).prot, TARGET_PROT_READ);
+    QCOMPARE(vm.get_regions().at(0x103000).prot, PROT_RW);
+    QCOMPARE(vm.mprotect(0x100000, 0x4000, PROT_RW), 0);
+    QCOMPARE(region_ranges(vm), (QList<QPair<uint64_t, uint64_t>> { { 0x100000, 0x104000 } }));
+
+    // Unmapping of the middle splits the region and zeroes the content.
+    mem.write_u32(0x101000_addr, 0x11223344);
+    mem.write_u32(0x102000_addr, 0x55667788);
+    QCOMPARE(vm.munmap(&mem, 0x101000, 0x1000), 0);
+    QCOMPARE(
+        region_ranges(vm), (QList<QPair<uint64_t, uint64_t>> {
+                               { 0x100000, 0x101000 }, { 0x102000, 0x104000 } }));
+    QCOMPARE(mem.read_u32(0x101000_addr), (uint32_t)0);
+    QCOMPARE(mem.read_u32(0x102000_addr), (uint32_t)0x55667788);
+
+    // Whole range has to be mapped for a protection change.
+    QCOMPARE(vm.mprotect(0x100000, 0x3000, TARGET_PROT_READ), -TARGET_ENOMEM);
+    QCOMPARE(vm.mprotect(0x100001, 0x1000, TARGET_PROT_READ), -TARGET_EINVAL);
+    QCOMPARE(vm.mprotect(0x100000, 0, TARGET_PROT_READ), 0);
+    QCOMPARE(vm.get_regions().at(0x100000).prot, PROT_RW);
+
+    // Unmapping of a range without mappings succeeds.
+    QCOMPARE(vm.munmap(&mem, 0x180000, 0x1000), 0);
+    QCOMPARE(vm.munmap(&mem, 0x180001, 0x1000), -TARGET_EINVAL);
+    QCOMPARE(vm.munmap(&mem, 0x180000, 0), -TARGET_EINVAL);
+}
+
+void TestVirtualMemory::virtual_memory_fixed() {
+    Memory ram(LITTLE, MemoryLayout::PAGED);
+    TrivialBus mem(&ram);
+    VirtualMemoryManager vm(BASE, LIMIT);
+
+    QCOMPARE(vm.mmap(&mem, 0, 0x4000, PROT_RW, MAP_ANON, -1, 0), (int64_t)0x100000);
+    mem.write_u32(0x101000_addr, 0x11223344);
+    mem.write_u32(0x103000_addr, 0x55667788);
+
+    QCOMPARE(
+        vm.mmap(&mem, 0x101000, 0x1000, PROT_RW, MAP_ANON | TARGET_MAP_FIXED_NOREPLACE, -1, 0),
+        (int64_t)-TARGET_EEXIST);
+    QCOMPARE(vm.mmap(&mem, 0x101800, 0x1000, PROT_RW, MAP_ANON | TARGET_MAP_FIXED, -1, 0),
+             (int64_t)-TARGET_EINVAL);
+
+    // Fixed mapping replaces the overlapped part with zeroed pages.
+    QCOMPARE(
+        vm.mmap(&mem, 0x101000, 0x1000, TARGET_PROT_READ, MAP_ANON | TARGET_MAP_FIXED, -1, 0),
+        (int64_t)0x101000);
+    QCOMPARE(mem.read_u32(0x101000_addr), (uint32_t)0);
+    QCOMPARE(mem.read_u32(0x103000_addr), (uint32_t)0x55667788);
+    QCOMPARE(
+        region_ranges(vm), (QList<QPair<uint64_t, uint64_t>> {
+                               { 0x100000, 0x101000 },
+                               { 0x101000, 0x102000 },
+                               { 0x102000, 0x104000 } }));
+
+    // Fixed mappings may be placed below the mapping area, not past the limit.
+    QCOMPARE(vm.mmap(&mem, 0x10000, 0x1000, PROT_RW, MAP_ANON | TARGET_MAP_FIXED, -1, 0),
+             (int64_t)0x10000);
+    QCOMPARE(
+        vm.mmap(&mem, LIMIT - 0x1000, 0x2000, PROT_RW, MAP_ANON | TARGET_MAP_FIXED, -1, 0),
+        (int64_t)-TARGET_ENOMEM);
+}
+
+void TestVirtualMemory::virtual_memory_exhaustion() {
+    Memory ram(LITTLE, MemoryLayout::PAGED);
+    TrivialBus mem(&ram);
+    VirtualMemoryManager vm(BASE, LIMIT);
+
+    QCOMPARE(vm.mmap(&mem, 0, LIMIT, PROT_RW, MAP_ANON, -1, 0), (int64_t)-TARGET_ENOMEM);
+    QCOMPARE(vm.mmap(&mem, 0, UINT64_MAX, PROT_RW, MAP_ANON, -1, 0), (int64_t)-TARGET_ENOMEM);
+    QCOMPARE(vm.mmap(&mem, 0, 0, PROT_RW, MAP_ANON, -1, 0), (int64_t)-TARGET_EINVAL);
+    QCOMPARE(
+        vm.mmap(&mem, 0, 0x1000, PROT_RW, TARGET_MAP_ANONYMOUS, -1, 0), (int64_t)-TARGET_EINVAL);
+
+    // The whole area can be mapped, then nothing more fits.
+    QCOMPARE(vm.mmap(&mem, 0, LIMIT - BASE - 0x1000, PROT_RW, MAP_ANON, -1, 0), (int64_t)BASE);
+    QCOMPARE(vm.mmap(&mem, 0, 0x2000, PROT_RW, MAP_ANON, -1, 0), (int64_t)-TARGET_ENOMEM);
+    QCOMPARE(vm.mmap(&mem, 0, 0x1000, PROT_RW, MAP_ANON, -1, 0), (int64_t)(LIMIT - 0x1000));
+    QCOMPARE(vm.mmap(&mem, 0, 0x1000, PROT_RW, MAP_ANON, -1, 0), (int64_t)-TARGET_ENOMEM);
+
+    // Released range is reused.
+    QCOMPARE(vm.munmap(&mem, 0x140000, 0x2000), 0);
+    QCOMPARE(vm.mmap(&mem, 0, 0x2000, PROT_RW, MAP_ANON, -1, 0), (int64_t)0x140000);
+}
+
+void TestVirtualMemory::virtual_memory_hole() {
+    Memory ram(LITTLE, MemoryLayout::PAGED);
+    TrivialBus mem(&ram);
+    VirtualMemoryManager vm(BASE, LIMIT, 0x140000, 0x180000);
+
+    QCOMPARE(vm.mmap(&mem, 0, 0x30000, PROT_RW, MAP_ANON, -1, 0), (int64_t)BASE);
+    QCOMPARE(vm.mmap(&mem, 0, 0x20000, PROT_RW, MAP_ANON, -1, 0), (int64_t)0x180000);
+    QCOMPARE(vm.mmap(&mem, 0x13f000, 0x2000, PROT_RW, MAP_ANON, -1, 0), (int64_t)0x1a0000);
+    QCOMPARE(
+        vm.mmap(&mem, 0x17f000, 0x1000, PROT_RW, MAP_ANON | TARGET_MAP_FIXED, -1, 0),
+        (int64_t)-TARGET_ENOMEM);
+    QCOMPARE(vm.munmap(&mem, 0x13f000, 0x2000), -TARGET_EINVAL);
+
+    // RV64 maps above 4 GiB, past the peripherals, RV32 below them.
+    VirtualMemoryManager vm64(Xlen::_64);
+    QCOMPARE(
+        vm64.mmap(&mem, 0, 0x1000, PROT_RW, MAP_ANON, -1, 0),
+        (int64_t)VirtualMemoryManager::MMAP_BASE_64);
+    QCOMPARE(
+        vm64.mmap(&mem, 0xf0000000, 0x1000, PROT_RW, MAP_ANON | TARGET_MAP_FIXED, -1, 0),
+        (int64_t)-TARGET_ENOMEM);
+    QCOMPARE(
+        vm64.mmap(&mem, 0x3ffffff000, 0x1000, PROT_RW, MAP_ANON | TARGET_MAP_FIXED, -1, 0),
+        (int64_t)0x3ffffff000);
+    VirtualMemoryManager vm32(Xlen::_32);
+    QCOMPARE(
+        vm32.mmap(&mem, 0xeffff000, 0x2000, PROT_RW, MAP_ANON | TARGET_MAP_FIXED, -1, 0),
+        (int64_t)-TARGET_ENOMEM);
+    QCOMPARE(
+        vm32.mmap(&mem, 0, 0x1000, PROT_RW, MAP_ANON, -1, 0),
+        (int64_t)VirtualMemoryManager::MMAP_BASE_32);
+}
+
+void TestVirtualMemory::virtual_memory_file() {
+    Memory ram(LITTLE, MemoryLayout::PAGED);
+    TrivialBus mem(&ram);
+    VirtualMemoryManager vm(BASE, LIMIT);
+
+    QTemporaryFile file;
+    QVERIFY(file.open());
+    QByteArray content(0x2100, '\0');
+    for (int i = 0; i < content.size(); i++) {
+        content[i] = char(((i & ~3) >> (8 * (i & 3))) & 0xff); // Little endian offsets of words
+    }
+    QVERIFY(file.write(content) == content.size());
+    QVERIFY(file.flush());
+    QVERIFY(file.seek(4));
+    const int fd = file.handle();
+
+    // Mapping starts at the page offset, the part past the end of the file reads as zeros.
+    const int flags = TARGET_MAP_PRIVATE;
+    QCOMPARE(vm.mmap(&mem, 0, 0x3000, PROT_RW, flags, fd, 0x1000), (int64_t)BASE);
+    QCOMPARE(mem.read_u32(0x100000_addr), (uint32_t)0x1000);
+    QCOMPARE(mem.read_u32(0x1010fc_addr), (uint32_t)0x20fc);
+    QCOMPARE(mem.read_u32(0x101100_addr), (uint32_t)0);
+    QCOMPARE(mem.read_u32(0x102000_addr), (uint32_t)0);
+    QCOMPARE(vm.mmap(&mem, 0, 0x1000, PROT_RW, flags, fd, 0x10), (int64_t)-TARGET_EINVAL);
+    QCOMPARE(file.pos(), (qint64)4);
+
+    // Split file regions keep their file offsets and are not merged back.
+    QCOMPARE(vm.mprotect(0x101000, 0x1000, TARGET_PROT_READ), 0);
+    QCOMPARE(vm.get_regions().at(0x101000).file_offset, (uint64_t)0x2000);
+    QCOMPARE(vm.get_regions().at(0x102000).file_offset, (uint64_t)0x3000);
+    QCOMPARE(vm.mprotect(0x101000, 0x1000, PROT_RW), 0);
+    QCOMPARE(vm.get_regions().size(), (size_t)3);
+}
+
+void TestVirtualMemory::virtual_memory_checkpoint() {
+    Memory ram(LITTLE, MemoryLayout::PAGED);
+    TrivialBus mem(&ram);
+    VirtualMemoryManager vm(BASE, LIMIT, 0x140000, 0x180000);
+    QCOMPARE(vm.brk(&mem, 0x10010), (uint64_t)0x10010);
+    QCOMPARE(vm.brk(&mem, 0x12345), (uint64_t)0x12345);
+    QCOMPARE(vm.mmap(&mem, 0, 0x3000, PROT_RW, MAP_ANON, -1, 0), (int64_t)BASE);
+    QCOMPARE(vm.mprotect(0x101000, 0x1000, TARGET_PROT_READ), 0);
+    QCOMPARE(vm.mmap(&mem, 0, 0x1000, PROT_RW, MAP_ANON, -1, 0), (int64_t)0x103000);
+
+    QByteArray data;
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::WriteOnly);
+    QDataStream out(&buffer);
+    vm.save_checkpoint(out);
+
+    // Restored manager continues with the same heap and finds the same free space.
+    VirtualMemoryManager restored(BASE, LIMIT, 0x140000, 0x180000);
+    QDataStream in(data);
+    restored.load_checkpoint(in);
+    QCOMPARE(region_ranges(restored), region_ranges(vm));
+    QCOMPARE(restored.get_regions().at(0x101000).prot, TARGET_PROT_READ);
+    QCOMPARE(restored.brk(&mem, 0), (uint64_t)0x12345);
+    QCOMPARE(restored.brk(&mem, 0x10000), (uint64_t)0x12345);
+    QCOMPARE(
+        restored.mmap(&mem, 0, 0x1000, PROT_RW, MAP_ANON, -1, 0),
+        vm.mmap(&mem, 0, 0x1000, PROT_RW, MAP_ANON, -1, 0));
+
+    // Mappings which do not fit the address space are rejected, the state is kept.
+    VirtualMemoryManager smaller(BASE, 0x102000);
+    QDataStream in_smaller(data);
+    bool thrown = false;
+    try {
+        smaller.load_checkpoint(in_smaller);
+    } catch (SimulatorExceptionInput &) { thrown = true; }
+    QVERIFY(thrown);
+    QVERIFY(smaller.get_regions().empty());
+    QCOMPARE(smaller.brk(&mem, 0), (uint64_t)0);
+}
+
+QTEST_APPLESS_MAIN(TestVirtualMemory)
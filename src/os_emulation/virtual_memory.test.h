@@ -0,0 +1,19 @@
+#ifndef VIRTUAL_MEMORY_TEST_H
+#define VIRTUAL_MEMORY_TEST_H
+
+#include <QtTest>
+
+class TestVirtualMemory : public QObject {
+    Q_OBJECT
+private slots:
+    static void virtual_memory_brk();
+    static void virtual_memory_first_fit();
+    static void virtual_memory_split_merge();
+    static void virtual_memory_fixed();
+    static void virtual_memory_exhaustion();
+    static void virtual_memory_hole();
+    static void virtual_memory_file();
+    static void virtual_memory_checkpoint();
+};
+
+#endif // VIRTUAL_MEMORY_TEST_H
@@ -0,0 +1,73 @@
+import subprocess
+
+import helpers as hp
+import constants as cn
+
+# Simulator is run in both modes, headless mode switches off all observer signals.
+BENCH_MODES = [("signals", []), ("headless", ["--headless"])]
+
+
+# If output of the qtrvsim-cli is changed this will probably break !!!
+def parse_ips(stdout):
+    instructions = 0
+    ips = 0.0
+    for line in stdout.decode("utf-8").splitlines():
+        if (line.startswith("instructions:")):
+            instructions = int(line.split(":")[1])
+        elif (line.startswith("ips:")):
+            ips = float(line.split(":")[1])
+    return instructions, ips
+
+
+def run_bench(sim_bin, params, test_path, mode_args):
+    param_bin = [sim_bin, test_path, "--dump-ips"] + mode_args
+    if (params.pipeline):
+        param_bin.append("--pipelined")
+    if (params.cache):
+        param_bin.extend(cn.CACHE_SETTINGS)
+    best = (0, 0.0)
+    for _ in range(max(params.bench_repeat, 1)):
+        res = subprocess.run(param_bin, capture_output=True)
+        instructions, ips = parse_ips(res.stdout)
+        if (ips > best[1]):
+            best = (instructions, ips)
+    return best
+
+
+def bench_tests(sim_bin, params, dir_path, tests):
+    max_width = hp.max_str_list(tests)
+    totals = {mode: [0, 0.0] for mode, _ in BENCH_MODES}
+    header = "test".ljust(max_width) + "  instr"
+    for mode, _ in BENCH_MODES:
+        header += "  " + (mode + " IPS").rjust(14)
+    print(header)
+    for test in tests:
+        line = ""
+        instructions = 0
+        for mode, mode_args in BENCH_MODES:
+            instructions, ips = run_bench(
+                sim_bin, params, dir_path + test, mode_args)
+            totals[mode][0] += instructions
+            if (ips > 0):
+                totals[mode][1] += instructions / ips
+            line += "  " + "{0:14.0f}".format(ips)
+        print(test.ljust(max_width) + "  " + str(instructions).rjust(5) + line)
+    line = ""
+    for mode, _ in BENCH_MODES:
+        instructions, seconds = totals[mode]
+        line += "  " + "{0:14.0f}".format(
+            instructions / seconds if seconds > 0 else 0)
+    print("total".ljust(max_width) + "       " + line + "\n")
+
+
+def benchmark(sim_bin, params, src_path, tests):
+    groups = [hp.get_RVxx(tests, "ui")]
+    if (params.multiply):
+        groups.append(hp.get_RVxx(tests, "um"))
+    if (params.atomic):
+        groups.append(hp.get_RVxx(tests, "ua"))
+    for tests32, tests64 in groups:
+        if (not params.no32):
+            bench_tests(sim_bin, params, src_path + cn.ELF_PATH, tests32)
+        if (not params.no64):
+            bench_tests(sim_bin, params, src_path + cn.ELF_PATH, tests64)
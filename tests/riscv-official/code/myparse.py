@@ -88,6 +88,16 @@ def init_parser():
                      default=0,
                      dest="selftest",
                      help="Enable simple tests to check if tester behaves properly.")
+    gth.add_argument("-B", "--benchmark",
+                     action="count",
+                     default=0,
+                     dest="benchmark",
+                     help="Measure instructions per second with and without headless mode instead of testing.")
+    gth.add_argument("--bench-repeat",
+                     type=int,
+                     default=3,
+                     dest="bench_repeat",
+                     help="Number of runs per test in benchmark mode (best run is reported).")
     gth.add_argument("--clean",
                      action="count",
                      default=0,
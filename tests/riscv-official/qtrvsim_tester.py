@@ -9,6 +9,7 @@ import constants as cn
 import myparse as mp
 import testing as ts
 import selftesting as sts
+import benchmark as bm
 
 parser = mp.init_parser()
 params = parser.parse_args()
@@ -34,6 +35,10 @@ test_files, t_file_check = ts.load_filenames(
 if (params.selftest):
     sts.self_test(sim_bin, params, SRC_DIR, self_files)
 
+if (params.benchmark):
+    bm.benchmark(sim_bin, params, SRC_DIR, test_files)
+    sys.exit(0)
+
 ts.test_selector(sim_bin, params, SRC_DIR, test_files)
 
 sys.exit(0)